@@ -292,6 +292,7 @@ class QwADC18_Channel: public VQwHardwareChannel, public MQwMockable {
   size_t fPreviousSequenceNumber; ///< Previous event sequence number for this channel
   size_t fNumberOfSamples;     ///< Number of samples  read through the module
   size_t fNumberOfSamples_map; ///< Number of samples in the expected to  read through the module. This value is set in the QwBeamline map file
+  Int_t fDividerValue;         ///< Divider value of the first diff word (-1 before it)
 
   // Set of error counters for each HW test.
   Int_t fErrorCount_HWSat;    ///< check to see ADC channel is saturated
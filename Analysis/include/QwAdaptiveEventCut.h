@@ -0,0 +1,156 @@
+/*!
+ * \file   QwAdaptiveEventCut.h
+ * \brief  Event cut limits relative to robust rolling statistics
+ */
+
+#ifndef __QwAdaptiveEventCut__
+#define __QwAdaptiveEventCut__
+
+// System headers
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Boost headers
+#include <boost/shared_ptr.hpp>
+
+// Forward declarations
+class QwOptions;
+
+/**
+ *  \class QwAdaptiveEventCut
+ *  \ingroup QwAnalysis
+ *  \brief Event cut limits relative to robust rolling statistics
+ *
+ * For the channels in the map file given with --adaptive-eventcuts-map,
+ * the lower and upper event cut limits are not taken from the eventcuts
+ * file, but follow the center and width of the channel value over the
+ * last 'window' events:
+ *   limits = center -/+ nsigma * width.
+ * The center and width are the median and the scaled median absolute
+ * deviation (statistic 'median'), or the 10% trimmed mean and the scaled
+ * trimmed standard deviation (statistic 'trimmed'); both are consistent
+ * with the mean and sigma of a normal distribution.  One line per channel:
+ *   qwk_bcm1       2000  5  median
+ *   qwk_bpm3h04XP  2000  6  trimmed
+ *
+ * Only values within the limits of the eventcuts file, and of events
+ * without hardware errors, beam trip or BCM cut flags, enter the window;
+ * values which fail the adaptive limits do, so that the limits follow a
+ * shift of the baseline.  Channels without limits in the eventcuts file
+ * accept all values of good events.  The limits are recalculated every
+ * --adaptive-eventcuts-update accepted values once the window is full;
+ * until then the limits of the eventcuts file apply.  The limits in
+ * effect over the run are written to the text file given with
+ * --adaptive-eventcuts-log.
+ *
+ * The map file only holds the configuration: every channel object gets
+ * its own copy with an empty window from Create(), so that copies of a
+ * channel (in analysis branches or running sums) do not share a window.
+ * The configuration belongs to the current analysis context (see
+ * QwAnalysisContext), or to the process without one; a cut keeps the
+ * update interval and log of the configuration it was created from.
+ */
+class QwAdaptiveEventCut {
+
+  public:
+
+    /// Statistics of the center and width
+    enum EQwStatistic { kMedian, kTrimmedMean };
+
+    /// \brief Constructor
+    QwAdaptiveEventCut(const TString& channel, size_t window, Double_t nsigma, EQwStatistic statistic);
+    /// \brief Destructor
+    virtual ~QwAdaptiveEventCut() { };
+
+    /// \brief Add a value if accepted, update the limits when due, and
+    ///        set the limits once they are valid
+    void Update(Double_t value, Bool_t accept, Double_t& lower, Double_t& upper) {
+      if (accept) {
+        fWindow[fNext] = value;
+        if (++fNext == fWindow.size()) fNext = 0;
+        if (fEntries < fWindow.size()) fEntries++;
+        if (fEntries == fWindow.size() && ++fSinceUpdate >= fUpdateInterval) {
+          Recalculate();
+          fSinceUpdate = 0;
+        }
+      }
+      if (fIsValid) {
+        lower = fLower;
+        upper = fUpper;
+      }
+    };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options and load the map file
+    static void ProcessOptions(QwOptions& options);
+
+    /// \brief Load the adaptive cuts from a map file
+    static void LoadCutMap(const std::string& mapfile);
+    /// \brief Remove all adaptive cuts
+    static void Clear();
+
+    /// \brief Create a new adaptive cut for a channel (null if none)
+    static QwAdaptiveEventCut* Create(const TString& channel);
+    /// Generation of the cut map, changed whenever it changes
+    static UInt_t GetGeneration() { return GetConfiguration().fGeneration; };
+
+    /**
+     *  \class Configuration
+     *  \brief Adaptive cuts, update interval and log of one analysis
+     */
+    class Configuration {
+      public:
+        /// \brief Constructor with an empty cut map
+        Configuration();
+        /// Configuration of the adaptive cuts by lowercase channel name
+        std::map<TString, boost::shared_ptr<QwAdaptiveEventCut> > fChannelCuts;
+        /// Generation of the cut map, unique in the process
+        UInt_t fGeneration;
+        /// Events between updates of the limits
+        size_t fUpdateInterval;
+        /// Log of the limits, shared with the cuts created from this configuration
+        boost::shared_ptr<std::ofstream> fLogFile;
+    };
+    /// \brief Configuration of the current analysis context, or of the process
+    static Configuration& GetConfiguration();
+
+  private:
+
+    /// Private default constructor
+    QwAdaptiveEventCut();
+
+    /// \brief Recalculate the center, width and limits from the window
+    void Recalculate();
+
+    TString fChannel;
+    Double_t fNumberOfSigma;
+    EQwStatistic fStatistic;
+
+    /// Circular buffer of the last values
+    std::vector<Double_t> fWindow;
+    size_t fNext;
+    size_t fEntries;
+    /// Scratch space for the order statistics
+    std::vector<Double_t> fSorted;
+
+    /// Events since the last update, and total number of updates
+    size_t fSinceUpdate;
+    UInt_t fUpdates;
+
+    /// Current limits
+    Bool_t fIsValid;
+    Double_t fLower, fUpper;
+
+    /// Events between updates of the limits, and log of the limits
+    size_t fUpdateInterval;
+    boost::shared_ptr<std::ofstream> fLogFile;
+};
+
+#endif // __QwAdaptiveEventCut__
@@ -0,0 +1,123 @@
+/*!
+ * \file   QwAnalysisContext.h
+ * \brief  Per-analysis ownership of the options, histogram helper, cut maps and mock data randomness
+ */
+
+#ifndef __QwAnalysisContext__
+#define __QwAnalysisContext__
+
+// System headers
+#include <string>
+
+// Boost headers
+#include <boost/random.hpp>
+
+// ROOT headers
+#include "Rtypes.h"
+
+// Qweak headers
+#include "QwAdaptiveEventCut.h"
+#include "QwNonlinearityCorrection.h"
+
+// Forward declarations
+class QwOptions;
+class QwHistogramHelper;
+
+/**
+ *  \class QwAnalysisContext
+ *  \ingroup QwAnalysis
+ *  \brief Per-analysis ownership of the options, histogram helper and mock data randomness
+ *
+ * The analyzer reaches its configuration through process-wide facilities:
+ * gQwOptions, gQwHists, the random generator of the mock data, and the
+ * adaptive event cut and nonlinearity correction maps.  An analysis
+ * context owns its own copies of these, so that two analyses with
+ * a different configuration can run in one process, each in its own thread.
+ * A context is made current for the calling thread with a Scope:
+ * \code
+ * QwAnalysisContext context("overlay");
+ * QwAnalysisContext::Scope scope(context);
+ * DefineOptionsParity(gQwOptions);   // the options of this context
+ * gQwOptions.SetCommandLine(argc, argv);
+ * gQwHists.ProcessOptions(gQwOptions);
+ * \endcode
+ * While a scope is active, these facilities resolve to those of the
+ * context; without one they resolve to the process defaults, so existing
+ * code runs unchanged.  The context is only consulted when the facilities
+ * are looked up, so objects which are configured in one context should be
+ * processed in the same one.
+ *
+ * Not per analysis, by design: the log (gQwLog), whose thresholds and log
+ * file are set once by the main program (the level of a message being
+ * written is per thread, but lines of concurrent analyses may interleave),
+ * the registry of active feedback handlers (QwFeedbackHandler), since the
+ * feedback controls act on the one beam, and the parameter file search
+ * path and list of opened parameter files (QwParameterFile).  The registry
+ * and the file list are guarded for concurrent analyses.
+ */
+class QwAnalysisContext {
+
+  public:
+
+    /// \brief Constructor with a name and the seed of the mock data randomness
+    QwAnalysisContext(const std::string& name, UInt_t seed = 5489u);
+    /// \brief Destructor
+    virtual ~QwAnalysisContext();
+
+    /// Name of the context
+    const std::string& GetName() const { return fName; };
+
+    /// Options of this context
+    QwOptions& GetOptions() { return *fOptions; };
+    /// Histogram and tree trim helper of this context
+    QwHistogramHelper& GetHistogramHelper() { return *fHistogramHelper; };
+    /// Normal random variable of the mock data of this context
+    Double_t GetNormalRandomVariable() { return fNormalRandomVariable(); };
+    /// Adaptive event cuts of this context
+    QwAdaptiveEventCut::Configuration& GetAdaptiveEventCuts() { return *fAdaptiveEventCuts; };
+    /// Nonlinearity corrections of this context
+    QwNonlinearityCorrection::Configuration& GetNonlinearityCorrections() { return *fNonlinearityCorrections; };
+
+    /// \brief Context of the calling thread, or null for the process defaults
+    static QwAnalysisContext* GetCurrent();
+
+    /**
+     *  \class Scope
+     *  \brief Makes a context current for the calling thread during its lifetime
+     */
+    class Scope {
+      public:
+        /// \brief Make the context current, and remember the previous one
+        Scope(QwAnalysisContext& context);
+        /// \brief Restore the previous context
+        ~Scope();
+      private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+        QwAnalysisContext* fPrevious;
+    };
+
+  private:
+
+    /// Private default constructor
+    QwAnalysisContext();
+    /// Private copy constructor, not implemented
+    QwAnalysisContext(const QwAnalysisContext&);
+    /// Private assignment operator, not implemented
+    QwAnalysisContext& operator=(const QwAnalysisContext&);
+
+    std::string fName;
+
+    QwOptions* fOptions;
+    QwHistogramHelper* fHistogramHelper;
+    QwAdaptiveEventCut::Configuration* fAdaptiveEventCuts;
+    QwNonlinearityCorrection::Configuration* fNonlinearityCorrections;
+
+    /// Mock data randomness, as in MQwMockable
+    boost::mt19937 fRandomnessGenerator;
+    boost::normal_distribution<double> fNormalDistribution;
+    boost::variate_generator
+      < boost::mt19937&, boost::normal_distribution<double> > fNormalRandomVariable;
+};
+
+#endif // __QwAnalysisContext__
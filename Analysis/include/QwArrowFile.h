@@ -0,0 +1,106 @@
+/*!
+ * \file   QwArrowFile.h
+ * \brief  Columnar export of a ROOT tree in Apache Arrow IPC format
+ */
+
+#ifndef __QwArrowFile__
+#define __QwArrowFile__
+
+// System headers
+#include <memory>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class TTree;
+class TLeaf;
+namespace arrow {
+  class Schema;
+  namespace io { class FileOutputStream; }
+  namespace ipc { class RecordBatchWriter; }
+}
+
+/**
+ *  \class QwArrowFile
+ *  \ingroup QwAnalysis
+ *  \brief Columnar export of a ROOT tree in Apache Arrow IPC format
+ *
+ * Writes the entries of a tree to an Arrow IPC file (Feather version 2), so
+ * that the burst and run summaries can be read as memory-mapped columns,
+ * e.g. with pyarrow or pandas, without a ROOT installation.  There is one
+ * column per leaf, with the same names as in ROOT: the branch name for a
+ * branch with a single leaf, and 'branch.leaf' for the leaves of a leaf
+ * list, so 'bcm1.hw_sum' or 'ErrorFlag'.  Elements of fixed-size arrays
+ * get their flattened index, 'eigenvalues[2]'.  Floating point leaves are
+ * written as float64 and integer leaves as int64; string leaves and arrays
+ * of variable size are not exported.
+ *
+ * The columns are taken from the tree at the first entry, when all branches
+ * have been constructed.  The entries are collected into record batches of
+ * --arrow-batch-size rows.  QwRootFile creates an Arrow file for each tree
+ * selected with --arrow-tree, and fills it together with the tree.
+ */
+class QwArrowFile {
+
+  public:
+
+    /// \brief Constructor with the file name and the tree to export
+    QwArrowFile(const TString& filename, TTree* tree, Int_t batchsize);
+    /// \brief Destructor, which writes the last batch and closes the file
+    virtual ~QwArrowFile();
+
+    /// \brief Append the current values of the tree leaves as a row
+    void Fill();
+    /// \brief Write the last batch and close the file
+    void Close();
+
+    /// Number of rows written so far
+    Long64_t GetEntries() const { return fEntries; };
+
+  private:
+
+    /// Private default constructor
+    QwArrowFile();
+    /// Private copy constructor, not implemented
+    QwArrowFile(const QwArrowFile&);
+    /// Private assignment operator, not implemented
+    QwArrowFile& operator=(const QwArrowFile&);
+
+    /// \brief Determine the columns and open the file
+    Bool_t Open();
+    /// \brief Write the collected rows as a record batch
+    Bool_t WriteBatch();
+
+    /// Column for one element of a leaf
+    struct Column {
+      std::string fName;
+      TLeaf* fLeaf;
+      Int_t fIndex;
+      Bool_t fIsInteger;
+      std::vector<Double_t> fDouble;
+      std::vector<Long64_t> fInteger;
+    };
+    std::vector<Column> fColumns;
+
+    TString fFileName;
+    TTree* fTree;
+    size_t fBatchSize;
+
+    /// Rows in the current batch, and rows written
+    size_t fRows;
+    Long64_t fEntries;
+
+    /// File is open for writing, or was closed after an error
+    Bool_t fIsOpen;
+    Bool_t fIsFailed;
+
+    std::shared_ptr<arrow::Schema> fSchema;
+    std::shared_ptr<arrow::io::FileOutputStream> fStream;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> fWriter;
+};
+
+#endif // __QwArrowFile__
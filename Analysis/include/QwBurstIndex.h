@@ -0,0 +1,83 @@
+#ifndef __QWBURSTINDEX__
+#define __QWBURSTINDEX__
+
+// System headers
+#include <vector>
+#include <utility>
+
+// ROOT headers
+#include "TNamed.h"
+
+// Forward declarations
+class TTree;
+
+/**
+ *  \class QwBurstIndex
+ *  \ingroup QwAnalysis
+ *  \brief Entry ranges of the bursts in a tree
+ *
+ * For the trees selected with --burst-aligned-tree, QwRootFile flushes the
+ * baskets at the end of every burst, so that each burst starts a new
+ * cluster, and stores this index in the user info of the tree.  Each burst
+ * covers the entries [first, end) of the tree.  The burst number is the
+ * BurstCounter of the patterns in that range.
+ *
+ * For trees filled per pattern (mul, pr) the ranges match the BurstCounter
+ * branch exactly.  In trees filled per helicity window (evt) the windows of
+ * the pattern which starts the next burst are already filled when the
+ * burst ends, and are counted in the earlier burst.
+ *
+ * Readers use the index as follows, e.g. to process the bursts in parallel:
+ * \code
+ * const QwBurstIndex* index = QwBurstIndex::GetFromTree(tree);
+ * for (Int_t i = 0; index && i < index->GetNumberOfBursts(); i++)
+ *   process(tree, index->GetFirstEntry(i), index->GetEndEntry(i));
+ * \endcode
+ * The index only describes the tree it was written with: after merging
+ * files with hadd, CheckTree will reject it.
+ */
+class QwBurstIndex : public TNamed {
+
+ public:
+
+  /// Name of the index in the user info of a tree
+  static const char* const kName;
+
+  QwBurstIndex();
+  virtual ~QwBurstIndex() { };
+
+  /// \brief Add a burst which ends before entry 'end', if it has entries
+  Bool_t AddBurst(Int_t burst, Long64_t end);
+
+  /// Number of bursts
+  Int_t GetNumberOfBursts() const { return fBurst.size(); };
+  /// Burst number, first entry and end entry of the i-th burst
+  Int_t GetBurst(Int_t i) const { return fBurst.at(i); };
+  Long64_t GetFirstEntry(Int_t i) const { return (i > 0)? fEndEntry.at(i-1): 0; };
+  Long64_t GetEndEntry(Int_t i) const { return fEndEntry.at(i); };
+  /// Number of entries covered by the index
+  Long64_t GetEntries() const { return fEndEntry.empty()? 0: fEndEntry.back(); };
+
+  /// \brief Entry range [first, end) of a burst number
+  Bool_t GetEntryRange(Int_t burst, Long64_t& first, Long64_t& end) const;
+  /// \brief Entry ranges [first, end) of all bursts
+  std::vector< std::pair<Long64_t,Long64_t> > GetEntryRanges() const;
+
+  /// \brief Get the burst index stored with a tree, or null
+  static const QwBurstIndex* GetFromTree(TTree* tree);
+  /// \brief Check the index against the entries and the burst counter of a tree
+  Bool_t CheckTree(TTree* tree, const char* branch = "BurstCounter") const;
+
+  void Print(Option_t* option = "") const;
+
+ private:
+
+  /// Burst numbers, and the entry after the last entry of each burst
+  std::vector<Int_t> fBurst;
+  std::vector<Long64_t> fEndEntry;
+
+  ClassDef(QwBurstIndex,1);
+
+};
+
+#endif // __QWBURSTINDEX__
@@ -0,0 +1,122 @@
+/*!
+ * \file   QwCodaFileCheck.h
+ * \brief  Validation and content summary of a CODA data file without decoding
+ */
+
+#ifndef __QwCodaFileCheck__
+#define __QwCodaFileCheck__
+
+// System headers
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+
+/**
+ *  \class QwCodaFileCheck
+ *  \ingroup QwAnalysis
+ *  \brief Validation and content summary of a CODA data file without decoding
+ *
+ * The file is memory-mapped and scanned once.  The block structure is
+ * checked (block size, block numbers, header size, magic word, the start
+ * of the first event in each block, and truncated last blocks), and the
+ * events are followed across the blocks.  For each event the bank
+ * structure is checked down to the subbanks of the ROC banks, without
+ * decoding any data.  The summary lists the number of events per event
+ * type, ROC and bank, the physics event number range and its gaps, the
+ * control events with their times, and the number of EPICS events.
+ *
+ * After a corrupted block the scan continues at the first event which
+ * starts in the next good block.  Compressed files cannot be mapped, and
+ * are reported as not checked.
+ */
+class QwCodaFileCheck {
+
+  public:
+
+    /// \brief Constructor with the name of the file
+    QwCodaFileCheck(const std::string& filename);
+    /// \brief Destructor
+    virtual ~QwCodaFileCheck() { };
+
+    /// \brief Scan the file
+    Bool_t Scan();
+
+    /// Name of the file
+    const std::string& GetFileName() const { return fFileName; };
+    /// Did the file pass all checks?
+    Bool_t IsValid() const { return fScanned && fNumErrors == 0; };
+    /// Number of problems found
+    Long64_t GetNumberOfErrors() const { return fNumErrors; };
+
+    /// Physics event number range
+    UInt_t GetFirstEventNumber() const { return fFirstEventNumber; };
+    UInt_t GetLastEventNumber() const { return fLastEventNumber; };
+    Long64_t GetNumberOfPhysicsEvents() const { return fNumPhysicsEvents; };
+
+    /// \brief Print the summary of the file
+    void PrintSummary(Bool_t brief = kFALSE) const;
+
+  private:
+
+    /// Private default constructor
+    QwCodaFileCheck();
+
+    /// \brief Check the blocks of the mapped file
+    void ScanBlocks(const UInt_t* words, size_t nwords);
+    /// \brief Check and count one complete event
+    void ScanEvent(const UInt_t* event, UInt_t length);
+    /// \brief Check and count the ROC banks of a physics event
+    void ScanBanks(const UInt_t* event, UInt_t length);
+    /// \brief Record a problem (only the first ones are kept)
+    void AddError(const std::string& message);
+
+    /// Word of the file in host byte order
+    UInt_t Word(const UInt_t* words, size_t index) const {
+      UInt_t w = words[index];
+      return fByteSwapped? __builtin_bswap32(w): w;
+    };
+
+    std::string fFileName;
+    Bool_t fScanned;
+
+    /// Block structure
+    size_t fFileSize;
+    UInt_t fBlockSize;
+    Long64_t fNumBlocks;
+    Bool_t fByteSwapped;
+
+    /// Events per event type, ROC and bank (ROC, tag)
+    Long64_t fNumEvents;
+    std::map<UInt_t, Long64_t> fEventTypeCount;
+    std::map<UInt_t, Long64_t> fROCCount;
+    std::map<std::pair<UInt_t, UInt_t>, Long64_t> fBankCount;
+
+    /// Physics event numbers and their gaps
+    Long64_t fNumPhysicsEvents;
+    UInt_t fFirstEventNumber;
+    UInt_t fLastEventNumber;
+    Long64_t fNumGaps;
+    Long64_t fNumMissingEvents;
+
+    /// Control events: type, time and the run number or event count
+    struct ControlEvent {
+      UInt_t fType;
+      UInt_t fTime;
+      UInt_t fValue;
+    };
+    std::vector<ControlEvent> fControlEvents;
+
+    /// Problems found, the first kMaxErrors of them with a message
+    static const size_t kMaxErrors = 20;
+    Long64_t fNumErrors;
+    std::vector<std::string> fErrors;
+
+    /// Event which continues in the following blocks
+    std::vector<UInt_t> fPartialEvent;
+};
+
+#endif // __QwCodaFileCheck__
@@ -0,0 +1,104 @@
+/*!
+ * \file   QwEPICSCarryForward.h
+ * \brief  EPICS values carried forward onto the pattern and burst trees
+ */
+
+#ifndef __QwEPICSCarryForward__
+#define __QwEPICSCarryForward__
+
+// System headers
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class TTree;
+class QwOptions;
+class QwEPICSEvent;
+
+/**
+ *  \class QwEPICSCarryForward
+ *  \ingroup QwAnalysis
+ *  \brief Last value and update count of selected EPICS tags
+ *
+ * The EPICS tags selected with --epics-carry-forward are followed through
+ * the EPICS events of the run.  For each tag, the last value as of the
+ * current entry and the number of EPICS events which contained the tag so
+ * far are written as two branches, 'epics_<tag>' and 'epics_<tag>_n'
+ * (colons replaced with underscores), on every tree the object is added
+ * to.  String values are hashed as in the slow tree.  Before the first
+ * update of a tag the value is -999999 and the count is zero.
+ *
+ * The EPICS events are decoded ahead of the events which leave the event
+ * ring, where the patterns are formed.  Each EPICS event is therefore
+ * queued with the CODA event number of the last event which was decoded
+ * before it, and applied only when the first later event leaves the ring,
+ * so that the patterns which were complete before the EPICS event keep
+ * the earlier values.
+ *
+ * The object can be added to several trees; the position in the branch
+ * vector is kept separately for each tree.
+ */
+class QwEPICSCarryForward {
+
+  public:
+
+    /// \brief Constructor with options
+    QwEPICSCarryForward(QwOptions& options);
+    /// \brief Destructor
+    virtual ~QwEPICSCarryForward() { };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options
+    void ProcessOptions(QwOptions& options);
+
+    /// Are there any tags to carry forward?
+    Bool_t IsEnabled() const { return ! fTags.empty(); };
+
+    /// \brief Look up the tags in the EPICS event
+    void ConnectTags(const QwEPICSEvent& epicsevent);
+    /// \brief Queue the values of an EPICS event after an event number
+    void Update(const QwEPICSEvent& epicsevent, UInt_t event_number);
+    /// \brief Apply the queued EPICS events from before an event number
+    void ApplyUpdates(UInt_t event_number);
+    /// \brief Reset all values and counts
+    void Clear();
+
+    /// \brief Construct the branch and tree vector
+    void ConstructBranchAndVector(TTree *tree, TString& prefix, std::vector<Double_t>& values);
+    /// \brief Fill the tree vector
+    void FillTreeVector(std::vector<Double_t>& values) const;
+
+  private:
+
+    /// Private default constructor
+    QwEPICSCarryForward();
+
+    /// Tags and their index in the EPICS event
+    std::vector<std::string> fTags;
+    std::vector<Int_t> fTagIndex;
+
+    /// Last value and number of updates of each tag
+    std::vector<Double_t> fValue;
+    std::vector<Double_t> fUpdates;
+
+    /// EPICS event which is not applied yet
+    struct PendingUpdate {
+      UInt_t fEventNumber;          ///< last event decoded before the EPICS event
+      std::vector<Double_t> fValue; ///< values of the tags
+      std::vector<Bool_t> fFilled;  ///< was the tag in the EPICS event?
+    };
+    /// Queued EPICS events, in the order in which they were decoded
+    std::deque<PendingUpdate> fPending;
+
+    /// Position in the branch vector of each tree
+    std::map<const std::vector<Double_t>*, size_t> fTreeArrayIndex;
+};
+
+#endif // __QwEPICSCarryForward__
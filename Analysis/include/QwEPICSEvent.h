@@ -58,6 +58,8 @@ class QwEPICSEvent
 
   Double_t GetDataValue(const string& tag) const;      // get recent value corr. to tag
   TString  GetDataString(const string& tag) const;
+  Bool_t   IsDataFilled(Int_t index) const;           // was the tag in the last EPICS event
+  Double_t GetTreeValue(Int_t index) const;           // value as stored in the slow tree
 
 
   int SetDataValue(const string& tag, const double value, const int event);
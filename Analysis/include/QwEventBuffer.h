@@ -102,6 +102,15 @@ class QwEventBuffer: public MQwCodaControlEvent{
 
   const TString&  GetDataFile() const {return fDataFile;};
   const TString&  GetDataDirectory() const {return fDataDirectory;};
+  /// \brief Returns the data files read by the current stream (empty if online)
+  std::vector<TString> GetDataFileList() const;
+
+  /// \brief Number of blocks in the current data file (zero if online or compressed)
+  Int_t GetDataFileBlockCount() const;
+  /// \brief Block of the current data file which holds the last event read
+  Int_t GetDataFileBlock() const;
+  /// \brief Continue reading at the first event which starts in a block
+  Int_t SeekDataFileBlock(Int_t block);
 
   Int_t ReOpenStream();
 
@@ -152,6 +161,7 @@ class QwEventBuffer: public MQwCodaControlEvent{
 
 
   Int_t EncodeSubsystemData(QwSubsystemArray &subsystems);
+  Int_t EncodeEPICSEvent(const std::string& text);
   Int_t EncodePrestartEvent(int runnumber, int runtype = 0);
   Int_t EncodeGoEvent();
   Int_t EncodePauseEvent();
@@ -174,6 +184,7 @@ class QwEventBuffer: public MQwCodaControlEvent{
   TString fETStationName;
   Int_t   fETWaitMode;
   Bool_t  fExitOnEnd;
+  Bool_t  fETZeroCopy;
 
   Bool_t fAllowLowSubbankIDs;
 
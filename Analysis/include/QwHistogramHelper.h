@@ -23,6 +23,9 @@ class QwHistogramHelper{
   QwHistogramHelper(): fDEBUG(kFALSE) { fHistParams.clear(); };
   virtual ~QwHistogramHelper() { };
 
+  /// \brief Get instance of the current analysis context, or the process default
+  static QwHistogramHelper& Instance();
+
   /// \brief Define the configuration options
   static void DefineOptions(QwOptions &options);
   /// \brief Process the configuration options
@@ -155,9 +158,9 @@ class QwHistogramHelper{
   std::vector<std::vector<std::vector<TString> > > fVQWKTrimmedList; //will store list of VQWK elements for each subsystem for each module  
 };
 
-//  Declare a global copy of the histogram helper.
-//  It is instantiated in the source file.
-extern QwHistogramHelper gQwHists;
+//  The global copy of the histogram helper is the one of the current
+//  analysis context, or the process default instantiated in the source file.
+#define gQwHists QwHistogramHelper::Instance()
 
 #endif
 
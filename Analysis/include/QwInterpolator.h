@@ -6,7 +6,13 @@
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <cmath>
+#include <cstring>
 #include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // Qweak headers
 #include "QwLog.h"
@@ -46,6 +52,10 @@ typedef double coord_t;
  *
  * The minimum, maximum, and step size of the grid have to be known before
  * the values are filled.
+ *
+ * Large read-only tables can be memory-mapped from a binary file with
+ * MapBinaryFile instead of being read into memory; the values are then
+ * accessed directly in the file and cannot be changed.
  */
 template <class value_t = float, unsigned int value_n = 1>
 class QwInterpolator {
@@ -53,7 +63,9 @@ class QwInterpolator {
   public: // constructors and destructor
 
     /// Constructor with number of dimensions
-    QwInterpolator(const unsigned int ndim = 1) {
+    QwInterpolator(const unsigned int ndim = 1)
+    : fMappedRegion(0), fMappedLength(0), fMappedValues(0),
+      fCurrentEntries(0), fMaximumEntries(0) {
       SetDimensions(ndim);
       SetInterpolationMethod(kMultiLinear);
       f_cell_index = new unsigned int[fNDim];
@@ -62,7 +74,9 @@ class QwInterpolator {
     /// Constructor with minimum, maximum, and step size
     QwInterpolator(const std::vector<coord_t>& min,
         const std::vector<coord_t>& max,
-        const std::vector<coord_t>& step) {
+        const std::vector<coord_t>& step)
+    : fMappedRegion(0), fMappedLength(0), fMappedValues(0),
+      fCurrentEntries(0), fMaximumEntries(0) {
       SetDimensions(min.size());
       SetInterpolationMethod(kMultiLinear);
       SetMinimumMaximumStep(min,max,step);
@@ -70,7 +84,9 @@ class QwInterpolator {
       f_cell_local = new double[fNDim];
     };
     /// Constructor with file name
-    QwInterpolator(const std::string& filename) {
+    QwInterpolator(const std::string& filename)
+    : fMappedRegion(0), fMappedLength(0), fMappedValues(0),
+      fCurrentEntries(0), fMaximumEntries(0) {
       ReadBinaryFile(filename);
       SetInterpolationMethod(kMultiLinear);
       f_cell_index = new unsigned int[fNDim];
@@ -78,6 +94,7 @@ class QwInterpolator {
     };
     /// Destructor
     virtual ~QwInterpolator() {
+      UnmapBinaryFile();
       delete[] f_cell_index;
       delete[] f_cell_local;
     };
@@ -108,6 +125,12 @@ class QwInterpolator {
     /// Table with pointers to arrays of values
     std::vector<value_t> fValues[value_n];
 
+    /// Memory-mapped binary file and its length (if mapped)
+    void* fMappedRegion;
+    size_t fMappedLength;
+    /// Interleaved values in the memory-mapped file (if mapped)
+    const value_t* fMappedValues;
+
     /// Number of values read in
     unsigned int fCurrentEntries;
     /// Maximum number of values
@@ -149,15 +172,11 @@ class QwInterpolator {
       // Check the dimensionality and assign boundaries and step size vectors
       if (min.size() != fNDim || min.size() != fNDim || step.size() != fNDim) return;
       fMin = min; fMax = max; fStep = step;
-      fExtent[0] = 1;
-      for (size_t i = 0; i < fMin.size(); i++) {
-        coord_t int_part; // safer to use modf than a direct static cast
-        coord_t frac_part = modf((fMax[i] - fMin[i]) / fStep[i] + 1.0, &int_part);
-        fSize[i] = static_cast<unsigned int>(int_part) + (frac_part > 0.5 ? 1 : 0);
-        fExtent[i+1] = fExtent[i] * fSize[i];
-      }
+      // Values will be stored in memory
+      UnmapBinaryFile();
+      CalculateExtents();
       // Try resizing to allocate memory and initialize with zeroes
-      fMaximumEntries = fExtent[fNDim]; fCurrentEntries = 0; // no entries read yet
+      fCurrentEntries = 0; // no entries read yet
       for (unsigned int i = 0; i < value_n; i++) {
         try {
           fValues[i].resize(fMaximumEntries,0);
@@ -166,6 +185,8 @@ class QwInterpolator {
         }
       }
     };
+    /// Get the number of coordinate dimensions
+    unsigned int GetDimensions() const { return fNDim; };
     /// Get minimum in dimension
     coord_t GetMinimum(const unsigned int dim) const { return fMin.at(dim); };
     /// Get maximum in dimension
@@ -176,6 +197,14 @@ class QwInterpolator {
     unsigned int GetMaximumEntries() const { return fMaximumEntries; };
     /// Get the current number of entries
     unsigned int GetCurrentEntries() const { return fCurrentEntries; };
+    /// Get the contiguous array of values (for one-component values only)
+    const value_t* GetValueArray() const {
+      if (value_n != 1) return 0;
+      if (fMappedValues) return fMappedValues;
+      return fValues[0].empty()? 0: &fValues[0][0];
+    };
+    /// Are the values memory-mapped from a binary file?
+    bool IsMapped() const { return fMappedValues != 0; };
 
     /// Get wrapping coordinate
     unsigned int GetWrapCoordinate(const unsigned int dim) const
@@ -303,6 +332,7 @@ class QwInterpolator {
     };
     /// Set a set of values at a linearized index (false if not possible)
     bool Set(const unsigned int linear_index, const value_t* value) {
+      if (fMappedValues) return false; // read-only
       if (! Check(linear_index)) return false; // out of bounds
       for (unsigned int i = 0; i < value_n; i++)
         fValues[i][linear_index] = value[i];
@@ -397,6 +427,13 @@ class QwInterpolator {
     bool WriteBinaryFile(const std::string& filename) const;
     /// \brief Read the grid values from binary file
     bool ReadBinaryFile(const std::string& filename);
+    /// \brief Map the grid values from binary file into memory (read-only)
+    bool MapBinaryFile(const std::string& filename);
+    /// Release the memory-mapped binary file
+    void UnmapBinaryFile() {
+      if (fMappedRegion) munmap(fMappedRegion, fMappedLength);
+      fMappedRegion = 0; fMappedLength = 0; fMappedValues = 0;
+    };
     // @}
 
 
@@ -430,6 +467,28 @@ class QwInterpolator {
 
   private: // private methods
 
+    /// Calculate the number of points and extents from the grid parameters
+    void CalculateExtents() {
+      fExtent[0] = 1;
+      for (size_t i = 0; i < fMin.size(); i++) {
+        coord_t int_part; // safer to use modf than a direct static cast
+        coord_t frac_part = modf((fMax[i] - fMin[i]) / fStep[i] + 1.0, &int_part);
+        fSize[i] = static_cast<unsigned int>(int_part) + (frac_part > 0.5 ? 1 : 0);
+        fExtent[i+1] = fExtent[i] * fSize[i];
+      }
+      fMaximumEntries = fExtent[fNDim];
+    };
+
+    /// Progress bar for reading and writing (only for large grids)
+    void Progress(const unsigned int index, const unsigned int entries) const {
+      if (entries < 100) return;
+      if (index % (entries / 10) == 0)
+        mycout << index / (entries / 100) << "%" << QwLog::flush;
+      if (index % (entries / 10) != 0
+       && index % (entries / 40) == 0)
+        mycout << "." << QwLog::flush;
+    };
+
     /// Return the cell index closest to the coordinate (could be above) (unchecked)
     void Nearest(const coord_t* coord, unsigned int* cell_index) const {
       Cell(coord, cell_index, f_cell_local);
@@ -453,15 +512,21 @@ class QwInterpolator {
     /// Get a single value by cell index (unchecked)
     value_t Get(const unsigned int* cell_index) const {
       if (value_n != 1) return 0; // only for one-dimensional values
-      return fValues[0][Index(cell_index)];
+      return Get(Index(cell_index));
     };
 
     /// Get a single value by linearized index (unchecked)
     value_t Get(const unsigned int index) const {
+      if (fMappedValues) return fMappedValues[index * value_n];
       return fValues[0][index];
     };
     /// Get a vector value by linearized index (unchecked)
     bool Get(const unsigned int index, value_t* value) const {
+      if (fMappedValues) {
+        for (unsigned int i = 0; i < value_n; i++)
+          value[i] = fMappedValues[index * value_n + i];
+        return true;
+      }
       for (unsigned int i = 0; i < value_n; i++)
         value[i] = fValues[i][index];
       return true;
@@ -714,20 +779,18 @@ inline bool QwInterpolator<value_t,value_n>::WriteText(std::ostream& stream) con
   for (unsigned int dim = 0; dim < fNDim; dim++)
     stream << dim << "\t" << fMin[dim] << "\t" << fMax[dim] << "\t" << fStep[dim] << std::endl;
   // Write the values
-  stream << fValues[0].size() << std::endl;
-  unsigned int entries = fValues[0].size();
+  unsigned int entries = fMaximumEntries;
+  stream << entries << std::endl;
+  value_t value[value_n];
   for (unsigned int index = 0; index < entries; index++) {
     // Write values
+    Get(index, value);
     for (unsigned int i = 0; i < value_n; i++) {
-      stream << fValues[i][index] << "\t";
+      stream << value[i] << "\t";
     }
     stream << std::endl;
     // Progress bar
-    if (index % (entries / 10) == 0)
-      mycout << index / (entries / 100) << "%" << QwLog::flush;
-    if (index % (entries / 10) != 0
-     && index % (entries / 40) == 0)
-      mycout << "." << QwLog::flush;
+    Progress(index, entries);
   }
   stream << "end" << std::endl;
   mycout << myendl;
@@ -762,11 +825,7 @@ inline bool QwInterpolator<value_t,value_n>::ReadText(std::istream& stream)
       stream >> fValues[i][index];
     }
     // Progress bar
-    if (index % (entries / 10) == 0)
-      mycout << index / (entries / 100) << "%" << QwLog::flush;
-    if (index % (entries / 10) != 0
-     && index % (entries / 40) == 0)
-      mycout << "." << QwLog::flush;
+    Progress(index, entries);
   }
   // Check for end of file
   std::string end;
@@ -808,20 +867,15 @@ inline bool QwInterpolator<value_t,value_n>::WriteBinaryFile(const std::string&
     file.write(reinterpret_cast<const char*>(&fMax[dim]),sizeof(fMax[dim]));
     file.write(reinterpret_cast<const char*>(&fStep[dim]),sizeof(fStep[dim]));
   }
-  uint32_t entries = fValues[0].size();
+  uint32_t entries = fMaximumEntries;
   file.write(reinterpret_cast<const char*>(&entries),sizeof(entries));
+  value_t value[value_n];
   for (unsigned int index = 0; index < entries; index++) {
     // Write values
-    for (unsigned int i = 0; i < value_n; i++) {
-      value_t value = fValues[i][index];
-      file.write(reinterpret_cast<const char*>(&value),sizeof(value));
-    }
+    Get(index, value);
+    file.write(reinterpret_cast<const char*>(value),sizeof(value));
     // Progress bar
-    if (index % (entries / 10) == 0)
-      mycout << index / (entries / 100) << "%" << QwLog::flush;
-    if (index % (entries / 10) != 0
-     && index % (entries / 40) == 0)
-      mycout << "." << QwLog::flush;
+    Progress(index, entries);
   }
   mycout << myendl;
   file.close();
@@ -872,16 +926,88 @@ inline bool QwInterpolator<value_t,value_n>::ReadBinaryFile(const std::string& f
       file.read((char*)(&fValues[i][index]),value_size);
     }
     // Progress bar
-    if (index % (entries / 10) == 0)
-      mycout << index / (entries / 100) << "%" << QwLog::flush;
-    if (index % (entries / 10) != 0
-     && index % (entries / 40) == 0)
-      mycout << "." << QwLog::flush;
+    Progress(index, entries);
   }
   mycout << myendl;
   file.close();
   return true;
 }
 
+/**
+ * Map the grid values from a binary file, as written by WriteBinaryFile, into
+ * memory.  The grid parameters are read from the header, and the values are
+ * accessed directly in the mapped file, so that large tables are not copied
+ * and tables used by several processes are shared in the page cache.  The
+ * values cannot be modified afterwards.
+ * @param filename File name
+ * @return True if mapped successfully
+ */
+template <class value_t, unsigned int value_n>
+inline bool QwInterpolator<value_t,value_n>::MapBinaryFile(const std::string& filename)
+{
+  UnmapBinaryFile();
+  // Open the file and map it in its entirety
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  size_t length = status.st_size;
+  void* region = mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping stays valid
+  if (region == MAP_FAILED) return false;
+  const char* data = static_cast<const char*>(region);
+
+  // Read template and grid parameters from the header
+  uint32_t n = 0, size = 0, ndim = 0, entries = 0;
+  size_t offset = 0;
+  if (length >= 3 * sizeof(uint32_t)) {
+    memcpy(&n, data, sizeof(n));
+    memcpy(&size, data + sizeof(n), sizeof(size));
+    memcpy(&ndim, data + sizeof(n) + sizeof(size), sizeof(ndim));
+    offset = 3 * sizeof(uint32_t);
+  }
+  const size_t header = offset + ndim * 3 * sizeof(coord_t) + sizeof(entries);
+  if (n != value_n // not same dimensionality
+   || size != sizeof(value_t) // not same type
+   || ndim == 0 || length < header // no grid
+   || header % sizeof(value_t) != 0) { // values not aligned
+    munmap(region, length);
+    return false;
+  }
+  std::vector<coord_t> min(ndim), max(ndim), step(ndim);
+  for (unsigned int dim = 0; dim < ndim; dim++) {
+    memcpy(&min[dim], data + offset, sizeof(coord_t)); offset += sizeof(coord_t);
+    memcpy(&max[dim], data + offset, sizeof(coord_t)); offset += sizeof(coord_t);
+    memcpy(&step[dim], data + offset, sizeof(coord_t)); offset += sizeof(coord_t);
+  }
+  memcpy(&entries, data + offset, sizeof(entries));
+
+  // Set the grid without allocating memory for the values
+  if (ndim != fNDim) {
+    SetDimensions(ndim);
+    delete[] f_cell_index; f_cell_index = new unsigned int[fNDim];
+    delete[] f_cell_local; f_cell_local = new double[fNDim];
+  }
+  fMin = min; fMax = max; fStep = step;
+  CalculateExtents();
+  if (entries != fMaximumEntries // not expected number of entries
+   || length != header + size_t(entries) * value_n * sizeof(value_t)) { // truncated
+    munmap(region, length);
+    return false;
+  }
+  for (unsigned int i = 0; i < value_n; i++)
+    std::vector<value_t>().swap(fValues[i]);
+
+  fMappedRegion = region;
+  fMappedLength = length;
+  fMappedValues = reinterpret_cast<const value_t*>(data + header);
+  fCurrentEntries = fMaximumEntries;
+  mycout << "Mapped binary file: " << filename << myendl;
+  return true;
+}
+
 
 #endif // _QWINTERPOLATOR_H_
@@ -14,6 +14,7 @@
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <mutex>
 using std::string;
 
 // Qweak headers
@@ -74,6 +75,12 @@ class QwOptions;
 \verbatim
  QwMessage << "Hello World !!!" << QwLog::endl;
 \endverbatim
+ *
+ * There is one log per process, shared by all analysis contexts (see
+ * QwAnalysisContext): the thresholds, streams and debugged functions are
+ * set once by the main program.  The log level and line state of the
+ * message being written are kept per thread, so concurrent analyses do not
+ * change each other's level or prefixes, but their lines may interleave.
  */
 class QwLog : public std::ostream {
 
@@ -113,7 +120,7 @@ class QwLog : public std::ostream {
 
     /*! \brief Determine whether the function name matches a specified list of regular expressions
      */
-    bool                        IsDebugFunction(const string func_name);
+    bool                        IsDebugFunction(const char* func_name);
 
     /*! \brief Initialize the log file with name 'name'
      */
@@ -134,7 +141,7 @@ class QwLog : public std::ostream {
     /*! \brief Set the stream log level
      */
     QwLog&                      operator()(const QwLogLevel level,
-                                           const std::string func_sig  = "<unknown>");
+                                           const char* func_sig  = "<unknown>");
 
     /*! \brief Stream an object to the output stream
      */
@@ -168,7 +175,7 @@ class QwLog : public std::ostream {
     /*! \brief Get the local time
      */
     const char*                 GetTime();
-    char                        fTimeString[128];
+    static thread_local char    fTimeString[128];
 
     //! Screen thresholds and stream
     QwLogLevel    fScreenThreshold;
@@ -176,8 +183,8 @@ class QwLog : public std::ostream {
     //! File thresholds and stream
     QwLogLevel    fFileThreshold;
     std::ostream *fFile;
-    //! Log level of this stream
-    QwLogLevel fLogLevel;
+    //! Log level of the message being written by this thread
+    static thread_local QwLogLevel fLogLevel;
 
     //! Flag to print function signature on warning or error
     bool fPrintFunctionSignature;
@@ -185,14 +192,16 @@ class QwLog : public std::ostream {
     //! List of regular expressions for functions that will have increased log level
     std::map<std::string,bool> fIsDebugFunction;
     std::vector<std::string> fDebugFunctionRegexString;
+    //! Guard of the cache of debugged functions
+    std::mutex fIsDebugFunctionMutex;
 
     //! Flag to disable color
     bool fUseColor;
 
-    //! Flags only relevant for current line, but static for use in static function
-    static bool fFileAtNewLine;
-    static bool fScreenInColor;
-    static bool fScreenAtNewLine;
+    //! Flags only relevant for current line of this thread, but static for use in static function
+    static thread_local bool fFileAtNewLine;
+    static thread_local bool fScreenInColor;
+    static thread_local bool fScreenAtNewLine;
 
 };
 
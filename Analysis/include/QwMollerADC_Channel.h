@@ -130,6 +130,9 @@ class QwMollerADC_Channel: public VQwHardwareChannel, public MQwMockable {
   void  SetHardwareSum(Double_t hwsum, UInt_t sequencenumber = 0);
   void  SetEventData(Double_t* block, UInt_t sequencenumber = 0);
   void  SetRawEventData();
+  /// \brief Set the event data of a derived channel: hardware sum and blocks
+  ///        in value[0..4], without raw data
+  void  SetDerivedEventData(const Double_t* value, size_t nsamples, Int_t goodcount, UInt_t errorflag);
 
   /// Encode the event data into a CODA buffer
   void  EncodeEventData(std::vector<UInt_t> &buffer);
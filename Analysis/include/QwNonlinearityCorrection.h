@@ -0,0 +1,121 @@
+/*!
+ * \file   QwNonlinearityCorrection.h
+ * \brief  Per-channel nonlinearity correction from interpolation tables
+ */
+
+#ifndef __QwNonlinearityCorrection__
+#define __QwNonlinearityCorrection__
+
+// System headers
+#include <map>
+#include <string>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Boost headers
+#include <boost/shared_ptr.hpp>
+
+// Forward declarations
+class QwOptions;
+template <class value_t, unsigned int value_n> class QwInterpolator;
+
+/**
+ *  \class QwNonlinearityCorrection
+ *  \ingroup QwAnalysis
+ *  \brief Correction of the calibrated channel value for nonlinear response
+ *
+ * A correction is a one-dimensional QwInterpolator table which maps the
+ * calibrated value of a channel (per sample, as the hardware sum and the
+ * blocks) to the corrected value.  Tables are written with
+ * QwInterpolator::WriteBinaryFile and memory-mapped when they are loaded,
+ * or read from the text format.  Values outside the range of the table are
+ * not corrected.
+ *
+ * The tables are assigned to channels by name in the map file given with
+ * --nonlinearity-map, with one 'channel table' pair per line, e.g.
+ *   qwk_bcm1       nonlinearity/bcm1.bin
+ *   qwk_bpm3h04XP  nonlinearity/bpm_adc.bin
+ * Relative table paths are taken relative to the directory of the map file.
+ * Channels which share a table file share one mapping.  The channels look
+ * up their correction lazily, so that the map can be reloaded.  The map
+ * belongs to the current analysis context (see QwAnalysisContext), or to
+ * the process without one.
+ */
+class QwNonlinearityCorrection {
+
+  public:
+
+    /// \brief Constructor from a table file (binary or text)
+    QwNonlinearityCorrection(const std::string& filename);
+    /// \brief Destructor
+    virtual ~QwNonlinearityCorrection();
+
+    /// Was the table loaded successfully?
+    Bool_t IsValid() const { return fValues != 0; };
+
+    /// \brief Correct an array of calibrated values in place
+    void Apply(Double_t* value, size_t n) const {
+      for (size_t i = 0; i < n; i++) {
+        const Double_t u = (value[i] - fMinimum) * fInverseStep;
+        if (! (u >= 0.0 && u <= fLast)) continue; // outside the table, or NaN
+        size_t j = static_cast<size_t>(u);
+        if (j >= fSize - 1) j = fSize - 2;
+        const Double_t f = u - j;
+        value[i] = fValues[j] + f * (fValues[j+1] - fValues[j]);
+      }
+    };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options and load the map file
+    static void ProcessOptions(QwOptions& options);
+
+    /// \brief Load the assignment of tables to channels from a map file
+    static void LoadTableMap(const std::string& mapfile);
+    /// \brief Remove all corrections
+    static void Clear();
+
+    /// \brief Get the correction for a channel (null if not corrected)
+    static const QwNonlinearityCorrection* Find(const TString& channel);
+    /// Generation of the table map, changed whenever it changes
+    static UInt_t GetGeneration() { return GetConfiguration().fGeneration; };
+
+    /**
+     *  \class Configuration
+     *  \brief Corrections of the channels of one analysis
+     */
+    class Configuration {
+      public:
+        /// \brief Constructor with an empty table map
+        Configuration();
+        /// Corrections by lowercase channel name
+        std::map<TString, boost::shared_ptr<QwNonlinearityCorrection> > fChannelTables;
+        /// Generation of the table map, unique in the process
+        UInt_t fGeneration;
+    };
+    /// \brief Configuration of the current analysis context, or of the process
+    static Configuration& GetConfiguration();
+
+  private:
+
+    /// Private default constructor
+    QwNonlinearityCorrection();
+    /// Private copy constructor, not implemented
+    QwNonlinearityCorrection(const QwNonlinearityCorrection&);
+    /// Private assignment operator, not implemented
+    QwNonlinearityCorrection& operator=(const QwNonlinearityCorrection&);
+
+    /// Correction table
+    QwInterpolator<float,1>* fTable;
+
+    /// Grid and values of the table, cached for Apply
+    Double_t fMinimum;
+    Double_t fInverseStep;
+    Double_t fLast;
+    size_t fSize;
+    const float* fValues;
+};
+
+#endif // __QwNonlinearityCorrection__
@@ -139,17 +139,16 @@ class QwOptions {
 
     /// \brief Private default constructor
     QwOptions();
+    /// Analysis contexts own their options
+    friend class QwAnalysisContext;
     /// \brief Private copy constructor, not implemented
     QwOptions(QwOptions const&);
     /// \brief Private assignment operator, not implemented
     QwOptions& operator=(QwOptions const&);
 
   public:
-    /// \brief Get instance
-    static QwOptions& Instance() {
-      if (! fInstance) fInstance = new QwOptions();
-      return *fInstance;
-    }
+    /// \brief Get instance of the current analysis context, or the process default
+    static QwOptions& Instance();
 
     /// \brief Default destructor
     virtual ~QwOptions();
@@ -200,6 +199,16 @@ class QwOptions {
 	AddConfigFile(configfiles.at(i));
     };
 
+    /// \brief Set a configuration file which overrides all other sources
+    void SetOverlayConfigFile(const std::string& configfile) {
+      fOverlayConfigFile = configfile;
+      Clear();
+    };
+    /// \brief Remove the overriding configuration file
+    void ClearOverlayConfigFile() {
+      SetOverlayConfigFile("");
+    };
+
     /// \brief List the configuration files
     void ListConfigFiles() {
       QwMessage << "Config files:" << QwLog::endl;
@@ -211,6 +220,8 @@ class QwOptions {
     /// \brief Parse all sources of options
     void Parse(bool force = false) {
       if (! fParsed || force) {
+        // The first value stored for an option is kept, so the overlay goes first
+        if (! fOverlayConfigFile.empty()) ParseConfigFile(fOverlayConfigFile);
         ParseCommandLine();
         ParseEnvironment();
         ParseConfigFile();
@@ -281,14 +292,18 @@ class QwOptions {
     /// \brief Parse the command line arguments
     void ParseCommandLine();
 
-    /// \brief Parse the configuration file
+    /// \brief Parse the configuration files
     void ParseConfigFile();
+    /// \brief Parse a single configuration file
+    void ParseConfigFile(const std::string& configfile);
 
     /// \brief Parse the environment variables
     void ParseEnvironment();
 
     /// \brief Configuration file
     std::vector<std::string> fConfigFiles;
+    /// \brief Configuration file which overrides all other sources
+    std::string fOverlayConfigFile;
 
     /** \brief Command line arguments
      *
@@ -17,6 +17,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <mutex>
 
 // ROOT headers
 #include "Rtypes.h"
@@ -61,6 +62,19 @@ class QwParameterFile {
     /// Set the current run number for looking up the appropriate parameter file
     static void SetCurrentRunNumber(const UInt_t runnumber) { fCurrentRunNumber = runnumber; };
 
+    /// Get the set of parameter files that have been opened so far
+    static const std::set<std::string>& GetOpenedFileList() { return fOpenedFileList; };
+    /// Clear the set of parameter files that have been opened so far
+    static void ClearOpenedFileList() {
+      std::lock_guard<std::mutex> lock(fOpenedFileListMutex);
+      fOpenedFileList.clear();
+    };
+    /// Add a file that was read outside of QwParameterFile to the set
+    static void AddToOpenedFileList(const std::string& file) {
+      std::lock_guard<std::mutex> lock(fOpenedFileListMutex);
+      fOpenedFileList.insert(file);
+    };
+
     /// Set various sets of special characters
     void SetCommentChars(const std::string value)    { fCommentChars = value; };
     void SetWhitespaceChars(const std::string value) { fWhitespaceChars = value; };
@@ -290,6 +304,11 @@ class QwParameterFile {
     // Current run number
     static UInt_t fCurrentRunNumber;
 
+    // Full paths of all parameter files opened so far, by all analyses of
+    // the process (not per analysis context), and its guard
+    static std::set<std::string> fOpenedFileList;
+    static std::mutex fOpenedFileListMutex;
+
     // Default comment, whitespace, section, module characters
     static const std::string kDefaultCommentChars;
     static const std::string kDefaultWhitespaceChars;
@@ -0,0 +1,94 @@
+/*!
+ * \file   QwReplayMemo.h
+ * \brief  Content-addressed memoization of complete replays
+ */
+
+#ifndef __QwReplayMemo__
+#define __QwReplayMemo__
+
+// System headers
+#include <vector>
+#include <string>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class QwOptions;
+class QwEventBuffer;
+
+/**
+ *  \class QwReplayMemo
+ *  \ingroup QwAnalysis
+ *  \brief Skips replays whose inputs have been analyzed before
+ *
+ * A replay is identified by the MD5 digest of everything that determines
+ * its output: the contents of the raw data files, the contents of every
+ * parameter, map, cut and configuration file opened through QwParameterFile,
+ * the command line arguments, and the code version.  When a store directory
+ * is configured, the output ROOT files of each replay are kept in
+ * <store>/<hash>/ together with a manifest.  A later replay with the same
+ * hash is then skipped, and the stored outputs are symlinked into the
+ * output directory (or only reported).
+ *
+ * Inputs that are not read through files (e.g. database lookups) are not
+ * part of the hash; use --memo-force to replay regardless.
+ */
+class QwReplayMemo {
+
+  public:
+
+    /// \brief Constructor with options
+    QwReplayMemo(QwOptions& options);
+    /// \brief Destructor
+    virtual ~QwReplayMemo() { };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options
+    void ProcessOptions(QwOptions& options);
+
+    /// Is memoization enabled?
+    Bool_t IsEnabled() const { return fEnabled; };
+
+    /// \brief Compute the replay hash for the currently open stream
+    const TString& ComputeHash(const QwEventBuffer& eventbuffer);
+    /// Get the replay hash (empty if not computed)
+    const TString& GetHash() const { return fHash; };
+
+    /// \brief Look up the replay hash in the store, and make the outputs available
+    Bool_t Recall(const TString& outputdir);
+    /// \brief Register the output files of this replay in the store
+    void Store(const std::vector<TString>& outputs);
+
+  private:
+
+    /// Private default constructor
+    QwReplayMemo();
+
+    /// Directory of the store entry for the current hash
+    TString GetEntryDirectory() const { return fStoreDirectory + "/" + fHash; };
+
+    /// \brief MD5 digest of the contents of a file
+    static TString FileDigest(const TString& filename);
+
+    /// Name of the manifest file in each store entry
+    static const TString kManifestName;
+    /// Last line of a complete manifest, followed by the number of outputs
+    static const std::string kManifestEnd;
+
+    /// Store directory
+    TString fStoreDirectory;
+    /// Is memoization enabled?
+    Bool_t fEnabled;
+    /// Replay even if the hash is found in the store
+    Bool_t fForce;
+    /// Symlink stored outputs into the output directory on a hit
+    Bool_t fLinkOutputs;
+
+    /// Replay hash
+    TString fHash;
+};
+
+#endif // __QwReplayMemo__
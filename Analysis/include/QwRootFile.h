@@ -9,14 +9,19 @@ using std::type_info;
 // ROOT headers
 #include "TFile.h"
 #include "TTree.h"
+#include "TList.h"
 #include "TPRegexp.h"
 #include "TSystem.h"
 
 // Qweak headers
 #include "QwOptions.h"
+#include "QwBurstIndex.h"
 #include "TMapFile.h"
 
 
+// Forward declarations
+class QwArrowFile;
+
 // If one defines more than this number of words in the full ntuple,
 // the results are going to get very very crazy.
 #define BRANCH_VECTOR_MAX_SIZE 15000
@@ -40,7 +45,8 @@ class QwRootTree {
     /// Constructor with name, and description
     QwRootTree(const std::string& name, const std::string& desc, const std::string& prefix = "")
     : fName(name),fDesc(desc),fPrefix(prefix),fType("type undefined"),
-      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0) {
+      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0),
+      fBurstIndex(0) {
       // Construct tree
       ConstructNewTree();
     }
@@ -48,7 +54,8 @@ class QwRootTree {
     /// Constructor with existing tree
     QwRootTree(const QwRootTree* tree, const std::string& prefix = "")
     : fName(tree->GetName()),fDesc(tree->GetDesc()),fPrefix(prefix),fType("type undefined"),
-      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0) {
+      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0),
+      fBurstIndex(0) {
       QwMessage << "Existing tree: " << tree->GetName() << ", " << tree->GetDesc() << QwLog::endl;
       fTree = tree->fTree;
     }
@@ -57,7 +64,8 @@ class QwRootTree {
     template < class T >
     QwRootTree(const std::string& name, const std::string& desc, T& object, const std::string& prefix = "")
     : fName(name),fDesc(desc),fPrefix(prefix),fType("type undefined"),
-      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0) {
+      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0),
+      fBurstIndex(0) {
       // Construct tree
       ConstructNewTree();
 
@@ -72,7 +80,8 @@ class QwRootTree {
     template < class T >
     QwRootTree(const QwRootTree* tree, T& object, const std::string& prefix = "")
     : fName(tree->GetName()),fDesc(tree->GetDesc()),fPrefix(prefix),fType("type undefined"),
-      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0) {
+      fCurrentEvent(0),fNumEventsCycle(0),fNumEventsToSave(0),fNumEventsToSkip(0),
+      fBurstIndex(0) {
       QwMessage << "Existing tree: " << tree->GetName() << ", " << tree->GetDesc() << QwLog::endl;
       fTree = tree->fTree;
 
@@ -169,6 +178,18 @@ class QwRootTree {
     }
 
 
+    /// End a burst: store its entry range, and start a new cluster
+    void EndBurst(Int_t burst) {
+      if (fBurstIndex == 0) return;
+      if (! fBurstIndex->AddBurst(burst, fTree->GetEntries())) return;
+      #if ROOT_VERSION_CODE >= ROOT_VERSION(6,14,00)
+        fTree->FlushBaskets(kTRUE);
+      #else
+        fTree->FlushBaskets();
+      #endif
+    }
+
+
     /// Print the tree name and description
     void Print() const {
       QwMessage << GetName() << ", " << GetType();
@@ -257,6 +278,16 @@ class QwRootTree {
       if (fTree) fTree->SetBasketSize("*",basketsize);
     }
 
+    /// Entry ranges of the bursts, stored in the user info of the tree
+    QwBurstIndex* fBurstIndex;
+
+    /// Flush the tree at the end of each burst and keep the burst index
+    void EnableBurstIndex() {
+      if (fBurstIndex || fTree == 0) return;
+      fBurstIndex = new QwBurstIndex();
+      fTree->GetUserInfo()->Add(fBurstIndex);
+    }
+
     //Set circular buffer size for the memory resident tree
     void SetCircular(Long64_t buff = 100000) {
       if (fTree) fTree->SetCircular(buff);
@@ -321,6 +352,8 @@ class QwRootFile {
     Bool_t IsRootFile() const { return (fRootFile); };
     /// Is the map file active?
     Bool_t IsMapFile()  const { return (fMapFile); };
+    /// Final name of the ROOT file on disk
+    const TString& GetPermanentName() const { return fPermanentName; };
 
     /// \brief Construct indices from one tree to another tree
     void ConstructIndices(const std::string& from, const std::string& to, bool reverse = true);
@@ -382,7 +415,16 @@ class QwRootFile {
     /// Fill the tree with name
     Int_t FillTree(const std::string& name) {
       if (! HasTreeByName(name)) return 0;
-      else return fTreeByName[name].front()->Fill();
+      Int_t retval = fTreeByName[name].front()->Fill();
+      if (retval > 0 && ! fArrowTrees.empty()) FillArrowFile(name);
+      return retval;
+    }
+
+    /// End a burst in all burst-aligned trees
+    void EndBurst(Int_t burst) {
+      std::map< const std::string, std::vector<QwRootTree*> >::iterator iter;
+      for (iter = fTreeByName.begin(); iter != fTreeByName.end(); iter++)
+        iter->second.front()->EndBurst(burst);
     }
 
     /// Fill all registered trees
@@ -391,7 +433,9 @@ class QwRootFile {
       Int_t retval = 0;
       std::map< const std::string, std::vector<QwRootTree*> >::iterator iter;
       for (iter = fTreeByName.begin(); iter != fTreeByName.end(); iter++) {
-        retval += iter->second.front()->Fill();
+        Int_t nbytes = iter->second.front()->Fill();
+        if (nbytes > 0 && ! fArrowTrees.empty()) FillArrowFile(iter->first);
+        retval += nbytes;
       }
       return retval;
     }
@@ -455,6 +499,7 @@ class QwRootFile {
     void ls()     { if (fMapFile) fMapFile->ls();     if (fRootFile) fRootFile->ls(); }
     void Map()    { if (fRootFile) fRootFile->Map(); }
     void Close()  {
+      CloseArrowFiles();
       if (!fMakePermanent) fMakePermanent = HasAnyFilled();
       if (fMapFile) fMapFile->Close();
       if (fRootFile) fRootFile->Close();
@@ -598,6 +643,38 @@ class QwRootFile {
     }
 
 
+  private:
+
+    /// Trees which are also exported in Arrow IPC format
+    std::vector< TPRegexp > fArrowTrees;
+    Int_t fArrowBatchSize;
+    std::map< const std::string, QwArrowFile* > fArrowFileByName;
+
+    /// Does this tree name match an exported tree name?
+    bool IsArrowTree(const std::string& name) {
+      for (size_t i = 0; i < fArrowTrees.size(); i++)
+        if (fArrowTrees.at(i).Match(name)) return true;
+      return false;
+    }
+    /// \brief Fill the Arrow file of a tree
+    void FillArrowFile(const std::string& name);
+    /// \brief Close all Arrow files
+    void CloseArrowFiles();
+
+
+  private:
+
+    /// Trees which are flushed at the end of each burst, with a burst index
+    std::vector< TPRegexp > fBurstAlignedTrees;
+
+    /// Does this tree name match a burst-aligned tree name?
+    bool IsBurstAlignedTree(const std::string& name) {
+      for (size_t i = 0; i < fBurstAlignedTrees.size(); i++)
+        if (fBurstAlignedTrees.at(i).Match(name)) return true;
+      return false;
+    }
+
+
   private:
 
     /// Prescaling of events written to tree
@@ -681,6 +758,8 @@ void QwRootFile::ConstructTreeBranches(
 
     if (fCircularBufferSize > 0)
       tree->SetCircular(fCircularBufferSize);
+    else if (fRootFile && IsBurstAlignedTree(name))
+      tree->EnableBurstIndex();
 
   } else {
 
@@ -15,6 +15,8 @@
 
 // Qweak headers
 #include "VQwDataElement.h"
+#include "QwNonlinearityCorrection.h"
+#include "QwAdaptiveEventCut.h"
 
 // ROOT forward declarations
 class TTree;
@@ -127,6 +129,9 @@ public:
   Double_t GetEventCutLowerLimit() const { return fLLimit; };
 
   Double_t GetStabilityLimit() const { return fStability;};
+  Double_t GetBurpThreshold() const { return fBurpThreshold; };
+  /// Does a failure of the event cuts of this channel fail the event?
+  Bool_t IsGlobalCut() const { return (fErrorConfigFlag & kGlobalCut) == kGlobalCut; };
 
   UInt_t UpdateErrorFlag() {return GetEventcutErrorFlag();};
   void UpdateErrorFlag(const VQwHardwareChannel& elem){fErrorFlag |= elem.fErrorFlag;};
@@ -232,6 +237,40 @@ public:
       fDataToSave = kMoments; // stat has priority
   }
 
+  /*! \brief Get the nonlinearity correction table for this channel,
+   *         looked up by name when the table map has changed */
+  const QwNonlinearityCorrection* GetNonlinearityCorrection() {
+    if (fNonlinearityGeneration != QwNonlinearityCorrection::GetGeneration()) {
+      fNonlinearity = QwNonlinearityCorrection::Find(GetElementName());
+      fNonlinearityGeneration = QwNonlinearityCorrection::GetGeneration();
+    }
+    return fNonlinearity;
+  };
+
+  /*! \brief Update the event cut limits from the rolling statistics of
+   *         this channel, if it has adaptive event cuts
+   *
+   * Only values within the limits of the eventcuts file, of events without
+   * hardware errors, beam trip or BCM cut flags, enter the window of this
+   * channel object.  When the adaptive cuts are removed, the limits of the
+   * eventcuts file are restored.
+   */
+  void UpdateAdaptiveEventCuts() {
+    if (fAdaptiveCutGeneration != QwAdaptiveEventCut::GetGeneration()) {
+      fAdaptiveCut.reset(QwAdaptiveEventCut::Create(GetElementName()));
+      fAdaptiveCutGeneration = QwAdaptiveEventCut::GetGeneration();
+      fLLimit = fFixedLLimit;
+      fULimit = fFixedULimit;
+    }
+    if (fAdaptiveCut) {
+      Double_t value = GetValue();
+      Bool_t accept = (fErrorFlag & (kPreserveError | kBeamTripError | kBCMErrorFlag)) == 0
+                   && (fFixedULimit < fFixedLLimit
+                    || (value >= fFixedLLimit && value <= fFixedULimit));
+      fAdaptiveCut->Update(value, accept, fLLimit, fULimit);
+    }
+  };
+
   /*! \brief Checks that the requested element is in range, to be
    *         used in accesses to subelements similar to
    *         std::vector::at(). */
@@ -265,18 +304,25 @@ protected:
   Double_t fCalibrationFactor;
   Bool_t kFoundPedestal;
   Bool_t kFoundGain;
+  const QwNonlinearityCorrection* fNonlinearity; ///< Nonlinearity correction (if any)
+  UInt_t fNonlinearityGeneration; ///< Table map generation of the lookup
   //@}
 
   /*! \name Single event cuts and errors                    */
   // @{
   Int_t bEVENTCUTMODE;/*!<If this set to kFALSE then Event cuts are OFF*/
   Double_t fULimit, fLLimit;/*!<this sets the upper and lower limits*/
+  Double_t fFixedULimit, fFixedLLimit;/*!<limits from the eventcuts file*/
   Double_t fStability;/*!<how much deviaton from the stable reading is allowed*/
 
   Double_t fBurpThreshold;
   Int_t fBurpCountdown;
   Int_t fBurpHoldoff;
 
+  /// Limits from rolling statistics (if any), owned by this channel object
+  boost::shared_ptr<QwAdaptiveEventCut> fAdaptiveCut;
+  UInt_t fAdaptiveCutGeneration; ///< Cut map generation of the lookup
+
   //@}
 
 };   // class VQwHardwareChannel
@@ -77,6 +77,7 @@ class VQwSubsystem: virtual public VQwSubsystemCloneable, public MQwHistograms,
     fMarkerWords(orig.fMarkerWords)
   {
     fSystemName = orig.fSystemName;
+    fEventCutsFile = orig.fEventCutsFile;
     fIsDataLoaded = orig.fIsDataLoaded;
     fCurrentROC_ID = orig.fCurrentROC_ID;
     fCurrentBank_ID = orig.fCurrentBank_ID;
@@ -132,6 +133,8 @@ class VQwSubsystem: virtual public VQwSubsystemCloneable, public MQwHistograms,
   virtual Int_t LoadCrosstalkDefinition(TString mapfile) { return 0; };
   /// Optional event cut file
   virtual Int_t LoadEventCuts(TString mapfile) { return 0; };
+  /// Event cut file of the detector map, or empty
+  const TString& GetEventCutsFile() const { return fEventCutsFile; };
 
   /// Set event type mask
   void SetEventTypeMask(const UInt_t mask) { fEventTypeMask = mask; };
@@ -332,6 +335,8 @@ class VQwSubsystem: virtual public VQwSubsystemCloneable, public MQwHistograms,
 
   UInt_t   fEventTypeMask; ///< Mask of event types
 
+  TString  fEventCutsFile; ///< Event cut file, for reloading while running
+
   Bool_t   fIsDataLoaded; ///< Has this subsystem gotten data to be processed?
 
   std::vector<TString> fDetectorMapsNames;
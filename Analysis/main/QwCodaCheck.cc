@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwCodaCheck.cc
+
+ \ingroup QwAnalysis
+
+ \brief Fast validation and content summary of CODA data files
+
+ Usage: qwcodacheck [-q] [-j threads] file...
+
+ Each file is memory-mapped and checked for a sound block and bank
+ structure, without decoding any data, and a summary of its contents is
+ printed.  The files are scanned in parallel.  Consecutive segments of
+ one run (run.dat.0, run.dat.1, ...) must have continuous event numbers.
+ The exit status is zero only if all files passed.
+
+*//*-------------------------------------------------------------------------*/
+
+// System headers
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwCodaFileCheck.h"
+
+static void usage(const char* name)
+{
+  QwMessage << "Usage: " << name << " [-q] [-j threads] file..." << QwLog::endl;
+  QwMessage << "  -q          one line per file" << QwLog::endl;
+  QwMessage << "  -j threads  number of files scanned at the same time" << QwLog::endl;
+}
+
+/// Are the files segments of the same run (run.dat.0, run.dat.1, ...)?
+static bool IsNextSegment(const std::string& previous, const std::string& next)
+{
+  size_t dot = previous.find_last_of('.');
+  return dot != std::string::npos && dot == next.find_last_of('.')
+      && previous.compare(0, dot, next, 0, dot) == 0
+      && atoi(next.c_str() + dot + 1) == atoi(previous.c_str() + dot + 1) + 1;
+}
+
+int main(int argc, char** argv)
+{
+  // Command line: the files are positional arguments
+  Bool_t brief = kFALSE;
+  size_t nthreads = std::thread::hardware_concurrency();
+  std::vector<QwCodaFileCheck*> files;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-q") == 0) {
+      brief = kTRUE;
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      nthreads = atoi(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      usage(argv[0]);
+      return (strcmp(argv[i], "-h") == 0)? 0: 1;
+    } else {
+      files.push_back(new QwCodaFileCheck(argv[i]));
+    }
+  }
+  if (files.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (nthreads < 1) nthreads = 1;
+
+  // Scan the files in parallel; each thread takes every n-th file
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < nthreads && t < files.size(); t++)
+    threads.push_back(std::thread([&files, nthreads, t]() {
+      for (size_t i = t; i < files.size(); i += nthreads)
+        files[i]->Scan();
+    }));
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+
+  // Print the summaries in order, and check the segment boundaries
+  int status = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    files[i]->PrintSummary(brief);
+    if (! files[i]->IsValid()) status = 1;
+    if (i > 0 && IsNextSegment(files[i-1]->GetFileName(), files[i]->GetFileName())
+     && files[i-1]->GetNumberOfPhysicsEvents() > 0
+     && files[i]->GetNumberOfPhysicsEvents() > 0
+     && files[i]->GetFirstEventNumber() != files[i-1]->GetLastEventNumber() + 1) {
+      QwError << files[i]->GetFileName() << " starts at event "
+              << files[i]->GetFirstEventNumber() << ", but "
+              << files[i-1]->GetFileName() << " ends at event "
+              << files[i-1]->GetLastEventNumber() << QwLog::endl;
+      status = 1;
+    }
+  }
+
+  for (size_t i = 0; i < files.size(); i++)
+    delete files[i];
+  return status;
+}
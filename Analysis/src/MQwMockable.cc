@@ -1,5 +1,6 @@
 #include "MQwMockable.h"
 #include "QwParameterFile.h"
+#include "QwAnalysisContext.h"
 
 // Randomness generator: Mersenne twister with period 2^19937 - 1
 //
@@ -90,6 +91,9 @@ Double_t MQwMockable::GetRandomValue(){
   if (fUseExternalRandomVariable)
     // external normal random variable
     random_variable = fExternalRandomVariable;
+  else if (QwAnalysisContext::GetCurrent())
+    // normal random variable of the current analysis context
+    random_variable = QwAnalysisContext::GetCurrent()->GetNormalRandomVariable();
   else
     // internal normal random variable
     random_variable = fNormalRandomVariable();
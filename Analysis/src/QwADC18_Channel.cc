@@ -161,6 +161,7 @@ void QwADC18_Channel::InitializeChannel(TString name, TString datatosave)
   fPreviousSequenceNumber = 0;
   fNumberOfSamples_map    = 0;
   fNumberOfSamples        = 0;
+  fDividerValue           = -1;
 
   // Use internal random variable by default
   fUseExternalRandomVariable = false;
@@ -178,6 +179,8 @@ void QwADC18_Channel::InitializeChannel(TString name, TString datatosave)
   // Event cuts
   fULimit=-1;
   fLLimit=1;
+  fFixedULimit=-1;
+  fFixedLLimit=1;
   fNumEvtsWithEventCutsRejected = 0;
 
   fErrorFlag=0;               //Initialize the error flag
@@ -340,9 +343,9 @@ Int_t QwADC18_Channel::ProcessDataWord(UInt_t rawd)
   UInt_t value_raw = 0;
   switch (act_dtype) {
     case 0: // Diff word
-      static UInt_t prev_dvalue = act_dvalue;
-      if (act_dvalue != prev_dvalue) {
-        QwError << "QwADC18_Channel::ProcessEvBuffer: Number of samples changed " << act_dvalue << " " << prev_dvalue << QwLog::endl;
+      if (fDividerValue < 0) fDividerValue = act_dvalue;
+      if (act_dvalue != UInt_t(fDividerValue)) {
+        QwError << "QwADC18_Channel::ProcessEvBuffer: Number of samples changed " << act_dvalue << " " << fDividerValue << QwLog::endl;
         return 0;
       }
       value_raw = rawd & mask200x;
@@ -1202,6 +1205,7 @@ Bool_t QwADC18_Channel::ApplySingleEventCuts()//This will check the limits and u
   Bool_t status;
 
   if (bEVENTCUTMODE>=2){//Global switch to ON/OFF event cuts set at the event cut file
+    UpdateAdaptiveEventCuts();
 
     if (fULimit < fLLimit){
       status=kTRUE;
@@ -0,0 +1,199 @@
+/*!
+ * \file   QwAdaptiveEventCut.cc
+ * \brief  Event cut limits relative to robust rolling statistics
+ */
+
+#include "QwAdaptiveEventCut.h"
+
+// System headers
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwParameterFile.h"
+#include "QwAnalysisContext.h"
+
+/// Last generation of any cut map, so that the channels of one analysis
+/// never mistake the cut map of another for their own
+static std::atomic<UInt_t> gLastGeneration(0);
+
+/// Scale of the median absolute deviation to sigma, for a normal distribution
+static const Double_t kMADToSigma = 1.482602;
+/// Fraction of the values trimmed on each side for the trimmed mean
+static const Double_t kTrimFraction = 0.10;
+/// Ratio of sigma for the 10% trimmed and the full normal distribution
+static const Double_t kTrimmedSigmaRatio = 0.661602;
+
+QwAdaptiveEventCut::QwAdaptiveEventCut(const TString& channel, size_t window,
+    Double_t nsigma, EQwStatistic statistic)
+: fChannel(channel), fNumberOfSigma(nsigma), fStatistic(statistic),
+  fWindow(window, 0.0), fNext(0), fEntries(0), fSorted(window, 0.0),
+  fSinceUpdate(0), fUpdates(0),
+  fIsValid(kFALSE), fLower(0.0), fUpper(0.0),
+  fUpdateInterval(100)
+{
+}
+
+QwAdaptiveEventCut::Configuration::Configuration()
+: fGeneration(++gLastGeneration), fUpdateInterval(100)
+{
+}
+
+QwAdaptiveEventCut::Configuration& QwAdaptiveEventCut::GetConfiguration()
+{
+  QwAnalysisContext* context = QwAnalysisContext::GetCurrent();
+  if (context) return context->GetAdaptiveEventCuts();
+  static Configuration configuration;
+  return configuration;
+}
+
+void QwAdaptiveEventCut::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Adaptive event cuts")
+    ("adaptive-eventcuts-map", po::value<std::string>()->default_value(""),
+     "map of channels with event cut limits from rolling statistics");
+  options.AddOptions("Adaptive event cuts")
+    ("adaptive-eventcuts-update", po::value<int>()->default_value(100),
+     "number of events between updates of the adaptive event cut limits");
+  options.AddOptions("Adaptive event cuts")
+    ("adaptive-eventcuts-log", po::value<std::string>()->default_value(""),
+     "text file with the adaptive event cut limits over the run");
+}
+
+void QwAdaptiveEventCut::ProcessOptions(QwOptions& options)
+{
+  Configuration& config = GetConfiguration();
+  config.fUpdateInterval = std::max(options.GetValue<int>("adaptive-eventcuts-update"), 1);
+
+  // Cuts created before keep writing to the previous log until they are replaced
+  config.fLogFile.reset();
+  std::string logfile = options.GetValue<std::string>("adaptive-eventcuts-log");
+  if (logfile.size() > 0) {
+    config.fLogFile.reset(new std::ofstream(logfile.c_str()));
+    if (config.fLogFile->good())
+      *config.fLogFile << "# channel update lower upper" << std::endl;
+    else
+      QwError << "QwAdaptiveEventCut: unable to open log file " << logfile << QwLog::endl;
+  }
+
+  std::string mapfile = options.GetValue<std::string>("adaptive-eventcuts-map");
+  if (mapfile.size() > 0) LoadCutMap(mapfile);
+}
+
+/**
+ * Load the adaptive cuts, one 'channel window nsigma [median|trimmed]'
+ * line per channel
+ * @param mapfile Map file name
+ */
+void QwAdaptiveEventCut::LoadCutMap(const std::string& mapfile)
+{
+  Clear();
+
+  Configuration& config = GetConfiguration();
+  QwParameterFile map(mapfile);
+  while (map.ReadNextLine()) {
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    TString channel = map.GetNextToken(" \t");
+    Int_t window = map.GetTypedNextToken<Int_t>();
+    Double_t nsigma = map.GetTypedNextToken<Double_t>();
+    TString statistic = map.GetNextToken(" \t");
+    statistic.ToLower();
+    if (window < 10 || nsigma <= 0.0) {
+      QwError << "QwAdaptiveEventCut: invalid window or number of sigma for channel "
+              << channel << " in " << mapfile << QwLog::endl;
+      continue;
+    }
+    EQwStatistic type = kMedian;
+    if (statistic == "trimmed") type = kTrimmedMean;
+    else if (statistic != "" && statistic != "median")
+      QwWarning << "QwAdaptiveEventCut: unknown statistic " << statistic
+                << " for channel " << channel << ", using median" << QwLog::endl;
+
+    channel.ToLower();
+    config.fChannelCuts[channel].reset(new QwAdaptiveEventCut(channel, window, nsigma, type));
+  }
+
+  QwMessage << "QwAdaptiveEventCut: " << config.fChannelCuts.size()
+            << " channels with adaptive event cuts" << QwLog::endl;
+}
+
+/**
+ * Remove all adaptive cuts.  The channels create their cuts again before
+ * use whenever the generation has changed.
+ */
+void QwAdaptiveEventCut::Clear()
+{
+  Configuration& config = GetConfiguration();
+  config.fChannelCuts.clear();
+  config.fGeneration = ++gLastGeneration;
+}
+
+/**
+ * Create an adaptive cut for a channel, with the configuration from the
+ * map file and an empty window
+ * @param channel Channel name
+ * @return New adaptive cut owned by the caller, or null if the channel
+ *         has fixed limits
+ */
+QwAdaptiveEventCut* QwAdaptiveEventCut::Create(const TString& channel)
+{
+  const Configuration& config = GetConfiguration();
+  if (config.fChannelCuts.empty()) return 0;
+  TString name = channel;
+  name.ToLower();
+  std::map<TString, boost::shared_ptr<QwAdaptiveEventCut> >::const_iterator
+    it = config.fChannelCuts.find(name);
+  if (it == config.fChannelCuts.end()) return 0;
+  const QwAdaptiveEventCut& cut = *(it->second);
+  QwAdaptiveEventCut* copy = new QwAdaptiveEventCut(cut.fChannel, cut.fWindow.size(),
+                                                    cut.fNumberOfSigma, cut.fStatistic);
+  copy->fUpdateInterval = config.fUpdateInterval;
+  copy->fLogFile = config.fLogFile;
+  return copy;
+}
+
+void QwAdaptiveEventCut::Recalculate()
+{
+  const size_t n = fWindow.size();
+  std::copy(fWindow.begin(), fWindow.end(), fSorted.begin());
+
+  Double_t center = 0.0, width = 0.0;
+  if (fStatistic == kMedian) {
+    // Median and median absolute deviation
+    std::vector<Double_t>::iterator mid = fSorted.begin() + n / 2;
+    std::nth_element(fSorted.begin(), mid, fSorted.end());
+    center = *mid;
+    for (size_t i = 0; i < n; i++)
+      fSorted[i] = std::fabs(fWindow[i] - center);
+    std::nth_element(fSorted.begin(), mid, fSorted.end());
+    width = kMADToSigma * (*mid);
+  } else {
+    // Mean and standard deviation of the central values
+    std::sort(fSorted.begin(), fSorted.end());
+    size_t trim = static_cast<size_t>(kTrimFraction * n);
+    size_t m = n - 2 * trim;
+    Double_t sum = 0.0, sum2 = 0.0;
+    for (size_t i = trim; i < n - trim; i++) sum += fSorted[i];
+    center = sum / m;
+    for (size_t i = trim; i < n - trim; i++)
+      sum2 += (fSorted[i] - center) * (fSorted[i] - center);
+    width = std::sqrt(sum2 / (m - 1)) / kTrimmedSigmaRatio;
+  }
+
+  fLower = center - fNumberOfSigma * width;
+  fUpper = center + fNumberOfSigma * width;
+  if (! fIsValid)
+    QwVerbose << "QwAdaptiveEventCut: " << fChannel << " limits "
+              << fLower << " to " << fUpper << QwLog::endl;
+  fIsValid = kTRUE;
+  fUpdates++;
+
+  if (fLogFile)
+    *fLogFile << fChannel << " " << fUpdates << " "
+             << fLower << " " << fUpper << std::endl;
+}
@@ -0,0 +1,55 @@
+/*!
+ * \file   QwAnalysisContext.cc
+ * \brief  Per-analysis ownership of the options, histogram helper, cut maps and mock data randomness
+ */
+
+#include "QwAnalysisContext.h"
+
+// Qweak headers
+#include "QwOptions.h"
+#include "QwHistogramHelper.h"
+#include "QwLog.h"
+
+/// Context of each thread, null for the process defaults
+static thread_local QwAnalysisContext* gCurrentContext = 0;
+
+QwAnalysisContext::QwAnalysisContext(const std::string& name, UInt_t seed)
+: fName(name),
+  fOptions(new QwOptions()),
+  fHistogramHelper(new QwHistogramHelper()),
+  fAdaptiveEventCuts(new QwAdaptiveEventCut::Configuration()),
+  fNonlinearityCorrections(new QwNonlinearityCorrection::Configuration()),
+  fRandomnessGenerator(seed),
+  fNormalRandomVariable(fRandomnessGenerator, fNormalDistribution)
+{
+  QwVerbose << "Created analysis context " << fName << QwLog::endl;
+}
+
+QwAnalysisContext::~QwAnalysisContext()
+{
+  if (gCurrentContext == this) {
+    QwWarning << "Analysis context " << fName << " is deleted while current"
+              << QwLog::endl;
+    gCurrentContext = 0;
+  }
+  delete fNonlinearityCorrections;
+  delete fAdaptiveEventCuts;
+  delete fHistogramHelper;
+  delete fOptions;
+}
+
+QwAnalysisContext* QwAnalysisContext::GetCurrent()
+{
+  return gCurrentContext;
+}
+
+QwAnalysisContext::Scope::Scope(QwAnalysisContext& context)
+: fPrevious(gCurrentContext)
+{
+  gCurrentContext = &context;
+}
+
+QwAnalysisContext::Scope::~Scope()
+{
+  gCurrentContext = fPrevious;
+}
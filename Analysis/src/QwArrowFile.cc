@@ -0,0 +1,175 @@
+/*!
+ * \file   QwArrowFile.cc
+ * \brief  Columnar export of a ROOT tree in Apache Arrow IPC format
+ */
+
+#include "QwArrowFile.h"
+
+// ROOT headers
+#include "TTree.h"
+#include "TLeaf.h"
+#include "TLeafC.h"
+#include "TBranch.h"
+#include "TObjArray.h"
+
+// Arrow headers
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+
+// Qweak headers
+#include "QwLog.h"
+
+QwArrowFile::QwArrowFile(const TString& filename, TTree* tree, Int_t batchsize)
+: fFileName(filename), fTree(tree), fBatchSize(batchsize > 0? batchsize: 1),
+  fRows(0), fEntries(0), fIsOpen(kFALSE), fIsFailed(kFALSE)
+{
+}
+
+QwArrowFile::~QwArrowFile()
+{
+  Close();
+}
+
+/**
+ * Determine the columns from the leaves of the tree, and open the file
+ * @return True if the file is open for writing
+ */
+Bool_t QwArrowFile::Open()
+{
+  std::vector<std::shared_ptr<arrow::Field> > fields;
+  TObjArray* leaves = fTree->GetListOfLeaves();
+  for (Int_t i = 0; i < leaves->GetEntriesFast(); i++) {
+    TLeaf* leaf = static_cast<TLeaf*>(leaves->UncheckedAt(i));
+    TString branch = leaf->GetBranch()->GetName();
+    TString name = (branch == leaf->GetName())? branch: branch + "." + leaf->GetName();
+    if (leaf->IsA() == TLeafC::Class() || leaf->GetLeafCount() != 0) {
+      QwVerbose << "QwArrowFile: leaf " << name << " of tree " << fTree->GetName()
+                << " is not exported" << QwLog::endl;
+      continue;
+    }
+    TString type = leaf->GetTypeName();
+    Bool_t is_integer = ! (type == "Double_t" || type == "Float_t"
+                        || type == "Double32_t" || type == "Float16_t");
+    Int_t len = leaf->GetLen();
+    for (Int_t j = 0; j < len; j++) {
+      Column column;
+      column.fName = (len > 1)? Form("%s[%d]", name.Data(), j): name.Data();
+      column.fLeaf = leaf;
+      column.fIndex = j;
+      column.fIsInteger = is_integer;
+      if (is_integer) column.fInteger.reserve(fBatchSize);
+      else            column.fDouble.reserve(fBatchSize);
+      fColumns.push_back(column);
+      fields.push_back(arrow::field(column.fName,
+          is_integer? arrow::int64(): arrow::float64(), false));
+    }
+  }
+  fSchema = arrow::schema(fields);
+
+  arrow::Result<std::shared_ptr<arrow::io::FileOutputStream> >
+    stream = arrow::io::FileOutputStream::Open(fFileName.Data());
+  if (! stream.ok()) {
+    QwError << "QwArrowFile: unable to open " << fFileName << ": "
+            << stream.status().ToString() << QwLog::endl;
+    return kFALSE;
+  }
+  fStream = *stream;
+
+  arrow::Result<std::shared_ptr<arrow::ipc::RecordBatchWriter> >
+    writer = arrow::ipc::MakeFileWriter(fStream, fSchema);
+  if (! writer.ok()) {
+    QwError << "QwArrowFile: unable to write " << fFileName << ": "
+            << writer.status().ToString() << QwLog::endl;
+    return kFALSE;
+  }
+  fWriter = *writer;
+
+  QwMessage << "Opened Arrow file " << fFileName << " with " << fColumns.size()
+            << " columns of tree " << fTree->GetName() << QwLog::endl;
+  return kTRUE;
+}
+
+void QwArrowFile::Fill()
+{
+  if (fIsFailed) return;
+  if (! fIsOpen) {
+    fIsOpen = Open();
+    if (! fIsOpen) {
+      fIsFailed = kTRUE;
+      return;
+    }
+  }
+
+  for (size_t i = 0; i < fColumns.size(); i++) {
+    Column& column = fColumns[i];
+    if (column.fIsInteger)
+      column.fInteger.push_back(column.fLeaf->GetValueLong64(column.fIndex));
+    else
+      column.fDouble.push_back(column.fLeaf->GetValue(column.fIndex));
+  }
+
+  if (++fRows >= fBatchSize && ! WriteBatch()) {
+    fIsFailed = kTRUE;
+    Close();
+  }
+}
+
+/**
+ * Write the collected rows as a record batch and clear the columns
+ * @return True if the batch was written
+ */
+Bool_t QwArrowFile::WriteBatch()
+{
+  if (fRows == 0) return kTRUE;
+
+  std::vector<std::shared_ptr<arrow::Array> > arrays;
+  arrow::Status status;
+  for (size_t i = 0; status.ok() && i < fColumns.size(); i++) {
+    Column& column = fColumns[i];
+    std::shared_ptr<arrow::Array> array;
+    if (column.fIsInteger) {
+      arrow::Int64Builder builder;
+      status = builder.AppendValues(reinterpret_cast<const int64_t*>(column.fInteger.data()),
+                                    column.fInteger.size());
+      if (status.ok()) status = builder.Finish(&array);
+      column.fInteger.clear();
+    } else {
+      arrow::DoubleBuilder builder;
+      status = builder.AppendValues(column.fDouble.data(), column.fDouble.size());
+      if (status.ok()) status = builder.Finish(&array);
+      column.fDouble.clear();
+    }
+    arrays.push_back(array);
+  }
+  if (status.ok()) {
+    std::shared_ptr<arrow::RecordBatch> batch =
+      arrow::RecordBatch::Make(fSchema, fRows, arrays);
+    status = fWriter->WriteRecordBatch(*batch);
+  }
+  if (! status.ok()) {
+    QwError << "QwArrowFile: writing to " << fFileName << " failed: "
+            << status.ToString() << QwLog::endl;
+    return kFALSE;
+  }
+
+  fEntries += fRows;
+  fRows = 0;
+  return kTRUE;
+}
+
+void QwArrowFile::Close()
+{
+  if (! fIsOpen) return;
+  fIsOpen = kFALSE;
+
+  if (! fIsFailed) WriteBatch();
+  arrow::Status status = fWriter->Close();
+  if (status.ok()) status = fStream->Close();
+  if (! status.ok())
+    QwError << "QwArrowFile: closing " << fFileName << " failed: "
+            << status.ToString() << QwLog::endl;
+  else
+    QwMessage << "Arrow file " << fFileName << " has " << fEntries
+              << " rows" << QwLog::endl;
+}
@@ -0,0 +1,109 @@
+#include "QwBurstIndex.h"
+
+// ROOT headers
+#include "TTree.h"
+#include "TList.h"
+#include "TLeaf.h"
+#include "TBranch.h"
+
+// Qweak headers
+#include "QwLog.h"
+
+const char* const QwBurstIndex::kName = "burst_index";
+
+QwBurstIndex::QwBurstIndex()
+: TNamed(kName, "Entry ranges of the bursts")
+{
+}
+
+/**
+ * Add a burst to the index
+ * @param burst Burst number
+ * @param end Number of entries in the tree at the end of the burst
+ * @return False if the burst has no entries and was not added
+ */
+Bool_t QwBurstIndex::AddBurst(Int_t burst, Long64_t end)
+{
+  if (end <= GetEntries()) return kFALSE;
+  fBurst.push_back(burst);
+  fEndEntry.push_back(end);
+  return kTRUE;
+}
+
+/**
+ * Get the entry range of a burst number
+ * @param burst Burst number
+ * @param first First entry of the burst
+ * @param end Entry after the last entry of the burst
+ * @return False if the burst is not in the index
+ */
+Bool_t QwBurstIndex::GetEntryRange(Int_t burst, Long64_t& first, Long64_t& end) const
+{
+  for (size_t i = 0; i < fBurst.size(); i++) {
+    if (fBurst[i] == burst) {
+      first = GetFirstEntry(i);
+      end = GetEndEntry(i);
+      return kTRUE;
+    }
+  }
+  return kFALSE;
+}
+
+std::vector< std::pair<Long64_t,Long64_t> > QwBurstIndex::GetEntryRanges() const
+{
+  std::vector< std::pair<Long64_t,Long64_t> > ranges;
+  for (size_t i = 0; i < fBurst.size(); i++)
+    ranges.push_back(std::make_pair(GetFirstEntry(i), GetEndEntry(i)));
+  return ranges;
+}
+
+const QwBurstIndex* QwBurstIndex::GetFromTree(TTree* tree)
+{
+  if (tree == 0 || tree->GetUserInfo() == 0) return 0;
+  return dynamic_cast<const QwBurstIndex*>(tree->GetUserInfo()->FindObject(kName));
+}
+
+/**
+ * Check that the index covers all entries of a tree, and that the burst
+ * counter of every entry is the burst number of its range
+ * @param tree Tree which was read with the index
+ * @param branch Name of the burst counter branch (empty to skip)
+ * @return True if the index matches the tree
+ */
+Bool_t QwBurstIndex::CheckTree(TTree* tree, const char* branch) const
+{
+  if (tree == 0) return kFALSE;
+  if (tree->GetEntries() != GetEntries()) {
+    QwError << "Burst index of tree " << tree->GetName() << " covers "
+            << GetEntries() << " entries, but the tree has "
+            << tree->GetEntries() << QwLog::endl;
+    return kFALSE;
+  }
+  if (branch == 0 || *branch == 0) return kTRUE;
+
+  TLeaf* leaf = tree->GetLeaf(branch);
+  if (leaf == 0) {
+    QwError << "Tree " << tree->GetName() << " has no branch " << branch << QwLog::endl;
+    return kFALSE;
+  }
+  for (size_t i = 0; i < fBurst.size(); i++) {
+    for (Long64_t entry = GetFirstEntry(i); entry < GetEndEntry(i); entry++) {
+      leaf->GetBranch()->GetEntry(entry);
+      if (Int_t(leaf->GetValue()) != fBurst[i]) {
+        QwError << "Entry " << entry << " of tree " << tree->GetName()
+                << " has " << branch << " = " << leaf->GetValue()
+                << " but is indexed in burst " << fBurst[i] << QwLog::endl;
+        return kFALSE;
+      }
+    }
+  }
+  return kTRUE;
+}
+
+void QwBurstIndex::Print(Option_t* option) const
+{
+  QwMessage << GetTitle() << ": " << fBurst.size() << " bursts" << QwLog::endl;
+  for (size_t i = 0; i < fBurst.size(); i++)
+    QwMessage << "  burst " << fBurst[i] << ": entries " << GetFirstEntry(i)
+              << " to " << GetEndEntry(i) - 1 << QwLog::endl;
+}
@@ -0,0 +1,362 @@
+/*!
+ * \file   QwCodaFileCheck.cc
+ * \brief  Validation and content summary of a CODA data file without decoding
+ */
+
+#include "QwCodaFileCheck.h"
+
+// System headers
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ROOT headers
+#include "TString.h"
+
+// Qweak headers
+#include "QwLog.h"
+
+// CODA block header (as in evio/src/evio.C)
+static const UInt_t kBlockMagic    = 0xc0da0100;
+static const UInt_t kBlockHdSize   = 8;
+static const UInt_t kHdBlockSize   = 0;
+static const UInt_t kHdBlockNumber = 1;
+static const UInt_t kHdHeaderSize  = 2;
+static const UInt_t kHdStart       = 3;
+static const UInt_t kHdUsed        = 4;
+static const UInt_t kHdMagic       = 7;
+
+// CODA event types (as in MQwCodaControlEvent and QwEventBuffer)
+static const UInt_t kMaxPhysicsEventType = 15;
+static const UInt_t kSyncEvent     = 16;
+static const UInt_t kPrestartEvent = 17;
+static const UInt_t kGoEvent       = 18;
+static const UInt_t kPauseEvent    = 19;
+static const UInt_t kEndEvent      = 20;
+static const UInt_t kEPICSEvent    = 131;
+
+/// Largest event which is considered sane, in words
+static const UInt_t kMaxEventLength = 1 << 24;
+
+QwCodaFileCheck::QwCodaFileCheck(const std::string& filename)
+: fFileName(filename), fScanned(kFALSE),
+  fFileSize(0), fBlockSize(0), fNumBlocks(0), fByteSwapped(kFALSE),
+  fNumEvents(0),
+  fNumPhysicsEvents(0), fFirstEventNumber(0), fLastEventNumber(0),
+  fNumGaps(0), fNumMissingEvents(0),
+  fNumErrors(0)
+{ }
+
+void QwCodaFileCheck::AddError(const std::string& message)
+{
+  if (fErrors.size() < kMaxErrors) fErrors.push_back(message);
+  fNumErrors++;
+}
+
+/**
+ * Map the file into memory and check its block and event structure.  This
+ * is thread-safe for different objects: nothing is printed.
+ * @return True if the file could be scanned (even with errors)
+ */
+Bool_t QwCodaFileCheck::Scan()
+{
+  int fd = open(fFileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    AddError("cannot open file: " + std::string(strerror(errno)));
+    return kFALSE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < Long64_t(kBlockHdSize * sizeof(UInt_t))) {
+    AddError("file is too short for a block header");
+    close(fd);
+    return kFALSE;
+  }
+  fFileSize = st.st_size;
+  void* map = mmap(0, fFileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    AddError("cannot map file: " + std::string(strerror(errno)));
+    return kFALSE;
+  }
+  madvise(map, fFileSize, MADV_SEQUENTIAL);
+
+  const unsigned char* bytes = static_cast<const unsigned char*>(map);
+  if (bytes[0] == 0x1f && (bytes[1] == 0x8b || bytes[1] == 0x9d)) {
+    AddError("compressed file, not checked");
+  } else {
+    ScanBlocks(static_cast<const UInt_t*>(map), fFileSize / sizeof(UInt_t));
+    fScanned = kTRUE;
+  }
+  munmap(map, fFileSize);
+  return fScanned;
+}
+
+/**
+ * Follow the events through the blocks.  An event which continues into
+ * the next block is collected in fPartialEvent; the start of the first
+ * event in each block must agree with the length of that event.
+ * @param words Mapped file
+ * @param nwords Number of words in the file
+ */
+void QwCodaFileCheck::ScanBlocks(const UInt_t* words, size_t nwords)
+{
+  // Byte order and block size from the first block
+  fByteSwapped = (words[kHdMagic] != kBlockMagic);
+  if (Word(words, kHdMagic) != kBlockMagic) {
+    AddError("no CODA block header at the start of the file");
+    return;
+  }
+  fBlockSize = Word(words, kHdBlockSize);
+  if (fBlockSize <= kBlockHdSize) {
+    AddError(Form("invalid block size %u", fBlockSize));
+    return;
+  }
+  fNumBlocks = nwords / fBlockSize;
+  if (nwords % fBlockSize != 0 || fFileSize % sizeof(UInt_t) != 0)
+    AddError(Form("truncated file: last block has %lu of %u words",
+                  (unsigned long) (nwords % fBlockSize), fBlockSize));
+
+  UInt_t first_number = Word(words, kHdBlockNumber);
+  UInt_t missing = 0;   // words of fPartialEvent still to come
+  for (Long64_t block = 0; block < fNumBlocks; block++) {
+    const UInt_t* header = words + block * fBlockSize;
+    UInt_t used  = Word(header, kHdUsed);
+    UInt_t start = Word(header, kHdStart);
+
+    // Block header
+    if (Word(header, kHdMagic) != kBlockMagic
+     || Word(header, kHdBlockSize) != fBlockSize
+     || Word(header, kHdHeaderSize) != kBlockHdSize
+     || used < kBlockHdSize || used > fBlockSize
+     || start > used) {
+      AddError(Form("block %lld: corrupted block header", block));
+      if (missing > 0)
+        AddError(Form("block %lld: event lost in corrupted block", block));
+      missing = 0;
+      fPartialEvent.clear();
+      continue;
+    }
+    if (Word(header, kHdBlockNumber) != first_number + block)
+      AddError(Form("block %lld: block number %u, expected %lld", block,
+                    Word(header, kHdBlockNumber), first_number + block));
+
+    // Tail of the event from the previous blocks
+    UInt_t pos = kBlockHdSize;
+    if (missing > 0) {
+      UInt_t available = used - kBlockHdSize;
+      UInt_t expected_start = (missing < available)? kBlockHdSize + missing: 0;
+      if (start != expected_start) {
+        AddError(Form("block %lld: first event starts at word %u, "
+                      "but the previous event ends at word %u",
+                      block, start, expected_start));
+        missing = 0;
+        fPartialEvent.clear();
+      } else {
+        UInt_t ncopy = (missing < available)? missing: available;
+        for (UInt_t i = 0; i < ncopy; i++)
+          fPartialEvent.push_back(Word(header, pos + i));
+        pos += ncopy;
+        missing -= ncopy;
+        if (missing == 0) {
+          ScanEvent(&fPartialEvent[0], fPartialEvent.size());
+          fPartialEvent.clear();
+        }
+        if (missing > 0) continue;
+      }
+    }
+    if (missing == 0 && start == 0) continue;  // no event starts here
+    if (start > 0 && pos != start) pos = start;
+
+    // Events which start in this block
+    while (pos < used) {
+      UInt_t length = Word(header, pos) + 1;
+      if (length < 2 || length > kMaxEventLength) {
+        AddError(Form("block %lld: invalid event length %u at word %u",
+                      block, length, pos));
+        break;
+      }
+      if (pos + length <= used) {
+        if (fByteSwapped) {
+          fPartialEvent.resize(length);
+          for (UInt_t i = 0; i < length; i++)
+            fPartialEvent[i] = Word(header, pos + i);
+          ScanEvent(&fPartialEvent[0], length);
+          fPartialEvent.clear();
+        } else {
+          ScanEvent(header + pos, length);
+        }
+        pos += length;
+      } else {
+        // Event continues in the next block
+        for (UInt_t i = pos; i < used; i++)
+          fPartialEvent.push_back(Word(header, i));
+        missing = length - (used - pos);
+        break;
+      }
+    }
+  }
+  if (missing > 0)
+    AddError(Form("truncated file: last event misses %u words", missing));
+}
+
+/**
+ * Count an event by type, and check the event ID bank of physics events
+ * and the times of control events.
+ * @param event Event in host byte order
+ * @param length Number of words in the event
+ */
+void QwCodaFileCheck::ScanEvent(const UInt_t* event, UInt_t length)
+{
+  fNumEvents++;
+  UInt_t type = (event[1] >> 16) & 0xFFFF;
+  fEventTypeCount[type]++;
+  if ((event[1] & 0xFF) != 0xCC) return;   // not a CODA event bank
+
+  if (type <= kMaxPhysicsEventType) {
+    if (length < 7) {
+      AddError(Form("event %lld: physics event of only %u words", fNumEvents, length));
+      return;
+    }
+    UInt_t number = event[4];
+    if (fNumPhysicsEvents == 0) {
+      fFirstEventNumber = number;
+    } else if (number != fLastEventNumber + 1) {
+      fNumGaps++;
+      if (number > fLastEventNumber)
+        fNumMissingEvents += number - fLastEventNumber - 1;
+      else
+        AddError(Form("event number %u after %u", number, fLastEventNumber));
+    }
+    fLastEventNumber = number;
+    fNumPhysicsEvents++;
+    ScanBanks(event, length);
+  } else if (type >= kSyncEvent && type <= kEndEvent) {
+    if (length < 5) {
+      AddError(Form("event %lld: control event of only %u words", fNumEvents, length));
+      return;
+    }
+    ControlEvent control;
+    control.fType = type;
+    control.fTime = event[2];
+    control.fValue = (type == kPrestartEvent)? event[3]: event[4];
+    fControlEvents.push_back(control);
+    if (type == kEndEvent && fNumPhysicsEvents > 0 && control.fValue != fLastEventNumber)
+      AddError(Form("end event counts %u events, but the last event number is %u",
+                    control.fValue, fLastEventNumber));
+  }
+}
+
+/**
+ * Check that the ROC banks and their subbanks fill the event exactly, and
+ * count them.
+ * @param event Physics event in host byte order
+ * @param length Number of words in the event
+ */
+void QwCodaFileCheck::ScanBanks(const UInt_t* event, UInt_t length)
+{
+  UInt_t pos = 2 + event[2] + 1;   // after the event ID bank
+  while (pos < length) {
+    UInt_t bank_length = event[pos] + 1;
+    if (pos + bank_length > length || bank_length < 2) {
+      AddError(Form("event %u: ROC bank of %u words at word %u overruns the event of %u words",
+                    fLastEventNumber, bank_length, pos, length));
+      return;
+    }
+    UInt_t roc = (event[pos+1] >> 16) & 0xFFFF;
+    fROCCount[roc]++;
+    if (((event[pos+1] >> 8) & 0xFF) == 0x10) {
+      UInt_t sub = pos + 2;
+      while (sub < pos + bank_length) {
+        UInt_t sub_length = event[sub] + 1;
+        if (sub + sub_length > pos + bank_length || sub_length < 2) {
+          AddError(Form("event %u: subbank of %u words overruns ROC %u bank",
+                        fLastEventNumber, sub_length, roc));
+          break;
+        }
+        fBankCount[std::make_pair(roc, (event[sub+1] >> 16) & 0xFFFF)]++;
+        sub += sub_length;
+      }
+    }
+    pos += bank_length;
+  }
+}
+
+/**
+ * Print the summary of the file: in brief, one line with the status and
+ * the event number range.
+ * @param brief Print only one line
+ */
+void QwCodaFileCheck::PrintSummary(Bool_t brief) const
+{
+  TString status = fScanned? (fNumErrors == 0? "OK": Form("%lld errors", fNumErrors)): "not checked";
+  if (brief) {
+    QwMessage << fFileName << ": " << status << ", " << fNumPhysicsEvents
+              << " physics events " << fFirstEventNumber << "-" << fLastEventNumber
+              << ", " << fNumGaps << " gaps" << QwLog::endl;
+    for (size_t i = 0; i < fErrors.size(); i++)
+      QwMessage << "  " << fErrors[i] << QwLog::endl;
+    return;
+  }
+
+  QwMessage << "File " << fFileName << ": " << status << QwLog::endl;
+  QwMessage << "  " << fNumBlocks << " blocks of " << fBlockSize << " words"
+            << (fByteSwapped? ", byte swapped": "") << QwLog::endl;
+  QwMessage << "  " << fNumEvents << " events, " << fNumPhysicsEvents
+            << " physics events with numbers " << fFirstEventNumber << " to "
+            << fLastEventNumber << QwLog::endl;
+  QwMessage << "  " << fNumGaps << " gaps in the event numbers, "
+            << fNumMissingEvents << " events missing" << QwLog::endl;
+
+  QwMessage << "  Events by type:" << QwLog::endl;
+  std::map<UInt_t, Long64_t>::const_iterator type;
+  for (type = fEventTypeCount.begin(); type != fEventTypeCount.end(); ++type) {
+    TString name;
+    if (type->first <= kMaxPhysicsEventType) name = "physics";
+    else if (type->first == kSyncEvent)     name = "sync";
+    else if (type->first == kPrestartEvent) name = "prestart";
+    else if (type->first == kGoEvent)       name = "go";
+    else if (type->first == kPauseEvent)    name = "pause";
+    else if (type->first == kEndEvent)      name = "end";
+    else if (type->first == kEPICSEvent)    name = "EPICS";
+    else if (type->first >= 0x90 && type->first <= 0xaf) name = "ROC configuration";
+    QwMessage << Form("    %5u %-18s %lld", type->first, name.Data(), type->second)
+              << QwLog::endl;
+  }
+  if (fEventTypeCount.count(kEPICSEvent) == 0)
+    QwMessage << "  No EPICS events" << QwLog::endl;
+
+  QwMessage << "  Control events:" << QwLog::endl;
+  for (size_t i = 0; i < fControlEvents.size(); i++) {
+    const ControlEvent& control = fControlEvents[i];
+    time_t time = control.fTime;
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", localtime(&time));
+    const char* names[] = {"sync", "prestart", "go", "pause", "end"};
+    QwMessage << Form("    %-8s %s  %s %u", names[control.fType - kSyncEvent], text,
+                      (control.fType == kPrestartEvent)? "run": "events", control.fValue)
+              << QwLog::endl;
+  }
+
+  QwMessage << "  ROC banks in physics events:" << QwLog::endl;
+  std::map<UInt_t, Long64_t>::const_iterator roc;
+  for (roc = fROCCount.begin(); roc != fROCCount.end(); ++roc)
+    QwMessage << Form("    ROC %3u: %lld", roc->first, roc->second) << QwLog::endl;
+  QwMessage << "  Subbanks in physics events:" << QwLog::endl;
+  std::map<std::pair<UInt_t, UInt_t>, Long64_t>::const_iterator bank;
+  for (bank = fBankCount.begin(); bank != fBankCount.end(); ++bank)
+    QwMessage << Form("    ROC %3u bank 0x%04x: %lld", bank->first.first,
+                      bank->first.second, bank->second) << QwLog::endl;
+
+  if (fErrors.size() > 0) {
+    QwMessage << "  Errors:" << QwLog::endl;
+    for (size_t i = 0; i < fErrors.size(); i++)
+      QwMessage << "    " << fErrors[i] << QwLog::endl;
+    if (fNumErrors > Long64_t(fErrors.size()))
+      QwMessage << "    ... and " << fNumErrors - fErrors.size() << " more" << QwLog::endl;
+  }
+}
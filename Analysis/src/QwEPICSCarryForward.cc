@@ -0,0 +1,136 @@
+/*!
+ * \file   QwEPICSCarryForward.cc
+ * \brief  EPICS values carried forward onto the pattern and burst trees
+ */
+
+#include "QwEPICSCarryForward.h"
+
+// ROOT headers
+#include "TTree.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwEPICSEvent.h"
+
+/// Value of a tag before its first update, as QwEPICSEvent::GetDataValue
+static const Double_t kNoEPICSData = -999999.0;
+
+QwEPICSCarryForward::QwEPICSCarryForward(QwOptions& options)
+{
+  ProcessOptions(options);
+}
+
+void QwEPICSCarryForward::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("EPICS options")
+    ("epics-carry-forward", po::value<std::vector<std::string> >()->composing(),
+     "EPICS tag to write with its last value and update count on the pattern and burst trees");
+}
+
+void QwEPICSCarryForward::ProcessOptions(QwOptions& options)
+{
+  fTags.clear();
+  if (options.HasValue("epics-carry-forward"))
+    fTags = options.GetValueVector<std::string>("epics-carry-forward");
+  fTagIndex.assign(fTags.size(), -1);
+  Clear();
+}
+
+/**
+ * Look up the tags in the EPICS event; tags which are not in the EPICS
+ * channel map are dropped.
+ * @param epicsevent EPICS event with the channel map loaded
+ */
+void QwEPICSCarryForward::ConnectTags(const QwEPICSEvent& epicsevent)
+{
+  std::vector<std::string> tags;
+  std::vector<Int_t> index;
+  for (size_t i = 0; i < fTags.size(); i++) {
+    Int_t tagindex = epicsevent.FindIndex(fTags[i]);
+    if (tagindex < 0) {
+      QwWarning << "QwEPICSCarryForward: EPICS tag " << fTags[i]
+                << " is not in the EPICS map, and will not be written" << QwLog::endl;
+      continue;
+    }
+    tags.push_back(fTags[i]);
+    index.push_back(tagindex);
+  }
+  fTags = tags;
+  fTagIndex = index;
+  Clear();
+}
+
+/**
+ * Queue the values of the tags which were in the last EPICS event, until
+ * the events decoded after it leave the event ring
+ * @param epicsevent EPICS event
+ * @param event_number CODA event number of the last event decoded before
+ *        the EPICS event (zero before the first event)
+ */
+void QwEPICSCarryForward::Update(const QwEPICSEvent& epicsevent, UInt_t event_number)
+{
+  if (fTagIndex.empty()) return;
+  PendingUpdate update;
+  update.fEventNumber = event_number;
+  update.fValue.assign(fTagIndex.size(), kNoEPICSData);
+  update.fFilled.assign(fTagIndex.size(), kFALSE);
+  for (size_t i = 0; i < fTagIndex.size(); i++) {
+    if (fTagIndex[i] < 0 || ! epicsevent.IsDataFilled(fTagIndex[i])) continue;
+    update.fValue[i] = epicsevent.GetTreeValue(fTagIndex[i]);
+    update.fFilled[i] = kTRUE;
+  }
+  fPending.push_back(update);
+}
+
+/**
+ * Update the values with the queued EPICS events which were decoded before
+ * an event
+ * @param event_number CODA event number of the event leaving the event ring
+ */
+void QwEPICSCarryForward::ApplyUpdates(UInt_t event_number)
+{
+  while (! fPending.empty() && fPending.front().fEventNumber < event_number) {
+    const PendingUpdate& update = fPending.front();
+    for (size_t i = 0; i < update.fFilled.size(); i++) {
+      if (! update.fFilled[i]) continue;
+      fValue[i] = update.fValue[i];
+      fUpdates[i]++;
+    }
+    fPending.pop_front();
+  }
+}
+
+void QwEPICSCarryForward::Clear()
+{
+  fValue.assign(fTags.size(), kNoEPICSData);
+  fUpdates.assign(fTags.size(), 0.0);
+  fPending.clear();
+}
+
+void QwEPICSCarryForward::ConstructBranchAndVector(TTree *tree, TString& prefix, std::vector<Double_t>& values)
+{
+  fTreeArrayIndex[&values] = values.size();
+  for (size_t i = 0; i < fTags.size(); i++) {
+    TString name = prefix + "epics_" + fTags[i].c_str();
+    name.ReplaceAll(':','_'); // remove colons before creating branch
+    TString name_n = name + "_n";
+
+    values.push_back(0.0);
+    tree->Branch(name, &(values.back()), name + "/D");
+    values.push_back(0.0);
+    tree->Branch(name_n, &(values.back()), name_n + "/D");
+  }
+}
+
+void QwEPICSCarryForward::FillTreeVector(std::vector<Double_t>& values) const
+{
+  std::map<const std::vector<Double_t>*, size_t>::const_iterator
+    index = fTreeArrayIndex.find(&values);
+  if (index == fTreeArrayIndex.end()) return;
+  size_t treeindex = index->second;
+  for (size_t i = 0; i < fTags.size(); i++) {
+    values[treeindex++] = fValue[i];
+    values[treeindex++] = fUpdates[i];
+  }
+}
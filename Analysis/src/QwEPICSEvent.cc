@@ -377,6 +377,21 @@ Double_t QwEPICSEvent::GetDataValue(const string& tag) const
   return data_value;
 }
 
+Bool_t QwEPICSEvent::IsDataFilled(Int_t index) const
+{
+  if (index < 0 || index >= static_cast<Int_t>(fEPICSDataEvent.size())) return kFALSE;
+  return fEPICSDataEvent[index].Filled;
+}
+
+/// Value of a tag as stored in the slow tree (string values are hashed)
+Double_t QwEPICSEvent::GetTreeValue(Int_t index) const
+{
+  if (index < 0 || index >= static_cast<Int_t>(fEPICSDataEvent.size())) return kInvalidEPICSData;
+  if (fEPICSVariableType[index] == kEPICSString)
+    return static_cast<Double_t>(fEPICSDataEvent[index].StringValue.Hash());
+  return fEPICSDataEvent[index].Value;
+}
+
 TString QwEPICSEvent::GetDataString(const string& tag) const
 {
   Int_t tagindex = FindIndex(tag);
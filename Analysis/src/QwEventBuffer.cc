@@ -8,6 +8,7 @@
 #include <TMath.h>
 
 #include <vector>
+#include <cstring>
 #include <glob.h>
 
 #include <csignal>
@@ -134,6 +135,9 @@ void QwEventBuffer::DefineOptions(QwOptions &options)
   options.AddOptions("ET system options")
     ("ET.exit-on-end", po::value<bool>()->default_value(false),
      "Exit the event loop if the end event is found.  --- Only used in online mode");
+  options.AddOptions("ET system options")
+    ("ET.zero-copy", po::value<bool>()->default_bool_value(false),
+     "Decode each event in the ET system instead of copying it out  --- Only used in online mode");
 }
 
 void QwEventBuffer::ProcessOptions(QwOptions &options)
@@ -142,6 +146,7 @@ void QwEventBuffer::ProcessOptions(QwOptions &options)
   if (fOnline){
     fETWaitMode  = options.GetValue<int>("ET.waitmode");
     fExitOnEnd  = options.GetValue<bool>("ET.exit-on-end");
+    fETZeroCopy = options.GetValue<bool>("ET.zero-copy");
 #ifndef __CODA_ET
     QwError << "Online mode will not work without the CODA libraries!"
 	    << QwLog::endl;
@@ -321,6 +326,57 @@ TString QwEventBuffer::GetRunLabel() const
   return runlabel;
 }
 
+std::vector<TString> QwEventBuffer::GetDataFileList() const
+{
+  std::vector<TString> filelist;
+  if (fOnline) return filelist;
+  if (fRunIsSegmented && fChainDataFiles && !fSingleFile){
+    //  All segments of the run are chained into this stream
+    TString basename = fDataDirectory + fDataFileStem
+      + Form("%d.",fCurrentRun) + fDataFileExtension;
+    for (size_t i = 0; i < fRunSegments.size(); i++)
+      filelist.push_back(basename + Form(".%d",fRunSegments.at(i)));
+  } else {
+    filelist.push_back(fDataFile);
+  }
+  return filelist;
+}
+
+Int_t QwEventBuffer::GetDataFileBlockCount() const
+{
+  if (fEvStreamMode != fEvStreamFile || fEvStream == NULL) return 0;
+  Int_t count = fEvStream->getBlockCount();
+  return (count > 0)? count: 0;
+}
+
+Int_t QwEventBuffer::GetDataFileBlock() const
+{
+  if (fEvStreamMode != fEvStreamFile || fEvStream == NULL) return -1;
+  return fEvStream->getBlockNumber();
+}
+
+/**
+ * Continue reading the current data file at the first event which starts
+ * in the given block.  Blocks past the end of the file end the file (and
+ * move on to the next segment when segments are chained).  The events in
+ * between are not decoded, so the subsystems see a gap in the event and
+ * pattern counters.
+ * @param block Block number in the current data file
+ * @return CODA_OK, or CODA_ERROR if the stream cannot seek
+ */
+Int_t QwEventBuffer::SeekDataFileBlock(Int_t block)
+{
+  if (fEvStreamMode != fEvStreamFile || fEvStream == NULL) {
+    QwError << "Cannot seek in an ET stream" << QwLog::endl;
+    return CODA_ERROR;
+  }
+  Int_t status = fEvStream->codaSeekBlock(block);
+  if (status != CODA_OK)
+    QwError << "Cannot seek to block " << block << " of " << fDataFile
+            << QwLog::endl;
+  return status;
+}
+
 Int_t QwEventBuffer::ReOpenStream()
 {
   Int_t status = CODA_ERROR;
@@ -583,6 +639,26 @@ Int_t QwEventBuffer::EncodeSubsystemData(QwSubsystemArray &subsystems)
 }
 
 
+/**
+ * Write an EPICS event with one string bank, as read by FillEPICSData
+ * @param text EPICS values, one 'tag value' pair per line
+ * @return Status of the write
+ */
+Int_t QwEventBuffer::EncodeEPICSEvent(const std::string& text)
+{
+  // String bank padded with at least one null character to full words
+  size_t nwords = text.size() / sizeof(int) + 1;
+  std::vector<int> codabuffer(nwords + 4, 0);
+  codabuffer[0] = nwords + 3; // length
+  codabuffer[1] = ((131 << 16) | (0x10 << 8) | 0xCC);
+		// event type | bank of banks | event ID (0xCC for CODA event)
+  codabuffer[2] = nwords + 1; // length of the string bank
+  codabuffer[3] = ((0x83 << 16) | (0x03 << 8) | 0x00);
+		// bank tag | bank data type (0x03 for string) | bank number
+  memcpy(&codabuffer[4], text.c_str(), text.size());
+  return WriteEvent(&codabuffer[0]);
+}
+
 Int_t QwEventBuffer::EncodePrestartEvent(int runnumber, int runtype)
 {
   int buffer[5];
@@ -1309,6 +1385,8 @@ Int_t QwEventBuffer::OpenETStream(TString computer, TString session, int mode,
     } else {
       fEvStream = new THaEtClient(computer, session, mode);
     }
+    //  Decode the events in the ET chunks only when requested
+    ((THaEtClient*)fEvStream)->setZeroCopy(fETZeroCopy);
     fEvStreamMode = fEvStreamET;
 #endif
   }
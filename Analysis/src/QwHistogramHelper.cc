@@ -13,9 +13,17 @@
 
 // Qweak headers
 #include "QwLog.h"
+#include "QwAnalysisContext.h"
 
-///  Globally defined instance of the QwHistogramHelper class.
-QwHistogramHelper gQwHists;
+///  Globally defined default instance of the QwHistogramHelper class.
+static QwHistogramHelper gQwHistsDefault;
+
+QwHistogramHelper& QwHistogramHelper::Instance()
+{
+  QwAnalysisContext* context = QwAnalysisContext::GetCurrent();
+  if (context) return context->GetHistogramHelper();
+  return gQwHistsDefault;
+}
 
 
 const Double_t QwHistogramHelper::fInvalidNumber  = -1.0e7;
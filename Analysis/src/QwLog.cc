@@ -21,10 +21,12 @@
 // Create the static logger object (with streams to screen and file)
 QwLog gQwLog;
 
-// Set the static flags
-bool QwLog::fScreenAtNewLine = true;
-bool QwLog::fScreenInColor = false;
-bool QwLog::fFileAtNewLine = true;
+// Set the static flags and log level of each thread
+thread_local bool QwLog::fScreenAtNewLine = true;
+thread_local bool QwLog::fScreenInColor = false;
+thread_local bool QwLog::fFileAtNewLine = true;
+thread_local QwLog::QwLogLevel QwLog::fLogLevel = QwLog::kMessage;
+thread_local char QwLog::fTimeString[128];
 
 // Log file open modes
 const std::ios_base::openmode QwLog::kTruncate = std::ios::trunc;
@@ -41,8 +43,6 @@ QwLog::QwLog()
   fFileThreshold = kMessage;
   fFile = 0;
 
-  fLogLevel = kMessage;
-
   fUseColor = true;
 
   fPrintFunctionSignature = false;
@@ -134,9 +134,13 @@ void QwLog::ProcessOptions(QwOptions* options)
 /*!
  *  Determine whether the function name matches a specified list of regular expressions
  */
-bool QwLog::IsDebugFunction(const string func_sig)
+bool QwLog::IsDebugFunction(const char* func_sig)
 {
+  // No debugged functions (avoids building a string for every message)
+  if (fDebugFunctionRegexString.empty()) return false;
+
   // If not in our cached list
+  std::lock_guard<std::mutex> lock(fIsDebugFunctionMutex);
   if (fIsDebugFunction.find(func_sig) == fIsDebugFunction.end()) {
     // Look through all regexes
     fIsDebugFunction[func_sig] = false;
@@ -191,7 +195,7 @@ void QwLog::SetFileThreshold(int thr)
  */
 QwLog& QwLog::operator()(
   const QwLogLevel level,
-  const std::string func_sig)
+  const char* func_sig)
 {
   // Set the log level of this sink
   fLogLevel = level;
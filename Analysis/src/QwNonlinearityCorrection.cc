@@ -0,0 +1,155 @@
+/*!
+ * \file   QwNonlinearityCorrection.cc
+ * \brief  Per-channel nonlinearity correction from interpolation tables
+ */
+
+#include "QwNonlinearityCorrection.h"
+
+// System headers
+#include <atomic>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwParameterFile.h"
+#include "QwInterpolator.h"
+#include "QwAnalysisContext.h"
+
+/// Last generation of any table map, so that the channels of one analysis
+/// never mistake the table map of another for their own
+static std::atomic<UInt_t> gLastGeneration(0);
+
+QwNonlinearityCorrection::Configuration::Configuration()
+: fGeneration(++gLastGeneration)
+{
+}
+
+QwNonlinearityCorrection::Configuration& QwNonlinearityCorrection::GetConfiguration()
+{
+  QwAnalysisContext* context = QwAnalysisContext::GetCurrent();
+  if (context) return context->GetNonlinearityCorrections();
+  static Configuration configuration;
+  return configuration;
+}
+
+/**
+ * Load a correction table, memory-mapped from a binary file if possible,
+ * and read from a text file otherwise.  Only one-dimensional tables with
+ * at least two points can be used.
+ * @param filename Table file name
+ */
+QwNonlinearityCorrection::QwNonlinearityCorrection(const std::string& filename)
+: fTable(new QwInterpolator<float,1>(1)),
+  fMinimum(0.0), fInverseStep(0.0), fLast(0.0), fSize(0), fValues(0)
+{
+  if (! fTable->MapBinaryFile(filename) && ! fTable->ReadTextFile(filename)) {
+    QwError << "QwNonlinearityCorrection: unable to read table " << filename
+            << QwLog::endl;
+    return;
+  }
+  if (fTable->GetDimensions() != 1
+   || fTable->GetMaximumEntries() < 2 || fTable->GetStepSize(0) <= 0.0) {
+    QwError << "QwNonlinearityCorrection: table " << filename
+            << " is not a one-dimensional table with positive step size" << QwLog::endl;
+    return;
+  }
+  fMinimum = fTable->GetMinimum(0);
+  fInverseStep = 1.0 / fTable->GetStepSize(0);
+  fSize = fTable->GetMaximumEntries();
+  fLast = fSize - 1;
+  fValues = fTable->GetValueArray();
+
+  // The table is part of the replay configuration
+  QwParameterFile::AddToOpenedFileList(filename);
+}
+
+QwNonlinearityCorrection::~QwNonlinearityCorrection()
+{
+  delete fTable;
+}
+
+void QwNonlinearityCorrection::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Nonlinearity correction")
+    ("nonlinearity-map", po::value<std::string>()->default_value(""),
+     "map of channels to nonlinearity correction tables");
+}
+
+void QwNonlinearityCorrection::ProcessOptions(QwOptions& options)
+{
+  std::string mapfile = options.GetValue<std::string>("nonlinearity-map");
+  if (mapfile.size() > 0) LoadTableMap(mapfile);
+}
+
+/**
+ * Load the assignment of correction tables to channels
+ * @param mapfile Map file name
+ */
+void QwNonlinearityCorrection::LoadTableMap(const std::string& mapfile)
+{
+  Clear();
+
+  Configuration& config = GetConfiguration();
+  QwParameterFile map(mapfile);
+  TString mapdir = map.GetParamFilenameAndPath();
+  Ssiz_t slash = mapdir.Last('/');
+  if (slash != kNPOS) mapdir.Remove(slash + 1);
+  else mapdir = "";
+
+  // Tables which are already loaded, by file name
+  std::map<std::string, boost::shared_ptr<QwNonlinearityCorrection> > tables;
+  while (map.ReadNextLine()) {
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    TString channel = map.GetNextToken(" \t");
+    std::string table = map.GetNextToken(" \t");
+    if (table.empty()) {
+      QwError << "QwNonlinearityCorrection: no table for channel " << channel
+              << " in " << mapfile << QwLog::endl;
+      continue;
+    }
+    if (table[0] != '/') table = mapdir.Data() + table;
+
+    if (tables.find(table) == tables.end()) {
+      boost::shared_ptr<QwNonlinearityCorrection> correction(new QwNonlinearityCorrection(table));
+      if (! correction->IsValid()) correction.reset();
+      tables[table] = correction;
+    }
+    if (! tables[table]) continue;
+
+    channel.ToLower();
+    config.fChannelTables[channel] = tables[table];
+  }
+
+  QwMessage << "QwNonlinearityCorrection: " << config.fChannelTables.size()
+            << " channels with " << tables.size() << " correction tables"
+            << QwLog::endl;
+}
+
+/**
+ * Remove all corrections.  The channels keep plain pointers to the tables,
+ * but look them up again before use whenever the generation has changed.
+ */
+void QwNonlinearityCorrection::Clear()
+{
+  Configuration& config = GetConfiguration();
+  config.fChannelTables.clear();
+  config.fGeneration = ++gLastGeneration;
+}
+
+/**
+ * Get the correction for a channel
+ * @param channel Channel name
+ * @return Correction, or null if the channel is not corrected
+ */
+const QwNonlinearityCorrection* QwNonlinearityCorrection::Find(const TString& channel)
+{
+  const Configuration& config = GetConfiguration();
+  if (config.fChannelTables.empty()) return 0;
+  TString name = channel;
+  name.ToLower();
+  std::map<TString, boost::shared_ptr<QwNonlinearityCorrection> >::const_iterator
+    it = config.fChannelTables.find(name);
+  return (it != config.fChannelTables.end())? it->second.get(): 0;
+}
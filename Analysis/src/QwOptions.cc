@@ -23,17 +23,22 @@
 #include <TROOT.h>
 // Qweak headers
 #include "QwLog.h"
+#include "QwAnalysisContext.h"
 #include "QwParameterFile.h"
 
 // Qweak objects with default options
 #include "QwSubsystemArray.h"
 #include "QwEventBuffer.h"
 #include "QwEPICSEvent.h"
+#include "QwEPICSCarryForward.h"
 #ifdef  __USE_DATABASE__
 #include "QwDatabase.h"
 #endif
 #include "QwRootFile.h"
 #include "QwHistogramHelper.h"
+#include "QwReplayMemo.h"
+#include "QwNonlinearityCorrection.h"
+#include "QwAdaptiveEventCut.h"
 
 // External objects
 extern const char* const gGitInfo;
@@ -41,6 +46,19 @@ extern const char* const gGitInfo;
 // Initialize the static command line arguments to zero
 QwOptions* QwOptions::fInstance = 0;
 
+/**
+ * Get the options of the analysis context of the calling thread, or the
+ * process default options if no context is current
+ * @return Options object
+ */
+QwOptions& QwOptions::Instance()
+{
+  QwAnalysisContext* context = QwAnalysisContext::GetCurrent();
+  if (context) return context->GetOptions();
+  if (! fInstance) fInstance = new QwOptions();
+  return *fInstance;
+}
+
 /**
  * The default constructor sets up the options description object with some
  * options that should always be there.  The other options can be setup
@@ -79,10 +97,17 @@ void QwOptions::DefineOptions(QwOptions& options)
   QwRootFile::DefineOptions(options);
   // Define EPICS event options
   QwEPICSEvent::DefineOptions(options);
+  QwEPICSCarryForward::DefineOptions(options);
   // Define subsystem array options
   QwSubsystemArray::DefineOptions(options);
   // Define histogram helper options
   QwHistogramHelper::DefineOptions(options);
+  // Define replay memoization options
+  QwReplayMemo::DefineOptions(options);
+  // Define nonlinearity correction options
+  QwNonlinearityCorrection::DefineOptions(options);
+  // Define adaptive event cut options
+  QwAdaptiveEventCut::DefineOptions(options);
 }
 
 /**
@@ -289,48 +314,58 @@ void QwOptions::ParseEnvironment()
 }
 
 /**
- * Parse the configuration file for options and warn when encountering
- * an unknown option, then notify the variables map.
+ * Parse the configuration files for options, including the files added
+ * with add-config.
  */
 void QwOptions::ParseConfigFile()
 {
   for (size_t i = 0; i < fConfigFiles.size(); i++) {
-    QwParameterFile configfile(fConfigFiles.at(i).c_str());
-    std::stringstream configstream;
-    configstream << configfile.rdbuf();
+    ParseConfigFile(fConfigFiles.at(i));
+
+    // If a configuration file is specified, load it.
+    if (fVariablesMap.count("add-config") > 0) {
+      AddConfigFile(fVariablesMap["add-config"].as<std::vector<std::string> >());
+    }
+  }
+}
+
+/**
+ * Parse the configuration file for options and warn when encountering
+ * an unknown option, then notify the variables map.
+ * @param filename Name of the config file
+ */
+void QwOptions::ParseConfigFile(const std::string& filename)
+{
+  QwParameterFile configfile(filename.c_str());
+  std::stringstream configstream;
+  configstream << configfile.rdbuf();
 
-    try {
+  try {
 #if BOOST_VERSION >= 103500
-      // Boost version after 1.35 have bool allow_unregistered = false in
-      // their signature.  This allows for unknown options in the config file.
-      po::options_description* config_file_options = CombineOptions();
-      po::store(po::parse_config_file(configstream, *config_file_options, true),
-		fVariablesMap);
-      delete config_file_options;
+    // Boost version after 1.35 have bool allow_unregistered = false in
+    // their signature.  This allows for unknown options in the config file.
+    po::options_description* config_file_options = CombineOptions();
+    po::store(po::parse_config_file(configstream, *config_file_options, true),
+              fVariablesMap);
+    delete config_file_options;
 #else
-      // Boost versions before 1.35 cannot handle files with unregistered
-      // options.
-      po::options_description* config_file_options = CombineOptions();
-      po::store(po::parse_config_file(configstream, *config_file_options),
-		fVariablesMap);
-      delete config_file_options;
+    // Boost versions before 1.35 cannot handle files with unregistered
+    // options.
+    po::options_description* config_file_options = CombineOptions();
+    po::store(po::parse_config_file(configstream, *config_file_options),
+              fVariablesMap);
+    delete config_file_options;
 #endif
-    } catch (std::exception const& e) {
-      QwWarning << e.what() << " while parsing configuration file "
-                << fConfigFiles.at(i) << QwLog::endl;
+  } catch (std::exception const& e) {
+    QwWarning << e.what() << " while parsing configuration file "
+              << filename << QwLog::endl;
 #if BOOST_VERSION < 103500
-      QwWarning << "The entire configuration file was ignored!" << QwLog::endl;
+    QwWarning << "The entire configuration file was ignored!" << QwLog::endl;
 #endif
-      exit(10);
-    }
-    // Notify of new options
-    po::notify(fVariablesMap);
-    
-    // If a configuration file is specified, load it.
-    if (fVariablesMap.count("add-config") > 0) {
-      AddConfigFile(fVariablesMap["add-config"].as<std::vector<std::string> >());
-    }
+    exit(10);
   }
+  // Notify of new options
+  po::notify(fVariablesMap);
 }
 
 
@@ -21,6 +21,10 @@ std::vector<bfs::path> QwParameterFile::fSearchPaths;
 // Set current run number to zero
 UInt_t QwParameterFile::fCurrentRunNumber = 0;
 
+// Initialize the list of opened parameter files
+std::set<std::string> QwParameterFile::fOpenedFileList;
+std::mutex QwParameterFile::fOpenedFileListMutex;
+
 // Set default comment, whitespace, section, module characters
 const std::string QwParameterFile::kDefaultCommentChars = "#!;";
 const std::string QwParameterFile::kDefaultWhitespaceChars = " \t\r";
@@ -223,6 +227,7 @@ bool QwParameterFile::OpenFile(const bfs::path& file)
     
     fBestParamFileNameAndPath = file.string();
     this->SetParamFilename();
+    AddToOpenedFileList(file.string());
     
     // Connect stream (fFile) to file
     fFile.open(file.string().c_str());
@@ -0,0 +1,279 @@
+/*!
+ * \file   QwReplayMemo.cc
+ * \brief  Content-addressed memoization of complete replays
+ */
+
+#include "QwReplayMemo.h"
+
+// System headers
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <string>
+
+// ROOT headers
+#include "TSystem.h"
+#include "TMD5.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwParameterFile.h"
+#include "QwEventBuffer.h"
+
+// External objects
+extern const char* const gGitInfo;
+
+const TString QwReplayMemo::kManifestName = "manifest";
+const std::string QwReplayMemo::kManifestEnd = "#end";
+
+QwReplayMemo::QwReplayMemo(QwOptions& options)
+  : fEnabled(kFALSE), fForce(kFALSE), fLinkOutputs(kTRUE)
+{
+  ProcessOptions(options);
+}
+
+void QwReplayMemo::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Replay memoization")
+    ("memo-store", po::value<std::string>()->default_value(""),
+     "directory of the replay store (empty to disable memoization)");
+  options.AddOptions("Replay memoization")
+    ("memo-action", po::value<std::string>()->default_value("link"),
+     "action when the replay hash is in the store: link or skip");
+  options.AddOptions("Replay memoization")
+    ("memo-force", po::value<bool>()->default_bool_value(false),
+     "replay even if the replay hash is in the store");
+}
+
+void QwReplayMemo::ProcessOptions(QwOptions& options)
+{
+  fStoreDirectory = options.GetValue<std::string>("memo-store");
+  fEnabled = (fStoreDirectory.Length() > 0);
+  fForce = options.GetValue<bool>("memo-force");
+
+  TString action = options.GetValue<std::string>("memo-action");
+  if (action == "link") {
+    fLinkOutputs = kTRUE;
+  } else if (action == "skip") {
+    fLinkOutputs = kFALSE;
+  } else {
+    QwWarning << "QwReplayMemo: unknown memo-action " << action
+              << ", using link" << QwLog::endl;
+    fLinkOutputs = kTRUE;
+  }
+}
+
+/**
+ * Compute the MD5 digest of a file
+ * @param filename Name of the file
+ * @return Digest as hex string, or empty string if the file can't be read
+ */
+TString QwReplayMemo::FileDigest(const TString& filename)
+{
+  TString digest;
+  TMD5* md5 = TMD5::FileChecksum(filename);
+  if (md5) {
+    digest = md5->AsString();
+    delete md5;
+  } else {
+    QwWarning << "QwReplayMemo: unable to read " << filename << QwLog::endl;
+  }
+  return digest;
+}
+
+/**
+ * Compute the replay hash from the raw data files of the open stream, the
+ * parameter files opened so far, the command line and the code version.
+ * This should be called after all subsystems and data handlers have loaded
+ * their parameter files.
+ * @param eventbuffer Event buffer with the stream open
+ * @return Replay hash, or empty string if the stream is not file-based
+ */
+const TString& QwReplayMemo::ComputeHash(const QwEventBuffer& eventbuffer)
+{
+  fHash = "";
+  if (! fEnabled) return fHash;
+
+  std::vector<TString> datafiles = eventbuffer.GetDataFileList();
+  if (datafiles.empty()) {
+    QwWarning << "QwReplayMemo: no data files for this stream, "
+              << "replay will not be memoized" << QwLog::endl;
+    return fHash;
+  }
+
+  std::ostringstream description;
+
+  //  Raw data, in the order in which it is read
+  for (size_t i = 0; i < datafiles.size(); i++) {
+    TString digest = FileDigest(datafiles.at(i));
+    if (digest.Length() == 0) return fHash;
+    description << "data " << digest << "\n";
+  }
+
+  //  Parameter files, keyed by name and content but not by location,
+  //  sorted so that the search path order does not matter
+  std::set<std::string> paramfiles;
+  const std::set<std::string>& opened = QwParameterFile::GetOpenedFileList();
+  for (std::set<std::string>::const_iterator file = opened.begin();
+       file != opened.end(); file++) {
+    std::string line = gSystem->BaseName(file->c_str());
+    line += " ";
+    line += FileDigest(*file).Data();
+    paramfiles.insert(line);
+  }
+  for (std::set<std::string>::const_iterator line = paramfiles.begin();
+       line != paramfiles.end(); line++) {
+    description << "param " << *line << "\n";
+  }
+
+  //  Command line arguments, except for the memoization options
+  //  (their values are skipped when given as a separate argument)
+  int argc = gQwOptions.GetArgc();
+  char** argv = gQwOptions.GetArgv();
+  for (int i = 1; i < argc; i++) {
+    TString arg = argv[i];
+    if (arg.BeginsWith("--memo-")) {
+      if (! arg.Contains("=") && i + 1 < argc && argv[i+1][0] != '-') i++;
+      continue;
+    }
+    description << "arg " << arg << "\n";
+  }
+
+  //  Code version, without the lines that change with every build
+  std::istringstream gitinfo(gGitInfo);
+  std::string line;
+  while (std::getline(gitinfo, line)) {
+    if (line.compare(0, 12, "Generated at") == 0) continue;
+    if (line.compare(0, 10, "Source dir") == 0) continue;
+    if (line.compare(0, 10, "Build  dir") == 0) continue;
+    description << "code " << line << "\n";
+  }
+
+  std::string text = description.str();
+  TMD5 md5;
+  md5.Update((const UChar_t*) text.data(), text.size());
+  md5.Final();
+  fHash = md5.AsString();
+
+  QwMessage << "Replay hash: " << fHash << QwLog::endl;
+  return fHash;
+}
+
+/**
+ * Look up the replay hash in the store.  On a hit, the stored outputs are
+ * symlinked into the output directory unless the action is 'skip'.
+ * @param outputdir Directory where the output ROOT files are expected
+ * @return True if the replay can be skipped
+ */
+Bool_t QwReplayMemo::Recall(const TString& outputdir)
+{
+  if (fHash.Length() == 0) return kFALSE;
+
+  TString entry = GetEntryDirectory();
+  std::ifstream manifest((entry + "/" + kManifestName).Data());
+  if (! manifest.good()) return kFALSE;
+
+  //  The manifest ends with a line with the number of outputs; without
+  //  it, the manifest was truncated and the entry is a miss
+  std::vector<TString> outputs;
+  std::string name;
+  Bool_t complete = kFALSE;
+  while (manifest >> name) {
+    if (name == kManifestEnd) {
+      size_t count = 0;
+      complete = (manifest >> count) && count == outputs.size();
+      break;
+    }
+    if (gSystem->AccessPathName(entry + "/" + name)) {
+      QwWarning << "QwReplayMemo: store entry " << entry
+                << " is incomplete, missing " << name << QwLog::endl;
+      return kFALSE;
+    }
+    outputs.push_back(name);
+  }
+  if (! complete || outputs.empty()) {
+    QwWarning << "QwReplayMemo: store entry " << entry
+              << " has an empty or truncated manifest" << QwLog::endl;
+    return kFALSE;
+  }
+
+  if (fForce) {
+    QwMessage << "Replay hash found in store, but replay is forced" << QwLog::endl;
+    return kFALSE;
+  }
+
+  QwMessage << "Replay hash found in store: " << entry << QwLog::endl;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    TString stored = entry + "/" + outputs.at(i);
+    if (fLinkOutputs) {
+      TString target = outputdir + "/" + outputs.at(i);
+      if (! gSystem->AccessPathName(target)) gSystem->Unlink(target);
+      if (gSystem->Symlink(stored, target) != 0) {
+        QwWarning << "QwReplayMemo: could not link " << target
+                  << " to " << stored << QwLog::endl;
+      } else {
+        QwMessage << "Linked " << target << QwLog::endl;
+      }
+    } else {
+      QwMessage << "Output available as " << stored << QwLog::endl;
+    }
+  }
+  return kTRUE;
+}
+
+/**
+ * Register the output files of this replay in the store.  The files are
+ * hard linked when possible and copied otherwise; the manifest is written
+ * last, and ends with the number of outputs, so that incomplete entries are
+ * never recalled.
+ * @param outputs Output files of this replay
+ */
+void QwReplayMemo::Store(const std::vector<TString>& outputs)
+{
+  if (fHash.Length() == 0) return;
+
+  TString entry = GetEntryDirectory();
+  if (gSystem->AccessPathName(entry) && gSystem->mkdir(entry, kTRUE) != 0) {
+    QwWarning << "QwReplayMemo: could not create store entry " << entry
+              << QwLog::endl;
+    return;
+  }
+
+  std::vector<TString> names;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    if (gSystem->AccessPathName(outputs.at(i))) continue;
+    TString name = gSystem->BaseName(outputs.at(i));
+    TString stored = entry + "/" + name;
+    if (! gSystem->AccessPathName(stored)) gSystem->Unlink(stored);
+    if (gSystem->Link(outputs.at(i), stored) != 0
+     && gSystem->CopyFile(outputs.at(i), stored, kTRUE) != 0) {
+      QwWarning << "QwReplayMemo: could not store " << outputs.at(i)
+                << QwLog::endl;
+      return;
+    }
+    names.push_back(name);
+  }
+
+  if (names.empty()) {
+    QwWarning << "QwReplayMemo: no outputs to store for this replay"
+              << QwLog::endl;
+    return;
+  }
+
+  //  Write the manifest under a temporary name, and rename it when it is
+  //  complete, so that a crash never leaves a manifest which looks valid
+  TString manifestname = entry + "/" + kManifestName;
+  std::ofstream manifest((manifestname + ".tmp").Data());
+  for (size_t i = 0; i < names.size(); i++)
+    manifest << names.at(i) << std::endl;
+  manifest << kManifestEnd << " " << names.size() << std::endl;
+  manifest.close();
+  if (! manifest || gSystem->Rename(manifestname + ".tmp", manifestname) != 0) {
+    QwWarning << "QwReplayMemo: could not write the manifest of " << entry
+              << QwLog::endl;
+    return;
+  }
+
+  QwMessage << "Stored replay outputs in " << entry << QwLog::endl;
+}
@@ -1,6 +1,9 @@
 #include "QwRootFile.h"
 #include "QwRunCondition.h"
 #include "TH1.h"
+#ifdef __USE_ARROW__
+#include "QwArrowFile.h"
+#endif
 
 #include <unistd.h>
 #include <cstdio>
@@ -20,7 +23,7 @@ Double_t QwRootTree::kUnitsValue[] = { 1e-6, 1e-9, 1e-3, 1 , 1e-3, 1};
 QwRootFile::QwRootFile(const TString& run_label)
   : fRootFile(0), fMakePermanent(0),
     fMapFile(0), fEnableMapFile(kFALSE),
-    fUpdateInterval(-1)
+    fUpdateInterval(-1), fArrowBatchSize(10000)
 {
   // Process the configuration options
   ProcessOptions(gQwOptions);
@@ -102,6 +105,9 @@ QwRootFile::~QwRootFile()
   // Also respect any other requests to keep the file around.
   if (!fMakePermanent) fMakePermanent = HasAnyFilled();
 
+  // Close the Arrow files
+  CloseArrowFiles();
+
   // Close the map file
   if (fMapFile) {
     fMapFile->Close();
@@ -201,6 +207,19 @@ void QwRootFile::DefineOptions(QwOptions &options)
     ("disable-slow-tree", po::value<bool>()->default_bool_value(false),
      "disable slow control tree");
 
+  // Define the columnar export options
+  options.AddOptions("ROOT output options")
+    ("arrow-tree", po::value<std::vector<std::string>>()->composing(),
+     "also export trees matching this regex in Arrow IPC format\n(e.g. ^burst$, ^bursts$, ^evts$, ^muls$)");
+  options.AddOptions("ROOT output options")
+    ("arrow-batch-size", po::value<int>()->default_value(10000),
+     "number of tree entries per Arrow record batch");
+
+  // Define the burst alignment options
+  options.AddOptions("ROOT output options")
+    ("burst-aligned-tree", po::value<std::vector<std::string>>()->composing(),
+     "flush trees matching this regex at the end of each burst, and store the entry range of each burst in the tree user info\n(e.g. ^mul$, ^pr$)");
+
   // Define the tree output prescaling options
   options.AddOptions("ROOT output options")
     ("num-mps-accepted-events", po::value<int>()->default_value(0),
@@ -278,6 +297,34 @@ void QwRootFile::ProcessOptions(QwOptions &options)
   if (options.GetValue<bool>("disable-burst-tree"))  DisableTree("^burst$");
   if (options.GetValue<bool>("disable-slow-tree")) DisableTree("^slow$");
 
+  // Option 'arrow-tree' for the columnar export of trees
+  fArrowTrees.clear();
+  auto a = options.GetValueVector<std::string>("arrow-tree");
+  std::for_each(a.begin(), a.end(), [&](const std::string& s){ fArrowTrees.push_back(s); });
+  fArrowBatchSize = options.GetValue<int>("arrow-batch-size");
+#ifndef __USE_ARROW__
+  if (! fArrowTrees.empty()) {
+    QwWarning << "QwRootFile::ProcessOptions:  "
+              << "The 'arrow-tree' option requires a build with Apache Arrow. "
+                 "Disabling it."
+              << QwLog::endl;
+    fArrowTrees.clear();
+  }
+#endif
+
+  // Option 'burst-aligned-tree' for the burst clusters and index
+  fBurstAlignedTrees.clear();
+  auto b = options.GetValueVector<std::string>("burst-aligned-tree");
+  std::for_each(b.begin(), b.end(), [&](const std::string& s){ fBurstAlignedTrees.push_back(s); });
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,14,00)
+  if (! fBurstAlignedTrees.empty()) {
+    QwWarning << "QwRootFile::ProcessOptions:  "
+              << "ROOT version " << ROOT_RELEASE << " cannot end clusters at the "
+                 "burst boundaries; only the burst index is stored."
+              << QwLog::endl;
+  }
+#endif
+
   // Options 'num-accepted-events' and 'num-discarded-events' for
   // prescaling of the tree output
   fNumMpsEventsToSave = options.GetValue<int>("num-mps-accepted-events");
@@ -304,6 +351,44 @@ void QwRootFile::ProcessOptions(QwOptions &options)
   return;
 }
 
+/**
+ * Append the current entry of a tree to its Arrow file, which is created
+ * next to the ROOT file at the first entry, e.g. Qweak_1234.burst.arrow
+ * for the burst tree in Qweak_1234.root.
+ * @param name Name of the tree
+ */
+void QwRootFile::FillArrowFile(const std::string& name)
+{
+#ifdef __USE_ARROW__
+  std::map< const std::string, QwArrowFile* >::iterator iter = fArrowFileByName.find(name);
+  if (iter == fArrowFileByName.end()) {
+    // Only trees in a ROOT file on disk are exported
+    QwArrowFile* arrowfile = 0;
+    if (fRootFile && IsArrowTree(name)) {
+      TString filename = fPermanentName;
+      if (filename.EndsWith(".root")) filename.Remove(filename.Length() - 5);
+      filename += Form(".%s.arrow", name.c_str());
+      arrowfile = new QwArrowFile(filename, GetTree(name), fArrowBatchSize);
+    }
+    iter = fArrowFileByName.insert(std::make_pair(name, arrowfile)).first;
+  }
+  if (iter->second) iter->second->Fill();
+#endif
+}
+
+/**
+ * Write the last record batches and close all Arrow files
+ */
+void QwRootFile::CloseArrowFiles()
+{
+#ifdef __USE_ARROW__
+  std::map< const std::string, QwArrowFile* >::iterator iter;
+  for (iter = fArrowFileByName.begin(); iter != fArrowFileByName.end(); iter++)
+    delete iter->second;
+#endif
+  fArrowFileByName.clear();
+}
+
 /**
  * Determine whether the rootfile object has any non-empty trees or
  * histograms.
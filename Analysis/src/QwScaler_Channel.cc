@@ -658,6 +658,7 @@ Bool_t VQwScaler_Channel::ApplySingleEventCuts()
   Bool_t status;
   //QwError<<" Single Event Check ! "<<QwLog::endl;
   if (bEVENTCUTMODE>=2){//Global switch to ON/OFF event cuts set at the event cut file
+    UpdateAdaptiveEventCuts();
     //std::cout << "Upper : " << fULimit << " , Lower: " << fLLimit << std::endl;
     if (fULimit <  fLLimit){
       // std::cout << "First" << std::endl;
@@ -14,6 +14,8 @@
 #include "VQwHardwareChannel.h"
 #include "QwLog.h"
 #include "QwParameterFile.h"
+#include "QwNonlinearityCorrection.h"
+#include "QwAdaptiveEventCut.h"
 
 //*****************************************************************
 
@@ -281,6 +283,10 @@ void QwSubsystemArray::ProcessOptionsToplevel(QwOptions &options)
   // Subsystems to disable
   fSubsystemsDisabledByName = options.GetValueVector<std::string>("disable-by-name");
   fSubsystemsDisabledByType = options.GetValueVector<std::string>("disable-by-type");
+  // Nonlinearity correction tables for the channels
+  QwNonlinearityCorrection::ProcessOptions(options);
+  // Event cut limits from rolling statistics
+  QwAdaptiveEventCut::ProcessOptions(options);
 }
 
 
@@ -192,6 +192,8 @@ void QwVQWK_Channel::InitializeChannel(TString name, TString datatosave)
   // Event cuts
   fULimit=-1;
   fLLimit=1;
+  fFixedULimit=-1;
+  fFixedLLimit=1;
   fNumEvtsWithEventCutsRejected = 0;
 
   fErrorFlag=0;               //Initialize the error flag
@@ -385,6 +387,31 @@ void QwVQWK_Channel::SetEventData(Double_t* block, UInt_t sequencenumber)
   return;
 }
 
+// SetDerivedEventData() stores the result of a calculation on other
+// channels, as done in batch by QwBPMStriplineBatch and QwBPMCavityBatch.
+// The values, number of samples, good event count and error flag are those
+// the equivalent sequence of channel operations would give, so that running
+// sums accumulate and deaccumulate the same way; no raw data is kept.
+
+void QwVQWK_Channel::SetDerivedEventData(const Double_t* value, size_t nsamples, Int_t goodcount, UInt_t errorflag)
+{
+  fHardwareBlockSum = value[0];
+  fHardwareBlockSumM2 = 0.0; // second moment is zero for single events
+  fHardwareBlockSumError = 0.0;
+  for (Int_t i = 0; i < fBlocksPerEvent; i++) {
+    fBlock[i] = value[i+1];
+    fBlockM2[i] = 0.0; // second moment is zero for single events
+    fBlock_raw[i] = 0;
+  }
+  fHardwareBlockSum_raw = 0;
+  fSoftwareBlockSum_raw = 0;
+
+  fSequenceNumber = 0;
+  fNumberOfSamples = nsamples;
+  fGoodEventCount = goodcount;
+  fErrorFlag = errorflag;
+}
+
 void QwVQWK_Channel::SetRawEventData(){
   fNumberOfSamples = fNumberOfSamples_map;
   fHardwareBlockSum_raw = 0;
@@ -540,6 +567,12 @@ void QwVQWK_Channel::ProcessEvent()
     }
     fHardwareBlockSum = fCalibrationFactor * ( (1.0 * fHardwareBlockSum_raw / fNumberOfSamples) - fPedestal );
     fHardwareBlockSumM2 = 0.0; // second moment is zero for single events
+    //  Correct the calibrated values for nonlinear response
+    const QwNonlinearityCorrection* nonlinearity = GetNonlinearityCorrection();
+    if (nonlinearity) {
+      nonlinearity->Apply(fBlock, fBlocksPerEvent);
+      nonlinearity->Apply(&fHardwareBlockSum, 1);
+    }
   }
   return;
 }
@@ -1668,6 +1701,7 @@ Bool_t QwVQWK_Channel::ApplySingleEventCuts()//This will check the limits and up
   Bool_t status;
 
   if (bEVENTCUTMODE>=2){//Global switch to ON/OFF event cuts set at the event cut file
+    UpdateAdaptiveEventCuts();
 
     if (fULimit < fLLimit){
       status=kTRUE;
@@ -10,10 +10,14 @@
 
 VQwHardwareChannel::VQwHardwareChannel():
   fNumberOfDataWords(0),
-  fNumberOfSubElements(0), fDataToSave(kRaw)
+  fNumberOfSubElements(0), fDataToSave(kRaw),
+  fNonlinearity(0), fNonlinearityGeneration(0),
+  fAdaptiveCutGeneration(0)
 {
   fULimit = -1;
   fLLimit = 1;
+  fFixedULimit = -1;
+  fFixedLLimit = 1;
   fErrorFlag = 0;
   fErrorConfigFlag = 0;
   fBurpHoldoff = 10;
@@ -33,14 +37,20 @@ VQwHardwareChannel::VQwHardwareChannel(const VQwHardwareChannel& value)
    fCalibrationFactor(value.fCalibrationFactor),
    kFoundPedestal(value.kFoundPedestal),
    kFoundGain(value.kFoundGain),
+   fNonlinearity(value.fNonlinearity),
+   fNonlinearityGeneration(value.fNonlinearityGeneration),
    bEVENTCUTMODE(value.bEVENTCUTMODE),
    fULimit(value.fULimit),
    fLLimit(value.fLLimit),
+   fFixedULimit(value.fFixedULimit),
+   fFixedLLimit(value.fFixedLLimit),
    fStability(value.fStability),
    fBurpThreshold(value.fBurpThreshold),
    fBurpCountdown(value.fBurpCountdown),
-   fBurpHoldoff(value.fBurpHoldoff)
+   fBurpHoldoff(value.fBurpHoldoff),
+   fAdaptiveCutGeneration(0)
 {
+  // The window of adaptive cuts is not shared; the copy creates its own
 }
 
 VQwHardwareChannel::VQwHardwareChannel(const VQwHardwareChannel& value, VQwDataElement::EDataToSave datatosave)
@@ -54,14 +64,20 @@ VQwHardwareChannel::VQwHardwareChannel(const VQwHardwareChannel& value, VQwDataE
    fCalibrationFactor(value.fCalibrationFactor),
    kFoundPedestal(value.kFoundPedestal),
    kFoundGain(value.kFoundGain),
+   fNonlinearity(value.fNonlinearity),
+   fNonlinearityGeneration(value.fNonlinearityGeneration),
    bEVENTCUTMODE(value.bEVENTCUTMODE),
    fULimit(value.fULimit),
    fLLimit(value.fLLimit),
+   fFixedULimit(value.fFixedULimit),
+   fFixedLLimit(value.fFixedLLimit),
    fStability(value.fStability),
    fBurpThreshold(value.fBurpThreshold),
    fBurpCountdown(value.fBurpCountdown),
-   fBurpHoldoff(value.fBurpHoldoff)
+   fBurpHoldoff(value.fBurpHoldoff),
+   fAdaptiveCutGeneration(0)
 {
+  // The window of adaptive cuts is not shared; the copy creates its own
 }
 
 void VQwHardwareChannel::CopyFrom(const VQwHardwareChannel& value)
@@ -76,13 +92,19 @@ void VQwHardwareChannel::CopyFrom(const VQwHardwareChannel& value)
   fCalibrationFactor = value.fCalibrationFactor;
   kFoundPedestal = value.kFoundPedestal;
   kFoundGain = value.kFoundGain;
+  fNonlinearity = value.fNonlinearity;
+  fNonlinearityGeneration = value.fNonlinearityGeneration;
   bEVENTCUTMODE = value.bEVENTCUTMODE;
   fULimit = value.fULimit;
   fLLimit = value.fLLimit;
+  fFixedULimit = value.fFixedULimit;
+  fFixedLLimit = value.fFixedLLimit;
   fStability = value.fStability;
   fBurpThreshold = value.fBurpThreshold;
   fBurpCountdown = value.fBurpCountdown;
   fBurpHoldoff = value.fBurpHoldoff;
+  fAdaptiveCut.reset();
+  fAdaptiveCutGeneration = 0;
 }
 
 
@@ -96,6 +118,8 @@ void VQwHardwareChannel::SetSingleEventCuts(Double_t min, Double_t max)
 {
   fULimit=max;
   fLLimit=min;
+  fFixedULimit=max;
+  fFixedLLimit=min;
 }
 
 void VQwHardwareChannel::SetSingleEventCuts(UInt_t errorflag,Double_t min, Double_t max, Double_t stability, Double_t BurpLevel)
@@ -73,6 +73,7 @@ Int_t VQwSubsystem::LoadDetectorMaps(QwParameterFile& file)
 	}
 	// Event cut file definition
 	else if (key == "eventcut") {
+	  fEventCutsFile = value;
 	  LoadEventCuts(value);
 	  // fDetectorMapsNames.push_back(value);
 	}
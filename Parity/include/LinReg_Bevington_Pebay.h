@@ -50,6 +50,9 @@ class LinRegBevPeb {
   /// mean values
   TVectorD mMP, mMY, mMYp;
 
+  /// deviations from the mean values (work space, sized in init)
+  TVectorD fDeltaP, fDeltaY;
+
 
   /// slopes
   TMatrixD Axy, Ayx, dAxy, dAyx; // found slopes and their standard errors
@@ -91,6 +94,10 @@ class LinRegBevPeb {
   Int_t getCovariancePY(int ip, int iy, Double_t &covar) const;
   Int_t getCovarianceY (int i,  int j,  Double_t &covar) const;
 
+  /// Get slope of dependent on independent variable (after solve), returns error code
+  Int_t getSlope     (int ip, int iy, Double_t &slope) const;
+  Int_t getSlopeError(int ip, int iy, Double_t &dslope) const;
+
   double  getUsedEve() const { return fGoodEventNumber; };
 
   // Addition-assignment
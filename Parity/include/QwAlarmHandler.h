@@ -46,6 +46,11 @@ class QwAlarmHandler:public VQwDataHandler, public MQwDataHandlerCloneable<QwAla
     void UpdateAlarmFile();
     void ParseConfigFile(QwParameterFile&);
 
+    /// \brief Alarm limits can be read again, also for other channels
+    Bool_t CanReload() const { return kTRUE; };
+    Bool_t PrepareReload();
+    void ApplyReload();
+
 
   
   protected:
@@ -88,6 +93,7 @@ class QwAlarmHandler:public VQwDataHandler, public MQwDataHandlerCloneable<QwAla
     };
 
     std::vector<alarmObject> fAlarmObjectList; // Vector pointer of objects
+    std::vector<alarmObject> fReloadAlarmObjectList; // Objects read by PrepareReload
 
 }; // class QwAlarmHandler
 
@@ -0,0 +1,179 @@
+/*!
+ * \file   QwAnalysisPipeline.h
+ * \brief  Downstream analysis of decoded events: ring, patterns, handlers, output
+ */
+
+#ifndef __QwAnalysisPipeline__
+#define __QwAnalysisPipeline__
+
+// System headers
+#include <vector>
+
+// ROOT headers
+#include "TString.h"
+
+// Qweak headers
+#include "QwSubsystemArrayParity.h"
+#include "QwHelicityPattern.h"
+#include "QwEventRing.h"
+#include "QwDataHandlerArray.h"
+#include "QwBurstSegmentation.h"
+
+// Forward declarations
+class QwOptions;
+class QwRootFile;
+class QwEPICSEvent;
+class QwEPICSCarryForward;
+class QwCutScan;
+class QwTimeSeriesWriter;
+class QwHelicity;
+
+/**
+ *  \class QwAnalysisPipeline
+ *  \ingroup QwAnalysis
+ *  \brief Everything downstream of ProcessEvent for one analysis configuration
+ *
+ * A pipeline holds its own event ring, helicity pattern, data handler arrays,
+ * running sums and output ROOT files, all constructed from the options that
+ * are in effect when the pipeline is created.  The decoded and processed
+ * subsystem array is shared: qwparity creates one pipeline for the standard
+ * configuration, and one more for each --analysis-branch option overlay, so
+ * that several cut sets or handler configurations are analyzed from a single
+ * decoding pass.  Each pipeline produces the same output as a standalone
+ * replay with its options.
+ */
+class QwAnalysisPipeline {
+
+  public:
+
+    /// \brief Constructor from the processed detectors with the current options
+    QwAnalysisPipeline(QwOptions& options, QwSubsystemArrayParity& detectors,
+        const TString& run_label, const TString& name = "");
+    /// \brief Destructor
+    virtual ~QwAnalysisPipeline();
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+
+    /// Name of this pipeline (empty for the standard configuration)
+    const TString& GetName() const { return fName; };
+    /// Is this the pipeline of the standard configuration?
+    Bool_t IsPrimary() const { return fName.Length() == 0; };
+
+    /// \brief Open the output ROOT files and construct histograms and trees
+    void OpenRootFiles(QwSubsystemArrayParity& detectors, QwEPICSEvent& epicsevent);
+    /// Names of the output ROOT files
+    const std::vector<TString>& GetRootFileNames() const { return fRootFileNames; };
+    /// \brief Write the replay hash to all output ROOT files
+    void WriteReplayHash(const TString& hash);
+
+    /// \brief Process an EPICS event
+    void ProcessEPICSEvent(QwEPICSEvent& epicsevent);
+    /// \brief Process a physics event that passed the single event cuts
+    void ProcessEvent(QwSubsystemArrayParity& detectors);
+    /// \brief Record the unix time of the start of the run
+    void SetRunStartTime(Double_t start);
+    /// \brief Unwind the event ring and finish the last burst
+    void FinishEventLoop(Int_t run_number);
+    /// \brief Finish the run and close the output ROOT files
+    void FinishRun();
+
+    /// Is the helicity pattern empty, i.e. between two patterns?
+    Bool_t IsAtPatternBoundary() const { return ! fHelicityPattern->HasDataLoaded(); };
+    /// \brief Read the map files of the selected data handlers again
+    Bool_t PrepareReload(const std::vector<std::string>& targets,
+        std::vector<TString>& reloaded);
+    /// \brief Use the configuration read by PrepareReload from a pattern on, and record it
+    void ScheduleReload(QwSubsystemArrayParity& detectors, const TString& record,
+        Long_t first_pattern);
+    /// Is a reload scheduled which no pattern has reached yet?
+    Bool_t IsReloadPending() const { return fReloadPending; };
+
+    /// Number of good helicity patterns in this run
+    Long64_t GetGoodPatternCount() const { return fGoodPatternCount; };
+    /// \brief Prepare for the jump to the next block of a quick-look replay
+    void StartSampleBlock();
+    /// \brief Write the description of the sampling to all output ROOT files
+    void WriteSamplingRecord(const TString& record);
+
+    /// Access to the pipeline objects
+    QwHelicityPattern& GetHelicityPattern() { return *fHelicityPattern; };
+    QwSubsystemArrayParity& GetRingOutput() { return *fRingOutput; };
+    QwHelicityPattern& GetPatternSum() { return *fPatternSum; };
+    QwDataHandlerArray& GetPatternDataHandlers() { return *fDataHandlerArrayMul; };
+
+  private:
+
+    /// Private default constructor
+    QwAnalysisPipeline();
+    /// Private copy constructor, not implemented
+    QwAnalysisPipeline(const QwAnalysisPipeline&);
+    /// Private assignment operator, not implemented
+    QwAnalysisPipeline& operator=(const QwAnalysisPipeline&);
+
+    /// \brief Analyze the next event which leaves the event ring
+    void ProcessRingOutput();
+
+    /// \brief Finish the current burst
+    void FinishBurst(QwBurstSegmentation::EQwBurstEndReason reason);
+    /// \brief Start a new burst with the next pattern
+    void StartNewBurst();
+
+    /// \brief Use the configuration read by PrepareReload
+    void ApplyReload();
+
+    TString fName;
+    TString fRunLabel;
+
+    /// Output options, as in effect when the pipeline was created
+    Bool_t fSingleOutputFile;
+    Bool_t fPrintErrorCounters;
+    Bool_t fPrintRunningSum;
+    Bool_t fPrintPatternSum;
+    Bool_t fPrintBurstSum;
+
+    ///  Helicity pattern
+    QwHelicityPattern* fHelicityPattern;
+    ///  Event ring and the events which pass through it
+    QwEventRing* fEventRing;
+    QwSubsystemArrayParity* fRingOutput;
+
+    ///  Data handler arrays
+    QwDataHandlerArray* fDataHandlerArrayEvt;
+    QwDataHandlerArray* fDataHandlerArrayMul;
+    QwDataHandlerArray* fDataHandlerArrayBurst;
+
+    ///  Burst sum and running sums
+    QwHelicityPattern* fPatternSumPerBurst;
+    QwSubsystemArrayParity* fEventSum;
+    QwHelicityPattern* fPatternSum;
+    QwHelicityPattern* fBurstSum;
+
+    ///  EPICS values carried forward onto the pattern and burst trees
+    QwEPICSCarryForward* fEPICSCarryForward;
+    ///  Conditions which end bursts before their full length
+    QwBurstSegmentation* fBurstSegmentation;
+    ///  Scan of cut thresholds
+    QwCutScan* fCutScan;
+    ///  Multi-resolution time series of selected channels
+    QwTimeSeriesWriter* fTimeSeries;
+
+    ///  Output ROOT files
+    QwRootFile* fTreeRootFile;
+    QwRootFile* fBurstRootFile;
+    QwRootFile* fHistoRootFile;
+    std::vector<TString> fRootFileNames;
+
+    ///  Number of configuration reloads in this run
+    Int_t fReloadCount;
+    ///  Scheduled reload, and the first pattern which uses it
+    Bool_t fReloadPending;
+    Long_t fReloadPattern;
+    QwHelicity* fRingHelicity;
+    ///  Number of good helicity patterns in this run
+    Long64_t fGoodPatternCount;
+    ///  CODA event number of the last event pushed into the event ring
+    UInt_t fLastPushedEvent;
+};
+
+#endif // __QwAnalysisPipeline__
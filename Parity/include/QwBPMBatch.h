@@ -0,0 +1,124 @@
+/*!
+ * \file   QwBPMBatch.h
+ * \brief  Position calculation for all stripline or cavity BPMs in one pass
+ */
+
+#ifndef __QwBPMBatch__
+#define __QwBPMBatch__
+
+// System headers
+#include <vector>
+
+// Qweak headers
+#include "QwVQWK_Channel.h"
+#include "QwMollerADC_Channel.h"
+#include "QwBPMStripline.h"
+#include "QwBPMCavity.h"
+
+/**
+ *  \class QwBPMStriplineBatch
+ *  \ingroup QwAnalysis_BL
+ *  \brief Stripline BPM positions for many BPMs in structure-of-arrays form
+ *
+ * The wire values (hardware sum and blocks) of all BPMs in the batch are
+ * gathered into one array per wire, the relative and absolute positions,
+ * effective charge and ellipticity are calculated in flat loops over these
+ * arrays, and the results are stored in the derived channels of each BPM.
+ * The arithmetic follows the channel operations of
+ * QwBPMStripline<T>::ProcessEvent, including the treatment of zero
+ * denominators, the number of samples, the good event counts and the error
+ * flags, so the outputs and running sums are the same.  The batched
+ * calculation is enabled with the beamline.batched-bpm option.  The calibration constants are copied when a BPM is added.
+ */
+template<typename T>
+class QwBPMStriplineBatch {
+
+  public:
+
+    QwBPMStriplineBatch() { };
+    virtual ~QwBPMStriplineBatch() { };
+
+    /// \brief Remove all BPMs from the batch
+    void Clear();
+    /// \brief Add a BPM to the batch
+    void Add(QwBPMStripline<T>* bpm);
+    /// Number of BPMs in the batch
+    size_t size() const { return fBPM.size(); };
+
+    /// \brief Process the event for all BPMs in the batch
+    void ProcessEvent();
+
+  private:
+
+    /// Hardware sum and four blocks
+    static const size_t kNumValues = 5;
+
+    std::vector<QwBPMStripline<T>*> fBPM;
+
+    /// Calibration constants, repeated for every value of a BPM
+    std::vector<Double_t> fRelativeGain[2];
+    std::vector<Double_t> fCalibration;
+    std::vector<Double_t> fCosRotation;
+    std::vector<Double_t> fSinRotation;
+    std::vector<Double_t> fPositionCenter[2];
+    std::vector<Double_t> fInverseGain[2];
+
+    /// Event values, indexed by bpm * kNumValues + value
+    std::vector<Double_t> fWire[4];
+    std::vector<Double_t> fRawPos[2];
+    std::vector<Double_t> fRelPos[2];
+    std::vector<Double_t> fAbsPos[2];
+    std::vector<Double_t> fEffectiveCharge;
+    std::vector<Double_t> fEllipticity;
+
+    /// Number of samples and error flag of all wires, indexed by bpm
+    std::vector<size_t> fNumberOfSamples;
+    std::vector<UInt_t> fErrorFlag;
+};
+
+
+/**
+ *  \class QwBPMCavityBatch
+ *  \ingroup QwAnalysis_BL
+ *  \brief Cavity BPM positions for many BPMs in structure-of-arrays form
+ *
+ * As QwBPMStriplineBatch, for the QwBPMCavity::ProcessEvent calculation.
+ */
+class QwBPMCavityBatch {
+
+  public:
+
+    QwBPMCavityBatch() { };
+    virtual ~QwBPMCavityBatch() { };
+
+    /// \brief Remove all BPMs from the batch
+    void Clear();
+    /// \brief Add a BPM to the batch
+    void Add(QwBPMCavity* bpm);
+    /// Number of BPMs in the batch
+    size_t size() const { return fBPM.size(); };
+
+    /// \brief Process the event for all BPMs in the batch
+    void ProcessEvent();
+
+  private:
+
+    /// Hardware sum and four blocks
+    static const size_t kNumValues = 5;
+
+    std::vector<QwBPMCavity*> fBPM;
+
+    /// Calibration constants, repeated for every value of a BPM
+    std::vector<Double_t> fPositionCenter[2];
+
+    /// Event values, indexed by bpm * kNumValues + value
+    std::vector<Double_t> fElement[QwBPMCavity::kNumElements];
+    std::vector<Double_t> fRelPos[2];
+    std::vector<Double_t> fAbsPos[2];
+
+    /// Number of samples of the charge element and error flags, indexed by bpm
+    std::vector<size_t> fNumberOfSamples;
+    std::vector<UInt_t> fErrorFlag[2];
+};
+
+#endif // __QwBPMBatch__
@@ -33,6 +33,7 @@ class QwErrDBInterface;
 class QwBPMCavity : public VQwBPM {
   template <typename TT> friend class QwCombinedBPM;
   friend class QwEnergyCalculator;
+  friend class QwBPMCavityBatch;
 
  public:
   enum ECavElements{kXElem=0, kYElem, kQElem, kNumElements};
@@ -85,6 +86,7 @@ class QwBPMCavity : public VQwBPM {
   const VQwHardwareChannel* GetEffectiveCharge() const {return &fElement[kQElem];}
 
   TString GetSubElementName(Int_t subindex);
+  const VQwHardwareChannel* GetSubElement(Int_t subindex) const {return &fElement.at(subindex);}
   void    GetAbsolutePosition();
 
   Bool_t  ApplyHWChecks();//Check for harware errors in the devices
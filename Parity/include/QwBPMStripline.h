@@ -35,6 +35,7 @@ class QwPromptSummary;
 template<typename T>
 class QwBPMStripline : public VQwBPM {
   template <typename TT> friend class QwCombinedBPM;
+  template <typename TT> friend class QwBPMStriplineBatch;
   friend class QwEnergyCalculator;
 
  public:
@@ -108,6 +109,7 @@ class QwBPMStripline : public VQwBPM {
   const VQwHardwareChannel* GetEllipticity() const {return &fEllipticity;}
 
   TString GetSubElementName(Int_t subindex);
+  const VQwHardwareChannel* GetSubElement(Int_t subindex) const {return &fWire.at(subindex);}
   void    GetAbsolutePosition();
 
   Bool_t  ApplyHWChecks();//Check for harware errors in the devices
@@ -212,6 +214,23 @@ private:
   std::vector<T> fBPMElementList;
   void    MakeBPMList();
 
+  /// Work channels of ProcessEvent and FillRawEventData, per instance so
+  /// that they are not shared by concurrent analyses
+  struct WorkChannels {
+    WorkChannels()
+    : numer("numerator","derived"), denom("denominator","derived"),
+      tmp1("tmp1","derived"), tmp2("tmp2","derived"),
+      tmp3("tmp3","derived"), tmp4("tmp4","derived"), tmp5("tmp5","derived")
+    {
+      rawpos[0].InitializeChannel("rawpos_0","derived");
+      rawpos[1].InitializeChannel("rawpos_1","derived");
+    }
+    T numer, denom;
+    T tmp1, tmp2, tmp3, tmp4, tmp5;
+    T rawpos[2];
+  };
+  WorkChannels fWork;
+
 
 
 
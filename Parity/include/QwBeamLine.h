@@ -30,6 +30,7 @@
 #include "QwLinearDiodeArray.h"
 #include "VQwClock.h"
 #include "QwBeamDetectorID.h"
+#include "QwBPMBatch.h"
 
 
 /*****************************************************************
@@ -44,7 +45,9 @@ class QwBeamLine : public VQwSubsystemParity, public MQwSubsystemCloneable<QwBea
  public:
   /// Constructor with name
   QwBeamLine(const TString& name)
-  : VQwSubsystem(name),VQwSubsystemParity(name)
+  : VQwSubsystem(name),VQwSubsystemParity(name),
+    fBatchedBPM(kFALSE),fBPMBatchReady(kFALSE),
+    fQwBeamLineErrorCount(0)
   { };
   /// Copy constructor
   QwBeamLine(const QwBeamLine& source)
@@ -54,7 +57,9 @@ class QwBeamLine : public VQwSubsystemParity, public MQwSubsystemCloneable<QwBea
     fCavity(source.fCavity),
     fHaloMonitor(source.fHaloMonitor),
     fECalculator(source.fECalculator),
-    fBeamDetectorID(source.fBeamDetectorID)
+    fBeamDetectorID(source.fBeamDetectorID),
+    fBatchedBPM(source.fBatchedBPM),fBPMBatchReady(kFALSE),
+    fQwBeamLineErrorCount(0)
   { this->CopyTemplatedDataElements(&source); }
   /// Virtual destructor
   virtual ~QwBeamLine() { };
@@ -63,12 +68,14 @@ class QwBeamLine : public VQwSubsystemParity, public MQwSubsystemCloneable<QwBea
 
   /* derived from VQwSubsystem */
   
+  static void DefineOptions(QwOptions &options);
   void   ProcessOptions(QwOptions &options);//Handle command line options
   Int_t  LoadChannelMap(TString mapfile);
   Int_t  LoadInputParameters(TString pedestalfile);
   void LoadEventCuts_Init() {};
   void LoadEventCuts_Line(QwParameterFile &mapstr, TString &varvalue, Int_t &eventcut_flag);
   void LoadEventCuts_Fin(Int_t &eventcut_flag);
+  Bool_t HasEventCutDevice(TString device_type, TString device_name);
   Int_t  LoadGeometryDefinition(TString mapfile);
   Int_t  LoadMockDataParameters(TString mapfile);
   void   AssignGeometry(QwParameterFile* mapstr, VQwBPM * bpm);
@@ -80,6 +87,7 @@ class QwBeamLine : public VQwSubsystemParity, public MQwSubsystemCloneable<QwBea
 
   void   PrintErrorCounters() const;// report number of events failed due to HW and event cut faliures
   UInt_t GetEventcutErrorFlag();//return the error flag
+  Int_t  GetNumberOfFailedEvents() const { return fQwBeamLineErrorCount; };//events failed in ApplySingleEventCuts
 
   UInt_t UpdateErrorFlag();//Update and return the error flags
 
@@ -192,6 +200,18 @@ protected:
   std::vector <QwEnergyCalculator> fECalculator;
   std::vector <QwBeamDetectorID> fBeamDetectorID;
 
+  ///  BPM positions calculated in batch over all BPMs of a type
+  Bool_t fBatchedBPM;
+  Bool_t fBPMBatchReady;
+  QwBPMStriplineBatch<QwVQWK_Channel> fStriplineBatchVQWK;
+  QwBPMStriplineBatch<QwMollerADC_Channel> fStriplineBatchMollerADC;
+  QwBPMCavityBatch fCavityBatch;
+  ///  Stripline BPMs with channel types that are not batched
+  std::vector <VQwBPM*> fStriplineUnbatched;
+
+  ///  \brief Sort the BPMs into the batches
+  void BuildBPMBatches();
+
   
 
 /////
@@ -132,6 +132,7 @@ class QwBeamMod: public VQwSubsystemParity, public MQwSubsystemCloneable<QwBeamM
   void LoadEventCuts_Init();
   void LoadEventCuts_Line(QwParameterFile &mapstr, TString &varvalue, Int_t &eventcut_flag);
   void LoadEventCuts_Fin(Int_t &eventcut_flag);
+  Bool_t HasEventCutDevice(TString device_type, TString device_name);
   Int_t LoadGeometry(TString mapfile);
   Int_t LoadInputParameters(TString pedestalfile);
 
@@ -21,6 +21,7 @@
 
 // Qweak headers
 #include "QwSubsystemArrayParity.h"
+#include "QwVQWK_Channel.h"
 #include "QwEPICSEvent.h"
 #include "QwTypes.h"
 
@@ -254,6 +255,8 @@ class QwBlinder {
 
     Double_t fBeamCurrentThreshold;
     Bool_t fBeamIsPresent;
+    /// Beam current on target, requested from the detectors in Update
+    QwVQWK_Channel fTargetCharge;
 
     EQwBlinderStatus CheckBlindability(std::vector<Int_t> &fCounters);
     Bool_t fBlinderIsOkay;
@@ -0,0 +1,122 @@
+/********************************************************************
+File Name: QwBurstResampler.h
+
+Description:  This is the header file of the QwBurstResampler class,
+              which is a child of the VQwDataHandler class.  It
+              estimates the uncertainties of the run-level means and
+              regression slopes by jackknife and bootstrap resampling
+              of bursts (or sub-bursts) of patterns.
+
+********************************************************************/
+
+#ifndef QWBURSTRESAMPLER_H_
+#define QWBURSTRESAMPLER_H_
+
+// Parent Class
+#include "VQwDataHandler.h"
+
+// LinRegBlue Correlator Class
+#include "LinReg_Bevington_Pebay.h"
+
+// Forward declarations
+class TTree;
+class QwRootFile;
+
+/**
+ *  \class QwBurstResampler
+ *  \brief Jackknife and bootstrap uncertainties from burst sub-sums
+ *
+ * The patterns of the run are divided into blocks: each burst, or with
+ * 'block-size = N' sub-bursts of N good patterns.  For every block the
+ * means and covariances of the dependent and independent variables are
+ * accumulated in a LinRegBevPeb object.  At the end of the run the blocks
+ * are combined with the parallel update formulas, without revisiting the
+ * patterns, to obtain
+ *  - the delete-one-block jackknife uncertainty, and
+ *  - the Poisson bootstrap uncertainty ('replicates' resamplings in which
+ *    every block enters with a Poisson(1) distributed multiplicity)
+ * of the mean of each dependent variable and of each regression slope.
+ * These are written together with the value and the uncertainty which
+ * assumes independent patterns, so that their ratio tests that assumption.
+ *
+ * The map file has the same format as for QwCorrelator ('dv' and 'iv'
+ * lines).  Without independent variables only the means are resampled.
+ */
+class QwBurstResampler : public VQwDataHandler, public MQwDataHandlerCloneable<QwBurstResampler>
+{
+ public:
+  /// \brief Constructor with name
+  QwBurstResampler(const TString& name);
+  QwBurstResampler(const QwBurstResampler& source);
+  virtual ~QwBurstResampler();
+
+  void ParseConfigFile(QwParameterFile& file);
+
+  Int_t LoadChannelMap(const std::string& mapfile);
+
+  /// \brief Connect to Channels (asymmetry/difference only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArrayParity& diff);
+
+  void ProcessData();
+  void UpdateBurstCounter(Short_t burstcounter);
+  void FinishDataHandler(){
+    CalcUncertainties();
+  }
+  void CalcUncertainties();
+
+  /// \brief Construct the tree branches
+  void ConstructTreeBranches(
+      QwRootFile *treerootfile,
+      const std::string& treeprefix = "",
+      const std::string& branchprefix = "");
+  /// \brief Fill the tree branches
+  void FillTreeBranches(QwRootFile *treerootfile) { };
+
+  void ClearEventData();
+
+ private:
+
+  /// Start a new block with the next good pattern
+  void StartNewBlock() { fStartNewBlock = kTRUE; };
+  /// Delete all blocks
+  void DeleteBlocks();
+  /// Initialize an empty accumulator with the dimensions of this handler
+  void InitBlock(LinRegBevPeb& block) const;
+  /// Estimates (means, then slopes) from combined blocks; false if not possible
+  Bool_t Estimate(LinRegBevPeb& lrb, std::vector<Double_t>& theta) const;
+
+  // Default constructor
+  QwBurstResampler();
+
+  std::vector< std::string > fIndependentFull;
+  std::vector< EQwHandleType > fIndependentType;
+  std::vector< std::string > fIndependentName;
+
+  std::vector< const VQwHardwareChannel* > fIndependentVar;
+  std::vector< Double_t > fIndependentValues;
+
+  Int_t fBlock;          ///< Channel block (-1 for the hardware sum)
+  Int_t fBlockSize;      ///< Good patterns per block (0 for whole bursts)
+  Int_t fReplicates;     ///< Number of bootstrap replicates
+  UInt_t fSeed;          ///< Seed of the bootstrap random numbers
+
+  int nP, nY;
+
+  /// Accumulators for each block
+  std::vector<LinRegBevPeb*> fBlocks;
+  Bool_t fStartNewBlock;
+
+  int fTotalCount;
+  int fGoodCount;
+
+  /// Names of the resampled quantities, and for each the value, the
+  /// uncertainty for independent patterns, the jackknife and the
+  /// bootstrap uncertainty
+  std::vector<TString> fQuantityName;
+  std::vector<Double_t> fResults;
+  Double_t fNumberOfBlocks;
+
+  TTree* fTree;
+};
+
+#endif // QWBURSTRESAMPLER_H_
@@ -0,0 +1,159 @@
+/*!
+ * \file   QwBurstSegmentation.h
+ * \brief  Conditions which close a burst before its full length
+ */
+
+#ifndef __QwBurstSegmentation__
+#define __QwBurstSegmentation__
+
+// System headers
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class TTree;
+class QwOptions;
+class QwEPICSEvent;
+class QwSubsystemArrayParity;
+class VQwHardwareChannel;
+
+/**
+ *  \class QwBurstSegmentation
+ *  \ingroup QwAnalysis
+ *  \brief Conditions which close a burst before its full length
+ *
+ * Bursts end after 'burstlength' good patterns.  This class watches the
+ * events that come out of the event ring and the EPICS events, and
+ * requests an earlier end of the burst when
+ *  - a beam trip of at least --burst-break-trip events occurred (events
+ *    flagged with a beam trip or BCM cut, or dropped by the event cuts),
+ *  - beam modulation was active for at least --burst-break-bmod events,
+ *  - one of the --burst-break-channel channels changed its value, or
+ *  - one of the --burst-break-epics tags changed its value (e.g. the
+ *    insertable half-wave plate or the Wien angles).
+ * The burst is closed before the next good pattern, so that the pattern
+ * after the condition starts the new burst.  EPICS events are decoded
+ * ahead of the events in the event ring, so their values are queued with
+ * the number of the last event decoded before them, and compared only when
+ * a later event comes out of the ring.  All conditions are disabled
+ * by default.  Bursts also end at each jump between the sampled blocks of
+ * a quick-look replay (see QwQuickLookSampler).
+ *
+ * The reason for the end of each burst is written as 'burst_end_reason'
+ * on the burst tree, with the values of EQwBurstEndReason.
+ */
+class QwBurstSegmentation {
+
+  public:
+
+    /// Reasons for the end of a burst
+    enum EQwBurstEndReason {
+      kBurstEndOfRun = 0,   ///< last burst of the run
+      kBurstLength,         ///< burst reached 'burstlength' good patterns
+      kBurstBeamTrip,       ///< beam trip or event cut holdoff
+      kBurstModulation,     ///< beam modulation cycle
+      kBurstChannelChange,  ///< value of a watched channel changed
+      kBurstEPICSChange,    ///< value of a watched EPICS tag changed
+      kBurstSampleBlock     ///< jump to the next block of a quick-look replay
+    };
+
+    /// \brief Constructor with options
+    QwBurstSegmentation(QwOptions& options);
+    /// \brief Destructor
+    virtual ~QwBurstSegmentation() { };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options
+    void ProcessOptions(QwOptions& options);
+
+    /// \brief Look up the watched channels and EPICS tags
+    void ConnectChannels(const QwSubsystemArrayParity& detectors, const QwEPICSEvent& epicsevent);
+
+    /// \brief Check the conditions on an event out of the event ring
+    void ProcessEvent(const QwSubsystemArrayParity& event);
+    /// \brief Queue the watched tags of an EPICS event
+    void ProcessEPICSEvent(const QwEPICSEvent& epicsevent, UInt_t event_number);
+
+    /// Should the burst be closed before the next good pattern?  (No break
+    /// is pending when the reason is kBurstEndOfRun.)
+    Bool_t IsBreakPending() const { return fPendingReason != kBurstEndOfRun; };
+    /// Reason for the pending break
+    EQwBurstEndReason GetPendingReason() const { return fPendingReason; };
+    /// Drop the pending break (e.g. when the burst is still empty)
+    void ClearPendingBreak() { fPendingReason = kBurstEndOfRun; };
+
+    /// \brief Break the burst at a jump between sampled blocks
+    void StartSampleBlock();
+
+    /// \brief Record the end of a burst for the burst tree
+    void EndBurst(EQwBurstEndReason reason);
+    /// \brief Print the number of bursts ended by each reason
+    void PrintSummary() const;
+
+    /// \brief Construct the branch and tree vector
+    void ConstructBranchAndVector(TTree *tree, TString& prefix, std::vector<Double_t>& values);
+    /// \brief Fill the tree vector
+    void FillTreeVector(std::vector<Double_t>& values) const;
+
+  private:
+
+    /// Private default constructor
+    QwBurstSegmentation();
+
+    /// Request a break, keeping the first reason
+    void RequestBreak(EQwBurstEndReason reason) {
+      if (fPendingReason == kBurstEndOfRun) fPendingReason = reason;
+    };
+
+    /// \brief Check the queued EPICS values decoded before an event
+    void ProcessEPICSUpdates(UInt_t event_number);
+
+    /// Events in a beam trip and with beam modulation before a break
+    Int_t fTripEvents;
+    Int_t fModulationEvents;
+    /// Current number of consecutive tripped and modulated events
+    Int_t fTripCount;
+    Int_t fModulationCount;
+    /// Last event number, to count events dropped by the event cuts
+    UInt_t fLastEventNumber;
+
+    /// Watched channels and their last values
+    std::vector<std::string> fChannelNames;
+    std::vector<const VQwHardwareChannel*> fChannels;
+    std::vector<Double_t> fChannelValues;
+    std::vector<Bool_t> fChannelIsSet;
+
+    /// Watched EPICS tags, their index in the EPICS event and their last values
+    std::vector<std::string> fTags;
+    std::vector<Int_t> fTagIndex;
+    std::vector<Double_t> fTagValues;
+    std::vector<Bool_t> fTagIsSet;
+
+    /// Values of the watched tags in an EPICS event, with the number of the
+    /// last event decoded before it
+    struct PendingEPICSValues {
+      UInt_t fEventNumber;
+      std::vector<Double_t> fValue;
+      std::vector<Bool_t> fFilled;
+    };
+    /// EPICS events which were decoded ahead of the event ring output
+    std::deque<PendingEPICSValues> fPendingEPICS;
+
+    /// Pending break and the reason for the end of the last burst
+    EQwBurstEndReason fPendingReason;
+    EQwBurstEndReason fLastReason;
+    /// Number of bursts ended by each reason
+    std::map<EQwBurstEndReason, Int_t> fReasonCount;
+
+    /// Position in the branch vector of each tree
+    std::map<const std::vector<Double_t>*, size_t> fTreeArrayIndex;
+};
+
+#endif // __QwBurstSegmentation__
@@ -0,0 +1,119 @@
+/********************************************************************
+File Name: QwCalibrator.h
+
+Description:  This is the header file of the QwCalibrator class,
+              which is a child of the VQwDataHandler class.  It
+              extracts pedestals and gains of integrating channels
+              from a beam current scan during replay, by linear
+              regression of the raw channel value against a
+              reference BCM, and writes them as a pedestal map file.
+
+********************************************************************/
+
+#ifndef QWCALIBRATOR_H_
+#define QWCALIBRATOR_H_
+
+// Parent Class
+#include "VQwDataHandler.h"
+
+// Forward declarations
+class TTree;
+class QwRootFile;
+
+class QwCalibrator : public VQwDataHandler, public MQwDataHandlerCloneable<QwCalibrator>
+{
+ public:
+  /// \brief Constructor with name
+  QwCalibrator(const TString& name);
+  QwCalibrator(const QwCalibrator& source);
+  virtual ~QwCalibrator() { };
+
+  void ParseConfigFile(QwParameterFile& file);
+
+  Int_t LoadChannelMap(const std::string& mapfile);
+
+  /// \brief Connect to the channels (MPS only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& event);
+
+  void ProcessData();
+  void FinishDataHandler(){
+    CalcCalibrations();
+  }
+  void CalcCalibrations();
+
+  /// \brief Construct the tree branches
+  void ConstructTreeBranches(
+      QwRootFile *treerootfile,
+      const std::string& treeprefix = "",
+      const std::string& branchprefix = "");
+  /// \brief Fill the tree branches (once, at the end of the run)
+  void FillTreeBranches(QwRootFile *treerootfile) { };
+
+  void ClearEventData();
+
+ protected:
+
+  /// \brief Connect to Channels (asymmetry/difference not supported)
+  Int_t ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArrayParity& diff);
+
+  /// Running moments of one channel against the reference
+  class Moments {
+   public:
+    Moments() { Clear(); }
+    void Clear() { fN = 0; fMeanX = fMeanY = fCxx = fCxy = fCyy = 0.0; }
+    void Add(Double_t x, Double_t y) {
+      fN++;
+      Double_t dx = x - fMeanX;
+      Double_t dy = y - fMeanY;
+      fMeanX += dx / fN;
+      fMeanY += dy / fN;
+      fCxx += dx * (x - fMeanX);
+      fCxy += dx * (y - fMeanY);
+      fCyy += dy * (y - fMeanY);
+    }
+    UInt_t fN;
+    Double_t fMeanX, fMeanY;
+    Double_t fCxx, fCxy, fCyy;
+  };
+
+  /// Fit result of one channel: y = fPedestal + fSlope * x
+  struct FitResult {
+    Double_t fPedestal, fPedestalError;
+    Double_t fSlope, fSlopeError;
+    Double_t fCalibration, fCalibrationError;
+    Double_t fEntries;
+  };
+
+  void WriteMapFile();
+
+  /// Reference channel (calibrated beam current)
+  std::string fReferenceFull;
+  std::string fReferenceName;
+  const VQwHardwareChannel* fReferenceVar;
+  /// Lower limit on the reference value for events used in the fit
+  Double_t fReferenceMinimum;
+
+  /// Whether the gain (calibration factor) of each channel is fitted
+  std::vector< Bool_t > fFitGain;
+
+  std::vector< Moments > fMoments;
+  std::vector< FitResult > fResults;
+
+  std::string fOutputFileBase;
+  std::string fOutputFileSuff;
+  std::string fOutputPath;
+
+  TTree* fTree;
+
+  Int_t fTotalCount;
+  Int_t fGoodCount;
+
+ private:
+
+  // Default constructor
+  QwCalibrator();
+
+};
+
+
+#endif //QWCALIBRATOR_H_
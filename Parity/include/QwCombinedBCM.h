@@ -120,6 +120,14 @@ class QwCombinedBCM : public QwBCM<T> {
   Double_t fTripRamp;
   Double_t fProbabilityOfTrip;
 
+  /// Work channel of ProcessEvent, per instance so that it is not shared
+  /// by concurrent analyses
+  struct WorkChannels {
+    WorkChannels(): tmpADC("tmp","derived") { }
+    T tmpADC;
+  };
+  WorkChannels fWork;
+
  protected:
   /// \name Parity mock data generation
   // @{
@@ -184,7 +184,7 @@ class QwCombinedBPM : public VQwBPM {
   /* Functions for least square fit */
   void     CalculateFixedParameter(std::vector<Double_t> fWeights, Int_t pos);
   Double_t SumOver( std::vector <Double_t> weight , std::vector <T> val);
-  void     LeastSquareFit(VQwBPM::EBeamPositionMonitorAxis axis, std::vector<Double_t> fWeights) ; //bbbbb
+  void     LeastSquareFit(VQwBPM::EBeamPositionMonitorAxis axis, const std::vector<Double_t>& fWeights) ; //bbbbb
 
 
 
@@ -224,6 +224,24 @@ private:
   void    MakeBPMComboList();
   std::vector<T> fBPMComboElementList;
 
+  /// Work channels of ProcessEvent, LeastSquareFit and RandomizeEventData,
+  /// per instance so that they are not shared by concurrent analyses
+  struct WorkChannels {
+    WorkChannels()
+    : tmpQADC("tmpQADC"),
+      tmp1("tmp1","derived"), tmp2("tmp2","derived"), tmp3("tmp3","derived")
+    {
+      C[kXAxis].InitializeChannel("cx","derived");
+      C[kYAxis].InitializeChannel("cy","derived");
+      E[kXAxis].InitializeChannel("ex","derived");
+      E[kYAxis].InitializeChannel("ey","derived");
+    }
+    T tmpQADC;
+    T tmp1, tmp2, tmp3;
+    T C[kNumAxes], E[kNumAxes];
+  };
+  WorkChannels fWork;
+
 };
 
 
@@ -143,6 +143,14 @@ class QwCombinedPMT : public VQwDataElement {
   QwIntegrationPMT  fSumADC;
   //QwIntegrationPMT  fAvgADC;
 
+  /// Work channel of CalculateSumAndAverage, per instance so that it is
+  /// not shared by concurrent analyses
+  struct WorkChannels {
+    WorkChannels(): tmpADC("tmpADC") { }
+    QwIntegrationPMT tmpADC;
+  };
+  WorkChannels fWork;
+
   Int_t fDevice_flag; /// sets the event cut level for the device
                       /// fDevice_flag=1 Event cuts & HW check,
                       /// fDevice_flag=0 HW check, fDevice_flag=-1 no check
@@ -38,6 +38,11 @@ class QwCombiner:public VQwDataHandler, public MQwDataHandlerCloneable<QwCombine
 			  QwSubsystemArrayParity& diff);
 
     void ProcessData();
+
+    /// \brief Sensitivities and mask can be read again for the same channels
+    Bool_t CanReload() const { return kTRUE; };
+    Bool_t PrepareReload();
+    void ApplyReload();
   
   protected:
   
@@ -54,6 +59,10 @@ class QwCombiner:public VQwDataHandler, public MQwDataHandlerCloneable<QwCombine
     std::vector< std::vector< const VQwHardwareChannel* > > fIndependentVar;
     std::vector< std::vector< Double_t > > fSensitivity;
 
+    /// Error flag mask and sensitivities read by PrepareReload
+    UInt_t fReloadErrorFlagMask;
+    std::vector< std::vector< Double_t > > fReloadSensitivity;
+
 
 }; // class QwCombiner
 
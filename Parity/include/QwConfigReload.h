@@ -0,0 +1,97 @@
+/*!
+ * \file   QwConfigReload.h
+ * \brief  Reload of event cuts and data handler maps while running
+ */
+
+#ifndef __QwConfigReload__
+#define __QwConfigReload__
+
+// System headers
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class QwOptions;
+class QwSubsystemArrayParity;
+class QwAnalysisPipeline;
+
+/**
+ *  \class QwConfigReload
+ *  \ingroup QwAnalysis
+ *  \brief Reload of event cuts and data handler maps while running
+ *
+ * With --config-reload, qwparity reads a part of its configuration again
+ * when it receives SIGHUP (kill -HUP <pid>), without restarting: the event
+ * ring, the running sums and the burst state are kept.  The targets of the
+ * reload are given by --reload-target:
+ *  - 'eventcuts' for the event cut files of all subsystems,
+ *  - 'handlers' for all data handlers which support a reload (the combiner
+ *    sensitivities and mask, and the alarm handler limits), or
+ *  - the name of a single data handler.
+ *
+ * The new files are read and checked against the channels in use before
+ * anything changes: event cuts may only refer to existing devices, the
+ * combiner map must have the same variables, and the alarms must refer to
+ * existing channels.  If any check fails, the reload is rejected as a whole
+ * and the previous configuration stays in effect.  Otherwise, all targets
+ * change together from the next helicity pattern on: the event cuts change
+ * after the last event of a pattern has been cut, and the data handlers of
+ * each pipeline change when the first event of the next pattern leaves the
+ * event ring.  The events which are still in the ring were cut with the old
+ * event cuts, and their patterns are finished with the old configuration,
+ * so that no pattern mixes the two.  If no pattern boundary is reached in
+ * --reload-max-delay events (e.g. without helicity information), everything
+ * changes at once, and the patterns around the reload may mix both.
+ *
+ * Each reload is recorded in the tree file as a string object
+ * 'config_reload_<n>' with the first pattern and the reloaded files, and
+ * the contents of the map files after the reload as 'mapfiles_reload_<n>'.
+ */
+class QwConfigReload {
+
+  public:
+
+    /// \brief Constructor with options
+    QwConfigReload(QwOptions& options);
+    /// \brief Destructor
+    virtual ~QwConfigReload() { };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options
+    void ProcessOptions(QwOptions& options);
+
+    /// Is the reload on SIGHUP enabled?
+    Bool_t IsEnabled() const { return fEnabled; };
+
+    /// \brief Request a reload at the next pattern boundary
+    static void RequestReload();
+
+    /// \brief Reload the configuration when requested and at a pattern boundary
+    void ProcessEvent(QwSubsystemArrayParity& detectors,
+        std::vector<QwAnalysisPipeline*>& pipelines, UInt_t event_number);
+
+  private:
+
+    /// Private default constructor
+    QwConfigReload();
+
+    /// \brief Check and apply the new configuration of all targets
+    Bool_t Reload(QwSubsystemArrayParity& detectors,
+        std::vector<QwAnalysisPipeline*>& pipelines, UInt_t event_number,
+        Long_t first_pattern);
+
+    Bool_t fEnabled;
+    std::vector<std::string> fTargets;
+
+    /// Maximum number of events to wait for a pattern boundary
+    Int_t fMaxDelay;
+    /// Number of events since the reload was requested
+    Int_t fDelay;
+};
+
+#endif // __QwConfigReload__
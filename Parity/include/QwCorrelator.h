@@ -86,6 +86,8 @@ class QwCorrelator : public VQwDataHandler, public MQwDataHandlerCloneable<QwCor
 
   std::vector< const VQwHardwareChannel* > fIndependentVar;
   std::vector< Double_t > fIndependentValues;
+  /// Independent and dependent values of the event, as passed to the regression
+  std::pair< TVectorD, TVectorD > fEventValues;
 
   std::string fAlphaOutputFileBase;
   std::string fAlphaOutputFileSuff;
@@ -0,0 +1,137 @@
+/********************************************************************
+File Name: QwCovarianceMonitor.h
+
+Description:  This is the header file of the QwCovarianceMonitor
+              class, which is a child of the VQwDataHandler class.  It
+              accumulates the full covariance matrix of a large set of
+              pattern channels, and writes the correlation matrix and
+              its principal components.
+
+********************************************************************/
+
+#ifndef QWCOVARIANCEMONITOR_H_
+#define QWCOVARIANCEMONITOR_H_
+
+// Parent Class
+#include "VQwDataHandler.h"
+
+// Forward declarations
+class TTree;
+class QwRootFile;
+
+/**
+ *  \class QwCovarianceMonitor
+ *  \brief Covariance and correlation matrix of all listed channels
+ *
+ * QwCorrelator and QwEigenRegression update their covariances with every
+ * pattern, which touches the whole matrix once per pattern.  For hundreds
+ * of channels this handler buffers 'block-size' good patterns instead,
+ * and folds each block into the running covariance with one symmetric
+ * rank-k update of the block deviations from the block mean, followed by
+ * the usual pairwise combination of means and co-moments.  The result is
+ * the same as for one pattern at a time, up to rounding.
+ *
+ * When the handler is finished (every burst in the burst handler array,
+ * at the end of the run in the pattern handler array) the correlation
+ * matrix is diagonalized.  The tree contains the means, the widths, the
+ * correlation matrix (unless 'write-matrix = false') and the largest
+ * 'components' eigenvalues and eigenvectors of the correlation matrix, in
+ * the order of the channels in the map file.  The largest loadings of
+ * each component are printed, which shows common-mode noise and
+ * cross-talk at a glance.
+ *
+ * The map file lists one channel per line (asym_, diff_ or yield_).
+ */
+class QwCovarianceMonitor : public VQwDataHandler, public MQwDataHandlerCloneable<QwCovarianceMonitor>
+{
+ public:
+  /// \brief Constructor with name
+  QwCovarianceMonitor(const TString& name);
+  QwCovarianceMonitor(const QwCovarianceMonitor& source);
+  virtual ~QwCovarianceMonitor() { };
+
+  void ParseConfigFile(QwParameterFile& file);
+
+  Int_t LoadChannelMap(const std::string& mapfile);
+
+  /// \brief Connect to the channels (yield/asymmetry/difference)
+  Int_t ConnectChannels(QwSubsystemArrayParity& yield,
+                        QwSubsystemArrayParity& asym,
+                        QwSubsystemArrayParity& diff);
+
+  void ProcessData();
+  void FinishDataHandler(){
+    CalcCorrelation();
+  }
+  void CalcCorrelation();
+
+  /// \brief Construct the tree branches
+  void ConstructTreeBranches(
+      QwRootFile *treerootfile,
+      const std::string& treeprefix = "",
+      const std::string& branchprefix = "");
+  /// \brief Fill the tree branches
+  void FillTreeBranches(QwRootFile *treerootfile) { };
+
+  void ClearEventData();
+  void AccumulateRunningSum(VQwDataHandler &value, Int_t count = 0, Int_t ErrorMask = 0xFFFFFFF);
+
+ protected:
+
+  /// Default constructor (Protected for child class access)
+  QwCovarianceMonitor() { };
+
+  /// \brief Connect to Channels (asymmetry/difference only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& asym,
+                        QwSubsystemArrayParity& diff);
+  /// \brief Connect the listed channels
+  Int_t ConnectMonitoredChannels(QwSubsystemArrayParity* yield,
+                                 QwSubsystemArrayParity& asym,
+                                 QwSubsystemArrayParity& diff);
+
+ private:
+
+  /// \brief Fold the buffered patterns into the running covariance
+  void FoldBlock();
+  /// \brief Reset the results
+  void ClearResults();
+
+  std::vector<std::string> fChannelFull;
+  std::vector<EQwHandleType> fChannelType;
+  std::vector<std::string> fChannelName;
+  std::vector<const VQwHardwareChannel*> fChannelVar;
+
+  Int_t fBlock;            ///< Channel block (-1 for the hardware sum)
+  Int_t fBlockSize;        ///< Patterns per rank-k update
+  Int_t fComponents;       ///< Principal components written
+  Bool_t fWriteMatrix;     ///< Write the correlation matrix
+
+  int nC;
+
+  /// Buffered patterns, channel-major: fBuffer[channel * fBlockSize + row]
+  std::vector<Double_t> fBuffer;
+  Int_t fBufferedRows;
+
+  /// Running count, means and co-moments (upper triangle of nC x nC)
+  Double_t fCount;
+  std::vector<Double_t> fRunningMean;
+  std::vector<Double_t> fComoment;
+  /// Work vector of the mean differences [nC]
+  std::vector<Double_t> fDelta;
+
+  int fTotalCount;
+  int fGoodCount;
+
+  /// Results
+  Int_t fBurst;
+  Int_t fErrorFlag;
+  std::vector<Double_t> fMean;          ///< [nC]
+  std::vector<Double_t> fWidth;         ///< [nC]
+  std::vector<Double_t> fCorrelation;   ///< [nC][nC]
+  std::vector<Double_t> fEigenValues;   ///< [fComponents]
+  std::vector<Double_t> fEigenVectors;  ///< [fComponents][nC], component first
+
+  TTree* fTree;
+};
+
+#endif // QWCOVARIANCEMONITOR_H_
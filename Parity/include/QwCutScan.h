@@ -0,0 +1,188 @@
+/*!
+ * \file   QwCutScan.h
+ * \brief  Pass fractions and asymmetry widths for a grid of cut thresholds
+ */
+
+#ifndef __QwCutScan__
+#define __QwCutScan__
+
+// System headers
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class TTree;
+class QwOptions;
+class QwEventRing;
+class QwHelicityPattern;
+class QwSubsystemArrayParity;
+class VQwHardwareChannel;
+
+/**
+ *  \class QwCutScan
+ *  \ingroup QwAnalysis
+ *  \brief Pass fractions and asymmetry widths for a grid of cut thresholds
+ *
+ * Tuning the event cuts by replaying a run once per candidate threshold is
+ * slow.  With --cutscan-map, the pipeline instead evaluates a grid of
+ * thresholds per cut variable during a single replay, and reports for each
+ * grid point the number of surviving events and patterns, and the mean and
+ * width of the selected asymmetries.  The map file has one line per cut
+ * variable or asymmetry:
+ *   lower  qwk_bcm0l00  holdoff  20 30 40 50
+ *   upper  qwk_1h04X    1.0 1.5 2.0
+ *   burp   qwk_bcm0l00  0.5 1.0 2.0
+ *   asym   qwk_bcm0l00
+ * A 'lower' ('upper') cut fails events with a value below (above) the
+ * threshold; with 'holdoff' the failures count as BCM cut failures, which
+ * start the beam trip holdoff of the event ring.  A 'burp' cut fails events
+ * which differ by more than the threshold from the average of the previous
+ * burp.extent events, and holds off and precuts like the event ring does.
+ *
+ * Each variable is scanned with the other scanned cuts open, on top of the
+ * cuts in effect.  Failing events are flagged as with a local cut (or
+ * event cut mode 3): they stay in the ring, so that the ring contents are
+ * the same for all grid points and the holdoff and burp cut of each grid
+ * point are emulated on a delay line of the ring size.
+ *
+ * The scan only sees the events which pass the cuts in effect, and only
+ * counts the patterns without event cut failures, so a grid point cannot
+ * be looser than the global event cut or burp threshold loaded for its
+ * channel.  Such grid points give the results of the loaded cut; they are
+ * reported when the channels are connected, marked in the summary, and
+ * have 'bounded' set in the tree.  Open the event cuts of the scanned
+ * channels in the eventcuts files to scan beyond them.  The results are
+ * printed at the end of the run, and written to the 'cutscan' tree with
+ * one entry per grid point.
+ */
+class QwCutScan {
+
+  public:
+
+    /// Types of scanned cuts
+    enum EQwCutType { kLowerLimit, kUpperLimit, kBurp };
+
+    /// \brief Constructor with options
+    QwCutScan(QwOptions& options);
+    /// \brief Destructor
+    virtual ~QwCutScan() { };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options and load the map file
+    void ProcessOptions(QwOptions& options);
+
+    /// Is a cut scan requested?
+    Bool_t IsEnabled() const { return ! fPointVariable.empty(); };
+
+    /// \brief Look up the scanned channels and asymmetries, and size the delay line
+    void ConnectChannels(const QwSubsystemArrayParity& detectors,
+        QwHelicityPattern& pattern, const QwEventRing& ring);
+
+    /// \brief Evaluate the grid cuts on an event as it enters the event ring
+    void PushEvent(const QwSubsystemArrayParity& event);
+    /// \brief Count an event as it leaves the event ring and is loaded into the pattern
+    void PopEvent(const QwSubsystemArrayParity& event, Int_t pattern_number);
+    /// \brief Accumulate the asymmetries of a good pattern
+    void ProcessPattern(const QwHelicityPattern& pattern);
+
+    /// \brief Print the results for all grid points
+    void PrintSummary() const;
+
+    /// Number of grid points
+    size_t GetNumberOfPoints() const { return fPointVariable.size(); };
+    /// Select the grid point for the next FillTreeVector
+    void SelectPoint(size_t point) { fSelectedPoint = point; };
+
+    /// \brief Construct the branch and tree vector
+    void ConstructBranchAndVector(TTree *tree, TString& prefix, std::vector<Double_t>& values);
+    /// \brief Fill the tree vector for the selected grid point
+    void FillTreeVector(std::vector<Double_t>& values) const;
+
+  private:
+
+    /// Private default constructor
+    QwCutScan();
+
+    /// \brief Load the cut variables, thresholds and asymmetries
+    void LoadScanMap(const std::string& mapfile);
+    /// \brief List the grid points of all variables
+    void BuildGrid();
+
+    /// Delay line slot of an event
+    size_t Slot(Long64_t event) const { return event % fRingSize; };
+
+    /// Cut variable with its grid of thresholds
+    struct CutVariable {
+      EQwCutType fType;
+      std::string fName;
+      Bool_t fHoldoff;
+      std::vector<Double_t> fThresholds;
+      const VQwHardwareChannel* fChannel;
+      /// Values of the last burp.extent+1 events, and whether they entered the average
+      std::deque<std::pair<Double_t, Bool_t> > fBurpWindow;
+      Double_t fBurpSum;
+      Int_t fBurpCount;
+    };
+    std::vector<CutVariable> fVariables;
+
+    /// \brief Is a threshold looser than the cut in effect on the channel?
+    Bool_t IsBounded(const CutVariable& var, Double_t threshold) const;
+
+    /// Selected asymmetries
+    std::vector<std::string> fAsymNames;
+    std::vector<const VQwHardwareChannel*> fAsymChannels;
+
+    /// Event ring and burp cut settings which are emulated
+    Int_t fRingSize;
+    Int_t fHoldoff;
+    Bool_t fHoldoffIsActive;
+    Int_t fBurpExtent;
+    Int_t fBurpPrecut;
+    Int_t fBurpHoldoff;
+
+    /// Variable and threshold of each grid point
+    std::vector<size_t> fPointVariable;
+    std::vector<Double_t> fPointThreshold;
+    /// Is the grid point looser than the cut in effect?
+    std::vector<Bool_t> fPointBounded;
+
+    /// Delay line with the grid cut failures (slot * points + point)
+    std::vector<UChar_t> fFailed;
+    /// Number of events pushed into and popped from the delay line
+    Long64_t fPushed;
+    Long64_t fPopped;
+
+    /// Holdoff state per grid point
+    std::vector<Bool_t> fLastWasBCMFailure;
+    std::vector<Int_t> fTripCountdown;
+    std::vector<Long64_t> fLastTripEvent;
+    /// Burp holdoff countdown per grid point
+    std::vector<Int_t> fBurpCountdown;
+
+    /// Grid cut failures of the current pattern
+    Int_t fPatternNumber;
+    std::vector<UChar_t> fPatternFailed;
+
+    /// Counts of all good events and patterns, and of the surviving ones
+    Long64_t fEvents;
+    Long64_t fPatterns;
+    std::vector<Long64_t> fEventsPassed;
+    std::vector<Long64_t> fPatternsPassed;
+    /// Running mean and sum of squared deviations (point * asymmetries + asymmetry)
+    std::vector<Double_t> fAsymMean;
+    std::vector<Double_t> fAsymM2;
+
+    /// Grid point for the tree vector
+    size_t fSelectedPoint;
+    /// Position in the branch vector of each tree
+    std::map<const std::vector<Double_t>*, size_t> fTreeArrayIndex;
+};
+
+#endif // __QwCutScan__
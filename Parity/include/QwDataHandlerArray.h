@@ -169,6 +169,12 @@ class QwDataHandlerArray:
 
     void FinishDataHandler();
 
+    /// \brief Read the map files of the selected handlers again
+    Bool_t PrepareReload(const std::vector<std::string>& targets,
+                         std::vector<TString>& reloaded);
+    /// \brief Use the configuration which was read by PrepareReload
+    void ApplyReload();
+
   protected:
 
     void SetPointer(QwHelicityPattern& helicitypattern) {
@@ -200,6 +206,9 @@ class QwDataHandlerArray:
 
     Bool_t fPrintRunningSum;
 
+    /// Handlers which were read again by PrepareReload
+    std::vector<VQwDataHandler*> fReloadHandlers;
+
     /// Test whether this handler array can contain a particular handler
     static Bool_t CanContain(VQwDataHandler* handler) {
       return (dynamic_cast<VQwDataHandler*>(handler) != 0);
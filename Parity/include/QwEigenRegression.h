@@ -0,0 +1,127 @@
+/********************************************************************
+File Name: QwEigenRegression.h
+
+Description:  This is the header file of the QwEigenRegression class,
+              which is a child of the VQwDataHandler class.  It
+              regresses the dependent variables on the principal
+              components (eigenvector combinations) of the
+              independent variables.
+
+********************************************************************/
+
+#ifndef QWEIGENREGRESSION_H_
+#define QWEIGENREGRESSION_H_
+
+// Parent Class
+#include "VQwDataHandler.h"
+
+// LinRegBlue Correlator Class
+#include "LinReg_Bevington_Pebay.h"
+
+// Forward declarations
+class TTree;
+class QwRootFile;
+
+/**
+ *  \class QwEigenRegression
+ *  \brief Regression on the principal components of the monitors
+ *
+ * The means and covariances of the dependent and independent variables
+ * are accumulated in a LinRegBevPeb object, as for QwCorrelator.  When the
+ * handler is finished (every burst in the burst handler array, at the end
+ * of the run in the pattern handler array) the covariance matrix of the
+ * independent variables is diagonalized.  The dependent variables are
+ * regressed on the eigenvector combinations of the independent variables,
+ * which are uncorrelated, so that nearly collinear monitors do not make
+ * the regression unstable.
+ *
+ * Components with an eigenvalue below 'eigenvalue-cut' times the largest
+ * eigenvalue are dropped, and with 'rank = r' only the r largest
+ * components are kept.  With 'standardize = true' the correlation matrix
+ * is diagonalized instead, so that monitors with different units are
+ * weighted equally.
+ *
+ * The tree contains the eigenvalues and eigenvectors (largest first, in
+ * standardized units if enabled), the slopes on the components, and the
+ * equivalent slopes on the monitors with the corrected means.
+ *
+ * The map file has the same format as for QwCorrelator ('dv' and 'iv'
+ * lines).
+ */
+class QwEigenRegression : public VQwDataHandler, public MQwDataHandlerCloneable<QwEigenRegression>
+{
+ public:
+  /// \brief Constructor with name
+  QwEigenRegression(const TString& name);
+  QwEigenRegression(const QwEigenRegression& source);
+  virtual ~QwEigenRegression() { };
+
+  void ParseConfigFile(QwParameterFile& file);
+
+  Int_t LoadChannelMap(const std::string& mapfile);
+
+  /// \brief Connect to Channels (asymmetry/difference only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArrayParity& diff);
+
+  void ProcessData();
+  void FinishDataHandler(){
+    CalcRegression();
+  }
+  void CalcRegression();
+
+  /// \brief Construct the tree branches
+  void ConstructTreeBranches(
+      QwRootFile *treerootfile,
+      const std::string& treeprefix = "",
+      const std::string& branchprefix = "");
+  /// \brief Fill the tree branches
+  void FillTreeBranches(QwRootFile *treerootfile) { };
+
+  void ClearEventData();
+  void AccumulateRunningSum(VQwDataHandler &value, Int_t count = 0, Int_t ErrorMask = 0xFFFFFFF);
+
+ private:
+
+  /// Reset the regression results
+  void ClearResults();
+
+  // Default constructor
+  QwEigenRegression();
+
+  std::vector< std::string > fIndependentFull;
+  std::vector< EQwHandleType > fIndependentType;
+  std::vector< std::string > fIndependentName;
+
+  std::vector< const VQwHardwareChannel* > fIndependentVar;
+  std::vector< Double_t > fIndependentValues;
+
+  Int_t fBlock;            ///< Channel block (-1 for the hardware sum)
+  Int_t fRank;             ///< Maximum number of components (0 for all)
+  Double_t fEigenvalueCut; ///< Smallest eigenvalue kept, relative to the largest
+  Bool_t fStandardize;     ///< Diagonalize the correlation matrix
+
+  int nP, nY;
+
+  LinRegBevPeb linReg;
+
+  int fTotalCount;
+  int fGoodCount;
+
+  /// Regression results
+  Int_t fBurst;
+  Int_t fErrorFlag;
+  Int_t fRankUsed;
+  std::vector<Double_t> fEigenValues;     ///< [nP]
+  std::vector<Double_t> fEigenVectors;    ///< [nP][nP], component first
+  std::vector<Double_t> fComponentSlope;  ///< [nY][nP]
+  std::vector<Double_t> fComponentError;  ///< [nY][nP]
+  std::vector<Double_t> fSlope;           ///< [nY][nP]
+  std::vector<Double_t> fSlopeError;      ///< [nY][nP]
+  std::vector<Double_t> fMean;            ///< [nY]
+  std::vector<Double_t> fCorrectedMean;   ///< [nY]
+  std::vector<Double_t> fCorrectedError;  ///< [nY]
+
+  TTree* fTree;
+};
+
+#endif // QWEIGENREGRESSION_H_
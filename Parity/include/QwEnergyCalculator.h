@@ -141,6 +141,13 @@ class QwEnergyCalculator : public VQwDataElement{
     Bool_t bEVENTCUTMODE;//If this set to kFALSE then Event cuts do not depend on HW ckecks. This is set externally through the qweak_beamline_eventcuts.map
     Bool_t   bFullSave; // used to restrict the amount of data histogramed
 
+    /// Work channel of ProcessEvent and GetProjectedPosition, per instance
+    /// so that it is not shared by concurrent analyses
+    struct WorkChannels {
+      WorkChannels(): tmp("tmp","derived") { }
+      QwMollerADC_Channel tmp;
+    };
+    WorkChannels fWork;
 
 
 };
@@ -52,6 +52,13 @@ class QwEventRing {
   /// \brief Return the number of events in the ring
   Int_t GetNumberOfEvents() const { return fNumberOfEvents; }
 
+  /// \brief Return the ring size and the beam trip and burp cut settings
+  Int_t GetRingSize() const { return fRING_SIZE; }
+  Int_t GetHoldoff() const { return holdoff; }
+  Bool_t IsStabilityCheckOn() const { return bStability; }
+  Int_t GetBurpExtent() const { return fBurpExtent; }
+  Int_t GetBurpPrecut() const { return fBurpPrecut; }
+
   /// \brief Unwind the ring until empty
   void Unwind() {
     while (GetNumberOfEvents() > 0) pop();
@@ -60,6 +67,8 @@ class QwEventRing {
       PrintRollingAverage();
     }
   }
+  /// \brief Discard the events in the ring and start filling it again
+  void Clear();
  private:
 
   Int_t fRING_SIZE;//this is the length of the ring
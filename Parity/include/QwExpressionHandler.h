@@ -0,0 +1,122 @@
+/********************************************************************
+File Name: QwExpressionHandler.h
+
+Description:  This is the header file of the QwExpressionHandler
+              class, which is a child of the VQwDataHandler class.
+              It defines derived channels by arithmetic expressions
+              of published channels, e.g.
+                asym_bcm_dd = asym_qwk_bcm0l01 - asym_qwk_bcm0l02
+              The expressions are compiled into a stack program
+              when the map file is loaded, and evaluated for each
+              event or helicity pattern on the hardware sum and the
+              blocks at once.
+
+********************************************************************/
+
+#ifndef QWEXPRESSIONHANDLER_H_
+#define QWEXPRESSIONHANDLER_H_
+
+// Parent Class
+#include "VQwDataHandler.h"
+
+// Forward declarations
+class QwVQWK_Channel;
+class QwMollerADC_Channel;
+
+class QwExpressionHandler : public VQwDataHandler, public MQwDataHandlerCloneable<QwExpressionHandler>
+{
+ public:
+  /// \brief Constructor with name
+  QwExpressionHandler(const TString& name);
+  QwExpressionHandler(const QwExpressionHandler& source);
+  virtual ~QwExpressionHandler() { };
+
+  /// \brief Load and compile the expressions
+  Int_t LoadChannelMap(const std::string& mapfile);
+
+  /// \brief Connect to the channels (MPS only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& event);
+  /// \brief Connect to the channels (yield/asymmetry/difference)
+  Int_t ConnectChannels(QwSubsystemArrayParity& yield,
+                        QwSubsystemArrayParity& asym,
+                        QwSubsystemArrayParity& diff);
+
+  void ProcessData();
+
+ protected:
+
+  /// Default constructor (Protected for child class access)
+  QwExpressionHandler() { };
+
+  /// \brief Connect to Channels (asymmetry/difference only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& asym,
+                        QwSubsystemArrayParity& diff);
+
+  /// Number of values evaluated at once: hardware sum and four blocks
+  static const size_t kNumLanes = 5;
+
+  /// Operation codes of the stack program
+  enum EQwOpcode {
+    kOpVariable, kOpConstant,
+    kOpAdd, kOpSubtract, kOpMultiply, kOpDivide, kOpPower, kOpNegate,
+    kOpSqrt, kOpLog, kOpLog10, kOpExp, kOpAbs,
+    kOpSin, kOpCos, kOpTan, kOpAsin, kOpAcos, kOpAtan,
+    kOpAtan2, kOpMin, kOpMax
+  };
+  /// Instruction with the operand index for variables and constants
+  struct Instruction {
+    EQwOpcode fOpcode;
+    size_t fIndex;
+  };
+
+  /// Compiled expression of one derived channel
+  struct Expression {
+    /// Full name, type and name of the derived channel
+    std::string fOutputFull;
+    EQwHandleType fOutputType;
+    std::string fOutputName;
+    std::string fText;
+    std::vector<Instruction> fProgram;
+    std::vector<Double_t> fConstants;
+    /// Full names, types and names of the operands
+    std::vector<std::string> fOperandFull;
+    std::vector<EQwHandleType> fOperandType;
+    std::vector<std::string> fOperandName;
+    /// Connected operands
+    std::vector<const VQwHardwareChannel*> fOperandVar;
+    /// Maximum depth of the stack
+    size_t fDepth;
+    /// Number of lanes: five if all operands have blocks, otherwise one
+    size_t fLanes;
+    /// First operand with blocks, for the number of samples and good event count
+    const QwVQWK_Channel* fSamplesVQWK;
+    const QwMollerADC_Channel* fSamplesMollerADC;
+  };
+
+  /// \brief Compile an expression into a stack program
+  Bool_t Compile(const std::string& text, EQwHandleType type, Expression& expr);
+  /// \brief Connect the operands of the expressions of the given types
+  Int_t ConnectExpressions(QwSubsystemArrayParity* mps,
+                           QwSubsystemArrayParity* yield,
+                           QwSubsystemArrayParity* asym,
+                           QwSubsystemArrayParity* diff);
+  /// \brief Evaluate one expression into the output channel
+  void Evaluate(const Expression& expr, QwVQWK_Channel* output);
+
+  /// Expressions in the order of the map file
+  std::vector<Expression> fExpressions;
+
+  /// Connected expressions, parallel to fOutputVar
+  std::vector<size_t> fConnected;
+
+  /// Evaluation stack, allocated once the expressions are connected
+  std::vector<Double_t> fStack;
+
+ private:
+
+  /// Recursive descent parser of one expression
+  class Parser;
+
+}; // class QwExpressionHandler
+
+#endif // QWEXPRESSIONHANDLER_H_
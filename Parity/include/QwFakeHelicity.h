@@ -18,7 +18,8 @@
 
 class QwFakeHelicity: public QwHelicity {
  public:
-  QwFakeHelicity(TString region_tmp):VQwSubsystem(region_tmp),QwHelicity(region_tmp),fMinPatternPhase(1)
+  QwFakeHelicity(TString region_tmp):VQwSubsystem(region_tmp),QwHelicity(region_tmp),fMinPatternPhase(1),
+    fFirstTimeThrough(kTRUE)
 
     {
       // using the constructor of the base class
@@ -36,6 +37,8 @@ class QwFakeHelicity: public QwHelicity {
 
  protected:
     Int_t fMinPatternPhase;
+    /// Have the random seeds not been set yet?
+    Bool_t fFirstTimeThrough;
 
     Bool_t CollectRandBits();
     UInt_t GetRandbit(UInt_t& ranseed);
@@ -0,0 +1,47 @@
+/********************************************************************
+File Name: QwFeedbackControlEPICS.h
+
+Description:  This is the header file of the QwFeedbackControlEPICS
+              class, a feedback control backend which reads and writes
+              EPICS process variables through Channel Access.  It is
+              only built when the EPICS libraries are found.
+
+********************************************************************/
+
+#ifndef QWFEEDBACKCONTROLEPICS_H_
+#define QWFEEDBACKCONTROLEPICS_H_
+
+// System headers
+#include <map>
+
+// EPICS headers
+#include "cadef.h"
+
+// Parent class
+#include "VQwFeedbackControl.h"
+
+class QwFeedbackControlEPICS : public VQwFeedbackControl {
+
+ public:
+
+  /// \brief Constructor with the Channel Access timeout in seconds
+  QwFeedbackControlEPICS(Double_t timeout);
+  virtual ~QwFeedbackControlEPICS();
+
+  Bool_t Get(const std::string& name, Double_t& value);
+  Bool_t Set(const std::string& name, Double_t value);
+
+ private:
+
+  /// \brief Connected channel of a process variable, or null
+  chid Connect(const std::string& name);
+
+  /// Channel Access timeout
+  Double_t fTimeout;
+
+  /// Connected channels by process variable name
+  std::map<std::string, chid> fChannels;
+
+}; // class QwFeedbackControlEPICS
+
+#endif // QWFEEDBACKCONTROLEPICS_H_
@@ -0,0 +1,40 @@
+/********************************************************************
+File Name: QwFeedbackControlMock.h
+
+Description:  This is the header file of the QwFeedbackControlMock
+              class, a feedback control backend which keeps the
+              setpoints in memory.  The initial values are read from a
+              file with lines 'name = value'.  It is used to run the
+              feedback loops on mock data, or in parallel with the
+              online feedback without touching the hardware.
+
+********************************************************************/
+
+#ifndef QWFEEDBACKCONTROLMOCK_H_
+#define QWFEEDBACKCONTROLMOCK_H_
+
+// System headers
+#include <map>
+
+// Parent class
+#include "VQwFeedbackControl.h"
+
+class QwFeedbackControlMock : public VQwFeedbackControl {
+
+ public:
+
+  /// \brief Constructor with the file of initial values
+  QwFeedbackControlMock(const std::string& filename);
+  virtual ~QwFeedbackControlMock() { };
+
+  Bool_t Get(const std::string& name, Double_t& value);
+  Bool_t Set(const std::string& name, Double_t value);
+
+ private:
+
+  /// Current values of the controls
+  std::map<std::string, Double_t> fValues;
+
+}; // class QwFeedbackControlMock
+
+#endif // QWFEEDBACKCONTROLMOCK_H_
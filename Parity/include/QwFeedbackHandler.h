@@ -0,0 +1,154 @@
+/********************************************************************
+File Name: QwFeedbackHandler.h
+
+Description:  This is the header file of the QwFeedbackHandler
+              class, which is a child of the VQwDataHandler class.
+              It runs the helicity-correlated feedback loops (charge
+              asymmetry on the Pockels cell and IA setpoints) on the
+              asymmetries and differences of the helicity patterns of
+              the main analysis, and writes the corrections through a
+              control backend (EPICS or mock).
+
+********************************************************************/
+
+#ifndef QWFEEDBACKHANDLER_H_
+#define QWFEEDBACKHANDLER_H_
+
+// System headers
+#include <map>
+#include <mutex>
+
+// Parent Class
+#include "VQwDataHandler.h"
+
+// Forward declarations
+class VQwFeedbackControl;
+
+/**
+ *  \class QwFeedbackHandler
+ *  \brief Helicity-correlated feedback inside the pattern analysis
+ *
+ * Each section of the map file defines one feedback loop: a monitored
+ * channel (e.g. asym_qwk_charge), the number of good patterns to
+ * accumulate, the required precision, the slope of the monitored
+ * channel against the setpoints, and the setpoints with their signs.
+ * When the loop has accumulated enough patterns and its mean is precise
+ * enough, every setpoint is moved by -sign * mean / slope, within the
+ * limits of the loop, which cancels the mean for the measured slope.  A loop can be restricted to one of the four
+ * helicity histories of consecutive patterns (mode 0: ++, 1: +-, 2: -+,
+ * 3: --, by the helicity of the first window of each pattern), as for
+ * the Hall C IA feedback.
+ *
+ * Pattern handlers are instantiated in every analysis pipeline and also
+ * for the burst sums; only the first instance with a given name drives
+ * the controls, the others stay idle.
+ */
+class QwFeedbackHandler : public VQwDataHandler, public MQwDataHandlerCloneable<QwFeedbackHandler>
+{
+ public:
+  /// \brief Constructor with name
+  QwFeedbackHandler(const TString& name);
+  QwFeedbackHandler(const QwFeedbackHandler& source);
+  virtual ~QwFeedbackHandler();
+
+  void ParseConfigFile(QwParameterFile& file);
+
+  /// \brief Load the feedback loops
+  Int_t LoadChannelMap(const std::string& mapfile);
+
+  /// \brief Connect to the channels (yield/asymmetry/difference)
+  Int_t ConnectChannels(QwSubsystemArrayParity& yield,
+                        QwSubsystemArrayParity& asym,
+                        QwSubsystemArrayParity& diff);
+
+  void ProcessData();
+
+  void FinishDataHandler();
+
+ protected:
+
+  /// Default constructor (Protected for child class access)
+  QwFeedbackHandler() { };
+
+  /// \brief Connect to Channels (asymmetry/difference only)
+  Int_t ConnectChannels(QwSubsystemArrayParity& asym,
+                        QwSubsystemArrayParity& diff);
+  /// \brief Connect the loop inputs and claim the controls
+  Int_t ConnectLoops(QwSubsystemArrayParity* yield,
+                     QwSubsystemArrayParity& asym,
+                     QwSubsystemArrayParity& diff);
+
+  /// One feedback loop
+  struct Loop {
+    std::string fName;
+    /// Monitored channel
+    std::string fInputFull;
+    EQwHandleType fInputType;
+    std::string fInputName;
+    const VQwHardwareChannel* fInput;
+    /// Helicity history of the patterns to use, or -1 for all
+    Int_t fMode;
+    /// Good patterns per correction, and precision required (in the units of scale)
+    Int_t fPatterns;
+    Double_t fPrecision;
+    /// Factor from the channel value to the units of the slope (1e6: ppm)
+    Double_t fScale;
+    /// Change of the monitored value per unit of correction, and with the IHWP in
+    Double_t fSlope;
+    Double_t fSlopeIHWPIn;
+    std::string fIHWP;
+    /// Setpoints, their signs, and their limits
+    std::vector<std::string> fSetpoints;
+    std::vector<Double_t> fSigns;
+    Double_t fLower, fUpper;
+    /// Clamp out-of-range setpoints at the limits instead of skipping the correction
+    Bool_t fClamp;
+    /// Reduce the correction for small monitored values
+    Bool_t fDamping;
+    /// Controls which receive the mean, error and width
+    std::vector<std::string> fReport;
+    /// Running mean and second moment of the monitored value
+    Int_t fCount;
+    Int_t fCountSinceCheck;
+    Double_t fMean, fM2;
+    /// Corrections written
+    Int_t fCorrections;
+  };
+
+  /// \brief Evaluate a loop and write the correction when it is due
+  void ApplyCorrection(Loop& loop);
+  /// \brief Damping factor of the correction for a monitored value
+  static Double_t DampingFactor(Double_t value);
+  /// \brief Helicity history of the current and the previous pattern
+  Int_t GetHelicityMode();
+
+  std::vector<Loop> fLoops;
+
+  /// Control backend: type and its configuration
+  std::string fControlType;
+  std::string fControlConfig;
+  /// Compute and log the corrections, but do not write them
+  Bool_t fDryRun;
+  /// Control which is set to 1 while the feedback runs
+  std::string fStatusControl;
+  /// Log file of the corrections
+  std::string fLogFile;
+
+  /// Does this instance drive the controls?
+  Bool_t fIsActive;
+  VQwFeedbackControl* fControl;
+
+  /// Polarity and number of the previous good pattern
+  Int_t fPreviousPolarity;
+  Int_t fPreviousPattern;
+
+  /// Active instance of each handler name.  This registry is process-wide
+  /// on purpose, not per analysis context: the controls act on the one beam,
+  /// so only one analysis of the process may drive them.
+  static std::map<std::string, const QwFeedbackHandler*> fActiveHandlers;
+  /// Guard of the registry, for analyses in concurrent threads
+  static std::mutex fActiveHandlersMutex;
+
+}; // class QwFeedbackHandler
+
+#endif // QWFEEDBACKHANDLER_H_
@@ -242,6 +242,7 @@ class QwHelicity: public VQwSubsystemParity, public MQwSubsystemCloneable<QwHeli
   size_t fTreeArrayIndex;
   size_t fTreeArrayNumEntries;
   UInt_t n_ranbits; //counts how many ranbits we have collected
+  UShort_t fFirst24Bits[25]; //stores the first 24 bits for the seed
   UInt_t iseed_Actual; //stores the random seed for the helicity predictor
   UInt_t iseed_Delayed;
   //stores the random seed to predict the reported helicity
@@ -297,10 +298,40 @@ class QwHelicity: public VQwSubsystemParity, public MQwSubsystemCloneable<QwHeli
 
   UInt_t fErrorFlag;
 
+  /// Redundant helicity sources which are compared with the decoded
+  /// reported helicity when helicity.crosscheck is enabled
+  enum HelicitySource{kSourceInputRegister = 0,
+		      kSourceUserbit,
+		      kSourcePredictor,
+		      kNumHelicitySources};
+  Bool_t fCrossCheckSources;
+  /// Input register and userbit words, independent of the decoding mode
+  Int_t  fCrossCheckInputRegister;
+  Int_t  fCrossCheckUserbit;
+  /// Events compared and disagreements per source
+  Int_t  fNumSourceCompared[kNumHelicitySources];
+  Int_t  fNumSourceDisagreements[kNumHelicitySources];
+  /// Patterns compared and patterns with disagreements
+  Int_t  fNumPatternsCrossChecked;
+  Int_t  fNumPatternsDisagreeing;
+  Int_t  fCrossCheckPatternNumber;
+  Bool_t fCrossCheckPatternDisagrees;
+
+  void   CrossCheckSources(Int_t reported, Int_t helicity_errors);
+  void   ClearCrossCheckCounters();
+  void   PrintCrossCheckSummary() const;
+
   /// Flag to disable the printing os missed MPS error messags during
   /// online running
   Bool_t fSuppressMPSErrorMsgs;
 
+  /// Decoding state of the input register, Moller and userbit modes,
+  /// per instance so that concurrent analyses do not share it
+  Bool_t fFirstEvent;
+  Bool_t fFirstPattern;
+  Bool_t fFakeTheCounters;
+  UInt_t fLastUserbits;
+
  private:
 
   UInt_t BuildHelicityBitPattern(Int_t patternsize);
@@ -85,7 +85,11 @@ class QwHelicityPattern {
 
   Bool_t IsEndOfBurst(){
     //  Is this the end of a burst? And is this not the final burst?
-    return (( fBurstLength > 0 && fGoodPatterns >= fBurstLength ) && ( fBurstCounter<fMaxBurstIndex ));
+    return (( fBurstLength > 0 && fGoodPatterns >= fBurstLength ) && CanStartNewBurst());
+  }
+  Bool_t CanStartNewBurst() const {
+    //  Is this not the final burst?
+    return ( fBurstCounter<fMaxBurstIndex );
   }
 
   void  CalculateAsymmetry();
@@ -98,6 +102,15 @@ class QwHelicityPattern {
   /// Status of alternate asymmetry calculation flag
   Bool_t IsAlternateAsymEnabled() { return fEnableAlternateAsym; };
 
+  /// Enable/disable Walsh-Hadamard contrast calculation
+  void  EnableHadamardContrasts(const Bool_t flag = kTRUE) { fEnableHadamard = flag; };
+  /// Disable Walsh-Hadamard contrast calculation
+  void  DisableHadamardContrasts() { fEnableHadamard = kFALSE; };
+  /// Status of Walsh-Hadamard contrast calculation flag
+  Bool_t IsHadamardEnabled() { return fEnableHadamard; };
+  /// Number of patterns where the primary contrast disagreed with the difference
+  UInt_t GetHadamardMismatchCount() const { return fHadamardMismatches; };
+
   /// Enable/disable burst sum calculation
   void  EnableBurstSum(const Bool_t flag = kTRUE) { fEnableBurstSum = flag; };
   /// Disable burst sum calculation
@@ -197,6 +210,9 @@ class QwHelicityPattern {
     // Else we just park here and don't try to increment any more. This is a parameter from command line or map file
   }
   Short_t GetBurstCounter() const {return fBurstCounter;}
+  Int_t GetPatternNumber() const {return fCurrentPatternNumber;}
+  /// Helicity of the first window of the pattern (1: +, 0: -, -9999: unknown)
+  Int_t GetPatternPolarity() const {return fHelicity.empty()? -9999: fHelicity.front();}
   void  ClearEventData();
 
   void  Print() const;
@@ -230,6 +246,24 @@ class QwHelicityPattern {
   QwSubsystemArrayParity fAsymmetry1;
   QwSubsystemArrayParity fAsymmetry2;
 
+  // Walsh-Hadamard contrasts of the pattern windows for selected channels
+  Bool_t fEnableHadamard;
+  std::vector<std::string> fHadamardChannelNames;
+  /// Window channels, indexed as [channel][window]
+  std::vector< std::vector<const VQwHardwareChannel*> > fHadamardWindowChannels;
+  /// Pattern difference channels used to verify the primary contrast
+  std::vector<const VQwHardwareChannel*> fHadamardDifferenceChannels;
+  /// Contrasts, indexed as [channel*fPatternSize + contrast]
+  std::vector<Double_t> fHadamardContrasts;
+  std::vector<UInt_t>   fHadamardErrorCode;
+  std::vector<Double_t> fHadamardSigns;
+  Int_t  fHadamardPrimary;
+  Bool_t fHadamardIsConsistent;
+  UInt_t fHadamardMismatches;
+  size_t fHadamardTreeArrayIndex;
+  void ConnectHadamardChannels();
+  void CalculateHadamardContrasts();
+
   // Yield and asymmetry of a single helicity pair
   Bool_t fEnablePairs;
   QwSubsystemArrayParity fPairYield;
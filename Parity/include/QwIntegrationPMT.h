@@ -193,6 +193,14 @@ void RandomizeMollerEvent(int helicity, const QwBeamCharge& charge, const QwBeam
 
   const static  Bool_t bDEBUG=kFALSE;//debugging display purposes
   Bool_t bEVENTCUTMODE; //global switch to turn event cuts ON/OFF
+
+  /// Work channel of RandomizeMollerEvent, per instance so that it is not
+  /// shared by concurrent analyses
+  struct WorkChannels {
+    WorkChannels(): temp("temp","derived") { }
+    QwMollerADC_Channel temp;
+  };
+  WorkChannels fWork;
 };
 
 
@@ -166,6 +166,16 @@ class QwLinearDiodeArray : public VQwBPM {
 
   std::vector<QwVQWK_Channel> fLinearArrayElementList;
 
+ private:
+  /// Work channels of ProcessEvent, per instance so that they are not
+  /// shared by concurrent analyses
+  struct WorkChannels {
+    WorkChannels()
+    : mean("mean","raw"), meansqr("meansqr","raw"), tmp("tmp"), tmp2("tmp2") { }
+    QwVQWK_Channel mean, meansqr;
+    QwVQWK_Channel tmp, tmp2;
+  };
+  WorkChannels fWork;
 };
 
 
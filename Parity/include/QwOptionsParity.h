@@ -21,10 +21,17 @@
 #include "QwEventRing.h"
 #include "QwHelicity.h"
 #include "QwHelicityPattern.h"
+#include "QwBeamLine.h"
 #include "QwDetectorArray.h"
 #include "QwBlindDetectorArray.h"
 #include "QwDataHandlerArray.h"
 #include "QwCorrelator.h"
+#include "QwAnalysisPipeline.h"
+#include "QwBurstSegmentation.h"
+#include "QwCutScan.h"
+#include "QwTimeSeries.h"
+#include "QwConfigReload.h"
+#include "QwQuickLookSampler.h"
 
 #ifdef __USE_DATABASE__
 #include "QwParityDB.h"
@@ -40,8 +47,15 @@ void DefineOptionsParity(QwOptions& options)
   QwEventRing::DefineOptions(options);
   QwHelicity::DefineOptions(options);
   QwHelicityPattern::DefineOptions(options);
+  QwBeamLine::DefineOptions(options);
   QwDataHandlerArray::DefineOptions(options);
   QwCorrelator::DefineOptions(options);
+  QwAnalysisPipeline::DefineOptions(options);
+  QwBurstSegmentation::DefineOptions(options);
+  QwCutScan::DefineOptions(options);
+  QwTimeSeriesWriter::DefineOptions(options);
+  QwConfigReload::DefineOptions(options);
+  QwQuickLookSampler::DefineOptions(options);
   #ifdef __USE_DATABASE__
   QwParityDB::DefineAdditionalOptions(options);
   #endif //__USE_DATABASE__
@@ -85,6 +85,7 @@ class QwQPD : public VQwBPM {
   const VQwHardwareChannel* GetEffectiveCharge() const {return &fEffectiveCharge;}
 
   TString GetSubElementName(Int_t subindex);
+  const VQwHardwareChannel* GetSubElement(Int_t subindex) const {return &fPhotodiode.at(subindex);}
   void    GetAbsolutePosition(){};
 
   Bool_t  ApplyHWChecks();//Check for harware errors in the devices
@@ -167,6 +168,18 @@ class QwQPD : public VQwBPM {
 
   std::vector<QwVQWK_Channel> fQPDElementList;
 
+ private:
+  /// Work channels of ProcessEvent, per instance so that they are not
+  /// shared by concurrent analyses
+  struct WorkChannels {
+    WorkChannels(): tmp("tmp"), tmp1("tmp1"), tmp2("tmp2") {
+      numer[0].InitializeChannel("Xnumerator","raw");
+      numer[1].InitializeChannel("Ynumerator","raw");
+    }
+    QwVQWK_Channel numer[2];
+    QwVQWK_Channel tmp, tmp1, tmp2;
+  };
+  WorkChannels fWork;
 };
 
 
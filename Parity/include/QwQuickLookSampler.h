@@ -0,0 +1,110 @@
+/*!
+ * \file   QwQuickLookSampler.h
+ * \brief  Quick-look replay of evenly spaced blocks of helicity patterns
+ */
+
+#ifndef __QwQuickLookSampler__
+#define __QwQuickLookSampler__
+
+// System headers
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class QwOptions;
+class QwEventBuffer;
+class QwAnalysisPipeline;
+
+/**
+ *  \class QwQuickLookSampler
+ *  \ingroup QwAnalysis
+ *  \brief Quick-look replay of evenly spaced blocks of helicity patterns
+ *
+ * With --sample-blocks N, qwparity analyzes only N blocks of each data
+ * file, evenly spaced over the whole file, instead of every event.  Each
+ * block starts at the first event of a file block (the CODA blocks are the
+ * index into the file) and ends at the first pattern boundary after
+ * --sample-patterns good helicity patterns.  The data in between are not
+ * decoded.  The choice of blocks depends only on the size of the file, so
+ * that the same options give the same result.
+ *
+ * Before each jump, the events which are still in the event ring of each
+ * pipeline are analyzed, and the pattern which they leave incomplete is
+ * discarded; the ring is filled again from the new block.  At the start
+ * of each block, the helicity subsystem sees a gap in the event and pattern
+ * counters: it reports the discontinuity and collects a new seed for the
+ * helicity predictor, so the first patterns of each block fail the helicity
+ * checks.  The running burst ends at each jump.  The
+ * sampling is written as the string object 'quicklook_sampling' to the
+ * output files, with the fraction of the file blocks which were read.
+ *
+ * Sampling needs random access to the data files: it is not possible for
+ * ET streams or compressed files, which are replayed in full.
+ */
+class QwQuickLookSampler {
+
+  public:
+
+    /// \brief Constructor with options
+    QwQuickLookSampler(QwOptions& options);
+    /// \brief Destructor
+    virtual ~QwQuickLookSampler() { };
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options
+    void ProcessOptions(QwOptions& options);
+
+    /// Is the quick-look sampling enabled?
+    Bool_t IsEnabled() const { return fEnabled; };
+
+    /// \brief Jump to the next block after enough patterns in this block
+    void ProcessEvent(QwEventBuffer& eventbuffer,
+        std::vector<QwAnalysisPipeline*>& pipelines);
+
+    /// \brief Write the sampling fraction to the output files of all pipelines
+    void WriteSamplingRecord(std::vector<QwAnalysisPipeline*>& pipelines);
+
+  private:
+
+    /// Private default constructor
+    QwQuickLookSampler();
+
+    /// \brief Start the sampling of a new data file
+    void StartDataFile(QwEventBuffer& eventbuffer, Long64_t patterns);
+    /// \brief Count the block which was cut short by the end of the data file
+    void FinishDataFile();
+
+    Bool_t fEnabled;
+    /// Number of blocks per data file
+    Int_t fNumBlocks;
+    /// Good patterns per block
+    Int_t fPatternsPerBlock;
+    /// Maximum number of events in one block
+    Int_t fMaxEvents;
+
+    /// Current data file, its number of file blocks, and whether it can be sampled
+    TString fDataFile;
+    Int_t fFileBlocks;
+    Bool_t fFileIsSampled;
+    /// Index of the current block in this data file
+    Int_t fSample;
+    /// File blocks at the start of the current block and of the last event
+    Int_t fFirstBlock;
+    Int_t fLastBlock;
+    /// Good patterns before, and events in, the current block
+    Long64_t fPatternsAtStart;
+    Int_t fEvents;
+
+    /// Blocks analyzed, and file blocks read and in total
+    Int_t fSamplesRead;
+    Long64_t fBlocksRead;
+    Long64_t fBlocksTotal;
+    /// Data files which could not be sampled
+    Int_t fFilesInFull;
+};
+
+#endif // __QwQuickLookSampler__
@@ -0,0 +1,192 @@
+/*!
+ * \file   QwTimeSeries.h
+ * \brief  Multi-resolution time series of selected channels for strip charts
+ */
+
+#ifndef __QwTimeSeries__
+#define __QwTimeSeries__
+
+// System headers
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TString.h"
+
+// Forward declarations
+class QwOptions;
+class QwSubsystemArrayParity;
+class VQwHardwareChannel;
+
+/**
+ *  \class QwTimeSeriesBin
+ *  \ingroup QwAnalysis
+ *  \brief Count, mean, sum of squared deviations, minimum and maximum of a time bin
+ */
+class QwTimeSeriesBin {
+
+  public:
+
+    QwTimeSeriesBin(): fStart(0.0) { Clear(); };
+
+    /// \brief Clear the aggregates
+    void Clear();
+    /// \brief Add a value
+    void Add(Double_t value);
+    /// \brief Add the values of another bin
+    void Merge(const QwTimeSeriesBin& bin);
+
+    /// Variance of the values in the bin
+    Double_t GetVariance() const { return (fCount > 1)? fM2 / (fCount - 1): 0.0; };
+
+    Double_t fStart;  ///< start time of the bin
+    Long64_t fCount;  ///< number of values
+    Double_t fMean;   ///< mean of the values
+    Double_t fM2;     ///< sum of squared deviations from the mean
+    Double_t fMin;    ///< minimum value
+    Double_t fMax;    ///< maximum value
+};
+
+/**
+ *  \class QwTimeSeriesWriter
+ *  \ingroup QwAnalysis
+ *  \brief Incremental writer of the time series pyramid of selected channels
+ *
+ * Trend plots over hours or a whole slug should not have to reread every
+ * event of the trees.  For the channels selected with --timeseries-channel,
+ * the writer keeps a pyramid of time bins: bins of --timeseries-base
+ * seconds at level 0, and bins which are --timeseries-factor times wider at
+ * each of the --timeseries-levels levels, e.g. 1 s, 10 s, 100 s, 1000 s and
+ * 10000 s.  Each bin holds the count, mean, sum of squared deviations,
+ * minimum and maximum of the good events in it.  A bin is written to the
+ * side file as soon as it is closed and merged into the bin of the next
+ * level, so that the file can be read while the run is being analyzed.
+ *
+ * The time of an event is its CODA event number divided by
+ * --timeseries-mps-rate, in seconds since the start of the run.  The unix
+ * time of the start of the run is written once it is known from the go
+ * event, before the first bin is closed, so that QwTimeSeriesReader can
+ * combine the files of several runs also while they are being written.
+ */
+class QwTimeSeriesWriter {
+
+  public:
+
+    /// \brief Constructor with options
+    QwTimeSeriesWriter(QwOptions& options);
+    /// \brief Destructor, which closes the file
+    virtual ~QwTimeSeriesWriter();
+
+    /// \brief Define the configuration options
+    static void DefineOptions(QwOptions& options);
+    /// \brief Process the configuration options
+    void ProcessOptions(QwOptions& options);
+
+    /// Are channels selected?
+    Bool_t IsEnabled() const { return ! fNames.empty(); };
+
+    /// \brief Look up the selected channels, and open the file
+    void ConnectChannels(const QwSubsystemArrayParity& detectors,
+        const TString& filename, Int_t run_number);
+    /// \brief Add the values of an event
+    void ProcessEvent(const QwSubsystemArrayParity& detectors);
+    /// \brief Record the unix time of the start of the run
+    void SetRunStartTime(Double_t start);
+    /// \brief Write the open bins and close the file
+    void Close();
+
+  private:
+
+    /// Private default constructor
+    QwTimeSeriesWriter();
+    /// Private copy constructor, not implemented
+    QwTimeSeriesWriter(const QwTimeSeriesWriter&);
+    /// Private assignment operator, not implemented
+    QwTimeSeriesWriter& operator=(const QwTimeSeriesWriter&);
+
+    /// \brief Close a bin, write it and merge it into the next level
+    void CloseBin(size_t channel, Int_t level);
+    /// \brief Write a record
+    void WriteRecord(Int_t channel, Int_t level, const QwTimeSeriesBin& bin);
+
+    /// Selected channels and their names
+    std::vector<std::string> fNames;
+    std::vector<const VQwHardwareChannel*> fChannels;
+
+    /// Pyramid settings
+    Double_t fBaseWidth;
+    Int_t fFactor;
+    Int_t fLevels;
+    Double_t fMPSRate;
+    std::vector<Double_t> fWidth;
+
+    /// Open bin of each channel and level (channel * levels + level)
+    std::vector<QwTimeSeriesBin> fOpenBins;
+
+    TString fFileName;
+    std::ofstream fFile;
+    Bool_t fNeedsFlush;
+    /// Was the start time of the run written?
+    Bool_t fRunStartWritten;
+};
+
+/**
+ *  \class QwTimeSeriesReader
+ *  \ingroup QwAnalysis
+ *  \brief Reader of time series files, serving time ranges at a suitable resolution
+ *
+ * Reads the files written by QwTimeSeriesWriter, of one or several runs.
+ * GetRange returns the bins of a channel in a time range at the finest level
+ * with at most the requested number of bins, so that a strip chart of the
+ * last hours of a run or of a whole slug reads a few hundred bins instead of
+ * all events.  The times are unix times when the start time of the runs is
+ * known, and seconds since the start of the run otherwise.
+ * \code
+ * QwTimeSeriesReader reader;
+ * reader.AddFile("Qweak_1234.trees.timeseries");
+ * std::vector<QwTimeSeriesBin> bins =
+ *   reader.GetRange(reader.FindChannel("bcm_an_us"), tmin, tmax, 500);
+ * \endcode
+ */
+class QwTimeSeriesReader {
+
+  public:
+
+    QwTimeSeriesReader(): fBaseWidth(0.0), fFactor(0), fLevels(0) { };
+    virtual ~QwTimeSeriesReader() { };
+
+    /// \brief Read a time series file
+    Bool_t AddFile(const std::string& filename);
+
+    /// Channels in the files
+    size_t GetNumberOfChannels() const { return fNames.size(); };
+    const std::string& GetChannelName(size_t channel) const { return fNames.at(channel); };
+    /// \brief Index of a channel, or -1
+    Int_t FindChannel(const std::string& name) const;
+
+    /// Pyramid levels and their bin widths
+    Int_t GetNumberOfLevels() const { return fLevels; };
+    Double_t GetBinWidth(Int_t level) const;
+
+    /// \brief Bins of a channel and level which overlap a time range
+    std::vector<QwTimeSeriesBin> GetBins(Int_t channel, Int_t level,
+        Double_t tmin, Double_t tmax) const;
+    /// \brief Bins of a channel in a time range, at the finest level with at most maxbins bins
+    std::vector<QwTimeSeriesBin> GetRange(Int_t channel,
+        Double_t tmin, Double_t tmax, size_t maxbins) const;
+
+  private:
+
+    std::vector<std::string> fNames;
+    Double_t fBaseWidth;
+    Int_t fFactor;
+    Int_t fLevels;
+
+    /// Bins sorted by start time (channel * levels + level)
+    std::vector<std::vector<QwTimeSeriesBin> > fBins;
+};
+
+#endif // __QwTimeSeries__
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <cstddef>
 
 // Copy C-style array a to b
 template<typename T>
@@ -17,4 +18,20 @@ void QwCopyArray( const T& a, T& b ) {
   }
 }
 
+// In-place fast Walsh-Hadamard transform of n values (n a power of two),
+// in natural (Sylvester) ordering and without normalization
+template<typename T>
+void QwFastWalshHadamard( T* x, const std::size_t n ) {
+  for (std::size_t len = 1; len < n; len <<= 1) {
+    for (std::size_t i = 0; i < n; i += 2*len) {
+      for (std::size_t j = i; j < i + len; j++) {
+        T a = x[j];
+        T b = x[j+len];
+        x[j]     = a + b;
+        x[j+len] = a - b;
+      }
+    }
+  }
+}
+
 #endif //QWANALYSIS_QWUTIL_H
@@ -194,6 +194,10 @@ public:
     std::cerr << "GetSubElementName()  is not implemented!! for device: " << GetElementName() << "\n";
     return TString("OBJECT_UNDEFINED"); // Return an erroneous TString
   }
+  virtual const VQwHardwareChannel* GetSubElement(Int_t subindex) const {
+    std::cerr << "GetSubElement()  is not implemented!! for device: " << GetElementName() << "\n";
+    return NULL;
+  }
   virtual void GetAbsolutePosition() {
     std::cerr << "GetAbsolutePosition() is not implemented!!\n";
   }
@@ -111,6 +111,13 @@ class VQwDataHandler:  virtual public VQwDataHandlerCloneable, public MQwPublish
     Int_t LoadChannelMap(){return this->LoadChannelMap(fMapFile);}
     virtual Int_t LoadChannelMap(const std::string& mapfile){return 0;};
 
+    /// \brief Can the map file be read again while running
+    virtual Bool_t CanReload() const { return kFALSE; };
+    /// \brief Read the map file again and check it against the connected channels
+    virtual Bool_t PrepareReload() { return kFALSE; };
+    /// \brief Use the configuration which was read by PrepareReload
+    virtual void ApplyReload() { };
+
     /// \brief Publish all variables of the subsystem
     virtual Bool_t PublishInternalValues() const;
     /// \brief Try to publish an internal variable matching the submitted name
@@ -67,7 +67,8 @@ class VQwDetectorArray: virtual public VQwSubsystemParity {
 
     /// Constructor with name
     VQwDetectorArray(const TString& name) 
-     :VQwSubsystem(name),VQwSubsystemParity(name),bNormalization(kFALSE) {
+     :VQwSubsystem(name),VQwSubsystemParity(name),bNormalization(kFALSE),
+      fMainDetErrorCount(0) {
 
         fTargetCharge.InitializeChannel("q_targ","derived");
         fTargetX.InitializeChannel("x_targ","derived");
@@ -84,7 +85,8 @@ class VQwDetectorArray: virtual public VQwSubsystemParity {
      :VQwSubsystem(source),VQwSubsystemParity(source),
      fIntegrationPMT(source.fIntegrationPMT),
      fCombinedPMT(source.fCombinedPMT),
-     fMainDetID(source.fMainDetID){}
+     fMainDetID(source.fMainDetID),
+     fMainDetErrorCount(0){}
 
     /// Virtual destructor
 
@@ -103,6 +105,7 @@ class VQwDetectorArray: virtual public VQwSubsystemParity {
     void LoadEventCuts_Init() {};
     void LoadEventCuts_Line(QwParameterFile &mapstr, TString &varvalue, Int_t &eventcut_flag);
     void LoadEventCuts_Fin(Int_t &eventcut_flag);
+    Bool_t HasEventCutDevice(TString device_type, TString device_name);
     Bool_t ApplySingleEventCuts();//Check for good events by stting limits on the devices readings
 
     Bool_t  CheckForBurpFail(const VQwSubsystem *subsys);
@@ -0,0 +1,38 @@
+/********************************************************************
+File Name: VQwFeedbackControl.h
+
+Description:  This is the header file of the VQwFeedbackControl
+              class, the interface through which the QwFeedbackHandler
+              reads and writes the setpoints of the helicity-correlated
+              feedback (Pockels cell and IA voltages).  The controls are
+              addressed by name: EPICS process variables for the EPICS
+              backend, arbitrary names for the mock backend.
+
+********************************************************************/
+
+#ifndef VQWFEEDBACKCONTROL_H_
+#define VQWFEEDBACKCONTROL_H_
+
+// System headers
+#include <string>
+
+// ROOT headers
+#include "Rtypes.h"
+
+class VQwFeedbackControl {
+
+ public:
+
+  virtual ~VQwFeedbackControl() { };
+
+  /// \brief Read the current value of a control
+  virtual Bool_t Get(const std::string& name, Double_t& value) = 0;
+  /// \brief Write a new value to a control
+  virtual Bool_t Set(const std::string& name, Double_t value) = 0;
+
+  /// \brief Create the backend of a type ('mock' or 'epics')
+  static VQwFeedbackControl* Create(const std::string& type, const std::string& config);
+
+}; // class VQwFeedbackControl
+
+#endif // VQWFEEDBACKCONTROL_H_
@@ -94,7 +94,9 @@ class VQwSubsystemParity: virtual public VQwSubsystem {
 
       // Open the file
       QwParameterFile mapstr(filename.Data());
-      fDetectorMaps.insert(mapstr.GetParamFileNameContents());
+      //  Replace the contents of a file which is read again while running
+      std::pair<TString, TString> contents = mapstr.GetParamFileNameContents();
+      fDetectorMaps[contents.first] = contents.second;
       this->LoadEventCuts_Init();
   
       while (mapstr.ReadNextLine()){
@@ -119,6 +121,32 @@ class VQwSubsystemParity: virtual public VQwSubsystem {
     virtual void LoadEventCuts_Init() {};
     virtual void LoadEventCuts_Line(QwParameterFile &mapstr, TString &varvalue, Int_t &eventcut_flag) {};
     virtual void LoadEventCuts_Fin(Int_t &eventcut_flag) {};
+
+    /// \brief Check that the event cuts file only refers to known devices
+    virtual Bool_t CheckEventCuts(TString filename){
+      Bool_t status = kTRUE;
+      QwParameterFile mapstr(filename.Data());
+      while (mapstr.ReadNextLine()){
+        mapstr.TrimComment('!');
+        mapstr.TrimWhitespace();
+        if (mapstr.LineIsEmpty())
+          continue;
+        TString varname, varvalue;
+        if (mapstr.HasVariablePair("=",varname,varvalue))
+          continue;
+        TString device_type = mapstr.GetTypedNextToken<TString>();
+        TString device_name = mapstr.GetTypedNextToken<TString>();
+        if (! this->HasEventCutDevice(device_type, device_name)) {
+          QwError << GetName() << ": event cut for unknown device " << device_name
+                  << " of type " << device_type << " in " << filename << QwLog::endl;
+          status = kFALSE;
+        }
+      }
+      mapstr.Close();
+      return status;
+    };
+    /// \brief Does a line of the event cuts file refer to a known device
+    virtual Bool_t HasEventCutDevice(TString device_type, TString device_name) { return kTRUE; };
     /// \brief Apply the single event cuts
     virtual Bool_t ApplySingleEventCuts() = 0;
     /// \brief Report the number of events failed due to HW and event cut failures
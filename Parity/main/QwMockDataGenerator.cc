@@ -8,6 +8,7 @@
 
 // C and C++ headers
 #include <iostream>
+#include <map>
 
 // Boost math library for random number generation
 #include <boost/random.hpp>
@@ -49,6 +50,8 @@ int main(int argc, char* argv[])
 {
   // Define the command line options
   DefineOptionsParity(gQwOptions);
+  gQwOptions.AddOptions()("mock-epics", po::value<std::string>()->default_value(""),
+      "file with the EPICS events to write, one 'event tag value' per line, written before that event");
 
   ///  Without anything, print usage
   if (argc == 1) {
@@ -151,6 +154,24 @@ if(1==2){
 */
 
 
+  // EPICS values by the event before which they are written
+  std::map<Int_t, std::string> epics;
+  std::string epicsfile = gQwOptions.GetValue<std::string>("mock-epics");
+  if (epicsfile.size() > 0) {
+    QwParameterFile epicsmap(epicsfile);
+    while (epicsmap.ReadNextLine()) {
+      epicsmap.TrimComment();
+      epicsmap.TrimWhitespace();
+      if (epicsmap.LineIsEmpty()) continue;
+      Int_t event = atoi(epicsmap.GetNextToken(" \t").c_str());
+      std::string tag = epicsmap.GetNextToken(" \t");
+      std::string value = epicsmap.GetNextToken(" \t");
+      epics[event] += tag + " " + value + "\n";
+    }
+    QwMessage << "Writing " << epics.size() << " mock EPICS events from "
+              << epicsfile << QwLog::endl;
+  }
+
   // Initialize randomness provider and distribution
   boost::mt19937 randomnessGenerator(999); // Mersenne twister with seed (see below)
   boost::normal_distribution<double> normalDistribution;
@@ -297,6 +318,10 @@ if(1==2){
       detchannels[i]->RandomizeMollerEvent(myhelicity);
       }
 
+      // Write the EPICS event before this event
+      if (epics.count(event) > 0)
+        eventbuffer.EncodeEPICSEvent(epics[event]);
+
       // Write this event to file
       eventbuffer.EncodeSubsystemData(detectors);
 
@@ -11,6 +11,7 @@
 #include <fstream>
 #include <vector>
 #include <new>
+#include <algorithm>
 
 // Boost headers
 #include <boost/shared_ptr.hpp>
@@ -19,6 +20,7 @@
 #include "Rtypes.h"
 #include "TROOT.h"
 #include "TFile.h"
+#include "TObjString.h"
 
 // Qweak headers
 #include "QwLog.h"
@@ -40,6 +42,10 @@
 #include "LRBCorrector.h"
 #include "QwExtractor.h"
 #include "QwDataHandlerArray.h"
+#include "QwReplayMemo.h"
+#include "QwAnalysisPipeline.h"
+#include "QwConfigReload.h"
+#include "QwQuickLookSampler.h"
 
 // Qweak subsystems
 // (for correct dependency generation)
@@ -91,6 +97,9 @@ Int_t main(Int_t argc, Char_t* argv[])
   QwEventBuffer eventbuffer;
   eventbuffer.ProcessOptions(gQwOptions);
 
+  ///  Create the configuration reload on SIGHUP
+  QwConfigReload reload(gQwOptions);
+
   ///  Create the database connection
   #ifdef __USE_DATABASE__
   QwParityDB database(gQwOptions);
@@ -109,6 +118,8 @@ Int_t main(Int_t argc, Char_t* argv[])
 
     ///  Set the current event number for parameter file lookup
     QwParameterFile::SetCurrentRunNumber(run_number);
+    //  Forget the parameter files of the previous run
+    QwParameterFile::ClearOpenedFileList();
     //  Parse the options again, in case there are run-ranged config files
     gQwOptions.Parse(kTRUE);
     eventbuffer.ProcessOptions(gQwOptions);
@@ -132,120 +143,86 @@ Int_t main(Int_t argc, Char_t* argv[])
     //    QwCombinerSubsystem corrector_sub(gQwOptions, detectors, name);
     //    detectors.push_back(corrector_sub.GetSharedPointerToStaticObject());
     
-    /// Create the helicity pattern
-    //    Instead of having run_label in the constructor of helicitypattern, it might
-    //    make since to have it be an option for use globally
-    QwHelicityPattern helicitypattern(detectors,run_label);
-    helicitypattern.ProcessOptions(gQwOptions);
-    
-    ///  Create the event ring with the subsystem array
-    QwEventRing eventring(gQwOptions,detectors);
-    //  Make a copy of the detectors object to hold the
-    //  events which pass through the ring.
-    QwSubsystemArrayParity ringoutput(detectors);
-
-    /// Create the data handler arrays
-    QwDataHandlerArray datahandlerarray_evt(gQwOptions,ringoutput,run_label);
-    QwDataHandlerArray datahandlerarray_mul(gQwOptions,helicitypattern,run_label);
-    QwDataHandlerArray datahandlerarray_burst(gQwOptions,helicitypattern,run_label);
-
-    ///  Create the burst sum
-    QwHelicityPattern patternsum_per_burst(helicitypattern);
-    patternsum_per_burst.DisablePairs();
-
-    ///  Create the running sum
-    QwSubsystemArrayParity eventsum(detectors);
-    QwHelicityPattern patternsum(helicitypattern);
-    patternsum.DisablePairs();
-    QwHelicityPattern burstsum(helicitypattern);
-    burstsum.DisablePairs();
+    ///  Create the downstream analysis pipelines: the standard configuration,
+    ///  and one for each option overlay, all fed by the same decoded events
+    std::vector<QwAnalysisPipeline*> pipelines;
+    pipelines.push_back(new QwAnalysisPipeline(gQwOptions, detectors, run_label));
+    std::vector<std::string> overlays = gQwOptions.GetValueVector<std::string>("analysis-branch");
+    std::vector<std::string> stems(1, gQwOptions.GetValue<std::string>("rootfiles")
+                                    + "/" + gQwOptions.GetValue<std::string>("rootfile-stem"));
+    for (size_t i = 0; i < overlays.size(); i++) {
+      gQwOptions.SetOverlayConfigFile(overlays.at(i));
+      std::string stem = gQwOptions.GetValue<std::string>("rootfiles")
+                       + "/" + gQwOptions.GetValue<std::string>("rootfile-stem");
+      if (std::find(stems.begin(), stems.end(), stem) != stems.end()) {
+        QwError << "Analysis branch " << overlays.at(i) << " must set a different "
+                << "rootfile-stem or rootfiles directory; branch is skipped" << QwLog::endl;
+        continue;
+      }
+      stems.push_back(stem);
+      QwMessage << "Creating analysis branch " << overlays.at(i) << QwLog::endl;
+      pipelines.push_back(new QwAnalysisPipeline(gQwOptions, detectors, run_label, overlays.at(i)));
+    }
+    gQwOptions.ClearOverlayConfigFile();
+
+    ///  The standard pipeline is used for the prompt summary and the database
+    QwAnalysisPipeline& primary = *pipelines.front();
+
+    ///  Quick-look sampling of blocks of patterns, if requested
+    QwQuickLookSampler sampler(gQwOptions);
+
+    //  Identify this replay by its inputs, now that all parameter files
+    //  are loaded, and skip it if it has been done before
+    QwReplayMemo memo(gQwOptions);
+    memo.ComputeHash(eventbuffer);
+    if (memo.Recall(gQwOptions.GetValue<std::string>("rootfiles"))) {
+      for (size_t i = 0; i < pipelines.size(); i++) delete pipelines.at(i);
+      eventbuffer.CloseStream();
+      continue;
+    }
 
     //  Initialize the database connection.
     #ifdef __USE_DATABASE__
     database.SetupOneRun(eventbuffer);
     #endif // __USE_DATABASE__
 
-    //  Open the ROOT file (close when scope ends)
-    QwRootFile *treerootfile  = NULL;
-    QwRootFile *burstrootfile = NULL;
-    QwRootFile *historootfile = NULL;
-
-
-    if (gQwOptions.GetValue<bool>("single-output-file")) {
-
-      treerootfile  = new QwRootFile(run_label);
-      burstrootfile = historootfile = treerootfile;
-      //  Construct a tree which contains map file names which are used to analyze data
-      treerootfile->WriteParamFileList("mapfiles", detectors);
-
-    } else {
-
-      treerootfile  = new QwRootFile(run_label + ".trees");
-      burstrootfile = new QwRootFile(run_label + ".bursts");
-      historootfile = new QwRootFile(run_label + ".histos");
-
-      //  Construct a tree which contains map file names which are used to analyze data
-      detectors.PrintParamFileList();
-      treerootfile->WriteParamFileList("mapfiles", detectors);
-      burstrootfile->WriteParamFileList("mapfiles", detectors);
-      historootfile->WriteParamFileList("mapfiles", detectors);
+    //  Open the ROOT files (closed at the end of the run), each with
+    //  the options of its own pipeline
+    for (size_t i = 0; i < pipelines.size(); i++) {
+      if (i > 0) gQwOptions.SetOverlayConfigFile(pipelines.at(i)->GetName().Data());
+      pipelines.at(i)->OpenRootFiles(detectors, epicsevent);
     }
+    gQwOptions.ClearOverlayConfigFile();
+
     #ifdef __USE_DATABASE__
     if (database.AllowsWriteAccess()) {
       database.FillParameterFiles(detectors);
     }
     #endif // __USE_DATABASE__
-    //  Construct histograms
-    historootfile->ConstructHistograms("evt_histo", ringoutput);
-    historootfile->ConstructHistograms("mul_histo", helicitypattern);
-    burstrootfile->ConstructHistograms("burst_histo", patternsum_per_burst);
-    detectors.ShareHistograms(ringoutput);
-
-    //  Construct tree branches
-    treerootfile->ConstructTreeBranches("evt", "MPS event data tree", ringoutput);
-    treerootfile->ConstructTreeBranches("mul", "Helicity event data tree", helicitypattern);
-    burstrootfile->ConstructTreeBranches("pr", "Pair tree", helicitypattern.GetPairYield(),"yield_");
-    burstrootfile->ConstructTreeBranches("pr", "Pair tree", helicitypattern.GetPairAsymmetry(),"asym_");
-    treerootfile->ConstructTreeBranches("slow", "EPICS and slow control tree", epicsevent);
-    burstrootfile->ConstructTreeBranches("burst", "Burst level data tree", patternsum_per_burst, "|stat");
-
-    historootfile->ConstructHistograms("evt_histo",   datahandlerarray_evt);
-    historootfile->ConstructHistograms("mul_histo",   datahandlerarray_mul);
-    burstrootfile->ConstructHistograms("burst_histo", datahandlerarray_burst);
-
-    datahandlerarray_evt.ConstructTreeBranches(treerootfile, "evt_");
-    datahandlerarray_mul.ConstructTreeBranches(treerootfile);
-    datahandlerarray_burst.ConstructTreeBranches(burstrootfile, "burst_", "|stat");
-
-    treerootfile->ConstructTreeBranches("evts", "Running sum tree", eventsum, "|stat");
-    treerootfile->ConstructTreeBranches("muls", "Running sum tree", patternsum, "|stat");
-    burstrootfile->ConstructTreeBranches("bursts", "Burst running sum tree", burstsum, "|stat");
-
-    // Summarize the ROOT file structure
-    //treerootfile->PrintTrees();
-    //treerootfile->PrintDirs();
-
-
-    //  Clear the single-event running sum at the beginning of the runlet
-    eventsum.ClearEventData();
-    patternsum.ClearEventData();
-    burstsum.ClearEventData();
-    //  Clear the running sum of the burst values at the beginning of the runlet
-    helicitypattern.ClearEventData();
-    patternsum_per_burst.ClearEventData();
 
+    //  Record the replay hash and the final names of the output files
+    std::vector<TString> outputfiles;
+    if (memo.GetHash().Length() > 0) {
+      for (size_t i = 0; i < pipelines.size(); i++) {
+        pipelines.at(i)->WriteReplayHash(memo.GetHash());
+        const std::vector<TString>& names = pipelines.at(i)->GetRootFileNames();
+        outputfiles.insert(outputfiles.end(), names.begin(), names.end());
+      }
+    }
 
 
     //  Load the blinder seed from a random number generator for online mode
-    if (eventbuffer.IsOnline() ){      
-      helicitypattern.UpdateBlinder();//this routine will call update blinder mechanism using a random number
-    }else{
-      //  Load the blinder seed from the database for this runlet.
+    for (size_t i = 0; i < pipelines.size(); i++) {
+      if (eventbuffer.IsOnline() ){
+        pipelines.at(i)->GetHelicityPattern().UpdateBlinder();//this routine will call update blinder mechanism using a random number
+      }else{
+        //  Load the blinder seed from the database for this runlet.
 #ifdef __USE_DATABASE__
-      helicitypattern.UpdateBlinder(&database);
-#endif // __USE_DATABASE__      
+        pipelines.at(i)->GetHelicityPattern().UpdateBlinder(&database);
+#endif // __USE_DATABASE__
+      }
     }
-    
+
 
     //  Find the first EPICS event and try to initialize
     //  the blinder, but only for disk files, not online.
@@ -255,7 +232,8 @@ Int_t main(Int_t argc, Char_t* argv[])
 	if (eventbuffer.IsEPICSEvent()) {
 	  eventbuffer.FillEPICSData(epicsevent);
 	  if (epicsevent.HasDataLoaded()) {
-	    helicitypattern.UpdateBlinder(epicsevent);
+	    for (size_t i = 0; i < pipelines.size(); i++)
+	      pipelines.at(i)->GetHelicityPattern().UpdateBlinder(epicsevent);
 	    // and break out of this event loop
 	    break;
 	  }
@@ -268,6 +246,7 @@ Int_t main(Int_t argc, Char_t* argv[])
     }
 
     ///  Start loop over events
+    Bool_t run_start_known = kFALSE;
     while (eventbuffer.GetNextEvent() == CODA_OK) {
 
       //  First, do processing of non-physics events...
@@ -283,10 +262,8 @@ Int_t main(Int_t argc, Char_t* argv[])
         eventbuffer.FillEPICSData(epicsevent);
 	if (epicsevent.HasDataLoaded()){
 	  epicsevent.CalculateRunningValues();
-	  helicitypattern.UpdateBlinder(epicsevent);
-	
-	  treerootfile->FillTreeBranches(epicsevent);
-	  treerootfile->FillTree("slow");
+	  for (size_t i = 0; i < pipelines.size(); i++)
+	    pipelines.at(i)->ProcessEPICSEvent(epicsevent);
 	}
       }
 
@@ -295,6 +272,14 @@ Int_t main(Int_t argc, Char_t* argv[])
       if (! eventbuffer.IsPhysicsEvent()) continue;
 
 
+      //  Record the start of the run once the go event has been read
+      if (! run_start_known && eventbuffer.GetStartUnixTime() > 0) {
+        for (size_t i = 0; i < pipelines.size(); i++)
+          pipelines.at(i)->SetRunStartTime(eventbuffer.GetStartUnixTime());
+        run_start_known = kTRUE;
+      }
+
+
       //  Fill the subsystem objects with their respective data for this event.
       eventbuffer.FillSubsystemData(detectors);
 
@@ -304,244 +289,44 @@ Int_t main(Int_t argc, Char_t* argv[])
 
       // The event pass the event cut constraints
       if (detectors.ApplySingleEventCuts()) {
-	
-        // Add event to the ring
-        eventring.push(detectors);
-
-        // Check to see ring is ready
-        if (eventring.IsReady()) {
-	  ringoutput = eventring.pop();
-	  ringoutput.IncrementErrorCounters();
-
-
-	  // Accumulate the running sum to calculate the event based running average
-	  eventsum.AccumulateRunningSum(ringoutput);
-
-	  // Fill the histograms
-	  historootfile->FillHistograms(ringoutput);
-
-	  // Fill mps tree branches
-	  treerootfile->FillTreeBranches(ringoutput);
-	  treerootfile->FillTree("evt");
-
-	  // Process data handlers
-          datahandlerarray_evt.ProcessDataHandlerEntry();
-
-          // Fill data handler histograms
-          historootfile->FillHistograms(datahandlerarray_evt);
-
-          // Fill data handler tree branches
-          datahandlerarray_evt.FillTreeBranches(treerootfile);
-
-          // Load the event into the helicity pattern
-          helicitypattern.LoadEventData(ringoutput);
-
-	  if (helicitypattern.PairAsymmetryIsGood()) {
-            patternsum.AccumulatePairRunningSum(helicitypattern);
-
-	    // Fill pair tree branches
-	    treerootfile->FillTreeBranches(helicitypattern.GetPairYield());
-	    treerootfile->FillTreeBranches(helicitypattern.GetPairAsymmetry());
-	    treerootfile->FillTreeBranches(helicitypattern.GetPairDifference());
-	    treerootfile->FillTree("pr");
-	    
-	    // Clear the data
-	    helicitypattern.ClearPairData();
-	  }
-
-          // Check to see if we can calculate helicity pattern asymmetry, do so, and report if it worked
-          if (helicitypattern.IsGoodAsymmetry()) {
-              patternsum.AccumulateRunningSum(helicitypattern);
 
-              // Fill histograms
-              historootfile->FillHistograms(helicitypattern);
-
-              // Fill helicity tree branches
-              treerootfile->FillTreeBranches(helicitypattern);
-              treerootfile->FillTree("mul");
-
-              // Process data handlers
-              datahandlerarray_mul.ProcessDataHandlerEntry();
-              datahandlerarray_burst.ProcessDataHandlerEntry();
-
-              // Fill data handler histograms
-              historootfile->FillHistograms(datahandlerarray_mul);
-
-              // Fill data handler tree branches
-              datahandlerarray_mul.FillTreeBranches(treerootfile);
-
-              // Fill the pattern into the sum for this burst
-              patternsum_per_burst.AccumulateRunningSum(helicitypattern);
-
-              // Accumulate data handler arrays
-              //datahandlerarray_burst.AccumulateRunningSum(datahandlerarray_mul);
-
-              // Burst mode
-              if (patternsum_per_burst.IsEndOfBurst()) {
-
-                // Calculate average over this burst
-                patternsum_per_burst.CalculateRunningAverage();
-
-                // Fill the burst into the sum over all bursts
-                burstsum.AccumulateRunningSum(patternsum_per_burst);
-
-                if (gQwOptions.GetValue<bool>("print-burstsum")) {
-                  QwMessage << " Running average of this burst" << QwLog::endl;
-                  QwMessage << " =============================" << QwLog::endl;
-                  patternsum_per_burst.PrintValue();
-                }
-
-                // Fill histograms
-                burstrootfile->FillHistograms(patternsum_per_burst);
-
-                // Fill burst tree branches
-                burstrootfile->FillTreeBranches(patternsum_per_burst);
-                burstrootfile->FillTree("burst");
-
-                // Finish data handler for burst
-                datahandlerarray_burst.FinishDataHandler();
-
-                // Fill data handler histograms
-                burstrootfile->FillHistograms(datahandlerarray_burst);
-
-                // Fill data handler tree branches
-                datahandlerarray_burst.FillTreeBranches(burstrootfile);
-
-		helicitypattern.IncrementBurstCounter();
-		datahandlerarray_mul.UpdateBurstCounter(helicitypattern.GetBurstCounter());
-		datahandlerarray_burst.UpdateBurstCounter(helicitypattern.GetBurstCounter());
-                // Clear the data
-                patternsum_per_burst.ClearEventData();
-                datahandlerarray_burst.ClearEventData();
-              }
-
-              // Clear the data
-              helicitypattern.ClearEventData();
-
-	  } // helicitypattern.IsGoodAsymmetry()
-
-        } // eventring.IsReady()
+        // Pass the event to the downstream analysis
+        for (size_t i = 0; i < pipelines.size(); i++)
+          pipelines.at(i)->ProcessEvent(detectors);
 
       } // detectors.ApplySingleEventCuts()
 
-    } // end of loop over events
-    
-    // Unwind event ring
-    QwMessage << "Unwinding event ring" << QwLog::endl;
-    eventring.Unwind();
-
-    //  TODO Drain event run
-
-    //  Finalize burst
-    if (patternsum_per_burst.HasBurstData()){
-      // Calculate average over this burst
-      patternsum_per_burst.CalculateRunningAverage();
-
-      // Fill the burst into the sum over all bursts
-      burstsum.AccumulateRunningSum(patternsum_per_burst);
-
-      if (gQwOptions.GetValue<bool>("print-burstsum")) {
-	QwMessage << " Running average of this burst" << QwLog::endl;
-	QwMessage << " =============================" << QwLog::endl;
-	patternsum_per_burst.PrintValue();
-      }
-
-      // Fill histograms
-      burstrootfile->FillHistograms(patternsum_per_burst);
+      //  Reload the configuration between two patterns when requested
+      reload.ProcessEvent(detectors, pipelines, eventbuffer.GetPhysicsEventNumber());
 
-      // Fill burst tree branches
-      burstrootfile->FillTreeBranches(patternsum_per_burst);
-      burstrootfile->FillTree("burst");
-    
-      // Finish data handler for burst
-      datahandlerarray_burst.FinishDataHandler();
+      //  Jump to the next sampled block in a quick-look replay
+      sampler.ProcessEvent(eventbuffer, pipelines);
 
-      // Fill data handler histograms
-      burstrootfile->FillHistograms(datahandlerarray_burst);
-
-      // Fill data handler tree branches
-      datahandlerarray_burst.FillTreeBranches(burstrootfile);
-      patternsum_per_burst.PrintIndexMapFile(run_number);
-    }
+    } // end of loop over events
 
-    //  Perform actions at the end of the event loop on the
-    //  detectors object, which ought to have handles for the
-    //  MPS based histograms.
-    ringoutput.AtEndOfEventLoop();
+    //  Unwind the event rings and finish the last bursts
+    for (size_t i = 0; i < pipelines.size(); i++)
+      pipelines.at(i)->FinishEventLoop(run_number);
 
     QwMessage << "Number of events processed at end of run: "
               << eventbuffer.GetPhysicsEventNumber() << QwLog::endl;
 
-    // Finish data handlers
-    datahandlerarray_evt.FinishDataHandler();
-    datahandlerarray_mul.FinishDataHandler();
-
-    // Calculate running averages
-    eventsum.CalculateRunningAverage();
-    patternsum.CalculateRunningAverage();
-    burstsum.CalculateRunningAverage();
+    //  Record the sampling fraction of a quick-look replay
+    sampler.WriteSamplingRecord(pipelines);
 
-    // This will calculate running averages over single helicity events
-    if (gQwOptions.GetValue<bool>("print-runningsum")) {
-      QwMessage << " Running average of events" << QwLog::endl;
-      QwMessage << " =========================" << QwLog::endl;
-      eventsum.PrintValue();
-    }
-    treerootfile->FillTreeBranches(eventsum);
-    treerootfile->FillTree("evts");
-
-    if (gQwOptions.GetValue<bool>("print-patternsum")) {
-      QwMessage << " Running average of patterns" << QwLog::endl;
-      QwMessage << " =========================" << QwLog::endl;
-      patternsum.PrintValue();
-    }
-    treerootfile->FillTreeBranches(patternsum);
-    treerootfile->FillTree("muls");
+    //  Finish the pipelines and close their ROOT files
+    for (size_t i = 0; i < pipelines.size(); i++)
+      pipelines.at(i)->FinishRun();
 
-    if (gQwOptions.GetValue<bool>("print-burstsum")) {
-      QwMessage << " Running average of bursts" << QwLog::endl;
-      QwMessage << " =========================" << QwLog::endl;
-      burstsum.PrintValue();
-    }
-    burstrootfile->FillTreeBranches(burstsum);
-    burstrootfile->FillTree("bursts");
-
-    //  Construct objects
-    treerootfile->ConstructObjects("objects", helicitypattern);
-
-    /*  Write to the root file, being sure to delete the old cycles  *
-     *  which were written by Autosave.                              *
-     *  Doing this will remove the multiple copies of the ntuples    *
-     *  from the root file.                                          *
-     *                                                               *
-     *  Then, we need to delete the histograms here.                 *
-     *  If we wait until the subsystem destructors, we get a         *
-     *  segfault; but in addition to that we should delete them      *
-     *  here, in case we run over multiple runs at a time.           */
-    if (treerootfile == historootfile) {
-      treerootfile->Write(0,TObject::kOverwrite);
-      delete treerootfile; treerootfile = 0; burstrootfile = 0; historootfile = 0;
-    } else {
-      treerootfile->Write(0,TObject::kOverwrite);
-      burstrootfile->Write(0,TObject::kOverwrite);
-      historootfile->Write(0,TObject::kOverwrite);
-      delete treerootfile; treerootfile = 0;
-      delete burstrootfile; burstrootfile = 0;
-      delete historootfile; historootfile = 0;
-    }
+    //  Register the output files under the replay hash
+    memo.Store(outputfiles);
 
-    //  Print the event cut error summary for each subsystem
-    if (gQwOptions.GetValue<bool>("print-errorcounters")) {
-      QwMessage << " ------------ error counters ------------------ " << QwLog::endl;
-      ringoutput.PrintErrorCounters();
-    }
-    
     if (gQwOptions.GetValue<bool>("write-promptsummary")) {
       //      runningsum.WritePromptSummary(&promptsummary, "yield");
       // runningsum.WritePromptSummary(&promptsummary, "asymmetry");
       //      runningsum.WritePromptSummary(&promptsummary, "difference");
-      datahandlerarray_mul.WritePromptSummary(&promptsummary, "asymmetry");
-      patternsum.WritePromptSummary(&promptsummary);
+      primary.GetPatternDataHandlers().WritePromptSummary(&promptsummary, "asymmetry");
+      primary.GetPatternSum().WritePromptSummary(&promptsummary);
       promptsummary.PrintCSV(eventbuffer.GetPhysicsEventNumber(),eventbuffer.GetStartSQLTime(), eventbuffer.GetEndSQLTime());
     }
     //  Read from the database
@@ -550,11 +335,11 @@ Int_t main(Int_t argc, Char_t* argv[])
 
     // Each subsystem has its own Connect() and Disconnect() functions.
     if (database.AllowsWriteAccess()) {
-      patternsum.FillDB(&database);
-      patternsum.FillErrDB(&database);
+      primary.GetPatternSum().FillDB(&database);
+      primary.GetPatternSum().FillErrDB(&database);
       epicsevent.FillDB(&database);
-      helicitypattern.return_running_combiner().FillDB(&database,"asymmetry");
-      ringoutput.FillDB_MPS(&database, "optics");
+      primary.GetHelicityPattern().return_running_combiner().FillDB(&database,"asymmetry");
+      primary.GetRingOutput().FillDB_MPS(&database, "optics");
     }
     #endif // __USE_DATABASE__    
   
@@ -563,7 +348,8 @@ Int_t main(Int_t argc, Char_t* argv[])
     //  Close event buffer stream
     eventbuffer.CloseStream();
 
-
+    //  Delete the pipelines
+    for (size_t i = 0; i < pipelines.size(); i++) delete pipelines.at(i);
 
     //  Report run summary
     eventbuffer.ReportRunSummary();
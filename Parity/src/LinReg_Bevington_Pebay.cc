@@ -42,6 +42,8 @@ void LinRegBevPeb::init()
   mMP.ResizeTo(nP);
   mMY.ResizeTo(nY);
   mMYp.ResizeTo(nY);
+  fDeltaP.ResizeTo(nP);
+  fDeltaY.ResizeTo(nY);
 
   mVPP.ResizeTo(nP,nP);
   mVPY.ResizeTo(nP,nY);
@@ -150,20 +152,22 @@ LinRegBevPeb& LinRegBevPeb::operator+=(const std::pair<TVectorD,TVectorD>& rhs)
     mMP = P;
     mMY = Y;
   } else {
-    // Deviations from mean
-    TVectorD delta_y(Y - mMY);
-    TVectorD delta_p(P - mMP);
+    // Deviations from mean (in place, without temporaries)
+    fDeltaY = Y;
+    fDeltaY -= mMY;
+    fDeltaP = P;
+    fDeltaP -= mMP;
 
     // Update covariances
     Double_t alpha = (fGoodEventNumber - 1.0) / fGoodEventNumber;
-    mVPP.Rank1Update(delta_p, alpha);
-    mVPY.Rank1Update(delta_p, delta_y, alpha);
-    mVYY.Rank1Update(delta_y, alpha);
+    mVPP.Rank1Update(fDeltaP, alpha);
+    mVPY.Rank1Update(fDeltaP, fDeltaY, alpha);
+    mVYY.Rank1Update(fDeltaY, alpha);
 
     // Update means
     Double_t beta = 1.0 / fGoodEventNumber;
-    mMP += delta_p * beta;
-    mMY += delta_y * beta;
+    Add(mMP, beta, fDeltaP);
+    Add(mMY, beta, fDeltaY);
   }
 
   return *this;
@@ -187,23 +191,25 @@ LinRegBevPeb& LinRegBevPeb::operator+=(const LinRegBevPeb& rhs)
     return *this;
 
   // Deviations from mean
-  TVectorD delta_y(mMY - rhs.mMY);
-  TVectorD delta_p(mMP - rhs.mMP);
+  fDeltaY = mMY;
+  fDeltaY -= rhs.mMY;
+  fDeltaP = mMP;
+  fDeltaP -= rhs.mMP;
 
   // Update covariances
-  Double_t alpha = fGoodEventNumber * rhs.fGoodEventNumber
+  Double_t alpha = Double_t(fGoodEventNumber) * rhs.fGoodEventNumber
                 / (fGoodEventNumber + rhs.fGoodEventNumber);
   mVYY += rhs.mVYY;
-  mVYY.Rank1Update(delta_y, alpha);
+  mVYY.Rank1Update(fDeltaY, alpha);
   mVPY += rhs.mVPY;
-  mVPY.Rank1Update(delta_p, delta_y, alpha);
+  mVPY.Rank1Update(fDeltaP, fDeltaY, alpha);
   mVPP += rhs.mVPP;
-  mVPP.Rank1Update(delta_p, alpha);
+  mVPP.Rank1Update(fDeltaP, alpha);
 
   // Update means
-  Double_t beta = rhs.fGoodEventNumber / (fGoodEventNumber + rhs.fGoodEventNumber);
-  mMY += delta_y * beta;
-  mMP += delta_p * beta;
+  Double_t beta = Double_t(rhs.fGoodEventNumber) / (fGoodEventNumber + rhs.fGoodEventNumber);
+  Add(mMY, -beta, fDeltaY);
+  Add(mMP, -beta, fDeltaP);
 
   fGoodEventNumber += rhs.fGoodEventNumber;
 
@@ -317,6 +323,30 @@ Int_t LinRegBevPeb::getCovarianceY( int i, int j, Double_t &covar) const
     return 0;
 }
 
+//==========================================================
+//==========================================================
+Int_t LinRegBevPeb::getSlope( int ip, int iy, Double_t &slope) const
+{
+    slope=-1e50;
+    if(ip<0 || ip >= nP ) return -11;
+    if(iy<0 || iy >= nY ) return -12;
+    if( fErrorFlag != 0) return -13;
+    slope=Axy(ip,iy);
+    return 0;
+}
+
+//==========================================================
+//==========================================================
+Int_t LinRegBevPeb::getSlopeError( int ip, int iy, Double_t &dslope) const
+{
+    dslope=-1e50;
+    if(ip<0 || ip >= nP ) return -11;
+    if(iy<0 || iy >= nY ) return -12;
+    if( fErrorFlag != 0) return -13;
+    dslope=dAxy(ip,iy);
+    return 0;
+}
+
 //==========================================================
 //==========================================================
 void LinRegBevPeb::printSummaryP() const
@@ -217,6 +217,55 @@ Int_t QwAlarmHandler::ConnectChannels(
   return 0;
 }
 
+/** Read the map file again into a handler which is connected to the
+ *  same helicity pattern
+ *
+ * @return True if all alarms of the map file refer to existing channels
+ */
+Bool_t QwAlarmHandler::PrepareReload()
+{
+  if (fHelicityPattern == NULL) return kFALSE;
+  QwAlarmHandler reload(fName);
+  reload.LoadChannelMap(fMapFile);
+  reload.ConnectChannels(fHelicityPattern->GetYield(),
+                         fHelicityPattern->GetAsymmetry(),
+                         fHelicityPattern->GetDifference());
+  Bool_t status = kTRUE;
+  for (size_t i = 0; i < reload.fAlarmObjectList.size(); i++) {
+    alarmObject& alarm = reload.fAlarmObjectList.at(i);
+    if (alarm.analysisType != kHandleTypeMps && alarm.value == NULL) {
+      QwError << "QwAlarmHandler " << fName << ": channel "
+              << (alarm.alarmParameterMapStr.count("Type-Name")?
+                  alarm.alarmParameterMapStr.at("Type-Name"): "(none)")
+              << " in " << fMapFile << " does not exist" << QwLog::endl;
+      status = kFALSE;
+    }
+  }
+  fReloadAlarmObjectList.swap(reload.fAlarmObjectList);
+  return status;
+}
+
+void QwAlarmHandler::ApplyReload()
+{
+  // Keep the violation history of alarms on the same channel
+  for (size_t i = 0; i < fReloadAlarmObjectList.size(); i++) {
+    alarmObject& alarm = fReloadAlarmObjectList.at(i);
+    for (size_t j = 0; j < fAlarmObjectList.size(); j++) {
+      const alarmObject& previous = fAlarmObjectList.at(j);
+      if (previous.alarmParameterMapStr.count("Type-Name")
+       && alarm.alarmParameterMapStr.count("Type-Name")
+       && previous.alarmParameterMapStr.at("Type-Name") == alarm.alarmParameterMapStr.at("Type-Name")) {
+        alarm.alarmStatus = previous.alarmStatus;
+        alarm.Nviolated = previous.Nviolated;
+        alarm.NsinceLastViolation = previous.NsinceLastViolation;
+        break;
+      }
+    }
+  }
+  fAlarmObjectList.swap(fReloadAlarmObjectList);
+  fReloadAlarmObjectList.clear();
+}
+
 /** Connect to the dependent and independent channels
  *
  * @param event Helicity event structure
@@ -0,0 +1,584 @@
+/*!
+ * \file   QwAnalysisPipeline.cc
+ * \brief  Downstream analysis of decoded events: ring, patterns, handlers, output
+ */
+
+#include "QwAnalysisPipeline.h"
+
+// ROOT headers
+#include "TObjString.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwRootFile.h"
+#include "QwEPICSEvent.h"
+#include "QwEPICSCarryForward.h"
+#include "QwCutScan.h"
+#include "QwTimeSeries.h"
+#include "QwHelicity.h"
+
+/**
+ * Create the pipeline objects from the options that are currently in
+ * effect (including any option overlay for this pipeline).
+ */
+QwAnalysisPipeline::QwAnalysisPipeline(QwOptions& options,
+    QwSubsystemArrayParity& detectors,
+    const TString& run_label, const TString& name)
+  : fName(name), fRunLabel(run_label),
+    fTreeRootFile(0), fBurstRootFile(0), fHistoRootFile(0), fReloadCount(0),
+    fReloadPending(kFALSE), fReloadPattern(-1), fRingHelicity(0),
+    fGoodPatternCount(0), fLastPushedEvent(0)
+{
+  fSingleOutputFile   = options.GetValue<bool>("single-output-file");
+  fPrintErrorCounters = options.GetValue<bool>("print-errorcounters");
+  fPrintRunningSum    = options.GetValue<bool>("print-runningsum");
+  fPrintPatternSum    = options.GetValue<bool>("print-patternsum");
+  fPrintBurstSum      = options.GetValue<bool>("print-burstsum");
+
+  /// Create the helicity pattern
+  fHelicityPattern = new QwHelicityPattern(detectors, run_label);
+  fHelicityPattern->ProcessOptions(options);
+
+  ///  Create the event ring with the subsystem array
+  fEventRing = new QwEventRing(options, detectors);
+  //  Make a copy of the detectors object to hold the
+  //  events which pass through the ring.
+  fRingOutput = new QwSubsystemArrayParity(detectors);
+
+  /// Create the data handler arrays
+  fDataHandlerArrayEvt   = new QwDataHandlerArray(options, *fRingOutput, run_label);
+  fDataHandlerArrayMul   = new QwDataHandlerArray(options, *fHelicityPattern, run_label);
+  fDataHandlerArrayBurst = new QwDataHandlerArray(options, *fHelicityPattern, run_label);
+
+  ///  Create the burst sum
+  fPatternSumPerBurst = new QwHelicityPattern(*fHelicityPattern);
+  fPatternSumPerBurst->DisablePairs();
+
+  ///  Create the running sum
+  fEventSum = new QwSubsystemArrayParity(detectors);
+  fPatternSum = new QwHelicityPattern(*fHelicityPattern);
+  fPatternSum->DisablePairs();
+  fBurstSum = new QwHelicityPattern(*fHelicityPattern);
+  fBurstSum->DisablePairs();
+
+  ///  Create the EPICS values for the pattern and burst trees
+  fEPICSCarryForward = new QwEPICSCarryForward(options);
+
+  ///  Create the conditions which end bursts early
+  fBurstSegmentation = new QwBurstSegmentation(options);
+
+  ///  Create the scan of cut thresholds
+  fCutScan = new QwCutScan(options);
+
+  ///  Create the time series of selected channels
+  fTimeSeries = new QwTimeSeriesWriter(options);
+}
+
+QwAnalysisPipeline::~QwAnalysisPipeline()
+{
+  delete fTimeSeries;
+  delete fCutScan;
+  delete fBurstSegmentation;
+  delete fEPICSCarryForward;
+  delete fBurstSum;
+  delete fPatternSum;
+  delete fEventSum;
+  delete fPatternSumPerBurst;
+  delete fDataHandlerArrayBurst;
+  delete fDataHandlerArrayMul;
+  delete fDataHandlerArrayEvt;
+  delete fRingOutput;
+  delete fEventRing;
+  delete fHelicityPattern;
+}
+
+void QwAnalysisPipeline::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Analysis branches")
+    ("analysis-branch", po::value<std::vector<std::string> >()->composing(),
+     "config file with option overrides for an additional analysis of the same decoded events\n(must set a different rootfile-stem)");
+}
+
+/**
+ * Open the output ROOT files, using the options that are currently in
+ * effect, and construct the histograms and tree branches.
+ */
+void QwAnalysisPipeline::OpenRootFiles(QwSubsystemArrayParity& detectors, QwEPICSEvent& epicsevent)
+{
+  if (fSingleOutputFile) {
+
+    fTreeRootFile  = new QwRootFile(fRunLabel);
+    fBurstRootFile = fHistoRootFile = fTreeRootFile;
+    //  Construct a tree which contains map file names which are used to analyze data
+    fTreeRootFile->WriteParamFileList("mapfiles", detectors);
+
+    fRootFileNames.push_back(fTreeRootFile->GetPermanentName());
+
+  } else {
+
+    fTreeRootFile  = new QwRootFile(fRunLabel + ".trees");
+    fBurstRootFile = new QwRootFile(fRunLabel + ".bursts");
+    fHistoRootFile = new QwRootFile(fRunLabel + ".histos");
+
+    //  Construct a tree which contains map file names which are used to analyze data
+    detectors.PrintParamFileList();
+    fTreeRootFile->WriteParamFileList("mapfiles", detectors);
+    fBurstRootFile->WriteParamFileList("mapfiles", detectors);
+    fHistoRootFile->WriteParamFileList("mapfiles", detectors);
+
+    fRootFileNames.push_back(fTreeRootFile->GetPermanentName());
+    fRootFileNames.push_back(fBurstRootFile->GetPermanentName());
+    fRootFileNames.push_back(fHistoRootFile->GetPermanentName());
+  }
+
+  //  Construct histograms
+  fHistoRootFile->ConstructHistograms("evt_histo", *fRingOutput);
+  fHistoRootFile->ConstructHistograms("mul_histo", *fHelicityPattern);
+  fBurstRootFile->ConstructHistograms("burst_histo", *fPatternSumPerBurst);
+  //  The detectors can only share the histograms of one pipeline
+  if (IsPrimary()) detectors.ShareHistograms(*fRingOutput);
+
+  //  Construct tree branches
+  fTreeRootFile->ConstructTreeBranches("evt", "MPS event data tree", *fRingOutput);
+  fTreeRootFile->ConstructTreeBranches("mul", "Helicity event data tree", *fHelicityPattern);
+  fBurstRootFile->ConstructTreeBranches("pr", "Pair tree", fHelicityPattern->GetPairYield(),"yield_");
+  fBurstRootFile->ConstructTreeBranches("pr", "Pair tree", fHelicityPattern->GetPairAsymmetry(),"asym_");
+  fTreeRootFile->ConstructTreeBranches("slow", "EPICS and slow control tree", epicsevent);
+  fBurstRootFile->ConstructTreeBranches("burst", "Burst level data tree", *fPatternSumPerBurst, "|stat");
+  fEPICSCarryForward->ConnectTags(epicsevent);
+  if (fEPICSCarryForward->IsEnabled()) {
+    fTreeRootFile->ConstructTreeBranches("mul", "Helicity event data tree", *fEPICSCarryForward);
+    fBurstRootFile->ConstructTreeBranches("burst", "Burst level data tree", *fEPICSCarryForward);
+  }
+  fBurstSegmentation->ConnectChannels(*fRingOutput, epicsevent);
+  fBurstRootFile->ConstructTreeBranches("burst", "Burst level data tree", *fBurstSegmentation);
+  if (fCutScan->IsEnabled()) {
+    fCutScan->ConnectChannels(detectors, *fHelicityPattern, *fEventRing);
+    if (fCutScan->IsEnabled())
+      fTreeRootFile->ConstructTreeBranches("cutscan", "Cut scan tree", *fCutScan);
+  }
+  if (fTimeSeries->IsEnabled()) {
+    //  The time series file is written next to the tree file
+    TString filename = fTreeRootFile->GetPermanentName();
+    if (filename.EndsWith(".root")) filename.Remove(filename.Length() - 5);
+    fTimeSeries->ConnectChannels(*fRingOutput, filename + ".timeseries",
+        fRunLabel.Atoi());
+  }
+
+  fHistoRootFile->ConstructHistograms("evt_histo",   *fDataHandlerArrayEvt);
+  fHistoRootFile->ConstructHistograms("mul_histo",   *fDataHandlerArrayMul);
+  fBurstRootFile->ConstructHistograms("burst_histo", *fDataHandlerArrayBurst);
+
+  fDataHandlerArrayEvt->ConstructTreeBranches(fTreeRootFile, "evt_");
+  fDataHandlerArrayMul->ConstructTreeBranches(fTreeRootFile);
+  fDataHandlerArrayBurst->ConstructTreeBranches(fBurstRootFile, "burst_", "|stat");
+
+  fTreeRootFile->ConstructTreeBranches("evts", "Running sum tree", *fEventSum, "|stat");
+  fTreeRootFile->ConstructTreeBranches("muls", "Running sum tree", *fPatternSum, "|stat");
+  fBurstRootFile->ConstructTreeBranches("bursts", "Burst running sum tree", *fBurstSum, "|stat");
+
+  //  Clear the single-event running sum at the beginning of the runlet
+  fEventSum->ClearEventData();
+  fPatternSum->ClearEventData();
+  fBurstSum->ClearEventData();
+  //  Clear the running sum of the burst values at the beginning of the runlet
+  fHelicityPattern->ClearEventData();
+  fPatternSumPerBurst->ClearEventData();
+}
+
+void QwAnalysisPipeline::WriteReplayHash(const TString& hash)
+{
+  TObjString replay_hash(hash);
+  fTreeRootFile->WriteObject(&replay_hash, "replay_hash");
+  if (fBurstRootFile != fTreeRootFile) {
+    fBurstRootFile->WriteObject(&replay_hash, "replay_hash");
+    fHistoRootFile->WriteObject(&replay_hash, "replay_hash");
+  }
+}
+
+void QwAnalysisPipeline::ProcessEPICSEvent(QwEPICSEvent& epicsevent)
+{
+  fHelicityPattern->UpdateBlinder(epicsevent);
+  fEPICSCarryForward->Update(epicsevent, fLastPushedEvent);
+  fBurstSegmentation->ProcessEPICSEvent(epicsevent, fLastPushedEvent);
+
+  fTreeRootFile->FillTreeBranches(epicsevent);
+  fTreeRootFile->FillTree("slow");
+}
+
+void QwAnalysisPipeline::ProcessEvent(QwSubsystemArrayParity& detectors)
+{
+  // Evaluate the scanned cuts on the event entering the ring
+  if (fCutScan->IsEnabled()) fCutScan->PushEvent(detectors);
+
+  // Add event to the ring
+  fEventRing->push(detectors);
+  fLastPushedEvent = detectors.GetCodaEventNumber();
+
+  // Check to see ring is ready
+  if (! fEventRing->IsReady()) return;
+
+  ProcessRingOutput();
+}
+
+/**
+ * Take the next event out of the event ring, and analyze it with the
+ * helicity pattern and the data handlers.
+ */
+void QwAnalysisPipeline::ProcessRingOutput()
+{
+  *fRingOutput = fEventRing->pop();
+  fRingOutput->IncrementErrorCounters();
+
+  // Use a scheduled reload from the first event of its first pattern on
+  if (fReloadPending
+   && (fRingHelicity == 0 || fRingHelicity->GetPatternNumber() >= fReloadPattern))
+    ApplyReload();
+
+  // EPICS events which were decoded before this event
+  fEPICSCarryForward->ApplyUpdates(fRingOutput->GetCodaEventNumber());
+
+  // Check the conditions which end the burst
+  fBurstSegmentation->ProcessEvent(*fRingOutput);
+
+  // Add the event to the time series
+  if (fTimeSeries->IsEnabled()) fTimeSeries->ProcessEvent(*fRingOutput);
+
+  // Accumulate the running sum to calculate the event based running average
+  fEventSum->AccumulateRunningSum(*fRingOutput);
+
+  // Fill the histograms
+  fHistoRootFile->FillHistograms(*fRingOutput);
+
+  // Fill mps tree branches
+  fTreeRootFile->FillTreeBranches(*fRingOutput);
+  fTreeRootFile->FillTree("evt");
+
+  // Process data handlers
+  fDataHandlerArrayEvt->ProcessDataHandlerEntry();
+
+  // Fill data handler histograms
+  fHistoRootFile->FillHistograms(*fDataHandlerArrayEvt);
+
+  // Fill data handler tree branches
+  fDataHandlerArrayEvt->FillTreeBranches(fTreeRootFile);
+
+  // Load the event into the helicity pattern
+  fHelicityPattern->LoadEventData(*fRingOutput);
+  if (fCutScan->IsEnabled())
+    fCutScan->PopEvent(*fRingOutput, fHelicityPattern->GetPatternNumber());
+
+  if (fHelicityPattern->PairAsymmetryIsGood()) {
+    fPatternSum->AccumulatePairRunningSum(*fHelicityPattern);
+
+    // Fill pair tree branches
+    fTreeRootFile->FillTreeBranches(fHelicityPattern->GetPairYield());
+    fTreeRootFile->FillTreeBranches(fHelicityPattern->GetPairAsymmetry());
+    fTreeRootFile->FillTreeBranches(fHelicityPattern->GetPairDifference());
+    fTreeRootFile->FillTree("pr");
+
+    // Clear the data
+    fHelicityPattern->ClearPairData();
+  }
+
+  // Check to see if we can calculate helicity pattern asymmetry, do so, and report if it worked
+  if (fHelicityPattern->IsGoodAsymmetry()) {
+
+    // End the burst before this pattern if a condition requires it
+    if (fBurstSegmentation->IsBreakPending()) {
+      if (fPatternSumPerBurst->HasBurstData() && fPatternSumPerBurst->CanStartNewBurst()) {
+        FinishBurst(fBurstSegmentation->GetPendingReason());
+        StartNewBurst();
+      } else {
+        fBurstSegmentation->ClearPendingBreak();
+      }
+    }
+
+    fPatternSum->AccumulateRunningSum(*fHelicityPattern);
+    fGoodPatternCount++;
+    if (fCutScan->IsEnabled()) fCutScan->ProcessPattern(*fHelicityPattern);
+
+    // Fill histograms
+    fHistoRootFile->FillHistograms(*fHelicityPattern);
+
+    // Fill helicity tree branches
+    fTreeRootFile->FillTreeBranches(*fHelicityPattern);
+    fTreeRootFile->FillTreeBranches(*fEPICSCarryForward);
+    fTreeRootFile->FillTree("mul");
+
+    // Process data handlers
+    fDataHandlerArrayMul->ProcessDataHandlerEntry();
+    fDataHandlerArrayBurst->ProcessDataHandlerEntry();
+
+    // Fill data handler histograms
+    fHistoRootFile->FillHistograms(*fDataHandlerArrayMul);
+
+    // Fill data handler tree branches
+    fDataHandlerArrayMul->FillTreeBranches(fTreeRootFile);
+
+    // Fill the pattern into the sum for this burst
+    fPatternSumPerBurst->AccumulateRunningSum(*fHelicityPattern);
+
+    // Burst mode
+    if (fPatternSumPerBurst->IsEndOfBurst()) {
+      FinishBurst(QwBurstSegmentation::kBurstLength);
+      StartNewBurst();
+    }
+
+    // Clear the data
+    fHelicityPattern->ClearEventData();
+  }
+}
+
+void QwAnalysisPipeline::SetRunStartTime(Double_t start)
+{
+  if (fTimeSeries->IsEnabled()) fTimeSeries->SetRunStartTime(start);
+}
+
+/**
+ * Read the map files of the selected data handlers of all handler arrays
+ * again, without changing the configuration in use.
+ * @param targets Handler names, or "handlers" for all which can reload
+ * @param reloaded Names of the handlers which were read again
+ * @return False if a selected handler cannot use its new map file
+ */
+Bool_t QwAnalysisPipeline::PrepareReload(
+    const std::vector<std::string>& targets,
+    std::vector<TString>& reloaded)
+{
+  Bool_t status = kTRUE;
+  status &= fDataHandlerArrayEvt->PrepareReload(targets, reloaded);
+  status &= fDataHandlerArrayMul->PrepareReload(targets, reloaded);
+  status &= fDataHandlerArrayBurst->PrepareReload(targets, reloaded);
+  return status;
+}
+
+/**
+ * The data handlers change with the first event of the first pattern which
+ * leaves the event ring, so that the patterns of the events which are still
+ * in the ring are finished with the old configuration.
+ * @param detectors Subsystem array with the reloaded map files
+ * @param record Description of the reload
+ * @param first_pattern First pattern with the new configuration, or -1 for
+ *        the next event which leaves the event ring
+ */
+void QwAnalysisPipeline::ScheduleReload(QwSubsystemArrayParity& detectors,
+    const TString& record, Long_t first_pattern)
+{
+  //  Record the reload and the map files in effect in the tree file
+  TObjString reload(record);
+  fTreeRootFile->WriteObject(&reload, Form("config_reload_%d", fReloadCount));
+  fTreeRootFile->WriteParamFileList(Form("mapfiles_reload_%d", fReloadCount), detectors);
+  fReloadCount++;
+
+  fRingHelicity = 0;
+  if (first_pattern >= 0) {
+    std::vector<VQwSubsystem*> subsys_helicity = fRingOutput->GetSubsystemByType("QwHelicity");
+    if (subsys_helicity.size() > 0)
+      fRingHelicity = dynamic_cast<QwHelicity*>(subsys_helicity.at(0));
+  }
+  fReloadPattern = first_pattern;
+  fReloadPending = kTRUE;
+}
+
+void QwAnalysisPipeline::ApplyReload()
+{
+  fDataHandlerArrayEvt->ApplyReload();
+  fDataHandlerArrayMul->ApplyReload();
+  fDataHandlerArrayBurst->ApplyReload();
+  fReloadPending = kFALSE;
+}
+
+/**
+ * The events up to the next sampled block are skipped.  The events still in
+ * the event ring are analyzed first, since they were decoded and cut with
+ * this block; the pattern which they leave incomplete is discarded, and the
+ * ring starts empty with the new block, so that no pattern and no beam trip
+ * or burp cut spans the jump.  The burst ends before the first pattern of
+ * the new block.
+ */
+void QwAnalysisPipeline::StartSampleBlock()
+{
+  while (fEventRing->GetNumberOfEvents() > 0)
+    ProcessRingOutput();
+  fEventRing->Clear();
+  fHelicityPattern->ClearEventData();
+
+  fBurstSegmentation->StartSampleBlock();
+}
+
+void QwAnalysisPipeline::WriteSamplingRecord(const TString& record)
+{
+  TObjString sampling(record);
+  fTreeRootFile->WriteObject(&sampling, "quicklook_sampling");
+  if (fBurstRootFile != fTreeRootFile) {
+    fBurstRootFile->WriteObject(&sampling, "quicklook_sampling");
+    fHistoRootFile->WriteObject(&sampling, "quicklook_sampling");
+  }
+}
+
+void QwAnalysisPipeline::FinishBurst(QwBurstSegmentation::EQwBurstEndReason reason)
+{
+  // Record the reason for the end of this burst
+  fBurstSegmentation->EndBurst(reason);
+
+  // End the clusters of this burst in the burst-aligned trees
+  fTreeRootFile->EndBurst(fHelicityPattern->GetBurstCounter());
+
+  // Calculate average over this burst
+  fPatternSumPerBurst->CalculateRunningAverage();
+
+  // Fill the burst into the sum over all bursts
+  fBurstSum->AccumulateRunningSum(*fPatternSumPerBurst);
+
+  if (fPrintBurstSum) {
+    QwMessage << " Running average of this burst" << QwLog::endl;
+    QwMessage << " =============================" << QwLog::endl;
+    fPatternSumPerBurst->PrintValue();
+  }
+
+  // Fill histograms
+  fBurstRootFile->FillHistograms(*fPatternSumPerBurst);
+
+  // Fill burst tree branches
+  fBurstRootFile->FillTreeBranches(*fPatternSumPerBurst);
+  fBurstRootFile->FillTreeBranches(*fEPICSCarryForward);
+  fBurstRootFile->FillTreeBranches(*fBurstSegmentation);
+  fBurstRootFile->FillTree("burst");
+
+  // Finish data handler for burst
+  fDataHandlerArrayBurst->FinishDataHandler();
+
+  // Fill data handler histograms
+  fBurstRootFile->FillHistograms(*fDataHandlerArrayBurst);
+
+  // Fill data handler tree branches
+  fDataHandlerArrayBurst->FillTreeBranches(fBurstRootFile);
+}
+
+void QwAnalysisPipeline::StartNewBurst()
+{
+  fHelicityPattern->IncrementBurstCounter();
+  fDataHandlerArrayMul->UpdateBurstCounter(fHelicityPattern->GetBurstCounter());
+  fDataHandlerArrayBurst->UpdateBurstCounter(fHelicityPattern->GetBurstCounter());
+  // Clear the data
+  fPatternSumPerBurst->ClearEventData();
+  fDataHandlerArrayBurst->ClearEventData();
+}
+
+/**
+ * Unwind the event ring and finish the last burst, at the end of the event
+ * loop.  FinishRun completes the run afterwards.
+ */
+void QwAnalysisPipeline::FinishEventLoop(Int_t run_number)
+{
+  if (! IsPrimary())
+    QwMessage << "Finishing analysis branch " << fName << QwLog::endl;
+
+  // Unwind event ring
+  QwMessage << "Unwinding event ring" << QwLog::endl;
+  fEventRing->Unwind();
+
+  // A reload which no pattern reached is still applied
+  if (fReloadPending) ApplyReload();
+
+  //  TODO Drain event run
+
+  //  Finalize burst
+  if (fPatternSumPerBurst->HasBurstData()){
+    FinishBurst(QwBurstSegmentation::kBurstEndOfRun);
+    fPatternSumPerBurst->PrintIndexMapFile(run_number);
+  }
+  fBurstSegmentation->PrintSummary();
+
+  //  Write the last time bins
+  fTimeSeries->Close();
+
+  //  Perform actions at the end of the event loop on the
+  //  detectors object, which ought to have handles for the
+  //  MPS based histograms.
+  fRingOutput->AtEndOfEventLoop();
+}
+
+void QwAnalysisPipeline::FinishRun()
+{
+  //  Results of the cut scan, one tree entry per grid point
+  if (fCutScan->IsEnabled()) {
+    fCutScan->PrintSummary();
+    for (size_t point = 0; point < fCutScan->GetNumberOfPoints(); point++) {
+      fCutScan->SelectPoint(point);
+      fTreeRootFile->FillTreeBranches(*fCutScan);
+      fTreeRootFile->FillTree("cutscan");
+    }
+  }
+
+  if (fHelicityPattern->IsHadamardEnabled()) {
+    QwMessage << "Patterns with inconsistent Walsh-Hadamard primary contrast: "
+              << fHelicityPattern->GetHadamardMismatchCount() << QwLog::endl;
+  }
+
+  // Finish data handlers
+  fDataHandlerArrayEvt->FinishDataHandler();
+  fDataHandlerArrayMul->FinishDataHandler();
+
+  // Calculate running averages
+  fEventSum->CalculateRunningAverage();
+  fPatternSum->CalculateRunningAverage();
+  fBurstSum->CalculateRunningAverage();
+
+  // This will calculate running averages over single helicity events
+  if (fPrintRunningSum) {
+    QwMessage << " Running average of events" << QwLog::endl;
+    QwMessage << " =========================" << QwLog::endl;
+    fEventSum->PrintValue();
+  }
+  fTreeRootFile->FillTreeBranches(*fEventSum);
+  fTreeRootFile->FillTree("evts");
+
+  if (fPrintPatternSum) {
+    QwMessage << " Running average of patterns" << QwLog::endl;
+    QwMessage << " =========================" << QwLog::endl;
+    fPatternSum->PrintValue();
+  }
+  fTreeRootFile->FillTreeBranches(*fPatternSum);
+  fTreeRootFile->FillTree("muls");
+
+  if (fPrintBurstSum) {
+    QwMessage << " Running average of bursts" << QwLog::endl;
+    QwMessage << " =========================" << QwLog::endl;
+    fBurstSum->PrintValue();
+  }
+  fBurstRootFile->FillTreeBranches(*fBurstSum);
+  fBurstRootFile->FillTree("bursts");
+
+  //  Construct objects
+  fTreeRootFile->ConstructObjects("objects", *fHelicityPattern);
+
+  /*  Write to the root file, being sure to delete the old cycles  *
+   *  which were written by Autosave.                              *
+   *  Doing this will remove the multiple copies of the ntuples    *
+   *  from the root file.                                          *
+   *                                                               *
+   *  Then, we need to delete the histograms here.                 *
+   *  If we wait until the subsystem destructors, we get a         *
+   *  segfault; but in addition to that we should delete them      *
+   *  here, in case we run over multiple runs at a time.           */
+  if (fTreeRootFile == fHistoRootFile) {
+    fTreeRootFile->Write(0,TObject::kOverwrite);
+    delete fTreeRootFile; fTreeRootFile = 0; fBurstRootFile = 0; fHistoRootFile = 0;
+  } else {
+    fTreeRootFile->Write(0,TObject::kOverwrite);
+    fBurstRootFile->Write(0,TObject::kOverwrite);
+    fHistoRootFile->Write(0,TObject::kOverwrite);
+    delete fTreeRootFile; fTreeRootFile = 0;
+    delete fBurstRootFile; fBurstRootFile = 0;
+    delete fHistoRootFile; fHistoRootFile = 0;
+  }
+
+  //  Print the event cut error summary for each subsystem
+  if (fPrintErrorCounters) {
+    QwMessage << " ------------ error counters ------------------ " << QwLog::endl;
+    fRingOutput->PrintErrorCounters();
+  }
+}
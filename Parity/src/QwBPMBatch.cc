@@ -0,0 +1,223 @@
+/*!
+ * \file   QwBPMBatch.cc
+ * \brief  Position calculation for all stripline or cavity BPMs in one pass
+ */
+
+#include "QwBPMBatch.h"
+
+namespace {
+
+  /// Ratio of two channel values, as in the channel division operator:
+  /// zero when either value is zero, except that a hardware sum with
+  /// a zero denominator keeps the value of the numerator.
+  inline Double_t ChannelRatio(Double_t numer, Double_t denom, Bool_t hwsum)
+  {
+    if (numer != 0.0 && denom != 0.0) return numer / denom;
+    if (numer == 0.0 || ! hwsum) return 0.0;
+    return numer;
+  }
+
+}
+
+
+template<typename T>
+void QwBPMStriplineBatch<T>::Clear()
+{
+  fBPM.clear();
+  for (size_t axis = 0; axis < 2; axis++) {
+    fRelativeGain[axis].clear();
+    fPositionCenter[axis].clear();
+    fInverseGain[axis].clear();
+    fRawPos[axis].clear();
+    fRelPos[axis].clear();
+    fAbsPos[axis].clear();
+  }
+  fCalibration.clear();
+  fCosRotation.clear();
+  fSinRotation.clear();
+  for (size_t k = 0; k < 4; k++) fWire[k].clear();
+  fEffectiveCharge.clear();
+  fEllipticity.clear();
+  fNumberOfSamples.clear();
+  fErrorFlag.clear();
+}
+
+template<typename T>
+void QwBPMStriplineBatch<T>::Add(QwBPMStripline<T>* bpm)
+{
+  fBPM.push_back(bpm);
+  for (size_t axis = 0; axis < 2; axis++) {
+    fRelativeGain[axis].insert(fRelativeGain[axis].end(), kNumValues, bpm->fRelativeGains[axis]);
+    fPositionCenter[axis].insert(fPositionCenter[axis].end(), kNumValues, bpm->fPositionCenter[axis]);
+    fInverseGain[axis].insert(fInverseGain[axis].end(), kNumValues, 1.0/bpm->fGains[axis]);
+    fRawPos[axis].resize(fBPM.size() * kNumValues);
+    fRelPos[axis].resize(fBPM.size() * kNumValues);
+    fAbsPos[axis].resize(fBPM.size() * kNumValues);
+  }
+  fCalibration.insert(fCalibration.end(), kNumValues, bpm->fQwStriplineCalibration);
+  fCosRotation.insert(fCosRotation.end(), kNumValues, bpm->fCosRotation);
+  fSinRotation.insert(fSinRotation.end(), kNumValues, bpm->fSinRotation);
+  for (size_t k = 0; k < 4; k++) fWire[k].resize(fBPM.size() * kNumValues);
+  fEffectiveCharge.resize(fBPM.size() * kNumValues);
+  fEllipticity.resize(fBPM.size() * kNumValues);
+  fNumberOfSamples.resize(fBPM.size());
+  fErrorFlag.resize(fBPM.size());
+}
+
+template<typename T>
+void QwBPMStriplineBatch<T>::ProcessEvent()
+{
+  const size_t nbpm = fBPM.size();
+  const size_t nvalues = nbpm * kNumValues;
+
+  //  Process the wires and gather their values
+  for (size_t b = 0; b < nbpm; b++) {
+    QwBPMStripline<T>& bpm = *fBPM[b];
+    size_t nsamples = 0;
+    UInt_t errorflag = 0;
+    for (size_t k = 0; k < 4; k++) {
+      T& wire = bpm.fWire[k];
+      wire.ApplyHWChecks();
+      wire.ProcessEvent();
+      for (size_t v = 0; v < kNumValues; v++)
+        fWire[k][b * kNumValues + v] = wire.GetValue(v);
+      nsamples  += wire.GetNumberOfSamples();
+      errorflag |= wire.GetErrorCode();
+    }
+    fNumberOfSamples[b] = nsamples;
+    fErrorFlag[b] = errorflag;
+    //  The relative gains are applied to the wires themselves
+    bpm.fWire[1].Scale(bpm.fRelativeGains[0]);
+    bpm.fWire[3].Scale(bpm.fRelativeGains[1]);
+  }
+
+  //  Effective charge and ellipticity from the wires as read
+  for (size_t i = 0; i < nvalues; i++) {
+    const Bool_t hwsum = (i % kNumValues == 0);
+    const Double_t sum = fWire[0][i] + fWire[1][i] + fWire[2][i] + fWire[3][i];
+    const Double_t ell = fWire[0][i] + fWire[1][i] - fWire[2][i] - fWire[3][i];
+    fEffectiveCharge[i] = sum;
+    fEllipticity[i] = ChannelRatio(ell, sum, hwsum)
+                    * (0.5 * fCalibration[i] * fCalibration[i]);
+  }
+
+  //  Positions from the wires with relative gains, in BPM coordinates
+  for (size_t axis = 0; axis < 2; axis++) {
+    const std::vector<Double_t>& plus  = fWire[2 * axis];
+    const std::vector<Double_t>& minus = fWire[2 * axis + 1];
+    const std::vector<Double_t>& gain  = fRelativeGain[axis];
+    std::vector<Double_t>& rawpos = fRawPos[axis];
+    for (size_t i = 0; i < nvalues; i++) {
+      const Bool_t hwsum = (i % kNumValues == 0);
+      const Double_t scaled = minus[i] * gain[i];
+      rawpos[i] = ChannelRatio(plus[i] - scaled, plus[i] + scaled, hwsum) * fCalibration[i];
+    }
+  }
+
+  //  Rotation to accelerator coordinates, offset and gain, and the
+  //  correction of the ellipticity for the relative positions
+  for (size_t i = 0; i < nvalues; i++) {
+    const Double_t relx = fRawPos[0][i] * fCosRotation[i] - fRawPos[1][i] * fSinRotation[i];
+    const Double_t rely = fRawPos[1][i] * fCosRotation[i] + fRawPos[0][i] * fSinRotation[i];
+    fRelPos[0][i] = relx;
+    fRelPos[1][i] = rely;
+    fAbsPos[0][i] = (relx + fPositionCenter[0][i]) * fInverseGain[0][i];
+    fAbsPos[1][i] = (rely + fPositionCenter[1][i]) * fInverseGain[1][i];
+    fEllipticity[i] += (relx * relx - rely * rely) * (-1.0*0.250014);
+  }
+
+  //  Store the results in the derived channels; all of them depend on all
+  //  wires, and the ellipticity is built from three sums over the wires.
+  //  The positions take the good event count of the plus wire, which is
+  //  the denominator of the position ratio; the effective charge and the
+  //  ellipticity start from cleared channels and keep a count of zero.
+  for (size_t b = 0; b < nbpm; b++) {
+    QwBPMStripline<T>& bpm = *fBPM[b];
+    const size_t offset = b * kNumValues;
+    const size_t nsamples = fNumberOfSamples[b];
+    const UInt_t errorflag = fErrorFlag[b];
+    for (size_t axis = 0; axis < 2; axis++) {
+      const Int_t goodcount = bpm.fWire[2 * axis].GetGoodEventCount();
+      bpm.fRelPos[axis].SetDerivedEventData(&fRelPos[axis][offset], nsamples, goodcount, errorflag);
+      bpm.fAbsPos[axis].SetDerivedEventData(&fAbsPos[axis][offset], nsamples, goodcount, errorflag);
+    }
+    bpm.fEffectiveCharge.SetDerivedEventData(&fEffectiveCharge[offset], nsamples, 0, errorflag);
+    bpm.fEllipticity.SetDerivedEventData(&fEllipticity[offset], 3 * nsamples, 0, errorflag);
+  }
+}
+
+
+void QwBPMCavityBatch::Clear()
+{
+  fBPM.clear();
+  for (size_t axis = 0; axis < 2; axis++) {
+    fPositionCenter[axis].clear();
+    fRelPos[axis].clear();
+    fAbsPos[axis].clear();
+    fErrorFlag[axis].clear();
+  }
+  for (size_t k = 0; k < QwBPMCavity::kNumElements; k++) fElement[k].clear();
+  fNumberOfSamples.clear();
+}
+
+void QwBPMCavityBatch::Add(QwBPMCavity* bpm)
+{
+  fBPM.push_back(bpm);
+  for (size_t axis = 0; axis < 2; axis++) {
+    fPositionCenter[axis].insert(fPositionCenter[axis].end(), kNumValues, bpm->fPositionCenter[axis]);
+    fRelPos[axis].resize(fBPM.size() * kNumValues);
+    fAbsPos[axis].resize(fBPM.size() * kNumValues);
+    fErrorFlag[axis].resize(fBPM.size());
+  }
+  for (size_t k = 0; k < QwBPMCavity::kNumElements; k++)
+    fElement[k].resize(fBPM.size() * kNumValues);
+  fNumberOfSamples.resize(fBPM.size());
+}
+
+void QwBPMCavityBatch::ProcessEvent()
+{
+  const size_t nbpm = fBPM.size();
+  const size_t nvalues = nbpm * kNumValues;
+  const size_t q = QwBPMCavity::kQElem;
+
+  //  Process the elements and gather their values
+  for (size_t b = 0; b < nbpm; b++) {
+    QwBPMCavity& bpm = *fBPM[b];
+    for (size_t k = 0; k < QwBPMCavity::kNumElements; k++) {
+      QwVQWK_Channel& element = bpm.fElement[k];
+      element.ApplyHWChecks();
+      element.ProcessEvent();
+      for (size_t v = 0; v < kNumValues; v++)
+        fElement[k][b * kNumValues + v] = element.GetValue(v);
+    }
+    fNumberOfSamples[b] = bpm.fElement[q].GetNumberOfSamples();
+    for (size_t axis = 0; axis < 2; axis++)
+      fErrorFlag[axis][b] = bpm.fElement[axis].GetErrorCode() | bpm.fElement[q].GetErrorCode();
+  }
+
+  //  Positions normalized to the charge element
+  for (size_t axis = 0; axis < 2; axis++) {
+    for (size_t i = 0; i < nvalues; i++) {
+      const Bool_t hwsum = (i % kNumValues == 0);
+      fRelPos[axis][i] = ChannelRatio(fElement[axis][i], fElement[q][i], hwsum)
+                       * QwBPMCavity::kQwCavityCalibration;
+      fAbsPos[axis][i] = fRelPos[axis][i] + fPositionCenter[axis][i];
+    }
+  }
+
+  //  Store the results in the derived channels, with the good event count
+  //  of the charge element as the denominator of the position ratio
+  for (size_t b = 0; b < nbpm; b++) {
+    QwBPMCavity& bpm = *fBPM[b];
+    const size_t offset = b * kNumValues;
+    const Int_t goodcount = bpm.fElement[q].GetGoodEventCount();
+    for (size_t axis = 0; axis < 2; axis++) {
+      bpm.fRelPos[axis].SetDerivedEventData(&fRelPos[axis][offset], fNumberOfSamples[b], goodcount, fErrorFlag[axis][b]);
+      bpm.fAbsPos[axis].SetDerivedEventData(&fAbsPos[axis][offset], fNumberOfSamples[b], goodcount, fErrorFlag[axis][b]);
+    }
+  }
+}
+
+
+template class QwBPMStriplineBatch<QwVQWK_Channel>;
+template class QwBPMStriplineBatch<QwMollerADC_Channel>;
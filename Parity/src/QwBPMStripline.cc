@@ -417,11 +417,14 @@ template<typename T>
 void  QwBPMStripline<T>::ProcessEvent()
 {
   Bool_t localdebug = kFALSE;
-  static T numer("numerator","derived"), denom("denominator","derived");
-  static T tmp1("tmp1","derived"), tmp2("tmp2","derived");
-  static T tmp3("tmp3","derived"), tmp4("tmp4","derived");
-  static T tmp5("tmp3","derived");
-  static T rawpos[2] = {T("rawpos_0","derived"),T("rawpos_1","derived")};
+  T& numer = fWork.numer;
+  T& denom = fWork.denom;
+  T& tmp1 = fWork.tmp1;
+  T& tmp2 = fWork.tmp2;
+  T& tmp3 = fWork.tmp3;
+  T& tmp4 = fWork.tmp4;
+  T& tmp5 = fWork.tmp5;
+  T* rawpos = fWork.rawpos;
 
   Short_t i = 0;
 
@@ -1101,9 +1104,6 @@ void QwBPMStripline<T>::RandomizeEventData(int helicity, double time)
 /* First randomize AbsX and AbsY, then go backwards through the steps of QwBPMStripline<T>::ProcessEvent() to get the randomized wire values.*/
 
   size_t i;
-  static T numer("numerator","derived"), denom("denominator","derived");
-  static T tmp1("tmp1","derived"), tmp2("tmp2","derived");
-  static T rawpos[2] = {T("rawpos_0","derived"),T("rawpos_1","derived")};
 
   //  std::cout << "In QwBPMStripline<T>::RandomizeEventData" << std::endl;
   for(i=kXAxis;i<kNumAxes;i++){
@@ -1183,9 +1183,11 @@ void QwBPMStripline<T>::FillRawEventData()
  // XP = XM*(A+tmpX)/(A-tmpX);
 
   size_t i;
-  static T numer("numerator","derived"), denom("denominator","derived");
-  static T tmp1("tmp1","derived"), tmp2("tmp2","derived");
-  static T rawpos[2] = {T("rawpos_0","derived"),T("rawpos_1","derived")};
+  T& numer = fWork.numer;
+  T& denom = fWork.denom;
+  T& tmp1 = fWork.tmp1;
+  T& tmp2 = fWork.tmp2;
+  T* rawpos = fWork.rawpos;
   int helicity = 0; double time = 0.0;
 
   numer.CopyParameters(&fAbsPos[0]);
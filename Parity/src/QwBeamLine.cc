@@ -30,9 +30,18 @@ class QwParityDB;
 // Register this subsystem with the factory
 RegisterSubsystemFactory(QwBeamLine);
 
+//*****************************************************************//
+void QwBeamLine::DefineOptions(QwOptions &options){
+  options.AddOptions("Beamline options")
+    ("beamline.batched-bpm", po::value<bool>()->default_bool_value(false),
+     "calculate the stripline and cavity BPM positions in batch");
+}
+
 //*****************************************************************//
 void QwBeamLine::ProcessOptions(QwOptions &options){
       //Handle command line options
+  if (options.HasValue("beamline.batched-bpm"))
+    fBatchedBPM = options.GetValue<bool>("beamline.batched-bpm");
 }
 
 //*****************************************************************//
@@ -117,6 +126,9 @@ Int_t QwBeamLine::LoadChannelMap(TString mapfile)
 
   std::vector<QwBeamDetectorID> clock_needed_list;
 
+  //  The BPM batches are sorted again at the next event
+  fBPMBatchReady = kFALSE;
+
   QwParameterFile mapstr(mapfile.Data());  //Open the file
   fDetectorMaps.insert(mapstr.GetParamFileNameContents());
   mapstr.EnableGreediness();
@@ -539,7 +551,13 @@ void QwBeamLine::LoadEventCuts_Fin(Int_t &eventcut_flag) {
   for (size_t i=0;i<fECalculator.size();i++)
     fECalculator[i].SetEventCutMode(eventcut_flag);
 
-  fQwBeamLineErrorCount=0; //set the error counter to zero
+  //  The error counter is kept when the event cuts are reloaded while running
+}
+
+Bool_t QwBeamLine::HasEventCutDevice(TString device_type, TString device_name) {
+  device_type.ToLower();
+  device_name.ToLower();
+  return (GetDetectorIndex(GetQwBeamInstrumentType(device_type),device_name) != -1);
 }
 
 //*****************************************************************//
@@ -1528,6 +1546,33 @@ void QwBeamLine::UpdateErrorFlag(const VQwSubsystem *ev_error){
 }
 
 
+//*****************************************************************//
+/**
+ * Sort the stripline and cavity BPMs into the batches for their channel
+ * type.  This is done at the first event after the channel map is loaded,
+ * when the geometry and calibration constants of the BPMs are known.
+ */
+void QwBeamLine::BuildBPMBatches()
+{
+  fStriplineBatchVQWK.Clear();
+  fStriplineBatchMollerADC.Clear();
+  fStriplineUnbatched.clear();
+  for(size_t i=0;i<fStripline.size();i++){
+    VQwBPM* bpm = fStripline[i].get();
+    QwBPMStripline<QwVQWK_Channel>* vqwk =
+      dynamic_cast<QwBPMStripline<QwVQWK_Channel>*>(bpm);
+    QwBPMStripline<QwMollerADC_Channel>* mollerADC =
+      dynamic_cast<QwBPMStripline<QwMollerADC_Channel>*>(bpm);
+    if (vqwk != NULL) fStriplineBatchVQWK.Add(vqwk);
+    else if (mollerADC != NULL) fStriplineBatchMollerADC.Add(mollerADC);
+    else fStriplineUnbatched.push_back(bpm);
+  }
+  fCavityBatch.Clear();
+  for(size_t i=0;i<fCavity.size();i++)
+    fCavityBatch.Add(&fCavity[i]);
+  fBPMBatchReady = kTRUE;
+}
+
 //*****************************************************************//
 void  QwBeamLine::ProcessEvent()
 {
@@ -1536,12 +1581,21 @@ void  QwBeamLine::ProcessEvent()
   for(size_t i=0;i<fClock.size();i++)
     fClock[i].get()->ProcessEvent();
 
-  for(size_t i=0;i<fStripline.size();i++){
-     fStripline[i].get()->ProcessEvent();
-    // fStripline[i].get()->PrintInfo();
+  if (fBatchedBPM) {
+    if (! fBPMBatchReady) BuildBPMBatches();
+    fStriplineBatchVQWK.ProcessEvent();
+    fStriplineBatchMollerADC.ProcessEvent();
+    for(size_t i=0;i<fStriplineUnbatched.size();i++)
+      fStriplineUnbatched[i]->ProcessEvent();
+    fCavityBatch.ProcessEvent();
+  } else {
+    for(size_t i=0;i<fStripline.size();i++){
+       fStripline[i].get()->ProcessEvent();
+      // fStripline[i].get()->PrintInfo();
+    }
+    for(size_t i=0;i<fCavity.size();i++)
+      fCavity[i].ProcessEvent();
   }
-  for(size_t i=0;i<fCavity.size();i++)
-    fCavity[i].ProcessEvent();
 
   for(size_t i=0;i<fBCM.size();i++){
      fBCM[i].get()->ProcessEvent();
@@ -1682,6 +1736,26 @@ Bool_t QwBeamLine::PublishByRequest(TString device_name)
     fPublishList.push_back(publishinfo);
     status = PublishInternalValue(publishinfo.at(0), "published-by-request",
 				  tmp_channel);
+  } else {
+    //  Not a device: try the individual wires or elements of the BPMs,
+    //  which are named as in the pedestal map files (e.g. bpm0i01XP)
+    TString subname = device_name;
+    subname.ToLower();
+    for (size_t i = 0; i < fStripline.size() && tmp_channel == 0; i++)
+      for (Int_t j = 0; j < 4 && tmp_channel == 0; j++)
+        if (subname.CompareTo(fStripline[i].get()->GetSubElementName(j), TString::kIgnoreCase) == 0)
+          tmp_channel = fStripline[i].get()->GetSubElement(j);
+    for (size_t i = 0; i < fQPD.size() && tmp_channel == 0; i++)
+      for (Int_t j = 0; j < 4 && tmp_channel == 0; j++)
+        if (subname.CompareTo(fQPD[i].GetSubElementName(j), TString::kIgnoreCase) == 0)
+          tmp_channel = fQPD[i].GetSubElement(j);
+    for (size_t i = 0; i < fCavity.size() && tmp_channel == 0; i++)
+      for (Int_t j = 0; j < QwBPMCavity::kNumElements && tmp_channel == 0; j++)
+        if (subname.CompareTo(fCavity[i].GetSubElementName(j), TString::kIgnoreCase) == 0)
+          tmp_channel = fCavity[i].GetSubElement(j);
+    if (tmp_channel != 0)
+      status = PublishInternalValue(device_name, "published-by-request",
+				    tmp_channel);
   }
 
   return status;
@@ -320,6 +320,15 @@ void QwBeamMod::LoadEventCuts_Fin(Int_t &eventcut_flag){
     fModChannel[i]->SetEventCutMode(eventcut_flag);
 }
 
+Bool_t QwBeamMod::HasEventCutDevice(TString device_type, TString device_name){
+  device_type.ToUpper();
+  if (device_type == "VQWK"||device_type=="SCALER" ||device_type=="SIS3801D24" ||device_type=="SIS3801D32"){
+    device_name.ToLower();
+    return (GetDetectorIndex(device_name) != -1);
+  }
+  return kTRUE;
+}
+
 //*****************************************************************
 Bool_t QwBeamMod::CheckForBurpFail(const VQwSubsystem *subsys){
   Bool_t burpstatus = kFALSE;
@@ -81,6 +81,7 @@ QwBlinder::QwBlinder(const EQwBlindingStrategy blinding_strategy):
   //
   fBeamCurrentThreshold(1.0),
   fBeamIsPresent(kFALSE),
+  fTargetCharge("q_targ"),
   fBlindingStrategy(blinding_strategy),
   fBlindingOffset(0.0),
   fBlindingOffset_Base(0.0),
@@ -290,7 +291,7 @@ void QwBlinder::Update()
  */
 void QwBlinder::Update(const QwSubsystemArrayParity& detectors)
 {
-  static QwVQWK_Channel q_targ("q_targ");
+  QwVQWK_Channel& q_targ = fTargetCharge;
   if (fBlindingStrategy != kDisabled && fTargetBlindability==kBlindable) {
     // Check for the target blindability flag
     
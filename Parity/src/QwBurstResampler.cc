@@ -0,0 +1,432 @@
+/********************************************************************
+File Name: QwBurstResampler.cc
+
+Description:  This is the implementation file of the QwBurstResampler
+              class, which is a child of the VQwDataHandler class.
+              It estimates the uncertainties of the run-level means
+              and regression slopes by jackknife and bootstrap
+              resampling of bursts (or sub-bursts) of patterns.
+
+********************************************************************/
+
+#include "QwBurstResampler.h"
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Boost headers
+#include "boost/random.hpp"
+
+// ROOT headers
+#include "TTree.h"
+
+// Qweak headers
+#include "QwParameterFile.h"
+#include "QwRootFile.h"
+
+// Register this handler with the factory
+RegisterHandlerFactory(QwBurstResampler);
+
+
+QwBurstResampler::QwBurstResampler(const TString& name)
+: VQwDataHandler(name),
+  fBlock(-1),
+  fBlockSize(0),
+  fReplicates(1000),
+  fSeed(4357),
+  nP(0),nY(0),
+  fStartNewBlock(kTRUE),
+  fNumberOfBlocks(0),
+  fTree(0)
+{
+  // Set default tree name and descriptions (in VQwDataHandler)
+  fTreeName = "resample";
+  fTreeComment = "Jackknife and bootstrap uncertainties";
+  // Parsing separator
+  ParseSeparator = "_";
+
+  // Clear all data
+  ClearEventData();
+}
+
+QwBurstResampler::QwBurstResampler(const QwBurstResampler& source)
+: VQwDataHandler(source),
+  fIndependentFull(source.fIndependentFull),
+  fIndependentType(source.fIndependentType),
+  fIndependentName(source.fIndependentName),
+  fIndependentVar(source.fIndependentVar),
+  fIndependentValues(source.fIndependentValues),
+  fBlock(source.fBlock),
+  fBlockSize(source.fBlockSize),
+  fReplicates(source.fReplicates),
+  fSeed(source.fSeed),
+  nP(source.nP),nY(source.nY),
+  fStartNewBlock(kTRUE),
+  fQuantityName(source.fQuantityName),
+  fResults(source.fResults),
+  fNumberOfBlocks(0),
+  fTree(0)
+{
+  // Clear all data (the blocks are not copied)
+  ClearEventData();
+}
+
+QwBurstResampler::~QwBurstResampler()
+{
+  DeleteBlocks();
+}
+
+void QwBurstResampler::ParseConfigFile(QwParameterFile& file)
+{
+  VQwDataHandler::ParseConfigFile(file);
+  file.PopValue("block", fBlock);
+  file.PopValue("block-size", fBlockSize);
+  file.PopValue("replicates", fReplicates);
+  file.PopValue("seed", fSeed);
+  if (fBlock >= 4)
+    QwWarning << "QwBurstResampler: expect 0 <= block <= 3 but block = "
+              << fBlock << QwLog::endl;
+}
+
+/** Load the channel map, in the same format as for QwCorrelator
+ *
+ * @param mapfile Filename of map file
+ * @return Zero when success
+ */
+Int_t QwBurstResampler::LoadChannelMap(const std::string& mapfile)
+{
+  // Open the file
+  QwParameterFile map(mapfile);
+
+  std::pair<EQwHandleType,std::string> type_name;
+  while (map.ReadNextLine()) {
+    // Throw away comments, whitespace, empty lines
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    // First token is dv or iv, second token is the name like "asym_blah"
+    string primary_token = map.GetNextToken(" ");
+    string current_token = map.GetNextToken(" ");
+    type_name = ParseHandledVariable(current_token);
+
+    if (primary_token == "iv") {
+      fIndependentType.push_back(type_name.first);
+      fIndependentName.push_back(type_name.second);
+      fIndependentFull.push_back(current_token);
+    }
+    else if (primary_token == "dv") {
+      fDependentType.push_back(type_name.first);
+      fDependentName.push_back(type_name.second);
+      fDependentFull.push_back(current_token);
+    }
+    else if (primary_token == "treetype") {
+      // Used by the correlator only
+    }
+    else {
+      QwError << "LoadChannelMap in QwBurstResampler read invalid primary_token " << primary_token << QwLog::endl;
+    }
+  }
+
+  return 0;
+}
+
+Int_t QwBurstResampler::ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+
+  // Find a variable among the asymmetries or differences
+  auto connect = [&](EQwHandleType type, const std::string& name, const std::string& full) {
+    const VQwHardwareChannel* ptr = this->RequestExternalPointer(full);
+    if (ptr == NULL) {
+      switch (type) {
+        case kHandleTypeAsym: ptr = asym.RequestExternalPointer(name); break;
+        case kHandleTypeDiff: ptr = diff.RequestExternalPointer(name); break;
+        default: break;
+      }
+    }
+    if (ptr == NULL)
+      QwWarning << "QwBurstResampler::ConnectChannels: variable " << full
+                << " was not found." << QwLog::endl;
+    return ptr;
+  };
+
+  // Only keep the variables that were found
+  std::vector<std::string> found;
+  for (size_t dv = 0; dv < fDependentName.size(); dv++) {
+    const VQwHardwareChannel* ptr = connect(fDependentType[dv], fDependentName[dv], fDependentFull[dv]);
+    if (ptr == NULL) continue;
+    fDependentVar.push_back(ptr);
+    found.push_back(fDependentFull[dv]);
+  }
+  fDependentFull = found;
+  found.clear();
+  for (size_t iv = 0; iv < fIndependentName.size(); iv++) {
+    const VQwHardwareChannel* ptr = connect(fIndependentType[iv], fIndependentName[iv], fIndependentFull[iv]);
+    if (ptr == NULL) continue;
+    fIndependentVar.push_back(ptr);
+    found.push_back(fIndependentFull[iv]);
+  }
+  fIndependentFull = found;
+
+  fDependentValues.resize(fDependentVar.size());
+  fIndependentValues.resize(fIndependentVar.size());
+  nP = fIndependentVar.size();
+  nY = fDependentVar.size();
+
+  // Means of the dependent variables, then the slopes
+  fQuantityName.clear();
+  for (int iy = 0; iy < nY; iy++)
+    fQuantityName.push_back("mean_" + fDependentFull[iy]);
+  for (int iy = 0; iy < nY; iy++)
+    for (int ip = 0; ip < nP; ip++)
+      fQuantityName.push_back("slope_" + fDependentFull[iy] + "_" + fIndependentFull[ip]);
+  fResults.assign(4 * fQuantityName.size(), 0.0);
+
+  return 0;
+}
+
+void QwBurstResampler::InitBlock(LinRegBevPeb& block) const
+{
+  block.setDims(nP, nY);
+  block.init();
+  block.clear();
+}
+
+void QwBurstResampler::DeleteBlocks()
+{
+  for (size_t i = 0; i < fBlocks.size(); i++)
+    delete fBlocks[i];
+  fBlocks.clear();
+}
+
+void QwBurstResampler::ProcessData()
+{
+  if (nY == 0) return;
+
+  fTotalCount++;
+
+  // Event error flag and variable error codes
+  UInt_t error = GetEventcutErrorFlag();
+  for (size_t i = 0; i < fDependentVar.size(); ++i) {
+    error |= fDependentVar[i]->GetErrorCode();
+    fDependentValues[i] = fDependentVar[i]->GetValue(fBlock+1);
+  }
+  for (size_t i = 0; i < fIndependentVar.size(); ++i) {
+    error |= fIndependentVar[i]->GetErrorCode();
+    fIndependentValues[i] = fIndependentVar[i]->GetValue(fBlock+1);
+  }
+  if (error != 0) return;
+
+  fGoodCount++;
+
+  // Start a new block if requested
+  if (fStartNewBlock || fBlocks.empty()) {
+    fBlocks.push_back(new LinRegBevPeb());
+    InitBlock(*fBlocks.back());
+    fStartNewBlock = kFALSE;
+  }
+
+  TVectorD P(fIndependentValues.size(), fIndependentValues.data());
+  TVectorD Y(fDependentValues.size(),   fDependentValues.data());
+  *fBlocks.back() += std::make_pair(P, Y);
+
+  // Sub-burst blocks
+  if (fBlockSize > 0 && fBlocks.back()->getUsedEve() >= fBlockSize)
+    StartNewBlock();
+}
+
+void QwBurstResampler::UpdateBurstCounter(Short_t burstcounter)
+{
+  VQwDataHandler::UpdateBurstCounter(burstcounter);
+  // Blocks never extend over burst boundaries
+  StartNewBlock();
+}
+
+void QwBurstResampler::ClearEventData()
+{
+  fTotalCount = 0;
+  fGoodCount = 0;
+  DeleteBlocks();
+  fStartNewBlock = kTRUE;
+}
+
+/**
+ * Means of the dependent variables and regression slopes of combined blocks
+ * @param lrb Combined blocks (solved here)
+ * @param theta Estimates, means first and then slopes by dependent variable
+ * @return True if all estimates could be determined
+ */
+Bool_t QwBurstResampler::Estimate(LinRegBevPeb& lrb, std::vector<Double_t>& theta) const
+{
+  theta.resize(fQuantityName.size());
+  for (int iy = 0; iy < nY; iy++)
+    if (lrb.getMeanY(iy, theta[iy]) != 0) return kFALSE;
+  if (nP == 0) return kTRUE;
+  if (lrb.failed()) return kFALSE;
+  lrb.solve();
+  for (int iy = 0; iy < nY; iy++)
+    for (int ip = 0; ip < nP; ip++)
+      if (lrb.getSlope(ip, iy, theta[nY + iy * nP + ip]) != 0) return kFALSE;
+  return kTRUE;
+}
+
+void QwBurstResampler::CalcUncertainties()
+{
+  if (nY == 0) return;
+
+  const size_t nblocks = fBlocks.size();
+  const size_t nq = fQuantityName.size();
+  fNumberOfBlocks = nblocks;
+  fResults.assign(4 * nq, 0.0);
+
+  QwMessage << "QwBurstResampler::CalcUncertainties(): name=" << GetName() << ", "
+            << fGoodCount << " good patterns of " << fTotalCount
+            << " in " << nblocks << " blocks" << QwLog::endl;
+  if (nblocks < 2) {
+    QwWarning << "QwBurstResampler: at least two blocks are needed for resampling"
+              << QwLog::endl;
+    if (fTree) fTree->Fill();
+    return;
+  }
+
+  // Full sample, with the uncertainties for independent patterns
+  LinRegBevPeb total;
+  InitBlock(total);
+  for (size_t b = 0; b < nblocks; b++)
+    total += *fBlocks[b];
+  std::vector<Double_t> theta;
+  if (! Estimate(total, theta)) {
+    QwWarning << "QwBurstResampler: the full sample could not be analyzed" << QwLog::endl;
+    if (fTree) fTree->Fill();
+    return;
+  }
+  const Double_t n = total.getUsedEve();
+  for (int iy = 0; iy < nY; iy++) {
+    Double_t sigma = 0.0;
+    total.getSigmaY(iy, sigma);
+    fResults[4 * iy + 0] = theta[iy];
+    fResults[4 * iy + 1] = sigma / std::sqrt(n);
+  }
+  for (int iy = 0; iy < nY; iy++) {
+    for (int ip = 0; ip < nP; ip++) {
+      size_t q = nY + iy * nP + ip;
+      Double_t dslope = 0.0;
+      total.getSlopeError(ip, iy, dslope);
+      fResults[4 * q + 0] = theta[q];
+      fResults[4 * q + 1] = dslope;
+    }
+  }
+
+  // Delete-one-block jackknife, from the sums of the blocks before
+  // and after the deleted block
+  std::vector<LinRegBevPeb*> after(nblocks + 1);
+  for (size_t b = nblocks + 1; b-- > 0; ) {
+    after[b] = new LinRegBevPeb();
+    InitBlock(*after[b]);
+    if (b < nblocks) {
+      *after[b] = *after[b+1];
+      *after[b] += *fBlocks[b];
+    }
+  }
+  LinRegBevPeb before, jackknife;
+  InitBlock(before);
+  InitBlock(jackknife);
+  std::vector<Double_t> sum(nq, 0.0), sum2(nq, 0.0), estimate;
+  size_t njack = 0;
+  for (size_t b = 0; b < nblocks; b++) {
+    jackknife = before;
+    jackknife += *after[b+1];
+    before += *fBlocks[b];
+    if (! Estimate(jackknife, estimate)) continue;
+    for (size_t q = 0; q < nq; q++) {
+      sum[q]  += estimate[q];
+      sum2[q] += estimate[q] * estimate[q];
+    }
+    njack++;
+  }
+  for (size_t b = 0; b <= nblocks; b++)
+    delete after[b];
+  if (njack > 1) {
+    for (size_t q = 0; q < nq; q++) {
+      Double_t mean = sum[q] / njack;
+      Double_t var = sum2[q] / njack - mean * mean;
+      fResults[4 * q + 2] = std::sqrt(std::max(var, 0.0) * (njack - 1));
+    }
+  }
+
+  // Poisson bootstrap: every block enters with multiplicity Poisson(1)
+  boost::mt19937 generator(fSeed);
+  boost::poisson_distribution<int> poisson(1.0);
+  boost::variate_generator<boost::mt19937&, boost::poisson_distribution<int> >
+    multiplicity(generator, poisson);
+  std::fill(sum.begin(), sum.end(), 0.0);
+  std::fill(sum2.begin(), sum2.end(), 0.0);
+  size_t nboot = 0;
+  LinRegBevPeb replicate;
+  InitBlock(replicate);
+  for (Int_t r = 0; r < fReplicates; r++) {
+    replicate.clear();
+    for (size_t b = 0; b < nblocks; b++)
+      for (int k = multiplicity(); k > 0; k--)
+        replicate += *fBlocks[b];
+    if (! Estimate(replicate, estimate)) continue;
+    for (size_t q = 0; q < nq; q++) {
+      sum[q]  += estimate[q];
+      sum2[q] += estimate[q] * estimate[q];
+    }
+    nboot++;
+  }
+  if (nboot > 1) {
+    for (size_t q = 0; q < nq; q++) {
+      Double_t mean = sum[q] / nboot;
+      Double_t var = (sum2[q] - nboot * mean * mean) / (nboot - 1);
+      fResults[4 * q + 3] = std::sqrt(std::max(var, 0.0));
+    }
+  }
+
+  QwMessage << "QwBurstResampler: " << njack << " jackknife and "
+            << nboot << " bootstrap samples" << QwLog::endl;
+  for (size_t q = 0; q < nq; q++) {
+    QwVerbose << "  " << fQuantityName[q] << " = " << fResults[4*q]
+              << ", error " << fResults[4*q+1]
+              << ", jackknife " << fResults[4*q+2]
+              << ", bootstrap " << fResults[4*q+3] << QwLog::endl;
+  }
+
+  // Fill tree
+  if (fTree) fTree->Fill();
+}
+
+void QwBurstResampler::ConstructTreeBranches(
+    QwRootFile *treerootfile,
+    const std::string& treeprefix,
+    const std::string& branchprefix)
+{
+  // Check if any channels are active
+  if (fQuantityName.empty()) return;
+
+  // Check if tree name is specified
+  if (fTreeName == "") {
+    QwWarning << "QwBurstResampler: no tree name specified, use 'tree-name = value'" << QwLog::endl;
+    return;
+  }
+
+  // Construct tree name and create new tree
+  const std::string name = treeprefix + fTreeName;
+  treerootfile->NewTree(name, fTreeComment.c_str());
+  fTree = treerootfile->GetTree(name);
+  // Check to make sure the tree was created successfully
+  if (fTree == NULL) return;
+
+  fTree->Branch(TString(branchprefix + "total_count"), &fTotalCount);
+  fTree->Branch(TString(branchprefix + "good_count"),  &fGoodCount);
+  fTree->Branch(TString(branchprefix + "n_blocks"),    &fNumberOfBlocks);
+
+  // One branch per quantity
+  for (size_t q = 0; q < fQuantityName.size(); q++) {
+    fTree->Branch(TString(branchprefix) + fQuantityName[q], &(fResults[4 * q]),
+        "value/D:error/D:jackknife/D:bootstrap/D");
+  }
+}
@@ -0,0 +1,259 @@
+/*!
+ * \file   QwBurstSegmentation.cc
+ * \brief  Conditions which close a burst before its full length
+ */
+
+#include "QwBurstSegmentation.h"
+
+// ROOT headers
+#include "TTree.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwTypes.h"
+#include "QwEPICSEvent.h"
+#include "QwSubsystemArrayParity.h"
+#include "VQwHardwareChannel.h"
+
+QwBurstSegmentation::QwBurstSegmentation(QwOptions& options)
+: fTripCount(0), fModulationCount(0), fLastEventNumber(0),
+  fPendingReason(kBurstEndOfRun), fLastReason(kBurstEndOfRun)
+{
+  ProcessOptions(options);
+}
+
+void QwBurstSegmentation::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Burst segmentation")
+    ("burst-break-trip", po::value<int>()->default_value(0),
+     "end the burst after a beam trip of at least this many events (0 to disable)");
+  options.AddOptions("Burst segmentation")
+    ("burst-break-bmod", po::value<int>()->default_value(0),
+     "end the burst after beam modulation for at least this many events (0 to disable)");
+  options.AddOptions("Burst segmentation")
+    ("burst-break-channel", po::value<std::vector<std::string> >()->composing(),
+     "end the burst when the value of this published channel changes");
+  options.AddOptions("Burst segmentation")
+    ("burst-break-epics", po::value<std::vector<std::string> >()->composing(),
+     "end the burst when the value of this EPICS tag changes");
+}
+
+void QwBurstSegmentation::ProcessOptions(QwOptions& options)
+{
+  fTripEvents       = options.GetValue<int>("burst-break-trip");
+  fModulationEvents = options.GetValue<int>("burst-break-bmod");
+  fChannelNames.clear();
+  if (options.HasValue("burst-break-channel"))
+    fChannelNames = options.GetValueVector<std::string>("burst-break-channel");
+  fTags.clear();
+  if (options.HasValue("burst-break-epics"))
+    fTags = options.GetValueVector<std::string>("burst-break-epics");
+}
+
+/**
+ * Look up the watched channels and EPICS tags; channels and tags which are
+ * not found are dropped.
+ * @param detectors Subsystem array of the events which will be processed
+ * @param epicsevent EPICS event with the channel map loaded
+ */
+void QwBurstSegmentation::ConnectChannels(
+    const QwSubsystemArrayParity& detectors,
+    const QwEPICSEvent& epicsevent)
+{
+  std::vector<std::string> names;
+  fChannels.clear();
+  for (size_t i = 0; i < fChannelNames.size(); i++) {
+    const VQwHardwareChannel* channel = detectors.RequestExternalPointer(fChannelNames[i]);
+    if (channel == 0) {
+      QwWarning << "QwBurstSegmentation: channel " << fChannelNames[i]
+                << " was not found, and will not end bursts" << QwLog::endl;
+      continue;
+    }
+    names.push_back(fChannelNames[i]);
+    fChannels.push_back(channel);
+  }
+  fChannelNames = names;
+  fChannelValues.assign(fChannels.size(), 0.0);
+  fChannelIsSet.assign(fChannels.size(), kFALSE);
+
+  std::vector<std::string> tags;
+  fTagIndex.clear();
+  for (size_t i = 0; i < fTags.size(); i++) {
+    Int_t tagindex = epicsevent.FindIndex(fTags[i]);
+    if (tagindex < 0) {
+      QwWarning << "QwBurstSegmentation: EPICS tag " << fTags[i]
+                << " is not in the EPICS map, and will not end bursts" << QwLog::endl;
+      continue;
+    }
+    tags.push_back(fTags[i]);
+    fTagIndex.push_back(tagindex);
+  }
+  fTags = tags;
+  fTagValues.assign(fTags.size(), 0.0);
+  fTagIsSet.assign(fTags.size(), kFALSE);
+  fPendingEPICS.clear();
+}
+
+/**
+ * Check the EPICS, trip, modulation and channel conditions on an event
+ * which came out of the event ring.  Events which were dropped by the
+ * event cuts are found from the gaps in the event numbers, and count as
+ * tripped.  The break for a trip or modulation cycle is requested at its
+ * end, so that the patterns in between (if any pass the cuts) stay in the
+ * old burst.
+ * @param event Event out of the event ring
+ */
+void QwBurstSegmentation::ProcessEvent(const QwSubsystemArrayParity& event)
+{
+  UInt_t flag = event.GetEventcutErrorFlag();
+
+  // EPICS events which were decoded before this event
+  ProcessEPICSUpdates(event.GetCodaEventNumber());
+
+  // Beam trips and holdoffs, one break per trip
+  if (fTripEvents > 0) {
+    UInt_t number = event.GetCodaEventNumber();
+    if (fLastEventNumber > 0 && number > fLastEventNumber + 1)
+      fTripCount += number - fLastEventNumber - 1;
+    fLastEventNumber = number;
+    if ((flag & (kBeamTripError | kBCMErrorFlag)) != 0) fTripCount++;
+    else if (fTripCount < fTripEvents) fTripCount = 0;
+    else {
+      // First clean event after the trip
+      RequestBreak(kBurstBeamTrip);
+      fTripCount = 0;
+    }
+  }
+
+  // Beam modulation cycles, one break per cycle
+  if (fModulationEvents > 0) {
+    if ((flag & kBModFFBErrorFlag) != 0) fModulationCount++;
+    else if (fModulationCount < fModulationEvents) fModulationCount = 0;
+    else {
+      // First event after the modulation cycle
+      RequestBreak(kBurstModulation);
+      fModulationCount = 0;
+    }
+  }
+
+  // Watched channels
+  for (size_t i = 0; i < fChannels.size(); i++) {
+    if (fChannels[i]->GetErrorCode() != 0) continue;
+    Double_t value = fChannels[i]->GetValue();
+    if (fChannelIsSet[i] && value != fChannelValues[i]) {
+      QwVerbose << "QwBurstSegmentation: " << fChannelNames[i] << " changed from "
+                << fChannelValues[i] << " to " << value << QwLog::endl;
+      RequestBreak(kBurstChannelChange);
+    }
+    fChannelValues[i] = value;
+    fChannelIsSet[i] = kTRUE;
+  }
+}
+
+/**
+ * Queue the values of the watched EPICS tags, until the events decoded
+ * after the EPICS event leave the event ring
+ * @param epicsevent EPICS event
+ * @param event_number CODA event number of the last event decoded before
+ *        the EPICS event (zero before the first event)
+ */
+void QwBurstSegmentation::ProcessEPICSEvent(const QwEPICSEvent& epicsevent, UInt_t event_number)
+{
+  if (fTagIndex.empty()) return;
+  PendingEPICSValues values;
+  values.fEventNumber = event_number;
+  values.fValue.assign(fTagIndex.size(), 0.0);
+  values.fFilled.assign(fTagIndex.size(), kFALSE);
+  for (size_t i = 0; i < fTagIndex.size(); i++) {
+    if (! epicsevent.IsDataFilled(fTagIndex[i])) continue;
+    values.fValue[i] = epicsevent.GetTreeValue(fTagIndex[i]);
+    values.fFilled[i] = kTRUE;
+  }
+  fPendingEPICS.push_back(values);
+}
+
+/**
+ * Check the watched EPICS tags for changes in the queued EPICS events which
+ * were decoded before an event
+ * @param event_number CODA event number of the event out of the event ring
+ */
+void QwBurstSegmentation::ProcessEPICSUpdates(UInt_t event_number)
+{
+  while (! fPendingEPICS.empty() && fPendingEPICS.front().fEventNumber < event_number) {
+    const PendingEPICSValues& values = fPendingEPICS.front();
+    for (size_t i = 0; i < values.fFilled.size(); i++) {
+      if (! values.fFilled[i]) continue;
+      Double_t value = values.fValue[i];
+      if (fTagIsSet[i] && value != fTagValues[i]) {
+        QwMessage << "QwBurstSegmentation: " << fTags[i] << " changed from "
+                  << fTagValues[i] << " to " << value << " before event "
+                  << event_number << QwLog::endl;
+        RequestBreak(kBurstEPICSChange);
+      }
+      fTagValues[i] = value;
+      fTagIsSet[i] = kTRUE;
+    }
+    fPendingEPICS.pop_front();
+  }
+}
+
+/**
+ * Request a break at a jump to the next sampled block.  The events which
+ * were skipped are not a beam trip, so the trip and modulation counters
+ * start over.
+ */
+void QwBurstSegmentation::StartSampleBlock()
+{
+  RequestBreak(kBurstSampleBlock);
+  fLastEventNumber = 0;
+  fTripCount = 0;
+  fModulationCount = 0;
+}
+
+/**
+ * Record the end of a burst and clear the pending break
+ * @param reason Reason for the end of the burst
+ */
+void QwBurstSegmentation::EndBurst(EQwBurstEndReason reason)
+{
+  fLastReason = reason;
+  fReasonCount[reason]++;
+  fPendingReason = kBurstEndOfRun;
+}
+
+/**
+ * Print the number of bursts ended for each reason.  Bursts ended by the
+ * end of the run or by the burst length are only printed in verbose mode,
+ * so that the log of a run without additional conditions is unchanged.
+ */
+void QwBurstSegmentation::PrintSummary() const
+{
+  static const char* names[] = {
+    "end of run", "burst length", "beam trip", "beam modulation",
+    "channel change", "EPICS change", "sample block"
+  };
+  std::map<EQwBurstEndReason, Int_t>::const_iterator it;
+  for (it = fReasonCount.begin(); it != fReasonCount.end(); ++it) {
+    if (it->first == kBurstEndOfRun || it->first == kBurstLength)
+      QwVerbose << "Bursts ended by " << names[it->first] << ": " << it->second << QwLog::endl;
+    else
+      QwMessage << "Bursts ended by " << names[it->first] << ": " << it->second << QwLog::endl;
+  }
+}
+
+void QwBurstSegmentation::ConstructBranchAndVector(TTree *tree, TString& prefix, std::vector<Double_t>& values)
+{
+  fTreeArrayIndex[&values] = values.size();
+  TString name = prefix + "burst_end_reason";
+  values.push_back(0.0);
+  tree->Branch(name, &(values.back()), name + "/D");
+}
+
+void QwBurstSegmentation::FillTreeVector(std::vector<Double_t>& values) const
+{
+  std::map<const std::vector<Double_t>*, size_t>::const_iterator
+    index = fTreeArrayIndex.find(&values);
+  if (index == fTreeArrayIndex.end()) return;
+  values[index->second] = fLastReason;
+}
@@ -0,0 +1,327 @@
+/********************************************************************
+File Name: QwCalibrator.cc
+
+Description:  This is the implementation file of the QwCalibrator
+              class, which is a child of the VQwDataHandler class.
+              It replaces the offline pedestal macros in
+              rootScripts/pedestal by fitting the raw channel value
+              against a reference BCM during replay.
+
+********************************************************************/
+
+#include "QwCalibrator.h"
+
+// System includes
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+// ROOT headers
+#include "TTree.h"
+#include "TTimeStamp.h"
+
+// Qweak headers
+#include "QwParameterFile.h"
+#include "QwRootFile.h"
+
+// Register this handler with the factory
+RegisterHandlerFactory(QwCalibrator);
+
+
+QwCalibrator::QwCalibrator(const TString& name)
+: VQwDataHandler(name),
+  fReferenceVar(0),
+  fReferenceMinimum(-std::numeric_limits<Double_t>::max()),
+  fOutputFileBase("calibration_pedestal."),
+  fOutputFileSuff(".map"),
+  fOutputPath("."),
+  fTree(0)
+{
+  // Set default tree name and descriptions (in VQwDataHandler)
+  fTreeName = "calib";
+  fTreeComment = "Pedestal and gain calibration";
+  // Parsing separator
+  ParseSeparator = "_";
+
+  // Clear all data
+  ClearEventData();
+}
+
+QwCalibrator::QwCalibrator(const QwCalibrator& source)
+: VQwDataHandler(source),
+  fReferenceFull(source.fReferenceFull),
+  fReferenceName(source.fReferenceName),
+  fReferenceVar(source.fReferenceVar),
+  fReferenceMinimum(source.fReferenceMinimum),
+  fFitGain(source.fFitGain),
+  fMoments(source.fMoments),
+  fResults(source.fResults),
+  fOutputFileBase(source.fOutputFileBase),
+  fOutputFileSuff(source.fOutputFileSuff),
+  fOutputPath(source.fOutputPath),
+  fTree(0),
+  fTotalCount(source.fTotalCount),
+  fGoodCount(source.fGoodCount)
+{
+}
+
+void QwCalibrator::ParseConfigFile(QwParameterFile& file)
+{
+  VQwDataHandler::ParseConfigFile(file);
+  file.PopValue("output-file-base", fOutputFileBase);
+  file.PopValue("output-file-suff", fOutputFileSuff);
+  file.PopValue("output-path", fOutputPath);
+  file.PopValue("reference-minimum", fReferenceMinimum);
+}
+
+/** Load the channel map
+ *
+ * The map contains one 'reference' line with the reference BCM, and
+ * 'pedestal' lines (pedestal only) or 'gain' lines (pedestal and gain)
+ * for the channels to be calibrated, e.g.
+ *   reference mps_bcm_an_us
+ *   pedestal  mps_bpm0i01XP
+ *   gain      mps_bcm_an_ds
+ *
+ * @param mapfile Filename of map file
+ * @return Zero when success
+ */
+Int_t QwCalibrator::LoadChannelMap(const std::string& mapfile)
+{
+  // Open the file
+  QwParameterFile map(mapfile);
+
+  std::pair<EQwHandleType,std::string> type_name;
+  while (map.ReadNextLine()) {
+    // Throw away comments, whitespace, empty lines
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    // First token is the role, second token is the name like "mps_bcm_an_us"
+    std::string primary_token = map.GetNextToken(" ");
+    std::string current_token = map.GetNextToken(" ");
+    type_name = ParseHandledVariable(current_token);
+    if (type_name.first != kHandleTypeMps) {
+      QwError << "QwCalibrator: only MPS channels can be calibrated, not "
+              << current_token << QwLog::endl;
+      continue;
+    }
+
+    if (primary_token == "reference") {
+      fReferenceFull = current_token;
+      fReferenceName = type_name.second;
+    }
+    else if (primary_token == "pedestal" || primary_token == "gain") {
+      fDependentType.push_back(type_name.first);
+      fDependentName.push_back(type_name.second);
+      fDependentFull.push_back(current_token);
+      fFitGain.push_back(primary_token == "gain");
+    }
+    else {
+      QwError << "LoadChannelMap in QwCalibrator read invalid primary_token " << primary_token << QwLog::endl;
+    }
+  }
+
+  return 0;
+}
+
+Int_t QwCalibrator::ConnectChannels(QwSubsystemArrayParity& event)
+{
+  SetEventcutErrorFlagPointer(event.GetEventcutErrorFlagPointer());
+
+  fReferenceVar = event.RequestExternalPointer(fReferenceName);
+  if (fReferenceVar == NULL) {
+    QwError << "QwCalibrator: reference channel " << fReferenceFull
+            << " was not found; no calibration will be done." << QwLog::endl;
+    fDependentName.clear();
+    return 0;
+  }
+
+  std::vector<std::string> names, fulls;
+  std::vector<Bool_t> fitgain;
+  for (size_t dv = 0; dv < fDependentName.size(); dv++) {
+    const VQwHardwareChannel* dv_ptr = event.RequestExternalPointer(fDependentName.at(dv));
+    if (dv_ptr == NULL) {
+      QwWarning << "QwCalibrator::ConnectChannels: channel "
+                << fDependentName.at(dv) << " was not found." << QwLog::endl;
+      continue;
+    }
+    fDependentVar.push_back(dv_ptr);
+    names.push_back(fDependentName.at(dv));
+    fulls.push_back(fDependentFull.at(dv));
+    fitgain.push_back(fFitGain.at(dv));
+  }
+  // Only keep the channels that were found
+  fDependentName = names;
+  fDependentFull = fulls;
+  fFitGain = fitgain;
+
+  fDependentValues.resize(fDependentVar.size());
+  fMoments.resize(fDependentVar.size());
+  fResults.resize(fDependentVar.size());
+
+  return 0;
+}
+
+Int_t QwCalibrator::ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArrayParity& diff)
+{
+  QwWarning << "QwCalibrator " << GetName()
+            << " works on MPS channels only, use 'scope = event'" << QwLog::endl;
+  return 0;
+}
+
+void QwCalibrator::ProcessData()
+{
+  if (fReferenceVar == NULL || fDependentVar.empty()) return;
+
+  fTotalCount++;
+
+  // Global event cuts and reference channel
+  if (GetEventcutErrorFlag() != 0) return;
+  if (fReferenceVar->GetErrorCode() != 0) return;
+  Double_t reference = fReferenceVar->GetValue();
+  if (reference < fReferenceMinimum) return;
+
+  fGoodCount++;
+
+  for (size_t i = 0; i < fDependentVar.size(); ++i) {
+    const VQwHardwareChannel* channel = fDependentVar[i];
+    if (channel->GetErrorCode() != 0) continue;
+    // Undo the current pedestal and calibration factor to recover
+    // the raw value per sample, as used in the pedestal map files
+    Double_t cal = channel->GetCalibrationFactor();
+    if (cal == 0.0) continue;
+    fDependentValues[i] = channel->GetValue() / cal + channel->GetPedestal();
+    fMoments[i].Add(reference, fDependentValues[i]);
+  }
+}
+
+void QwCalibrator::ClearEventData()
+{
+  fTotalCount = 0;
+  fGoodCount = 0;
+  for (size_t i = 0; i < fMoments.size(); i++)
+    fMoments[i].Clear();
+}
+
+/**
+ * Fit y = pedestal + slope * x for every channel, with uncertainties from
+ * the residual variance.  The calibration factor for 'gain' channels is
+ * 1/slope, so that the calibrated channel reproduces the reference;
+ * other channels keep their current calibration factor.
+ */
+void QwCalibrator::CalcCalibrations()
+{
+  if (fReferenceVar == NULL || fDependentVar.empty()) return;
+
+  QwMessage << "QwCalibrator::CalcCalibrations(): name=" << GetName() << ", "
+            << "good entries: " << fGoodCount << " of " << fTotalCount
+            << QwLog::endl;
+
+  const Double_t nan = std::numeric_limits<Double_t>::quiet_NaN();
+  for (size_t i = 0; i < fDependentVar.size(); i++) {
+    const Moments& m = fMoments[i];
+    FitResult& r = fResults[i];
+    r.fEntries = m.fN;
+    r.fPedestal = r.fPedestalError = nan;
+    r.fSlope = r.fSlopeError = nan;
+    r.fCalibration = fDependentVar[i]->GetCalibrationFactor();
+    r.fCalibrationError = 0.0;
+
+    if (m.fN < 3 || m.fCxx <= 0.0) {
+      QwWarning << "QwCalibrator: not enough range in " << fReferenceName
+                << " to calibrate " << fDependentName[i]
+                << " (" << m.fN << " entries)" << QwLog::endl;
+      continue;
+    }
+
+    r.fSlope = m.fCxy / m.fCxx;
+    r.fPedestal = m.fMeanY - r.fSlope * m.fMeanX;
+    Double_t ssr = m.fCyy - r.fSlope * m.fCxy;
+    Double_t s2 = (ssr > 0.0)? ssr / (m.fN - 2): 0.0;
+    r.fSlopeError = std::sqrt(s2 / m.fCxx);
+    r.fPedestalError = std::sqrt(s2 * (1.0 / m.fN + m.fMeanX * m.fMeanX / m.fCxx));
+
+    if (fFitGain[i]) {
+      if (r.fSlope != 0.0) {
+        r.fCalibration = 1.0 / r.fSlope;
+        r.fCalibrationError = r.fSlopeError / (r.fSlope * r.fSlope);
+      } else {
+        QwWarning << "QwCalibrator: zero slope for " << fDependentName[i]
+                  << ", keeping calibration factor" << QwLog::endl;
+      }
+    }
+
+    QwVerbose << "QwCalibrator: " << fDependentName[i]
+              << " pedestal = " << r.fPedestal << " +/- " << r.fPedestalError
+              << ", slope = " << r.fSlope << " +/- " << r.fSlopeError
+              << QwLog::endl;
+  }
+
+  // Fill tree
+  if (fTree) fTree->Fill();
+
+  // Write map file
+  WriteMapFile();
+}
+
+void QwCalibrator::WriteMapFile()
+{
+  std::string file = fOutputPath + "/" + fOutputFileBase + run_label.Data() + fOutputFileSuff;
+  std::ofstream output(file.c_str());
+  if (! output.good()) {
+    QwError << "QwCalibrator could not create output file " << file << QwLog::endl;
+    return;
+  }
+
+  TTimeStamp now;
+  output << "! Pedestal file of run " << run_label << std::endl;
+  output << "! reference channel " << fReferenceName
+         << ", " << fGoodCount << " good events" << std::endl;
+  output << "! fit is linear, generated by QwCalibrator " << GetName() << std::endl;
+  output << "! date of analysis = " << now.AsString("l") << std::endl;
+  for (size_t i = 0; i < fResults.size(); i++) {
+    const FitResult& r = fResults[i];
+    if (std::isnan(r.fPedestal)) {
+      output << "! " << fDependentName[i] << " could not be calibrated" << std::endl;
+      continue;
+    }
+    output << fDependentName[i] << " , "
+           << Form("%.4f , %.6g", r.fPedestal, r.fCalibration)
+           << Form("   ! dped = %.4f, dcal = %.3g, slope = %.6g +/- %.3g, n = %.0f",
+                   r.fPedestalError, r.fCalibrationError,
+                   r.fSlope, r.fSlopeError, r.fEntries)
+           << std::endl;
+  }
+  output.close();
+
+  QwMessage << "QwCalibrator wrote " << file << QwLog::endl;
+}
+
+void QwCalibrator::ConstructTreeBranches(
+    QwRootFile *treerootfile,
+    const std::string& treeprefix,
+    const std::string& branchprefix)
+{
+  // Check if any channels are active
+  if (fResults.empty()) return;
+
+  // Check if tree name is specified
+  if (fTreeName == "") {
+    QwWarning << "QwCalibrator: no tree name specified, use 'tree-name = value'" << QwLog::endl;
+    return;
+  }
+
+  // Construct tree name and create new tree
+  const std::string name = treeprefix + fTreeName;
+  treerootfile->NewTree(name, fTreeComment.c_str());
+  fTree = treerootfile->GetTree(name);
+  // Check to make sure the tree was created successfully
+  if (fTree == NULL) return;
+
+  // One branch per channel
+  for (size_t i = 0; i < fResults.size(); i++) {
+    fTree->Branch(TString(branchprefix + fDependentName[i]), &(fResults[i].fPedestal),
+        "ped/D:dped/D:slope/D:dslope/D:cal/D:dcal/D:n/D");
+  }
+}
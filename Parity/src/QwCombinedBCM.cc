@@ -96,8 +96,7 @@ void  QwCombinedBCM<T>::InitializeChannel(TString subsystem, TString name,
 template<typename T>
 void  QwCombinedBCM<T>::ProcessEvent()
 {
-  static T tmpADC;
-  tmpADC.InitializeChannel("tmp","derived");
+  T& tmpADC = fWork.tmpADC;
 
   this->ClearEventData();
 
@@ -459,7 +459,7 @@ void  QwCombinedBPM<T>::ProcessEvent()
 {
   Bool_t ldebug = kFALSE;
 
-  static T  tmpQADC("tmpQADC"), tmpADC("tmpADC");
+  T& tmpQADC = fWork.tmpQADC;
 
   this->ClearEventData();
   //check to see if the fixed parameters are calculated
@@ -556,7 +556,7 @@ template<typename T>
  {
 
    Bool_t ldebug = kFALSE;
-   static Double_t zpos = 0.0;
+   Double_t zpos = 0.0;
 
    for(size_t i=0;i<fElement.size();i++){
      zpos = fElement[i]->GetPositionInZ();
@@ -604,7 +604,7 @@ template<typename T>
  }
 
 template<typename T>
- void QwCombinedBPM<T>::LeastSquareFit(VQwBPM::EBeamPositionMonitorAxis axis, std::vector<Double_t> fWeights)
+ void QwCombinedBPM<T>::LeastSquareFit(VQwBPM::EBeamPositionMonitorAxis axis, const std::vector<Double_t>& fWeights)
  {
 
    /**
@@ -619,18 +619,12 @@ template<typename T>
    **/
 
    Bool_t ldebug = kFALSE;
-   static Double_t zpos = 0;
-   static T tmp1("tmp1","derived");
-   static T tmp2("tmp2","derived");
-   static T tmp3("tmp3","derived");
-   static T C[kNumAxes];
-   static T E[kNumAxes];
-
-   // initialize the VQWK_Channel arrays
-   C[kXAxis].InitializeChannel("cx","derived");
-   C[kYAxis].InitializeChannel("cy","derived");
-   E[kXAxis].InitializeChannel("ex","derived");
-   E[kYAxis].InitializeChannel("ey","derived");
+   Double_t zpos = 0;
+   T& tmp1 = fWork.tmp1;
+   T& tmp2 = fWork.tmp2;
+   T& tmp3 = fWork.tmp3;
+   T* C = fWork.C;
+   T* E = fWork.E;
 
    C[axis].ClearEventData();
    E[axis].ClearEventData();
@@ -1170,8 +1164,8 @@ void QwCombinedBPM<T>::MakeBPMComboList()
 template<typename T>
 void QwCombinedBPM<T>::RandomizeEventData(int helicity, double time)
 {
-  static Double_t zpos = 0;
-  static T tmp1("tmp1","derived");
+  Double_t zpos = 0;
+  T& tmp1 = fWork.tmp1;
   // Randomize the abs position and angle.
   for (size_t axis=kXAxis; axis<kNumAxes; axis++) 
   {
@@ -83,7 +83,7 @@ void QwCombinedPMT::CalculateSumAndAverage()
   Double_t  total_weights=0.0;
 
   fSumADC.ClearEventData();
-  static QwIntegrationPMT tmpADC("tmpADC");
+  QwIntegrationPMT& tmpADC = fWork.tmpADC;
 
   for (size_t i=0;i<fElement.size();i++)
     {
@@ -12,6 +12,7 @@
 #include "VQwSubsystem.h"
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
 
 // Qweak headers
 #include "QwLog.h"
@@ -178,6 +179,38 @@ Int_t QwCombiner::LoadChannelMap(const std::string& mapfile)
   return 0;
 }
 
+/** Read the map file again into a handler which is not connected
+ *
+ * Only the sensitivities and the error flag mask can change; the dependent
+ * and independent variables must be the same as in the connected map.
+ * @return True if the map file can be used
+ */
+Bool_t QwCombiner::PrepareReload()
+{
+  QwCombiner reload(fName);
+  reload.LoadChannelMap(fMapFile);
+  if (reload.fDependentName != fDependentName
+   || reload.fIndependentName != fIndependentName
+   || reload.fIndependentType != fIndependentType
+   || ! std::equal(reload.fDependentType.begin(), reload.fDependentType.end(),
+                   fDependentType.begin())) {
+    QwError << "QwCombiner " << fName << ": the channels in " << fMapFile
+            << " have changed; only sensitivities and the mask can be reloaded"
+            << QwLog::endl;
+    return kFALSE;
+  }
+  fReloadErrorFlagMask = reload.fErrorFlagMask;
+  fReloadSensitivity = reload.fSensitivity;
+  return kTRUE;
+}
+
+void QwCombiner::ApplyReload()
+{
+  fErrorFlagMask = fReloadErrorFlagMask;
+  fSensitivity.swap(fReloadSensitivity);
+  fReloadSensitivity.clear();
+}
+
 /** Connect to the dependent and independent channels
  *
  * @param asym Asymmetry event structure
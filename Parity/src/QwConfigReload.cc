@@ -0,0 +1,172 @@
+/*!
+ * \file   QwConfigReload.cc
+ * \brief  Reload of event cuts and data handler maps while running
+ */
+
+#include "QwConfigReload.h"
+
+// System headers
+#include <algorithm>
+#include <csignal>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwSubsystemArrayParity.h"
+#include "VQwSubsystemParity.h"
+#include "QwHelicity.h"
+#include "QwAnalysisPipeline.h"
+
+/// Reload requested by SIGHUP, and not yet applied
+static volatile sig_atomic_t gReloadRequested = 0;
+
+static void sighup_handler(int sig)
+{
+  gReloadRequested = 1;
+}
+
+QwConfigReload::QwConfigReload(QwOptions& options)
+: fEnabled(kFALSE), fMaxDelay(0), fDelay(0)
+{
+  ProcessOptions(options);
+}
+
+void QwConfigReload::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Configuration reload")
+    ("config-reload", po::value<bool>()->default_bool_value(false),
+     "read the configuration of --reload-target again on SIGHUP");
+  options.AddOptions("Configuration reload")
+    ("reload-target", po::value<std::vector<std::string> >()->composing(),
+     "'eventcuts', 'handlers' or the name of a data handler (default: eventcuts and handlers)");
+  options.AddOptions("Configuration reload")
+    ("reload-max-delay", po::value<int>()->default_value(1000),
+     "maximum number of events to wait for a pattern boundary before reloading");
+}
+
+void QwConfigReload::ProcessOptions(QwOptions& options)
+{
+  fEnabled  = options.GetValue<bool>("config-reload");
+  fMaxDelay = options.GetValue<int>("reload-max-delay");
+  fTargets.clear();
+  if (options.HasValue("reload-target"))
+    fTargets = options.GetValueVector<std::string>("reload-target");
+  if (fTargets.empty()) {
+    fTargets.push_back("eventcuts");
+    fTargets.push_back("handlers");
+  }
+
+  if (fEnabled) {
+    signal(SIGHUP, sighup_handler);
+    QwMessage << "Configuration is reloaded on SIGHUP" << QwLog::endl;
+  }
+}
+
+void QwConfigReload::RequestReload()
+{
+  gReloadRequested = 1;
+}
+
+/**
+ * Reload the configuration when requested, after the last event of a
+ * helicity pattern has been cut (or when the maximum delay has passed).
+ * @param detectors Subsystem array to which the event cuts are applied
+ * @param pipelines Analysis pipelines with the data handlers
+ * @param event_number Physics event number, for the record of the reload
+ */
+void QwConfigReload::ProcessEvent(
+    QwSubsystemArrayParity& detectors,
+    std::vector<QwAnalysisPipeline*>& pipelines,
+    UInt_t event_number)
+{
+  if (gReloadRequested == 0) return;
+
+  //  Wait until the previous reload has reached the end of the event rings
+  for (size_t i = 0; i < pipelines.size(); i++)
+    if (pipelines.at(i)->IsReloadPending()) return;
+
+  //  Was this event the last one of its pattern?
+  QwHelicity* helicity = 0;
+  std::vector<VQwSubsystem*> subsys_helicity = detectors.GetSubsystemByType("QwHelicity");
+  if (subsys_helicity.size() > 0)
+    helicity = dynamic_cast<QwHelicity*>(subsys_helicity.at(0));
+  Bool_t boundary = (helicity != 0 && helicity->HasDataLoaded()
+                  && helicity->GetPhaseNumber() == helicity->GetMaxPatternPhase());
+  if (! boundary && ++fDelay < fMaxDelay) return;
+  if (! boundary)
+    QwWarning << "No pattern boundary within " << fMaxDelay
+              << " events; reloading the configuration now, and the patterns"
+              << " in the event ring may mix both configurations" << QwLog::endl;
+
+  gReloadRequested = 0;
+  fDelay = 0;
+  Reload(detectors, pipelines, event_number,
+         boundary? helicity->GetPatternNumber() + 1: -1);
+}
+
+/**
+ * Read and check the new configuration of all targets, and apply it only
+ * if all checks passed: the event cuts right away, and the data handlers
+ * from the first pattern on.
+ * @param first_pattern First pattern with the new configuration, or -1 for
+ *        the next event which leaves the event ring
+ * @return True if the new configuration is in effect
+ */
+Bool_t QwConfigReload::Reload(
+    QwSubsystemArrayParity& detectors,
+    std::vector<QwAnalysisPipeline*>& pipelines,
+    UInt_t event_number,
+    Long_t first_pattern)
+{
+  QwMessage << "Reloading the configuration at event " << event_number << QwLog::endl;
+  Bool_t status = kTRUE;
+
+  //  Check the event cut files against the devices
+  std::vector<VQwSubsystemParity*> subsystems;
+  if (std::find(fTargets.begin(), fTargets.end(), "eventcuts") != fTargets.end()) {
+    for (QwSubsystemArrayParity::iterator subsys = detectors.begin();
+         subsys != detectors.end(); ++subsys) {
+      VQwSubsystemParity* subsys_parity = dynamic_cast<VQwSubsystemParity*>(subsys->get());
+      if (subsys_parity == 0 || subsys_parity->GetEventCutsFile().Length() == 0) continue;
+      if (subsys_parity->CheckEventCuts(subsys_parity->GetEventCutsFile()))
+        subsystems.push_back(subsys_parity);
+      else
+        status = kFALSE;
+    }
+  }
+
+  //  Read the data handler maps
+  std::vector<TString> handlers;
+  for (size_t i = 0; i < pipelines.size(); i++)
+    status &= pipelines.at(i)->PrepareReload(fTargets, handlers);
+  for (size_t i = 0; i < fTargets.size(); i++) {
+    if (fTargets.at(i) == "eventcuts" || fTargets.at(i) == "handlers") continue;
+    if (std::find(handlers.begin(), handlers.end(), TString(fTargets.at(i))) == handlers.end())
+      QwWarning << "No data handler " << fTargets.at(i) << " to reload" << QwLog::endl;
+  }
+
+  if (! status) {
+    QwError << "Configuration reload rejected; the previous configuration "
+            << "stays in effect" << QwLog::endl;
+    return kFALSE;
+  }
+
+  //  Apply the event cuts to the next event, and the handlers to the
+  //  first pattern of the next event
+  TString record = Form("event %u, pattern %ld:", event_number, first_pattern);
+  for (size_t i = 0; i < subsystems.size(); i++) {
+    subsystems.at(i)->LoadEventCuts(subsystems.at(i)->GetEventCutsFile());
+    record += " " + subsystems.at(i)->GetEventCutsFile();
+  }
+  for (size_t i = 0; i < handlers.size(); i++) {
+    //  Handlers with the same name in several arrays are listed once
+    if (std::find(handlers.begin(), handlers.begin() + i, handlers.at(i))
+        == handlers.begin() + i)
+      record += " " + handlers.at(i);
+  }
+  for (size_t i = 0; i < pipelines.size(); i++)
+    pipelines.at(i)->ScheduleReload(detectors, record, first_pattern);
+
+  QwMessage << "Configuration reloaded at " << record << QwLog::endl;
+  return kTRUE;
+}
@@ -150,9 +150,9 @@ void QwCorrelator::ProcessData()
   if (fGoodEvent == 0) {
     fGoodCount++;
 
-    TVectorD P(fIndependentValues.size(), fIndependentValues.data());
-    TVectorD Y(fDependentValues.size(),   fDependentValues.data());
-    linReg += std::make_pair(P, Y);
+    fEventValues.first.SetElements(fIndependentValues.data());
+    fEventValues.second.SetElements(fDependentValues.data());
+    linReg += fEventValues;
   }
 }
 
@@ -378,6 +378,8 @@ Int_t QwCorrelator::ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArr
   }
   fIndependentValues.resize(fIndependentVar.size());
   fDependentValues.resize(fDependentVar.size());
+  fEventValues.first.ResizeTo(fIndependentValues.size());
+  fEventValues.second.ResizeTo(fDependentValues.size());
  
   nP = fIndependentName.size();
   nY = fDependentName.size();
@@ -0,0 +1,448 @@
+/********************************************************************
+File Name: QwCovarianceMonitor.cc
+
+Description:  This is the implementation file of the
+              QwCovarianceMonitor class, which is a child of the
+              VQwDataHandler class.  It accumulates the full covariance
+              matrix of a large set of pattern channels, and writes the
+              correlation matrix and its principal components.
+
+********************************************************************/
+
+#include "QwCovarianceMonitor.h"
+
+// System includes
+#include <algorithm>
+#include <cmath>
+
+// ROOT headers
+#include "TTree.h"
+#include "TMatrixDSym.h"
+#include "TMatrixDSymEigen.h"
+
+// Qweak headers
+#include "QwParameterFile.h"
+#include "QwRootFile.h"
+
+// Register this handler with the factory
+RegisterHandlerFactory(QwCovarianceMonitor);
+
+
+QwCovarianceMonitor::QwCovarianceMonitor(const TString& name)
+: VQwDataHandler(name),
+  fBlock(-1),
+  fBlockSize(64),
+  fComponents(5),
+  fWriteMatrix(kTRUE),
+  nC(0),
+  fBufferedRows(0),
+  fBurst(0),
+  fTree(0)
+{
+  // Set default tree name and descriptions (in VQwDataHandler)
+  fTreeName = "covariance";
+  fTreeComment = "Correlation matrix and principal components";
+  // Parsing separator
+  ParseSeparator = "_";
+
+  // Clear all data
+  ClearEventData();
+}
+
+QwCovarianceMonitor::QwCovarianceMonitor(const QwCovarianceMonitor& source)
+: VQwDataHandler(source),
+  fChannelFull(source.fChannelFull),
+  fChannelType(source.fChannelType),
+  fChannelName(source.fChannelName),
+  fChannelVar(source.fChannelVar),
+  fBlock(source.fBlock),
+  fBlockSize(source.fBlockSize),
+  fComponents(source.fComponents),
+  fWriteMatrix(source.fWriteMatrix),
+  nC(source.nC),
+  fBuffer(source.fBuffer.size()),
+  fBufferedRows(0),
+  fRunningMean(source.fRunningMean.size()),
+  fComoment(source.fComoment.size()),
+  fDelta(source.fDelta.size()),
+  fBurst(0),
+  fMean(source.fMean),
+  fWidth(source.fWidth),
+  fCorrelation(source.fCorrelation),
+  fEigenValues(source.fEigenValues),
+  fEigenVectors(source.fEigenVectors),
+  fTree(0)
+{
+  // Clear all data
+  ClearEventData();
+}
+
+void QwCovarianceMonitor::ParseConfigFile(QwParameterFile& file)
+{
+  VQwDataHandler::ParseConfigFile(file);
+  file.PopValue("block", fBlock);
+  file.PopValue("block-size", fBlockSize);
+  file.PopValue("components", fComponents);
+  file.PopValue("write-matrix", fWriteMatrix);
+  if (fBlock >= 4)
+    QwWarning << "QwCovarianceMonitor: expect 0 <= block <= 3 but block = "
+              << fBlock << QwLog::endl;
+  if (fBlockSize < 1) fBlockSize = 1;
+  if (fComponents < 0) fComponents = 0;
+}
+
+/** Load the channel map, one channel per line
+ *
+ * @param mapfile Filename of map file
+ * @return Zero when success
+ */
+Int_t QwCovarianceMonitor::LoadChannelMap(const std::string& mapfile)
+{
+  // Open the file
+  QwParameterFile map(mapfile);
+
+  std::pair<EQwHandleType,std::string> type_name;
+  while (map.ReadNextLine()) {
+    // Throw away comments, whitespace, empty lines
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    string current_token = map.GetNextToken(" ");
+    type_name = ParseHandledVariable(current_token);
+    if (type_name.first == kHandleTypeUnknown || type_name.first == kHandleTypeMps) {
+      QwError << "LoadChannelMap in QwCovarianceMonitor read invalid channel "
+              << current_token << QwLog::endl;
+      continue;
+    }
+    fChannelType.push_back(type_name.first);
+    fChannelName.push_back(type_name.second);
+    fChannelFull.push_back(current_token);
+  }
+
+  return 0;
+}
+
+Int_t QwCovarianceMonitor::ConnectChannels(
+    QwSubsystemArrayParity& yield,
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+  return ConnectMonitoredChannels(&yield, asym, diff);
+}
+
+Int_t QwCovarianceMonitor::ConnectChannels(
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+  return ConnectMonitoredChannels(0, asym, diff);
+}
+
+Int_t QwCovarianceMonitor::ConnectMonitoredChannels(
+    QwSubsystemArrayParity* yield,
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  // Only keep the channels that were found
+  std::vector<std::string> full, name;
+  std::vector<EQwHandleType> type;
+  fChannelVar.clear();
+  for (size_t i = 0; i < fChannelFull.size(); i++) {
+    const VQwHardwareChannel* ptr = this->RequestExternalPointer(fChannelFull[i]);
+    if (ptr == NULL) {
+      switch (fChannelType[i]) {
+        case kHandleTypeAsym: ptr = asym.RequestExternalPointer(fChannelName[i]); break;
+        case kHandleTypeDiff: ptr = diff.RequestExternalPointer(fChannelName[i]); break;
+        case kHandleTypeYield:
+          if (yield) ptr = yield->RequestExternalPointer(fChannelName[i]);
+          break;
+        default: break;
+      }
+    }
+    if (ptr == NULL) {
+      QwWarning << "QwCovarianceMonitor::ConnectChannels: variable " << fChannelFull[i]
+                << " was not found." << QwLog::endl;
+      continue;
+    }
+    fChannelVar.push_back(ptr);
+    full.push_back(fChannelFull[i]);
+    name.push_back(fChannelName[i]);
+    type.push_back(fChannelType[i]);
+  }
+  fChannelFull = full;
+  fChannelName = name;
+  fChannelType = type;
+  nC = fChannelVar.size();
+  fComponents = std::min(fComponents, nC);
+
+  // Accumulators and result arrays, fixed in size so that the tree can point into them
+  fBuffer.assign(nC * fBlockSize, 0.0);
+  fRunningMean.assign(nC, 0.0);
+  fComoment.assign(nC * nC, 0.0);
+  fDelta.assign(nC, 0.0);
+  fMean.assign(nC, 0.0);
+  fWidth.assign(nC, 0.0);
+  fCorrelation.assign(fWriteMatrix? nC * nC: 0, 0.0);
+  fEigenValues.assign(fComponents, 0.0);
+  fEigenVectors.assign(fComponents * nC, 0.0);
+  ClearEventData();
+
+  QwMessage << "QwCovarianceMonitor: " << GetName() << ", " << nC
+            << " channels in blocks of " << fBlockSize << " patterns" << QwLog::endl;
+  return 0;
+}
+
+void QwCovarianceMonitor::ProcessData()
+{
+  if (nC == 0) return;
+
+  fTotalCount++;
+
+  // Event error flag and variable error codes
+  UInt_t error = GetEventcutErrorFlag();
+  for (int i = 0; i < nC; ++i)
+    error |= fChannelVar[i]->GetErrorCode();
+  if (error != 0) return;
+
+  fGoodCount++;
+
+  for (int i = 0; i < nC; ++i)
+    fBuffer[i * fBlockSize + fBufferedRows] = fChannelVar[i]->GetValue(fBlock+1);
+  if (++fBufferedRows == fBlockSize) FoldBlock();
+}
+
+/**
+ * Fold the buffered block of k patterns into the running means and
+ * co-moments.  The deviations X from the block mean m_b give the block
+ * co-moments X^T X, which are computed as one symmetric rank-k update of
+ * the upper triangle.  With n earlier patterns of mean m, the co-moments
+ * then gain (m_b - m)(m_b - m)^T n k / (n + k), as for the combination of
+ * two LinRegBevPeb objects.
+ */
+void QwCovarianceMonitor::FoldBlock()
+{
+  const int k = fBufferedRows;
+  if (k == 0) return;
+
+  // Block means and deviations
+  std::vector<Double_t>& delta = fDelta;
+  for (int i = 0; i < nC; i++) {
+    Double_t* x = &fBuffer[i * fBlockSize];
+    Double_t sum = 0.0;
+    for (int r = 0; r < k; r++) sum += x[r];
+    const Double_t mean = sum / k;
+    for (int r = 0; r < k; r++) x[r] -= mean;
+    delta[i] = mean - fRunningMean[i];
+  }
+
+  // Rank-k update of the upper triangle, four columns at a time
+  const Double_t weight = fCount * k / (fCount + k);
+  for (int i = 0; i < nC; i++) {
+    const Double_t* xi = &fBuffer[i * fBlockSize];
+    Double_t* row = &fComoment[i * nC];
+    int j = i;
+    for (; j + 3 < nC; j += 4) {
+      const Double_t* x0 = &fBuffer[(j+0) * fBlockSize];
+      const Double_t* x1 = &fBuffer[(j+1) * fBlockSize];
+      const Double_t* x2 = &fBuffer[(j+2) * fBlockSize];
+      const Double_t* x3 = &fBuffer[(j+3) * fBlockSize];
+      Double_t s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+      for (int r = 0; r < k; r++) {
+        s0 += xi[r] * x0[r];
+        s1 += xi[r] * x1[r];
+        s2 += xi[r] * x2[r];
+        s3 += xi[r] * x3[r];
+      }
+      row[j+0] += s0 + weight * delta[i] * delta[j+0];
+      row[j+1] += s1 + weight * delta[i] * delta[j+1];
+      row[j+2] += s2 + weight * delta[i] * delta[j+2];
+      row[j+3] += s3 + weight * delta[i] * delta[j+3];
+    }
+    for (; j < nC; j++) {
+      const Double_t* xj = &fBuffer[j * fBlockSize];
+      Double_t s = 0.0;
+      for (int r = 0; r < k; r++) s += xi[r] * xj[r];
+      row[j] += s + weight * delta[i] * delta[j];
+    }
+  }
+
+  // Running means
+  for (int i = 0; i < nC; i++)
+    fRunningMean[i] += delta[i] * k / (fCount + k);
+  fCount += k;
+  fBufferedRows = 0;
+}
+
+void QwCovarianceMonitor::ClearResults()
+{
+  fErrorFlag = -1;
+  std::fill(fMean.begin(), fMean.end(), 0.0);
+  std::fill(fWidth.begin(), fWidth.end(), 0.0);
+  std::fill(fCorrelation.begin(), fCorrelation.end(), 0.0);
+  std::fill(fEigenValues.begin(), fEigenValues.end(), 0.0);
+  std::fill(fEigenVectors.begin(), fEigenVectors.end(), 0.0);
+}
+
+void QwCovarianceMonitor::ClearEventData()
+{
+  fTotalCount = 0;
+  fGoodCount = 0;
+  fBufferedRows = 0;
+  fCount = 0.0;
+  std::fill(fRunningMean.begin(), fRunningMean.end(), 0.0);
+  std::fill(fComoment.begin(), fComoment.end(), 0.0);
+  ClearResults();
+}
+
+void QwCovarianceMonitor::AccumulateRunningSum(VQwDataHandler &value, Int_t count, Int_t ErrorMask)
+{
+  QwCovarianceMonitor* monitor = dynamic_cast<QwCovarianceMonitor*>(&value);
+  if (monitor == 0 || monitor->nC != nC) {
+    QwWarning << "QwCovarianceMonitor::AccumulateRunningSum "
+              << "can only accept other QwCovarianceMonitor objects with the same channels."
+              << QwLog::endl;
+    return;
+  }
+  FoldBlock();
+  monitor->FoldBlock();
+  const Double_t n = fCount, m = monitor->fCount;
+  if (m == 0) return;
+  std::vector<Double_t>& delta = fDelta;
+  for (int i = 0; i < nC; i++)
+    delta[i] = monitor->fRunningMean[i] - fRunningMean[i];
+  for (int i = 0; i < nC; i++)
+    for (int j = i; j < nC; j++)
+      fComoment[i * nC + j] += monitor->fComoment[i * nC + j]
+                             + delta[i] * delta[j] * n * m / (n + m);
+  for (int i = 0; i < nC; i++)
+    fRunningMean[i] += delta[i] * m / (n + m);
+  fCount += m;
+  fTotalCount += monitor->fTotalCount;
+  fGoodCount += monitor->fGoodCount;
+}
+
+/**
+ * Calculate the correlation matrix of the accumulated patterns, and
+ * diagonalize it.  Channels without variance have zero correlations.
+ */
+void QwCovarianceMonitor::CalcCorrelation()
+{
+  // Check if any channels are active
+  if (nC == 0) return;
+
+  FoldBlock();
+  ClearResults();
+  fBurst = fBurstCounter;
+
+  QwVerbose << "QwCovarianceMonitor::CalcCorrelation(): name=" << GetName() << ", "
+            << fGoodCount << " good patterns of " << fTotalCount << QwLog::endl;
+  if (fCount < 2) {
+    QwWarning << "QwCovarianceMonitor: " << fCount << " good patterns are not enough"
+              << QwLog::endl;
+    if (fTree) fTree->Fill();
+    return;
+  }
+
+  for (int i = 0; i < nC; i++) {
+    fMean[i] = fRunningMean[i];
+    fWidth[i] = std::sqrt(std::max(fComoment[i * nC + i], 0.0) / (fCount - 1));
+  }
+
+  TMatrixDSym corr(nC);
+  for (int i = 0; i < nC; i++) {
+    for (int j = i; j < nC; j++) {
+      Double_t norm = std::sqrt(fComoment[i * nC + i] * fComoment[j * nC + j]);
+      Double_t rho = (norm > 0.0)? fComoment[i * nC + j] / norm: 0.0;
+      if (i == j) rho = (norm > 0.0)? 1.0: 0.0;
+      corr(i,j) = corr(j,i) = rho;
+    }
+  }
+  if (fWriteMatrix)
+    for (int i = 0; i < nC; i++)
+      for (int j = 0; j < nC; j++)
+        fCorrelation[i * nC + j] = corr(i,j);
+
+  // Eigenvalues are sorted in decreasing order
+  if (fComponents > 0) {
+    TMatrixDSymEigen eigen(corr);
+    const TVectorD& lambda = eigen.GetEigenValues();
+    const TMatrixD& vectors = eigen.GetEigenVectors();
+    for (int k = 0; k < fComponents; k++) {
+      fEigenValues[k] = lambda(k);
+      for (int i = 0; i < nC; i++)
+        fEigenVectors[k * nC + i] = vectors(i,k);
+    }
+  }
+  fErrorFlag = 0;
+
+  // The trace of the correlation matrix is the number of varying channels
+  Double_t trace = 0.0;
+  for (int i = 0; i < nC; i++) trace += corr(i,i);
+  QwMessage << "QwCovarianceMonitor: " << GetName() << ", burst " << fBurst
+            << ", " << fCount << " patterns, " << nC << " channels" << QwLog::endl;
+  for (int k = 0; k < fComponents; k++) {
+    std::vector<std::pair<Double_t,int> > loadings(nC);
+    for (int i = 0; i < nC; i++)
+      loadings[i] = std::make_pair(-std::fabs(fEigenVectors[k * nC + i]), i);
+    const int shown = std::min(nC, 5);
+    std::partial_sort(loadings.begin(), loadings.begin() + shown, loadings.end());
+    QwMessage << "  component " << k << ": "
+              << Form("%.1f", trace > 0? 100.0 * fEigenValues[k] / trace: 0.0)
+              << "% of the variance;";
+    for (int l = 0; l < shown; l++) {
+      int i = loadings[l].second;
+      QwMessage << " " << fChannelFull[i] << Form(" %+.2f", fEigenVectors[k * nC + i]);
+    }
+    QwMessage << QwLog::endl;
+  }
+
+  // Fill tree
+  if (fTree) fTree->Fill();
+}
+
+void QwCovarianceMonitor::ConstructTreeBranches(
+    QwRootFile *treerootfile,
+    const std::string& treeprefix,
+    const std::string& branchprefix)
+{
+  // Check if any channels are active
+  if (nC == 0) {
+    return;
+  }
+
+  // Check if tree name is specified
+  if (fTreeName == "") {
+    QwWarning << "QwCovarianceMonitor: no tree name specified, use 'tree-name = value'" << QwLog::endl;
+    return;
+  }
+
+  // Construct tree name and create new tree
+  const std::string name = treeprefix + fTreeName;
+  treerootfile->NewTree(name, fTreeComment.c_str());
+  fTree = treerootfile->GetTree(name);
+  // Check to make sure the tree was created successfully
+  if (fTree == NULL) return;
+
+  // Set up branches
+  fTree->Branch(TString(branchprefix + "total_count"), &fTotalCount);
+  fTree->Branch(TString(branchprefix + "good_count"),  &fGoodCount);
+  fTree->Branch(TString(branchprefix + "burst"),       &fBurst);
+  fTree->Branch(TString(branchprefix + "ErrorFlag"),   &fErrorFlag);
+
+  auto branchm = [&](std::vector<Double_t>& m, int rows, const TString& n) {
+    fTree->Branch(TString(branchprefix) + n, m.data(), Form("%s[%d][%d]/D", n.Data(), rows, nC));
+  };
+  auto branchv = [&](std::vector<Double_t>& v, const TString& n) {
+    fTree->Branch(TString(branchprefix) + n, v.data(), Form("%s[%d]/D", n.Data(), (int) v.size()));
+  };
+
+  branchv(fMean,                     "mean");
+  branchv(fWidth,                    "width");
+  if (fWriteMatrix)
+    branchm(fCorrelation, nC,        "correlation");
+  if (fComponents > 0) {
+    branchv(fEigenValues,            "eigenvalues");
+    branchm(fEigenVectors, fComponents, "eigenvectors");  // [component][channel]
+  }
+}
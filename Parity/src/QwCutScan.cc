@@ -0,0 +1,436 @@
+/*!
+ * \file   QwCutScan.cc
+ * \brief  Pass fractions and asymmetry widths for a grid of cut thresholds
+ */
+
+#include "QwCutScan.h"
+
+// System headers
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// ROOT headers
+#include "TTree.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwParameterFile.h"
+#include "QwTypes.h"
+#include "QwEventRing.h"
+#include "QwHelicityPattern.h"
+#include "QwSubsystemArrayParity.h"
+#include "VQwHardwareChannel.h"
+
+QwCutScan::QwCutScan(QwOptions& options)
+: fRingSize(1), fHoldoff(0), fHoldoffIsActive(kFALSE),
+  fBurpExtent(0), fBurpPrecut(0), fBurpHoldoff(0),
+  fPushed(0), fPopped(0), fPatternNumber(-1),
+  fEvents(0), fPatterns(0), fSelectedPoint(0)
+{
+  ProcessOptions(options);
+}
+
+void QwCutScan::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Cut scan")
+    ("cutscan-map", po::value<std::string>()->default_value(""),
+     "map of cut variables with threshold grids, and of asymmetries, to scan in one replay");
+}
+
+void QwCutScan::ProcessOptions(QwOptions& options)
+{
+  fBurpHoldoff = options.GetValue<int>("burp.holdoff");
+
+  std::string mapfile = options.GetValue<std::string>("cutscan-map");
+  if (mapfile.size() > 0) LoadScanMap(mapfile);
+}
+
+/**
+ * Load the scan, one 'type channel [holdoff] threshold...' line per cut
+ * variable and one 'asym name' line per asymmetry
+ * @param mapfile Map file name
+ */
+void QwCutScan::LoadScanMap(const std::string& mapfile)
+{
+  fVariables.clear();
+  fAsymNames.clear();
+
+  QwParameterFile map(mapfile);
+  while (map.ReadNextLine()) {
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    TString type = map.GetNextToken(" \t");
+    std::string name = map.GetNextToken(" \t");
+    type.ToLower();
+    if (type == "asym") {
+      fAsymNames.push_back(name);
+      continue;
+    }
+
+    CutVariable var;
+    var.fName = name;
+    var.fHoldoff = kFALSE;
+    var.fChannel = 0;
+    var.fBurpSum = 0.0;
+    var.fBurpCount = 0;
+    if (type == "lower")      var.fType = kLowerLimit;
+    else if (type == "upper") var.fType = kUpperLimit;
+    else if (type == "burp")  var.fType = kBurp;
+    else {
+      QwError << "QwCutScan: unknown cut type " << type << " for "
+              << name << " in " << mapfile << QwLog::endl;
+      continue;
+    }
+    std::string token;
+    while (! (token = map.GetNextToken(" \t")).empty()) {
+      if (token == "holdoff") var.fHoldoff = kTRUE;
+      else var.fThresholds.push_back(atof(token.c_str()));
+    }
+    if (var.fThresholds.empty()) {
+      QwError << "QwCutScan: no thresholds for " << name << " in " << mapfile << QwLog::endl;
+      continue;
+    }
+    if (var.fHoldoff && var.fType == kBurp) {
+      QwWarning << "QwCutScan: burp cut failures on " << name
+                << " do not start the beam trip holdoff" << QwLog::endl;
+      var.fHoldoff = kFALSE;
+    }
+    fVariables.push_back(var);
+  }
+
+  BuildGrid();
+  QwMessage << "QwCutScan: " << fPointVariable.size() << " grid points for "
+            << fVariables.size() << " cut variables and "
+            << fAsymNames.size() << " asymmetries" << QwLog::endl;
+}
+
+/**
+ * List the grid points, in the order of the variables and thresholds
+ */
+void QwCutScan::BuildGrid()
+{
+  fPointVariable.clear();
+  fPointThreshold.clear();
+  fPointBounded.clear();
+  for (size_t v = 0; v < fVariables.size(); v++) {
+    for (size_t i = 0; i < fVariables[v].fThresholds.size(); i++) {
+      fPointVariable.push_back(v);
+      fPointThreshold.push_back(fVariables[v].fThresholds[i]);
+      fPointBounded.push_back(IsBounded(fVariables[v], fVariables[v].fThresholds[i]));
+    }
+  }
+}
+
+/**
+ * Check whether a threshold is looser than the global event cut or burp
+ * threshold in effect on the channel.  The events and patterns which fail
+ * the cut in effect never reach the scan, so such a threshold gives the
+ * results of the cut in effect.
+ * @param var Cut variable
+ * @param threshold Threshold of the grid point
+ * @return True if the cut in effect is tighter
+ */
+Bool_t QwCutScan::IsBounded(const CutVariable& var, Double_t threshold) const
+{
+  const VQwHardwareChannel* channel = var.fChannel;
+  if (channel == 0 || ! channel->IsGlobalCut()) return kFALSE;
+  const Double_t lower = channel->GetEventCutLowerLimit();
+  const Double_t upper = channel->GetEventCutUpperLimit();
+  switch (var.fType) {
+    case kLowerLimit:
+      return (upper >= lower && threshold < lower);
+    case kUpperLimit:
+      return (upper >= lower && threshold > upper);
+    case kBurp:
+      return (channel->GetBurpThreshold() > 0 && threshold > channel->GetBurpThreshold());
+  }
+  return kFALSE;
+}
+
+/**
+ * Look up the scanned channels in the events which enter the event ring,
+ * and the selected asymmetries in the pattern; variables and asymmetries
+ * which are not found are dropped.  Take the ring size, holdoff and burp
+ * settings from the event ring.
+ * @param detectors Subsystem array of the events which will be pushed
+ * @param pattern Helicity pattern of the pipeline
+ * @param ring Event ring of the pipeline
+ */
+void QwCutScan::ConnectChannels(
+    const QwSubsystemArrayParity& detectors,
+    QwHelicityPattern& pattern,
+    const QwEventRing& ring)
+{
+  std::vector<CutVariable> variables;
+  for (size_t v = 0; v < fVariables.size(); v++) {
+    fVariables[v].fChannel = detectors.RequestExternalPointer(fVariables[v].fName);
+    if (fVariables[v].fChannel == 0) {
+      QwWarning << "QwCutScan: channel " << fVariables[v].fName
+                << " was not found, and will not be scanned" << QwLog::endl;
+      continue;
+    }
+    variables.push_back(fVariables[v]);
+  }
+  fVariables = variables;
+
+  std::vector<std::string> names;
+  fAsymChannels.clear();
+  for (size_t a = 0; a < fAsymNames.size(); a++) {
+    const VQwHardwareChannel* channel = pattern.GetAsymmetry().RequestExternalPointer(fAsymNames[a]);
+    if (channel == 0) {
+      QwWarning << "QwCutScan: asymmetry " << fAsymNames[a]
+                << " was not found, and will not be scanned" << QwLog::endl;
+      continue;
+    }
+    names.push_back(fAsymNames[a]);
+    fAsymChannels.push_back(channel);
+  }
+  fAsymNames = names;
+
+  BuildGrid();
+  for (size_t point = 0; point < fPointVariable.size(); point++) {
+    if (fPointBounded[point])
+      QwWarning << "QwCutScan: threshold " << fPointThreshold[point] << " for "
+                << fVariables[fPointVariable[point]].fName
+                << " is looser than the event cut in effect, which bounds its results"
+                << QwLog::endl;
+  }
+
+  fRingSize = ring.GetRingSize();
+  fHoldoff = ring.GetHoldoff();
+  fHoldoffIsActive = ring.IsStabilityCheckOn();
+  fBurpExtent = ring.GetBurpExtent();
+  fBurpPrecut = ring.GetBurpPrecut();
+
+  const size_t npoints = fPointVariable.size();
+  fFailed.assign(fRingSize * npoints, 0);
+  fPushed = fPopped = 0;
+  fLastWasBCMFailure.assign(npoints, kFALSE);
+  fTripCountdown.assign(npoints, 0);
+  fLastTripEvent.assign(npoints, -1);
+  fBurpCountdown.assign(npoints, 0);
+  fPatternNumber = -1;
+  fPatternFailed.assign(npoints, 0);
+  fEvents = fPatterns = 0;
+  fEventsPassed.assign(npoints, 0);
+  fPatternsPassed.assign(npoints, 0);
+  fAsymMean.assign(npoints * fAsymChannels.size(), 0.0);
+  fAsymM2.assign(npoints * fAsymChannels.size(), 0.0);
+}
+
+/**
+ * Evaluate the grid cuts on an event which is pushed into the event ring,
+ * and emulate the beam trip holdoff and the burp cut of the event ring for
+ * each grid point.  The holdoff flags all events in the ring, i.e. all
+ * events which are less than the ring size before the last event in the
+ * holdoff; the burp cut flags the burp.precut events before the burp.
+ * @param event Event which is pushed into the event ring
+ */
+void QwCutScan::PushEvent(const QwSubsystemArrayParity& event)
+{
+  const size_t npoints = fPointVariable.size();
+  const Long64_t thisevent = fPushed++;
+  UChar_t* failed = &fFailed[Slot(thisevent) * npoints];
+  std::fill(failed, failed + npoints, 0);
+
+  // The event ring checks the holdoff once it is filled, and the burp cut
+  // once the burp average is filled
+  const Bool_t ring_ready = (thisevent >= fRingSize - 1);
+  const Bool_t check_burp = ring_ready || (thisevent > fBurpExtent);
+  const Bool_t bcm_failure = (event.GetEventcutErrorFlag() & kBCMErrorFlag) != 0;
+
+  size_t point = 0;
+  for (size_t v = 0; v < fVariables.size(); v++) {
+    CutVariable& var = fVariables[v];
+    Double_t value = var.fChannel->GetValue();
+
+    for (size_t i = 0; i < var.fThresholds.size(); i++, point++) {
+      Bool_t fail = kFALSE;
+      if (var.fType == kLowerLimit) {
+        fail = (value < var.fThresholds[i]);
+      } else if (var.fType == kUpperLimit) {
+        fail = (value > var.fThresholds[i]);
+      } else if (check_burp) {
+        Double_t average = (var.fBurpCount > 0)? var.fBurpSum / var.fBurpCount: 0.0;
+        if (std::fabs(value - average) > var.fThresholds[i]) {
+          fail = kTRUE;
+          fBurpCountdown[point] = fBurpHoldoff;
+        } else if (fBurpCountdown[point] > 0) {
+          fail = kTRUE;
+          fBurpCountdown[point]--;
+        }
+        if (fail) {
+          // Precut the events before the burp which are still in the ring
+          Long64_t first = std::max(thisevent - fBurpPrecut, fPopped);
+          for (Long64_t e = first; e < thisevent; e++)
+            fFailed[Slot(e) * npoints + point] = 1;
+        }
+      }
+      failed[point] = fail;
+
+      // Beam trip holdoff on consecutive BCM cut failures
+      Bool_t bcm = bcm_failure || (fail && var.fHoldoff);
+      if (fHoldoffIsActive && ring_ready) {
+        if (bcm && fLastWasBCMFailure[point]) fTripCountdown[point] = fHoldoff;
+        if (fTripCountdown[point] > 0) {
+          fTripCountdown[point]--;
+          fLastTripEvent[point] = thisevent;
+        }
+      }
+      fLastWasBCMFailure[point] = bcm;
+    }
+
+    // Move the burp average over the last burp.extent+1 events with good hardware
+    if (var.fType == kBurp) {
+      if (check_burp && var.fBurpWindow.size() > static_cast<size_t>(fBurpExtent)) {
+        if (var.fBurpWindow.front().second) {
+          var.fBurpSum -= var.fBurpWindow.front().first;
+          var.fBurpCount--;
+        }
+        var.fBurpWindow.pop_front();
+      }
+      Bool_t good = (var.fChannel->GetErrorCode() & kPreserveError) == 0;
+      var.fBurpWindow.push_back(std::make_pair(value, good));
+      if (good) {
+        var.fBurpSum += value;
+        var.fBurpCount++;
+      }
+    }
+  }
+}
+
+/**
+ * Count an event which leaves the event ring, after it was loaded into the
+ * helicity pattern.  The event fails a grid point when it failed the grid
+ * cut, was precut by a burp, or was in the ring during a holdoff.
+ * @param event Event out of the event ring
+ * @param pattern_number Pattern number of the helicity pattern
+ */
+void QwCutScan::PopEvent(const QwSubsystemArrayParity& event, Int_t pattern_number)
+{
+  if (fPopped >= fPushed) return;
+  const size_t npoints = fPointVariable.size();
+  const Long64_t thisevent = fPopped++;
+  const UChar_t* failed = &fFailed[Slot(thisevent) * npoints];
+
+  if (pattern_number != fPatternNumber) {
+    std::fill(fPatternFailed.begin(), fPatternFailed.end(), 0);
+    fPatternNumber = pattern_number;
+  }
+
+  Bool_t good = (event.GetEventcutErrorFlag() == 0);
+  if (good) fEvents++;
+  for (size_t point = 0; point < npoints; point++) {
+    if (failed[point] || fLastTripEvent[point] >= thisevent)
+      fPatternFailed[point] = 1;
+    else if (good)
+      fEventsPassed[point]++;
+  }
+}
+
+/**
+ * Accumulate the selected asymmetries of a pattern for the grid points at
+ * which none of its events failed.  Only patterns which enter the running
+ * sum are used.
+ * @param pattern Helicity pattern with a good asymmetry
+ */
+void QwCutScan::ProcessPattern(const QwHelicityPattern& pattern)
+{
+  if (pattern.GetEventcutErrorFlag() != 0) return;
+  fPatterns++;
+
+  const size_t nasym = fAsymChannels.size();
+  for (size_t point = 0; point < fPointVariable.size(); point++) {
+    if (fPatternFailed[point]) continue;
+    Double_t n = ++fPatternsPassed[point];
+    for (size_t a = 0; a < nasym; a++) {
+      // Running mean and sum of squared deviations (Welford)
+      Double_t& mean = fAsymMean[point * nasym + a];
+      Double_t delta = fAsymChannels[a]->GetValue() - mean;
+      mean += delta / n;
+      fAsymM2[point * nasym + a] += delta * (fAsymChannels[a]->GetValue() - mean);
+    }
+  }
+}
+
+void QwCutScan::PrintSummary() const
+{
+  static const char* types[] = { "lower", "upper", "burp" };
+  const size_t nasym = fAsymChannels.size();
+
+  QwMessage << "Cut scan over " << fEvents << " good events and "
+            << fPatterns << " good patterns" << QwLog::endl;
+  for (size_t point = 0; point < fPointVariable.size(); point++) {
+    const CutVariable& var = fVariables[fPointVariable[point]];
+    Double_t n = fPatternsPassed[point];
+    QwMessage << Form("%-6s %-20s %12g  events %10lld (%6.2f%%)  patterns %9lld (%6.2f%%)%s",
+                      types[var.fType], var.fName.c_str(), fPointThreshold[point],
+                      fEventsPassed[point], (fEvents > 0)? 100.0 * fEventsPassed[point] / fEvents: 0.0,
+                      fPatternsPassed[point], (fPatterns > 0)? 100.0 * n / fPatterns: 0.0,
+                      fPointBounded[point]? "  bounded by the cut in effect": "")
+              << QwLog::endl;
+    for (size_t a = 0; a < nasym; a++) {
+      Double_t width = (n > 0)? std::sqrt(fAsymM2[point * nasym + a] / n): 0.0;
+      QwMessage << Form("         %-28s mean %12.5g  width %12.5g  error %12.5g",
+                        fAsymNames[a].c_str(), fAsymMean[point * nasym + a],
+                        width, (n > 0)? width / std::sqrt(n): 0.0)
+                << QwLog::endl;
+    }
+  }
+}
+
+void QwCutScan::ConstructBranchAndVector(TTree *tree, TString& prefix, std::vector<Double_t>& values)
+{
+  fTreeArrayIndex[&values] = values.size();
+
+  std::vector<TString> names;
+  names.push_back("variable");
+  names.push_back("type");
+  names.push_back("threshold");
+  names.push_back("bounded");
+  names.push_back("events");
+  names.push_back("events_total");
+  names.push_back("patterns");
+  names.push_back("patterns_total");
+  for (size_t a = 0; a < fAsymNames.size(); a++) {
+    names.push_back(TString("asym_") + fAsymNames[a] + "_mean");
+    names.push_back(TString("asym_") + fAsymNames[a] + "_width");
+    names.push_back(TString("asym_") + fAsymNames[a] + "_err");
+  }
+
+  for (size_t i = 0; i < names.size(); i++) {
+    TString name = prefix + names[i];
+    values.push_back(0.0);
+    tree->Branch(name, &(values.back()), name + "/D");
+  }
+}
+
+void QwCutScan::FillTreeVector(std::vector<Double_t>& values) const
+{
+  std::map<const std::vector<Double_t>*, size_t>::const_iterator
+    index = fTreeArrayIndex.find(&values);
+  if (index == fTreeArrayIndex.end()) return;
+  if (fSelectedPoint >= fPointVariable.size()) return;
+
+  const size_t point = fSelectedPoint;
+  const size_t nasym = fAsymChannels.size();
+  size_t i = index->second;
+  values[i++] = fPointVariable[point];
+  values[i++] = fVariables[fPointVariable[point]].fType;
+  values[i++] = fPointThreshold[point];
+  values[i++] = fPointBounded[point];
+  values[i++] = fEventsPassed[point];
+  values[i++] = fEvents;
+  values[i++] = fPatternsPassed[point];
+  values[i++] = fPatterns;
+  Double_t n = fPatternsPassed[point];
+  for (size_t a = 0; a < nasym; a++) {
+    Double_t width = (n > 0)? std::sqrt(fAsymM2[point * nasym + a] / n): 0.0;
+    values[i++] = fAsymMean[point * nasym + a];
+    values[i++] = width;
+    values[i++] = (n > 0)? width / std::sqrt(n): 0.0;
+  }
+}
@@ -9,6 +9,7 @@
 
 // System headers
 #include <stdexcept>
+#include <algorithm>
 
 // Qweak headers
 #include "VQwDataHandler.h"
@@ -702,6 +703,46 @@ void QwDataHandlerArray::FinishDataHandler()
     }
   }
 }
+
+/**
+ * Read the map files of the selected handlers again, and check them against
+ * the connected channels, without changing the configuration in use.
+ *
+ * @param targets Handler names, or "handlers" for all handlers which can reload
+ * @param reloaded Names of the handlers which were read again
+ * @return False if a selected handler cannot use its new map file
+ */
+Bool_t QwDataHandlerArray::PrepareReload(
+    const std::vector<std::string>& targets,
+    std::vector<TString>& reloaded)
+{
+  Bool_t all = (std::find(targets.begin(), targets.end(), "handlers") != targets.end());
+  Bool_t status = kTRUE;
+  fReloadHandlers.clear();
+  for (iterator handler = begin(); handler != end(); ++handler) {
+    std::string name = (*handler)->GetName().Data();
+    Bool_t selected = (std::find(targets.begin(), targets.end(), name) != targets.end());
+    if (! selected && ! (all && (*handler)->CanReload())) continue;
+    if (! (*handler)->CanReload()) {
+      QwError << "Handler " << name << " cannot be reloaded" << QwLog::endl;
+      status = kFALSE;
+    } else if (! (*handler)->PrepareReload()) {
+      QwError << "Handler " << name << " rejected its new configuration" << QwLog::endl;
+      status = kFALSE;
+    } else {
+      fReloadHandlers.push_back(handler->get());
+      reloaded.push_back(name);
+    }
+  }
+  return status;
+}
+
+void QwDataHandlerArray::ApplyReload()
+{
+  for (size_t i = 0; i < fReloadHandlers.size(); i++)
+    fReloadHandlers.at(i)->ApplyReload();
+  fReloadHandlers.clear();
+}
   
   
   
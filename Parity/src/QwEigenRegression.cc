@@ -0,0 +1,430 @@
+/********************************************************************
+File Name: QwEigenRegression.cc
+
+Description:  This is the implementation file of the QwEigenRegression
+              class, which is a child of the VQwDataHandler class.
+              It regresses the dependent variables on the principal
+              components (eigenvector combinations) of the
+              independent variables.
+
+********************************************************************/
+
+#include "QwEigenRegression.h"
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// ROOT headers
+#include "TTree.h"
+#include "TMatrixDSym.h"
+#include "TMatrixDSymEigen.h"
+
+// Qweak headers
+#include "QwParameterFile.h"
+#include "QwRootFile.h"
+
+// Register this handler with the factory
+RegisterHandlerFactory(QwEigenRegression);
+
+
+QwEigenRegression::QwEigenRegression(const TString& name)
+: VQwDataHandler(name),
+  fBlock(-1),
+  fRank(0),
+  fEigenvalueCut(1.0e-9),
+  fStandardize(kFALSE),
+  nP(0),nY(0),
+  fBurst(0),
+  fTree(0)
+{
+  // Set default tree name and descriptions (in VQwDataHandler)
+  fTreeName = "eigen";
+  fTreeComment = "Principal component regression";
+  // Parsing separator
+  ParseSeparator = "_";
+
+  // Clear all data
+  ClearEventData();
+}
+
+QwEigenRegression::QwEigenRegression(const QwEigenRegression& source)
+: VQwDataHandler(source),
+  fIndependentFull(source.fIndependentFull),
+  fIndependentType(source.fIndependentType),
+  fIndependentName(source.fIndependentName),
+  fIndependentVar(source.fIndependentVar),
+  fIndependentValues(source.fIndependentValues),
+  fBlock(source.fBlock),
+  fRank(source.fRank),
+  fEigenvalueCut(source.fEigenvalueCut),
+  fStandardize(source.fStandardize),
+  nP(source.nP),nY(source.nY),
+  fBurst(0),
+  fEigenValues(source.fEigenValues),
+  fEigenVectors(source.fEigenVectors),
+  fComponentSlope(source.fComponentSlope),
+  fComponentError(source.fComponentError),
+  fSlope(source.fSlope),
+  fSlopeError(source.fSlopeError),
+  fMean(source.fMean),
+  fCorrectedMean(source.fCorrectedMean),
+  fCorrectedError(source.fCorrectedError),
+  fTree(0)
+{
+  linReg.setDims(nP, nY);
+  linReg.init();
+
+  // Clear all data
+  ClearEventData();
+}
+
+void QwEigenRegression::ParseConfigFile(QwParameterFile& file)
+{
+  VQwDataHandler::ParseConfigFile(file);
+  file.PopValue("block", fBlock);
+  file.PopValue("rank", fRank);
+  file.PopValue("eigenvalue-cut", fEigenvalueCut);
+  file.PopValue("standardize", fStandardize);
+  if (fBlock >= 4)
+    QwWarning << "QwEigenRegression: expect 0 <= block <= 3 but block = "
+              << fBlock << QwLog::endl;
+}
+
+/** Load the channel map, in the same format as for QwCorrelator
+ *
+ * @param mapfile Filename of map file
+ * @return Zero when success
+ */
+Int_t QwEigenRegression::LoadChannelMap(const std::string& mapfile)
+{
+  // Open the file
+  QwParameterFile map(mapfile);
+
+  std::pair<EQwHandleType,std::string> type_name;
+  while (map.ReadNextLine()) {
+    // Throw away comments, whitespace, empty lines
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    // First token is dv or iv, second token is the name like "asym_blah"
+    string primary_token = map.GetNextToken(" ");
+    string current_token = map.GetNextToken(" ");
+    type_name = ParseHandledVariable(current_token);
+
+    if (primary_token == "iv") {
+      fIndependentType.push_back(type_name.first);
+      fIndependentName.push_back(type_name.second);
+      fIndependentFull.push_back(current_token);
+    }
+    else if (primary_token == "dv") {
+      fDependentType.push_back(type_name.first);
+      fDependentName.push_back(type_name.second);
+      fDependentFull.push_back(current_token);
+    }
+    else if (primary_token == "treetype") {
+      // Used by the correlator only
+    }
+    else {
+      QwError << "LoadChannelMap in QwEigenRegression read invalid primary_token " << primary_token << QwLog::endl;
+    }
+  }
+
+  return 0;
+}
+
+Int_t QwEigenRegression::ConnectChannels(QwSubsystemArrayParity& asym, QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+
+  // Find a variable among the asymmetries or differences
+  auto connect = [&](EQwHandleType type, const std::string& name, const std::string& full) {
+    const VQwHardwareChannel* ptr = this->RequestExternalPointer(full);
+    if (ptr == NULL) {
+      switch (type) {
+        case kHandleTypeAsym: ptr = asym.RequestExternalPointer(name); break;
+        case kHandleTypeDiff: ptr = diff.RequestExternalPointer(name); break;
+        default: break;
+      }
+    }
+    if (ptr == NULL)
+      QwWarning << "QwEigenRegression::ConnectChannels: variable " << full
+                << " was not found." << QwLog::endl;
+    return ptr;
+  };
+
+  // Only keep the variables that were found
+  std::vector<std::string> found;
+  for (size_t dv = 0; dv < fDependentName.size(); dv++) {
+    const VQwHardwareChannel* ptr = connect(fDependentType[dv], fDependentName[dv], fDependentFull[dv]);
+    if (ptr == NULL) continue;
+    fDependentVar.push_back(ptr);
+    found.push_back(fDependentFull[dv]);
+  }
+  fDependentFull = found;
+  found.clear();
+  for (size_t iv = 0; iv < fIndependentName.size(); iv++) {
+    const VQwHardwareChannel* ptr = connect(fIndependentType[iv], fIndependentName[iv], fIndependentFull[iv]);
+    if (ptr == NULL) continue;
+    fIndependentVar.push_back(ptr);
+    found.push_back(fIndependentFull[iv]);
+  }
+  fIndependentFull = found;
+
+  fDependentValues.resize(fDependentVar.size());
+  fIndependentValues.resize(fIndependentVar.size());
+  nP = fIndependentVar.size();
+  nY = fDependentVar.size();
+
+  linReg.setDims(nP, nY);
+  linReg.init();
+
+  // Result arrays, fixed in size so that the tree can point into them
+  fEigenValues.assign(nP, 0.0);
+  fEigenVectors.assign(nP * nP, 0.0);
+  fComponentSlope.assign(nY * nP, 0.0);
+  fComponentError.assign(nY * nP, 0.0);
+  fSlope.assign(nY * nP, 0.0);
+  fSlopeError.assign(nY * nP, 0.0);
+  fMean.assign(nY, 0.0);
+  fCorrectedMean.assign(nY, 0.0);
+  fCorrectedError.assign(nY, 0.0);
+
+  return 0;
+}
+
+void QwEigenRegression::ProcessData()
+{
+  if (nP == 0 || nY == 0) return;
+
+  fTotalCount++;
+
+  // Event error flag and variable error codes
+  UInt_t error = GetEventcutErrorFlag();
+  for (size_t i = 0; i < fDependentVar.size(); ++i) {
+    error |= fDependentVar[i]->GetErrorCode();
+    fDependentValues[i] = fDependentVar[i]->GetValue(fBlock+1);
+  }
+  for (size_t i = 0; i < fIndependentVar.size(); ++i) {
+    error |= fIndependentVar[i]->GetErrorCode();
+    fIndependentValues[i] = fIndependentVar[i]->GetValue(fBlock+1);
+  }
+  if (error != 0) return;
+
+  fGoodCount++;
+
+  TVectorD P(fIndependentValues.size(), fIndependentValues.data());
+  TVectorD Y(fDependentValues.size(),   fDependentValues.data());
+  linReg += std::make_pair(P, Y);
+}
+
+void QwEigenRegression::ClearResults()
+{
+  fErrorFlag = -1;
+  fRankUsed = 0;
+  std::fill(fEigenValues.begin(), fEigenValues.end(), 0.0);
+  std::fill(fEigenVectors.begin(), fEigenVectors.end(), 0.0);
+  std::fill(fComponentSlope.begin(), fComponentSlope.end(), 0.0);
+  std::fill(fComponentError.begin(), fComponentError.end(), 0.0);
+  std::fill(fSlope.begin(), fSlope.end(), 0.0);
+  std::fill(fSlopeError.begin(), fSlopeError.end(), 0.0);
+  std::fill(fMean.begin(), fMean.end(), 0.0);
+  std::fill(fCorrectedMean.begin(), fCorrectedMean.end(), 0.0);
+  std::fill(fCorrectedError.begin(), fCorrectedError.end(), 0.0);
+}
+
+void QwEigenRegression::ClearEventData()
+{
+  fTotalCount = 0;
+  fGoodCount = 0;
+  linReg.clear();
+  ClearResults();
+}
+
+void QwEigenRegression::AccumulateRunningSum(VQwDataHandler &value, Int_t count, Int_t ErrorMask)
+{
+  QwEigenRegression* eigen = dynamic_cast<QwEigenRegression*>(&value);
+  if (eigen) {
+    linReg += eigen->linReg;
+  } else {
+    QwWarning << "QwEigenRegression::AccumulateRunningSum "
+              << "can only accept other QwEigenRegression objects."
+              << QwLog::endl;
+  }
+}
+
+/**
+ * Diagonalize the covariance matrix of the independent variables and
+ * regress the dependent variables on the retained components.
+ *
+ * With eigenvalues l_k and eigenvectors v_k of the covariance C_PP, the
+ * slope on component k is b_k = v_k.C_PY / l_k, with error
+ * sqrt(s^2 / ((n-1) l_k)) where s^2 is the residual variance for n-1-r
+ * degrees of freedom.  The equivalent slopes on the monitors are
+ * A = sum_k b_k v_k over the r retained components.
+ */
+void QwEigenRegression::CalcRegression()
+{
+  // Check if any channels are active
+  if (nP == 0 || nY == 0) return;
+
+  ClearResults();
+  fBurst = fBurstCounter;
+
+  const Double_t n = linReg.getUsedEve();
+  QwVerbose << "QwEigenRegression::CalcRegression(): name=" << GetName() << ", "
+            << fGoodCount << " good patterns of " << fTotalCount << QwLog::endl;
+  if (n < nP + 2) {
+    QwWarning << "QwEigenRegression: " << n << " good patterns are not enough for "
+              << nP << " independent variables" << QwLog::endl;
+    if (fTree) fTree->Fill();
+    return;
+  }
+
+  // Scale of the independent variables
+  std::vector<Double_t> scale(nP, 1.0);
+  if (fStandardize) {
+    for (int i = 0; i < nP; i++) {
+      linReg.getSigmaP(i, scale[i]);
+      if (! (scale[i] > 0.0)) scale[i] = 1.0;
+    }
+  }
+
+  // Covariance (or correlation) matrix of the independent variables
+  TMatrixDSym cpp(nP);
+  for (int i = 0; i < nP; i++) {
+    for (int j = i; j < nP; j++) {
+      Double_t covar = 0.0;
+      linReg.getCovarianceP(i, j, covar);
+      cpp(i,j) = cpp(j,i) = covar / (scale[i] * scale[j]);
+    }
+  }
+
+  // Eigenvalues are sorted in decreasing order
+  TMatrixDSymEigen eigen(cpp);
+  const TVectorD& lambda = eigen.GetEigenValues();
+  const TMatrixD& vectors = eigen.GetEigenVectors();
+
+  // Retained components
+  fRankUsed = 0;
+  while (fRankUsed < nP
+      && lambda(fRankUsed) > 0.0
+      && lambda(fRankUsed) > fEigenvalueCut * lambda(0)
+      && (fRank <= 0 || fRankUsed < fRank))
+    fRankUsed++;
+  const int r = fRankUsed;
+  if (r == 0 || n - 1 - r < 1) {
+    QwWarning << "QwEigenRegression: no components retained" << QwLog::endl;
+    if (fTree) fTree->Fill();
+    return;
+  }
+
+  for (int k = 0; k < nP; k++) {
+    fEigenValues[k] = lambda(k);
+    for (int i = 0; i < nP; i++)
+      fEigenVectors[k * nP + i] = vectors(i,k);
+  }
+
+  std::vector<Double_t> meanP(nP, 0.0), cpy(nP, 0.0);
+  for (int i = 0; i < nP; i++)
+    linReg.getMeanP(i, meanP[i]);
+
+  for (int iy = 0; iy < nY; iy++) {
+    Double_t cyy = 0.0;
+    linReg.getCovarianceY(iy, iy, cyy);
+    linReg.getMeanY(iy, fMean[iy]);
+    for (int i = 0; i < nP; i++) {
+      linReg.getCovariancePY(i, iy, cpy[i]);
+      cpy[i] /= scale[i];
+    }
+
+    // Slopes on the components and the explained variance
+    Double_t explained = 0.0;
+    for (int k = 0; k < r; k++) {
+      Double_t projection = 0.0;
+      for (int i = 0; i < nP; i++)
+        projection += vectors(i,k) * cpy[i];
+      fComponentSlope[iy * nP + k] = projection / lambda(k);
+      explained += projection * projection / lambda(k);
+    }
+    Double_t residual = std::max(cyy - explained, 0.0) * (n - 1) / (n - 1 - r);
+    for (int k = 0; k < r; k++)
+      fComponentError[iy * nP + k] = std::sqrt(residual / ((n - 1) * lambda(k)));
+
+    // Equivalent slopes on the monitors, and the corrected mean
+    fCorrectedMean[iy] = fMean[iy];
+    for (int i = 0; i < nP; i++) {
+      Double_t slope = 0.0, variance = 0.0;
+      for (int k = 0; k < r; k++) {
+        slope += vectors(i,k) * fComponentSlope[iy * nP + k];
+        variance += vectors(i,k) * vectors(i,k) * residual / ((n - 1) * lambda(k));
+      }
+      fSlope[iy * nP + i] = slope / scale[i];
+      fSlopeError[iy * nP + i] = std::sqrt(variance) / scale[i];
+      fCorrectedMean[iy] -= fSlope[iy * nP + i] * meanP[i];
+    }
+    fCorrectedError[iy] = std::sqrt(residual / n);
+  }
+  fErrorFlag = 0;
+
+  QwMessage << "QwEigenRegression: " << GetName() << ", " << n << " patterns, "
+            << r << " of " << nP << " components retained" << QwLog::endl;
+  for (int k = 0; k < nP; k++) {
+    QwVerbose << "  eigenvalue " << k << " = " << fEigenValues[k] << ":";
+    for (int i = 0; i < nP; i++)
+      QwVerbose << " " << fEigenVectors[k * nP + i] << "*" << fIndependentFull[i];
+    QwVerbose << QwLog::endl;
+  }
+
+  // Fill tree
+  if (fTree) fTree->Fill();
+}
+
+void QwEigenRegression::ConstructTreeBranches(
+    QwRootFile *treerootfile,
+    const std::string& treeprefix,
+    const std::string& branchprefix)
+{
+  // Check if any channels are active
+  if (nP == 0 || nY == 0) {
+    return;
+  }
+
+  // Check if tree name is specified
+  if (fTreeName == "") {
+    QwWarning << "QwEigenRegression: no tree name specified, use 'tree-name = value'" << QwLog::endl;
+    return;
+  }
+
+  // Construct tree name and create new tree
+  const std::string name = treeprefix + fTreeName;
+  treerootfile->NewTree(name, fTreeComment.c_str());
+  fTree = treerootfile->GetTree(name);
+  // Check to make sure the tree was created successfully
+  if (fTree == NULL) return;
+
+  // Set up branches
+  fTree->Branch(TString(branchprefix + "total_count"), &fTotalCount);
+  fTree->Branch(TString(branchprefix + "good_count"),  &fGoodCount);
+  fTree->Branch(TString(branchprefix + "burst"),       &fBurst);
+  fTree->Branch(TString(branchprefix + "ErrorFlag"),   &fErrorFlag);
+  fTree->Branch(TString(branchprefix + "rank"),        &fRankUsed);
+
+  auto branchm = [&](std::vector<Double_t>& m, int rows, const TString& n) {
+    fTree->Branch(TString(branchprefix) + n, m.data(), Form("%s[%d][%d]/D", n.Data(), rows, nP));
+  };
+  auto branchv = [&](std::vector<Double_t>& v, const TString& n) {
+    fTree->Branch(TString(branchprefix) + n, v.data(), Form("%s[%d]/D", n.Data(), (int) v.size()));
+  };
+
+  branchv(fEigenValues,       "eigenvalues");
+  branchm(fEigenVectors,  nP, "eigenvectors");  // [component][monitor]
+  branchm(fComponentSlope, nY, "B");            // slopes on the components
+  branchm(fComponentError, nY, "dB");
+  branchm(fSlope,          nY, "A");            // slopes on the monitors
+  branchm(fSlopeError,     nY, "dA");
+  branchv(fMean,              "MY");            // uncorrected mean
+  branchv(fCorrectedMean,     "MYp");           // corrected mean
+  branchv(fCorrectedError,    "dMYp");          // corrected mean error
+}
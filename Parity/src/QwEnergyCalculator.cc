@@ -70,8 +70,7 @@ void QwEnergyCalculator::ProcessEvent()
 {
   //Bool_t ldebug = kFALSE;
   //Double_t targetbeamangle = 0.0;
-  static QwMollerADC_Channel tmp;
-  tmp.InitializeChannel("tmp","derived");
+  QwMollerADC_Channel& tmp = fWork.tmp;
   tmp.ClearEventData();
 
   this->ClearEventData();
@@ -136,8 +135,7 @@ void QwEnergyCalculator::GetProjectedPosition(VQwBPM *device)
 
   if (idevice>fProperty.size()) return;  // Return without trying to find a new position if "device" doesn't contribute to the energy calculator
 
-  static QwMollerADC_Channel tmp;
-  tmp.InitializeChannel("tmp","derived");
+  QwMollerADC_Channel& tmp = fWork.tmp;
   tmp.ClearEventData();
   //  Set the device position value to be equal to the energy change 
   (device->GetPosition(VQwBPM::kXAxis))->AssignValueFrom(&fEnergyChange);
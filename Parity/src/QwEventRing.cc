@@ -187,6 +187,23 @@ QwSubsystemArrayParity& QwEventRing::pop(){
 }
 
 
+/**
+ * Discard the events in the ring without analyzing them, and reset the
+ * beam trip holdoff and the rolling and burp averages, as at the start of
+ * a run.  The ring is ready again after it has been filled.
+ */
+void QwEventRing::Clear()
+{
+  fNumberOfEvents = 0;
+  fNextToBeFilled = 0;
+  fNextToBeRead = 0;
+  bRING_READY = kFALSE;
+  countdown = 0;
+  fRollingAvg.ClearEventData();
+  fBurpAvg.ClearEventData();
+}
+
+
 Bool_t QwEventRing::IsReady(){ //Check for readyness to read data from the ring using the pop() routine   
   return bRING_READY;
 }
@@ -0,0 +1,472 @@
+/********************************************************************
+File Name: QwExpressionHandler.cc
+
+Description:  This is the implementation file of the
+              QwExpressionHandler class, which is a child of the
+              VQwDataHandler class.  Each line of the map file
+              defines one derived channel,
+                <type>_<name> = <expression>
+              where the expression combines published channels
+              (<type>_<channel>), numbers, the operators + - * / ^,
+              parentheses and the functions sqrt, log, log10, exp,
+              abs, sin, cos, tan, asin, acos, atan, atan2, min and
+              max.  Channels without a type prefix have the type of
+              the derived channel, and derived channels from earlier
+              lines can be used by their full name.
+
+********************************************************************/
+
+#include "QwExpressionHandler.h"
+
+// System includes
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwParameterFile.h"
+#include "QwVQWK_Channel.h"
+#include "QwMollerADC_Channel.h"
+
+// Register this handler with the factory
+RegisterHandlerFactory(QwExpressionHandler);
+
+
+/**
+ * Recursive descent parser which emits the stack program of an expression
+ * with the usual precedence: unary signs and the right-associative power
+ * bind stronger than products, which bind stronger than sums.
+ */
+class QwExpressionHandler::Parser {
+ public:
+  Parser(QwExpressionHandler& handler, const std::string& text,
+         EQwHandleType type, Expression& expr)
+  : fHandler(handler), fText(text), fPos(0), fType(type), fExpr(expr),
+    fDepth(0), fError("") { }
+
+  /// Parse the full text, and return an empty string or the error
+  std::string Parse() {
+    ParseSum();
+    SkipWhitespace();
+    if (fError.empty() && fPos < fText.size())
+      Fail("unexpected '" + fText.substr(fPos, 1) + "'");
+    return fError;
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (fPos < fText.size() && isspace(fText[fPos])) fPos++;
+  }
+  Bool_t Accept(char c) {
+    SkipWhitespace();
+    if (fPos < fText.size() && fText[fPos] == c) { fPos++; return kTRUE; }
+    return kFALSE;
+  }
+  void Expect(char c) {
+    if (! Accept(c)) Fail(std::string("expected '") + c + "'");
+  }
+  void Fail(const std::string& error) {
+    if (fError.empty())
+      fError = error + " at position " + std::to_string(fPos);
+    fPos = fText.size();
+  }
+
+  /// Append an instruction and keep track of the stack depth
+  void Emit(EQwOpcode opcode, size_t index = 0) {
+    Instruction instruction = { opcode, index };
+    fExpr.fProgram.push_back(instruction);
+    switch (opcode) {
+      case kOpVariable: case kOpConstant:
+        if (++fDepth > fExpr.fDepth) fExpr.fDepth = fDepth;
+        break;
+      case kOpAdd: case kOpSubtract: case kOpMultiply: case kOpDivide:
+      case kOpPower: case kOpAtan2: case kOpMin: case kOpMax:
+        fDepth--;
+        break;
+      default:
+        break;
+    }
+  }
+
+  void ParseSum() {
+    ParseProduct();
+    while (fError.empty()) {
+      if      (Accept('+')) { ParseProduct(); Emit(kOpAdd); }
+      else if (Accept('-')) { ParseProduct(); Emit(kOpSubtract); }
+      else break;
+    }
+  }
+  void ParseProduct() {
+    ParseUnary();
+    while (fError.empty()) {
+      if      (Accept('*')) { ParseUnary(); Emit(kOpMultiply); }
+      else if (Accept('/')) { ParseUnary(); Emit(kOpDivide); }
+      else break;
+    }
+  }
+  void ParseUnary() {
+    if      (Accept('-')) { ParseUnary(); Emit(kOpNegate); }
+    else if (Accept('+')) { ParseUnary(); }
+    else                  { ParsePower(); }
+  }
+  void ParsePower() {
+    ParsePrimary();
+    if (Accept('^')) { ParseUnary(); Emit(kOpPower); }
+  }
+  void ParsePrimary() {
+    SkipWhitespace();
+    if (fPos >= fText.size()) { Fail("unexpected end"); return; }
+    char c = fText[fPos];
+    if (Accept('(')) {
+      ParseSum();
+      Expect(')');
+    } else if (isdigit(c) || c == '.') {
+      const char* begin = fText.c_str() + fPos;
+      char* end = 0;
+      Double_t value = strtod(begin, &end);
+      if (end == begin) { Fail("invalid number"); return; }
+      fPos += end - begin;
+      fExpr.fConstants.push_back(value);
+      Emit(kOpConstant, fExpr.fConstants.size() - 1);
+    } else if (isalpha(c) || c == '_') {
+      size_t begin = fPos;
+      while (fPos < fText.size() && (isalnum(fText[fPos]) || fText[fPos] == '_')) fPos++;
+      std::string identifier = fText.substr(begin, fPos - begin);
+      if (Accept('(')) ParseFunction(identifier);
+      else ParseVariable(identifier);
+    } else {
+      Fail(std::string("unexpected '") + c + "'");
+    }
+  }
+  void ParseFunction(const std::string& function) {
+    static const struct { const char* fName; EQwOpcode fOpcode; size_t fArguments; } functions[] = {
+      {"sqrt", kOpSqrt, 1}, {"log", kOpLog, 1}, {"log10", kOpLog10, 1},
+      {"exp", kOpExp, 1}, {"abs", kOpAbs, 1},
+      {"sin", kOpSin, 1}, {"cos", kOpCos, 1}, {"tan", kOpTan, 1},
+      {"asin", kOpAsin, 1}, {"acos", kOpAcos, 1}, {"atan", kOpAtan, 1},
+      {"atan2", kOpAtan2, 2}, {"pow", kOpPower, 2},
+      {"min", kOpMin, 2}, {"max", kOpMax, 2}
+    };
+    for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+      if (function != functions[i].fName) continue;
+      ParseSum();
+      for (size_t arg = 1; arg < functions[i].fArguments; arg++) {
+        Expect(',');
+        ParseSum();
+      }
+      Expect(')');
+      Emit(functions[i].fOpcode);
+      return;
+    }
+    Fail("unknown function " + function);
+  }
+  void ParseVariable(const std::string& full) {
+    std::pair<EQwHandleType,std::string> type_name = fHandler.ParseHandledVariable(full);
+    if (type_name.first == kHandleTypeUnknown) {
+      // Channel without type prefix: same type as the derived channel
+      type_name.first  = fType;
+      type_name.second = full;
+    }
+    size_t index = 0;
+    while (index < fExpr.fOperandFull.size() && fExpr.fOperandFull[index] != full)
+      index++;
+    if (index == fExpr.fOperandFull.size()) {
+      fExpr.fOperandFull.push_back(full);
+      fExpr.fOperandType.push_back(type_name.first);
+      fExpr.fOperandName.push_back(type_name.second);
+    }
+    Emit(kOpVariable, index);
+  }
+
+  QwExpressionHandler& fHandler;
+  const std::string& fText;
+  size_t fPos;
+  EQwHandleType fType;
+  Expression& fExpr;
+  size_t fDepth;
+  std::string fError;
+};
+
+
+QwExpressionHandler::QwExpressionHandler(const TString& name)
+: VQwDataHandler(name)
+{
+  // Set default tree name and descriptions (in VQwDataHandler)
+  fTreeName = "expr";
+  fTreeComment = "Derived channels from expressions";
+  // Parsing separator
+  ParseSeparator = "_";
+  fKeepRunningSum = kTRUE;
+}
+
+QwExpressionHandler::QwExpressionHandler(const QwExpressionHandler& source)
+: VQwDataHandler(source),
+  fExpressions(source.fExpressions),
+  fConnected(source.fConnected),
+  fStack(source.fStack)
+{
+}
+
+/**
+ * Compile an expression into a stack program
+ *
+ * @param text Expression
+ * @param type Type of the derived channel, used for channels without prefix
+ * @param expr Compiled expression
+ * @return True if the expression is valid
+ */
+Bool_t QwExpressionHandler::Compile(
+    const std::string& text,
+    EQwHandleType type,
+    Expression& expr)
+{
+  expr.fText = text;
+  expr.fDepth = 0;
+  expr.fLanes = kNumLanes;
+  expr.fSamplesVQWK = 0;
+  expr.fSamplesMollerADC = 0;
+  std::string error = Parser(*this, text, type, expr).Parse();
+  if (! error.empty()) {
+    QwError << "QwExpressionHandler: " << error << " in expression '"
+            << text << "'" << QwLog::endl;
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+/** Load the channel map
+ *
+ * @param mapfile Filename of map file
+ * @return Zero when success
+ */
+Int_t QwExpressionHandler::LoadChannelMap(const std::string& mapfile)
+{
+  // Open the file
+  QwParameterFile map(mapfile);
+
+  std::pair<EQwHandleType,std::string> type_name;
+  while (map.ReadNextLine()) {
+    // Throw away comments, whitespace, empty lines
+    map.TrimComment();
+    map.TrimWhitespace();
+    if (map.LineIsEmpty()) continue;
+    // Split the line at the first equal sign
+    std::string line = map.GetLine();
+    size_t equal = line.find('=');
+    if (equal == std::string::npos) {
+      QwError << "QwExpressionHandler: no '=' in line '" << line << "'" << QwLog::endl;
+      continue;
+    }
+    std::string output = line.substr(0, equal);
+    output.erase(output.find_last_not_of(" \t") + 1);
+    type_name = ParseHandledVariable(output);
+    if (type_name.first == kHandleTypeUnknown) {
+      QwError << "QwExpressionHandler: derived channel " << output
+              << " needs a prefix mps_, yield_, asym_ or diff_" << QwLog::endl;
+      continue;
+    }
+
+    std::string text = line.substr(equal + 1);
+    text.erase(0, text.find_first_not_of(" \t"));
+
+    Expression expr;
+    if (! Compile(text, type_name.first, expr)) continue;
+    expr.fOutputFull = output;
+    expr.fOutputType = type_name.first;
+    expr.fOutputName = type_name.second;
+    fExpressions.push_back(expr);
+  }
+
+  QwMessage << "QwExpressionHandler: " << fExpressions.size()
+            << " derived channels in " << mapfile << QwLog::endl;
+  return 0;
+}
+
+Int_t QwExpressionHandler::ConnectChannels(QwSubsystemArrayParity& event)
+{
+  SetEventcutErrorFlagPointer(event.GetEventcutErrorFlagPointer());
+  return ConnectExpressions(&event, 0, 0, 0);
+}
+
+Int_t QwExpressionHandler::ConnectChannels(
+    QwSubsystemArrayParity& yield,
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+  return ConnectExpressions(0, &yield, &asym, &diff);
+}
+
+Int_t QwExpressionHandler::ConnectChannels(
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+  return ConnectExpressions(0, 0, &asym, &diff);
+}
+
+/**
+ * Connect the operands of the expressions, and create the derived channels
+ * of the types which are available in this scope
+ */
+Int_t QwExpressionHandler::ConnectExpressions(
+    QwSubsystemArrayParity* mps,
+    QwSubsystemArrayParity* yield,
+    QwSubsystemArrayParity* asym,
+    QwSubsystemArrayParity* diff)
+{
+  size_t depth = 0;
+  for (size_t i = 0; i < fExpressions.size(); i++) {
+    Expression& expr = fExpressions[i];
+
+    // Subsystem arrays indexed by EQwHandleType; derived channels of the
+    // other scope are quietly skipped
+    QwSubsystemArrayParity* arrays[] = { 0, mps, asym, diff, yield };
+    if (arrays[expr.fOutputType] == 0) continue;
+
+    expr.fOperandVar.assign(expr.fOperandFull.size(), 0);
+    Bool_t connected = kTRUE;
+    for (size_t op = 0; op < expr.fOperandFull.size(); op++) {
+      const VQwHardwareChannel* op_ptr = 0;
+      // Derived channels from earlier lines
+      for (size_t k = 0; k < fConnected.size() && op_ptr == 0; k++)
+        if (fExpressions[fConnected[k]].fOutputFull == expr.fOperandFull[op])
+          op_ptr = fOutputVar[k];
+      // Published variables
+      if (op_ptr == 0)
+        op_ptr = this->RequestExternalPointer(expr.fOperandFull[op]);
+      // Channels of the subsystem arrays
+      QwSubsystemArrayParity* array = arrays[expr.fOperandType[op]];
+      if (op_ptr == 0 && array != 0)
+        op_ptr = array->RequestExternalPointer(expr.fOperandName[op]);
+      if (op_ptr == 0) {
+        QwWarning << "QwExpressionHandler: operand " << expr.fOperandFull[op]
+                  << " of " << expr.fOutputFull << " could not be found."
+                  << QwLog::endl;
+        connected = kFALSE;
+        continue;
+      }
+      expr.fOperandVar[op] = op_ptr;
+
+      // Evaluate the blocks only if all operands have blocks
+      const QwVQWK_Channel* vqwk = dynamic_cast<const QwVQWK_Channel*>(op_ptr);
+      const QwMollerADC_Channel* moller = dynamic_cast<const QwMollerADC_Channel*>(op_ptr);
+      if (vqwk == 0 && moller == 0) expr.fLanes = 1;
+      if (expr.fSamplesVQWK == 0 && expr.fSamplesMollerADC == 0) {
+        expr.fSamplesVQWK = vqwk;
+        expr.fSamplesMollerADC = moller;
+      }
+    }
+    if (! connected) continue;
+
+    QwVQWK_Channel* output = new QwVQWK_Channel(expr.fOutputName, VQwDataElement::kDerived);
+    output->SetSubsystemName(fName);
+    fDependentFull.push_back(expr.fOutputFull);
+    fDependentType.push_back(expr.fOutputType);
+    fDependentName.push_back(expr.fOutputName);
+    fDependentVar.push_back(expr.fOperandVar.empty()? 0: expr.fOperandVar.front());
+    fOutputVar.push_back(output);
+    fConnected.push_back(i);
+
+    if (expr.fDepth > depth) depth = expr.fDepth;
+    QwVerbose << "QwExpressionHandler: " << expr.fOutputFull << " = "
+              << expr.fText << QwLog::endl;
+  }
+
+  // Allocate the stack once for all expressions
+  if (depth * kNumLanes > fStack.size())
+    fStack.assign(depth * kNumLanes, 0.0);
+
+  return 0;
+}
+
+void QwExpressionHandler::ProcessData()
+{
+  for (size_t i = 0; i < fConnected.size(); i++) {
+    Evaluate(fExpressions[fConnected[i]], static_cast<QwVQWK_Channel*>(fOutputVar[i]));
+  }
+}
+
+/**
+ * Run the stack program of an expression on the hardware sum and the blocks
+ * of its operands, which are evaluated side by side as lanes of each stack
+ * entry.  The error flag of the result is the OR of the error flags of the
+ * operands.  As for the ratio of channels, a division by zero gives zero;
+ * other results which are not finite are also set to zero.
+ */
+void QwExpressionHandler::Evaluate(const Expression& expr, QwVQWK_Channel* output)
+{
+  const size_t lanes = expr.fLanes;
+  Double_t* top = fStack.data();
+  UInt_t errorflag = 0;
+
+#define QW_UNARY(function) { \
+    Double_t* a = top - kNumLanes; \
+    for (size_t l = 0; l < lanes; l++) a[l] = function(a[l]); }
+#define QW_BINARY(expression) { \
+    Double_t* b = top - kNumLanes; \
+    Double_t* a = b - kNumLanes; \
+    for (size_t l = 0; l < lanes; l++) a[l] = (expression); \
+    top = b; }
+
+  for (size_t n = 0; n < expr.fProgram.size(); n++) {
+    const Instruction& instruction = expr.fProgram[n];
+    switch (instruction.fOpcode) {
+      case kOpVariable: {
+        const VQwHardwareChannel* var = expr.fOperandVar[instruction.fIndex];
+        for (size_t l = 0; l < lanes; l++) top[l] = var->GetValue(l);
+        errorflag |= var->GetErrorCode();
+        top += kNumLanes;
+        break;
+      }
+      case kOpConstant: {
+        Double_t value = expr.fConstants[instruction.fIndex];
+        for (size_t l = 0; l < lanes; l++) top[l] = value;
+        top += kNumLanes;
+        break;
+      }
+      case kOpAdd:      QW_BINARY(a[l] + b[l]); break;
+      case kOpSubtract: QW_BINARY(a[l] - b[l]); break;
+      case kOpMultiply: QW_BINARY(a[l] * b[l]); break;
+      case kOpDivide:   QW_BINARY(b[l] != 0.0? a[l] / b[l]: 0.0); break;
+      case kOpPower:    QW_BINARY(pow(a[l], b[l])); break;
+      case kOpAtan2:    QW_BINARY(atan2(a[l], b[l])); break;
+      case kOpMin:      QW_BINARY(a[l] < b[l]? a[l]: b[l]); break;
+      case kOpMax:      QW_BINARY(a[l] > b[l]? a[l]: b[l]); break;
+      case kOpNegate:   QW_UNARY(-); break;
+      case kOpSqrt:     QW_UNARY(sqrt); break;
+      case kOpLog:      QW_UNARY(log); break;
+      case kOpLog10:    QW_UNARY(log10); break;
+      case kOpExp:      QW_UNARY(exp); break;
+      case kOpAbs:      QW_UNARY(fabs); break;
+      case kOpSin:      QW_UNARY(sin); break;
+      case kOpCos:      QW_UNARY(cos); break;
+      case kOpTan:      QW_UNARY(tan); break;
+      case kOpAsin:     QW_UNARY(asin); break;
+      case kOpAcos:     QW_UNARY(acos); break;
+      case kOpAtan:     QW_UNARY(atan); break;
+    }
+  }
+
+#undef QW_UNARY
+#undef QW_BINARY
+
+  // Result is the only entry left on the stack; without blocks, the blocks
+  // are set to the value of the hardware sum
+  Double_t value[kNumLanes];
+  for (size_t l = 0; l < kNumLanes; l++) {
+    value[l] = fStack[l < lanes? l: 0];
+    if (! std::isfinite(value[l])) value[l] = 0.0;
+  }
+  size_t nsamples = 0;
+  Int_t goodcount = 0;
+  if (expr.fSamplesVQWK) {
+    nsamples = expr.fSamplesVQWK->GetNumberOfSamples();
+    goodcount = expr.fSamplesVQWK->GetGoodEventCount();
+  } else if (expr.fSamplesMollerADC) {
+    nsamples = expr.fSamplesMollerADC->GetNumberOfSamples();
+    goodcount = expr.fSamplesMollerADC->GetGoodEventCount();
+  }
+  output->SetDerivedEventData(value, nsamples, goodcount, errorflag);
+}
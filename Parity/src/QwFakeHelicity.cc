@@ -85,8 +85,6 @@ RegisterSubsystemFactory(QwFakeHelicity);
 
   Bool_t QwFakeHelicity::CollectRandBits()
  {
-   static Bool_t firsttimethrough = kTRUE;
-
    Bool_t  ldebug = kFALSE;
    UInt_t  ranseed = 0x2535D5&0xFFFFFF; //put a mask. 
   
@@ -94,10 +92,10 @@ RegisterSubsystemFactory(QwFakeHelicity);
      Buddhini did on the 24 bit helicity generater back in 2008.
   */
    // A modification to set the random seeds that are usually generated by the first 24 patterns.
-   if(! firsttimethrough){
+   if(! fFirstTimeThrough){
      return kTRUE;
    } else{
-     firsttimethrough = kFALSE;
+     fFirstTimeThrough = kFALSE;
      fGoodHelicity = kFALSE; //reset before prediction begins
      iseed_Delayed = ranseed;
      // Go 24 patterns back to get the reported helicity at this event
@@ -0,0 +1,76 @@
+/********************************************************************
+File Name: QwFeedbackControlEPICS.cc
+
+Description:  This is the implementation file of the
+              QwFeedbackControlEPICS class.  The process variables are
+              connected on first use and kept for the whole run.
+
+********************************************************************/
+
+#include "QwFeedbackControlEPICS.h"
+
+// Qweak headers
+#include "QwLog.h"
+
+QwFeedbackControlEPICS::QwFeedbackControlEPICS(Double_t timeout)
+: fTimeout(timeout)
+{
+  int status = ca_context_create(ca_disable_preemptive_callback);
+  if (status != ECA_NORMAL)
+    QwError << "Cannot create the EPICS Channel Access context: "
+            << ca_message(status) << QwLog::endl;
+}
+
+QwFeedbackControlEPICS::~QwFeedbackControlEPICS()
+{
+  std::map<std::string, chid>::iterator channel;
+  for (channel = fChannels.begin(); channel != fChannels.end(); ++channel)
+    if (channel->second) ca_clear_channel(channel->second);
+  ca_context_destroy();
+}
+
+chid QwFeedbackControlEPICS::Connect(const std::string& name)
+{
+  std::map<std::string, chid>::const_iterator channel = fChannels.find(name);
+  if (channel != fChannels.end()) return channel->second;
+
+  chid id = 0;
+  int status = ca_create_channel(name.c_str(), 0, 0, CA_PRIORITY_DEFAULT, &id);
+  if (status == ECA_NORMAL) status = ca_pend_io(fTimeout);
+  if (status != ECA_NORMAL) {
+    QwError << "Cannot connect to EPICS variable " << name << ": "
+            << ca_message(status) << QwLog::endl;
+    if (id) ca_clear_channel(id);
+    id = 0;
+  }
+  fChannels[name] = id;
+  return id;
+}
+
+Bool_t QwFeedbackControlEPICS::Get(const std::string& name, Double_t& value)
+{
+  chid id = Connect(name);
+  if (id == 0) return kFALSE;
+  int status = ca_get(DBR_DOUBLE, id, &value);
+  if (status == ECA_NORMAL) status = ca_pend_io(fTimeout);
+  if (status != ECA_NORMAL) {
+    QwError << "Cannot read EPICS variable " << name << ": "
+            << ca_message(status) << QwLog::endl;
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+Bool_t QwFeedbackControlEPICS::Set(const std::string& name, Double_t value)
+{
+  chid id = Connect(name);
+  if (id == 0) return kFALSE;
+  int status = ca_put(DBR_DOUBLE, id, &value);
+  if (status == ECA_NORMAL) status = ca_pend_io(fTimeout);
+  if (status != ECA_NORMAL) {
+    QwError << "Cannot write EPICS variable " << name << ": "
+            << ca_message(status) << QwLog::endl;
+    return kFALSE;
+  }
+  return kTRUE;
+}
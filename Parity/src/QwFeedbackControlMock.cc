@@ -0,0 +1,73 @@
+/********************************************************************
+File Name: QwFeedbackControlMock.cc
+
+Description:  This is the implementation file of the
+              QwFeedbackControlMock class, and of the factory of the
+              feedback control backends.
+
+********************************************************************/
+
+#include "QwFeedbackControlMock.h"
+
+// System headers
+#include <cstdlib>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwParameterFile.h"
+#ifdef __USE_EPICS__
+#include "QwFeedbackControlEPICS.h"
+#endif // __USE_EPICS__
+
+/**
+ * Create a feedback control backend
+ * @param type Type of the backend: 'mock' or 'epics'
+ * @param config File of initial values (mock), or the timeout in seconds (epics)
+ * @return New backend, or null if the type is not available
+ */
+VQwFeedbackControl* VQwFeedbackControl::Create(const std::string& type, const std::string& config)
+{
+  if (type == "mock")
+    return new QwFeedbackControlMock(config);
+#ifdef __USE_EPICS__
+  if (type == "epics")
+    return new QwFeedbackControlEPICS(config.size() > 0? atof(config.c_str()): 1.0);
+#endif // __USE_EPICS__
+  QwError << "No feedback control backend of type " << type
+          << " in this build" << QwLog::endl;
+  return 0;
+}
+
+QwFeedbackControlMock::QwFeedbackControlMock(const std::string& filename)
+{
+  if (filename.size() == 0) return;
+  QwParameterFile file(filename);
+  std::string name, value;
+  while (file.ReadNextLine()) {
+    file.TrimComment();
+    file.TrimWhitespace();
+    if (file.LineIsEmpty()) continue;
+    if (file.HasVariablePair("=", name, value))
+      fValues[name] = atof(value.c_str());
+  }
+  QwMessage << "Mock feedback controls: " << fValues.size()
+            << " initial values from " << filename << QwLog::endl;
+}
+
+Bool_t QwFeedbackControlMock::Get(const std::string& name, Double_t& value)
+{
+  std::map<std::string, Double_t>::const_iterator control = fValues.find(name);
+  if (control == fValues.end()) {
+    QwError << "Mock feedback control " << name << " has no value" << QwLog::endl;
+    return kFALSE;
+  }
+  value = control->second;
+  return kTRUE;
+}
+
+Bool_t QwFeedbackControlMock::Set(const std::string& name, Double_t value)
+{
+  QwVerbose << "Mock feedback control " << name << " = " << value << QwLog::endl;
+  fValues[name] = value;
+  return kTRUE;
+}
@@ -0,0 +1,407 @@
+/********************************************************************
+File Name: QwFeedbackHandler.cc
+
+Description:  This is the implementation file of the
+              QwFeedbackHandler class, which is a child of the
+              VQwDataHandler class.  It replaces the separate qwfeedback
+              executable, which decoded the ET stream a second time and
+              repeated the pattern analysis of QwHelicityPattern.
+
+********************************************************************/
+
+#include "QwFeedbackHandler.h"
+
+// System includes
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+// ROOT headers
+#include "TTimeStamp.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwParameterFile.h"
+#include "QwHelicityPattern.h"
+#include "VQwFeedbackControl.h"
+
+// Register this handler with the factory
+RegisterHandlerFactory(QwFeedbackHandler);
+
+std::map<std::string, const QwFeedbackHandler*> QwFeedbackHandler::fActiveHandlers;
+std::mutex QwFeedbackHandler::fActiveHandlersMutex;
+
+/// Split a comma-separated list of values
+static std::vector<std::string> SplitList(const std::string& list)
+{
+  std::vector<std::string> items;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    std::string item = list.substr(start, end - start);
+    size_t first = item.find_first_not_of(" \t");
+    size_t last = item.find_last_not_of(" \t");
+    if (first != std::string::npos)
+      items.push_back(item.substr(first, last - first + 1));
+    start = end + 1;
+  }
+  return items;
+}
+
+
+QwFeedbackHandler::QwFeedbackHandler(const TString& name)
+: VQwDataHandler(name),
+  fControlType("mock"),
+  fDryRun(kFALSE),
+  fIsActive(kFALSE),
+  fControl(0),
+  fPreviousPolarity(-9999),
+  fPreviousPattern(-1)
+{
+  // Parsing separator
+  ParseSeparator = "_";
+}
+
+QwFeedbackHandler::QwFeedbackHandler(const QwFeedbackHandler& source)
+: VQwDataHandler(source),
+  fLoops(source.fLoops),
+  fControlType(source.fControlType),
+  fControlConfig(source.fControlConfig),
+  fDryRun(source.fDryRun),
+  fStatusControl(source.fStatusControl),
+  fLogFile(source.fLogFile),
+  fIsActive(kFALSE),
+  fControl(0),
+  fPreviousPolarity(-9999),
+  fPreviousPattern(-1)
+{
+}
+
+QwFeedbackHandler::~QwFeedbackHandler()
+{
+  if (fIsActive) {
+    if (fControl && ! fDryRun && fStatusControl.size() > 0)
+      fControl->Set(fStatusControl, 0.0);
+    std::lock_guard<std::mutex> lock(fActiveHandlersMutex);
+    fActiveHandlers.erase(fName.Data());
+  }
+  delete fControl;
+}
+
+void QwFeedbackHandler::ParseConfigFile(QwParameterFile& file)
+{
+  VQwDataHandler::ParseConfigFile(file);
+  file.PopValue("control", fControlType);
+  file.PopValue("control-config", fControlConfig);
+  file.PopValue("dry-run", fDryRun);
+  file.PopValue("status", fStatusControl);
+  file.PopValue("log-file", fLogFile);
+}
+
+/** Load the feedback loops
+ *
+ * Each section defines one loop, e.g.
+ *   [pita]
+ *     input      = asym_qwk_charge
+ *     patterns   = 20000
+ *     precision  = 0.5
+ *     slope      = -3.2
+ *     setpoints  = C1068_QDAC01, C1068_QDAC02
+ *     signs      = +1, -1
+ *     limits     = 2000, 8000
+ * with the optional keys mode, scale, slope-ihwp-in, ihwp, clamp,
+ * damping and report.
+ *
+ * @param mapfile Filename of map file
+ * @return Zero when success
+ */
+Int_t QwFeedbackHandler::LoadChannelMap(const std::string& mapfile)
+{
+  // Open the file
+  QwParameterFile map(mapfile);
+  QwParameterFile* preamble = map.ReadSectionPreamble();
+  delete preamble;
+
+  std::string section_name;
+  QwParameterFile* section = 0;
+  while ((section = map.ReadNextSection(section_name))) {
+    section->EnableGreediness();
+    while (section->ReadNextLine()) { }
+
+    Loop loop;
+    loop.fName = section_name;
+    loop.fInput = 0;
+    loop.fMode = -1;
+    loop.fPatterns = 0;
+    loop.fPrecision = 0.0;
+    loop.fScale = 1.0e6;
+    loop.fSlope = 0.0;
+    loop.fSlopeIHWPIn = 0.0;
+    loop.fLower = -HUGE_VAL;
+    loop.fUpper = HUGE_VAL;
+    loop.fClamp = kFALSE;
+    loop.fDamping = kFALSE;
+    loop.fCount = loop.fCountSinceCheck = 0;
+    loop.fMean = loop.fM2 = 0.0;
+    loop.fCorrections = 0;
+
+    std::string setpoints, signs, limits, report;
+    section->PopValue("input", loop.fInputFull);
+    section->PopValue("mode", loop.fMode);
+    section->PopValue("patterns", loop.fPatterns);
+    section->PopValue("precision", loop.fPrecision);
+    section->PopValue("scale", loop.fScale);
+    section->PopValue("slope", loop.fSlope);
+    section->PopValue("slope-ihwp-in", loop.fSlopeIHWPIn);
+    section->PopValue("ihwp", loop.fIHWP);
+    section->PopValue("setpoints", setpoints);
+    section->PopValue("signs", signs);
+    section->PopValue("limits", limits);
+    section->PopValue("clamp", loop.fClamp);
+    section->PopValue("damping", loop.fDamping);
+    section->PopValue("report", report);
+    delete section; section = 0;
+
+    std::pair<EQwHandleType,std::string> type_name = ParseHandledVariable(loop.fInputFull);
+    loop.fInputType = type_name.first;
+    loop.fInputName = type_name.second;
+    loop.fSetpoints = SplitList(setpoints);
+    std::vector<std::string> sign_list = SplitList(signs);
+    for (size_t i = 0; i < loop.fSetpoints.size(); i++)
+      loop.fSigns.push_back(i < sign_list.size()? atof(sign_list[i].c_str()): 1.0);
+    std::vector<std::string> limit_list = SplitList(limits);
+    if (limit_list.size() == 2) {
+      loop.fLower = atof(limit_list[0].c_str());
+      loop.fUpper = atof(limit_list[1].c_str());
+    }
+    loop.fReport = SplitList(report);
+
+    if (loop.fInputType == kHandleTypeMps || loop.fInputType == kHandleTypeUnknown
+     || loop.fPatterns <= 0 || loop.fSlope == 0.0 || loop.fSetpoints.empty()
+     || loop.fMode < -1 || loop.fMode > 3) {
+      QwError << "QwFeedbackHandler: loop " << loop.fName << " needs an input "
+              << "asymmetry, difference or yield, patterns > 0, a nonzero slope, "
+              << "setpoints, and mode 0 to 3 if any" << QwLog::endl;
+      continue;
+    }
+    fLoops.push_back(loop);
+  }
+
+  return 0;
+}
+
+Int_t QwFeedbackHandler::ConnectChannels(
+    QwSubsystemArrayParity& yield,
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+  return ConnectLoops(&yield, asym, diff);
+}
+
+Int_t QwFeedbackHandler::ConnectChannels(
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  SetEventcutErrorFlagPointer(asym.GetEventcutErrorFlagPointer());
+  return ConnectLoops(0, asym, diff);
+}
+
+/**
+ * Connect the inputs of the loops, and claim the controls if no other
+ * instance of this handler drives them yet
+ */
+Int_t QwFeedbackHandler::ConnectLoops(
+    QwSubsystemArrayParity* yield,
+    QwSubsystemArrayParity& asym,
+    QwSubsystemArrayParity& diff)
+{
+  // Connect the monitored channels, among published values first
+  std::vector<Loop> loops;
+  for (size_t i = 0; i < fLoops.size(); i++) {
+    Loop& loop = fLoops[i];
+    loop.fInput = this->RequestExternalPointer(loop.fInputFull);
+    if (loop.fInput == NULL) {
+      switch (loop.fInputType) {
+        case kHandleTypeAsym:  loop.fInput = asym.RequestExternalPointer(loop.fInputName); break;
+        case kHandleTypeDiff:  loop.fInput = diff.RequestExternalPointer(loop.fInputName); break;
+        case kHandleTypeYield:
+          if (yield) loop.fInput = yield->RequestExternalPointer(loop.fInputName);
+          break;
+        default: break;
+      }
+    }
+    if (loop.fInput == NULL) {
+      QwWarning << "QwFeedbackHandler: input " << loop.fInputFull << " of loop "
+                << loop.fName << " was not found; loop disabled." << QwLog::endl;
+      continue;
+    }
+    loops.push_back(loop);
+  }
+  fLoops = loops;
+  if (fLoops.empty()) return 0;
+
+  // Only the first instance of this handler in the process drives the controls
+  std::lock_guard<std::mutex> lock(fActiveHandlersMutex);
+  if (fActiveHandlers.count(fName.Data()) > 0) {
+    QwVerbose << "QwFeedbackHandler " << fName << " is already running; "
+              << "this instance stays idle" << QwLog::endl;
+    return 0;
+  }
+  fControl = VQwFeedbackControl::Create(fControlType, fControlConfig);
+  if (fControl == 0) {
+    QwError << "QwFeedbackHandler " << fName << " has no control backend; "
+            << "feedback disabled" << QwLog::endl;
+    return 0;
+  }
+  fIsActive = kTRUE;
+  fActiveHandlers[fName.Data()] = this;
+  if (! fDryRun && fStatusControl.size() > 0)
+    fControl->Set(fStatusControl, 1.0);
+
+  QwMessage << "QwFeedbackHandler " << fName << ": " << fLoops.size()
+            << " feedback loops on the " << fControlType << " controls"
+            << (fDryRun? " (dry run)": "") << QwLog::endl;
+  return 0;
+}
+
+/**
+ * Helicity history of consecutive good patterns, from the helicity of the
+ * first window of the previous and the current pattern.
+ * @return Mode 0 to 3, or -1 if the previous pattern is not the last one
+ */
+Int_t QwFeedbackHandler::GetHelicityMode()
+{
+  if (fHelicityPattern == 0) return -1;
+  Int_t polarity = fHelicityPattern->GetPatternPolarity();
+  Int_t pattern = fHelicityPattern->GetPatternNumber();
+  Int_t mode = -1;
+  if (pattern == fPreviousPattern + 1
+   && (fPreviousPolarity == 0 || fPreviousPolarity == 1)
+   && (polarity == 0 || polarity == 1))
+    mode = 2 * (1 - fPreviousPolarity) + (1 - polarity);
+  fPreviousPolarity = polarity;
+  fPreviousPattern = pattern;
+  return mode;
+}
+
+void QwFeedbackHandler::ProcessData()
+{
+  if (! fIsActive) return;
+
+  Int_t mode = GetHelicityMode();
+  if (GetEventcutErrorFlag() != 0) return;
+
+  for (size_t i = 0; i < fLoops.size(); i++) {
+    Loop& loop = fLoops[i];
+    if (loop.fMode >= 0 && loop.fMode != mode) continue;
+    if (loop.fInput->GetErrorCode() != 0) continue;
+
+    // Running mean and second moment
+    Double_t value = loop.fInput->GetValue() * loop.fScale;
+    loop.fCount++;
+    Double_t delta = value - loop.fMean;
+    loop.fMean += delta / loop.fCount;
+    loop.fM2 += delta * (value - loop.fMean);
+
+    if (++loop.fCountSinceCheck >= loop.fPatterns)
+      ApplyCorrection(loop);
+  }
+}
+
+/**
+ * Move the setpoints of a loop by -sign * mean / slope when the mean is
+ * precise enough.  Otherwise, or when the new setpoints are out of the
+ * limits, the loop keeps accumulating and is checked again after the
+ * next block of patterns.
+ */
+void QwFeedbackHandler::ApplyCorrection(Loop& loop)
+{
+  loop.fCountSinceCheck = 0;
+  Double_t error = std::sqrt(loop.fM2) / loop.fCount;
+  Double_t width = std::sqrt(loop.fM2 / loop.fCount);
+  for (size_t i = 0; i < loop.fReport.size() && i < 3; i++)
+    if (! fDryRun)
+      fControl->Set(loop.fReport[i], (i == 0)? loop.fMean: (i == 1)? error: width);
+
+  if (loop.fPrecision > 0 && error > loop.fPrecision) {
+    QwMessage << "Feedback " << loop.fName << ": " << loop.fInputFull << " = "
+              << loop.fMean << " +/- " << error << ", precision of "
+              << loop.fPrecision << " not reached" << QwLog::endl;
+    return;
+  }
+
+  // Slope for the state of the insertable half-wave plate
+  Double_t slope = loop.fSlope;
+  Double_t ihwp = 0.0;
+  if (loop.fSlopeIHWPIn != 0.0 && loop.fIHWP.size() > 0
+   && fControl->Get(loop.fIHWP, ihwp) && ihwp != 0.0)
+    slope = loop.fSlopeIHWPIn;
+
+  Double_t correction = - loop.fMean / slope;
+  if (loop.fDamping) correction *= DampingFactor(loop.fMean);
+
+  // New setpoints
+  std::vector<Double_t> previous(loop.fSetpoints.size());
+  std::vector<Double_t> setpoint(loop.fSetpoints.size());
+  Bool_t in_range = kTRUE;
+  for (size_t i = 0; i < loop.fSetpoints.size(); i++) {
+    if (! fControl->Get(loop.fSetpoints[i], previous[i])) {
+      QwError << "Feedback " << loop.fName << ": cannot read "
+              << loop.fSetpoints[i] << "; no correction" << QwLog::endl;
+      return;
+    }
+    setpoint[i] = previous[i] + loop.fSigns[i] * correction;
+    if (setpoint[i] < loop.fLower || setpoint[i] > loop.fUpper) {
+      if (loop.fClamp)
+        setpoint[i] = (setpoint[i] < loop.fLower)? loop.fLower: loop.fUpper;
+      else
+        in_range = kFALSE;
+    }
+  }
+
+  // Log the correction
+  TString line = Form("%s %s pattern %d: %s = %g +/- %g (width %g, %d patterns)",
+                      TTimeStamp().AsString("s"), loop.fName.c_str(),
+                      fHelicityPattern? fHelicityPattern->GetPatternNumber(): 0,
+                      loop.fInputFull.c_str(), loop.fMean, error, width, loop.fCount);
+  for (size_t i = 0; i < loop.fSetpoints.size(); i++)
+    line += Form(", %s %g -> %g", loop.fSetpoints[i].c_str(), previous[i], setpoint[i]);
+  if (! in_range) line += ", out of limits";
+  else if (fDryRun) line += ", dry run";
+  QwMessage << "Feedback " << line << QwLog::endl;
+  if (fLogFile.size() > 0) {
+    std::ofstream log(fLogFile.c_str(), std::ios::app);
+    log << line << std::endl;
+  }
+  if (! in_range) return;
+
+  // Write the new setpoints, and start a new accumulation
+  if (! fDryRun)
+    for (size_t i = 0; i < loop.fSetpoints.size(); i++)
+      fControl->Set(loop.fSetpoints[i], setpoint[i]);
+  loop.fCorrections++;
+  loop.fCount = 0;
+  loop.fMean = loop.fM2 = 0.0;
+}
+
+/// Damping of the correction for small values (in ppm), as in qwfeedback
+Double_t QwFeedbackHandler::DampingFactor(Double_t value)
+{
+  Double_t abs = std::fabs(value);
+  if (abs < 0.01) return 0.01;
+  if (abs < 0.1)  return 0.1;
+  if (abs < 1.0)  return 0.25;
+  if (abs < 2.0)  return 0.5;
+  if (abs < 5.0)  return 0.75;
+  return 1.0;
+}
+
+void QwFeedbackHandler::FinishDataHandler()
+{
+  if (! fIsActive) return;
+  for (size_t i = 0; i < fLoops.size(); i++)
+    QwMessage << "Feedback " << fLoops[i].fName << ": "
+              << fLoops[i].fCorrections << " corrections" << QwLog::endl;
+}
@@ -9,6 +9,8 @@
 
 // System headers
 #include <stdexcept>
+#include <algorithm>
+#include <iomanip>
 
 // ROOT headers
 #include "TRegexp.h"
@@ -22,8 +24,6 @@
 #include "QwParityDB.h"
 #endif // __USE_DATABASE__
 #include "QwLog.h"
-
-extern QwHistogramHelper gQwHists;
 //**************************************************//
 
 // Register this subsystem with the factory
@@ -48,9 +48,14 @@ QwHelicity::QwHelicity(const TString& name)
   kPatternCounter(-1), kMpsCounter(-1), kPatternPhase(-1),
   fMinPatternPhase(1), fUsePredictor(kTRUE), fIgnoreHelicity(kFALSE),
   fEventNumberFirst(-1),fPatternNumberFirst(-1),
-  fSuppressMPSErrorMsgs(kFALSE)
+  fCrossCheckSources(kFALSE),
+  fCrossCheckInputRegister(-1), fCrossCheckUserbit(-1),
+  fSuppressMPSErrorMsgs(kFALSE),
+  fFirstEvent(kTRUE), fFirstPattern(kTRUE), fFakeTheCounters(kFALSE),
+  fLastUserbits(0xFF)
 {
   ClearErrorCounters();
+  ClearCrossCheckCounters();
   // Default helicity delay to two patterns.
   fHelicityDelay = 2;
   // Default the EventType flags to HelPlus=1 and HelMinus=4
@@ -70,6 +75,7 @@ QwHelicity::QwHelicity(const TString& name)
   fHelicityBitPlus=kFALSE;
   fHelicityBitMinus=kFALSE;
   n_ranbits = 0;
+  std::fill(fFirst24Bits, fFirst24Bits + 25, 0);
   fGoodHelicity=kFALSE;
   fGoodPattern=kFALSE;
   fHelicityDecodingMode=-1;
@@ -95,11 +101,18 @@ QwHelicity::QwHelicity(const QwHelicity& source)
   kPatternPhase(source.kPatternPhase),
   fMinPatternPhase(1), fUsePredictor(kTRUE), fIgnoreHelicity(kFALSE),
   fEventNumberFirst(-1),fPatternNumberFirst(-1),
-  fSuppressMPSErrorMsgs(kFALSE)
+  fCrossCheckSources(source.fCrossCheckSources),
+  fCrossCheckInputRegister(source.fCrossCheckInputRegister),
+  fCrossCheckUserbit(source.fCrossCheckUserbit),
+  fSuppressMPSErrorMsgs(kFALSE),
+  fFirstEvent(source.fFirstEvent), fFirstPattern(source.fFirstPattern),
+  fFakeTheCounters(source.fFakeTheCounters),
+  fLastUserbits(source.fLastUserbits)
 {
   fHelicityBitPattern = source.fHelicityBitPattern; 
   //std::cout << source.fHelicityBitPattern.size() << " " << fHelicityBitPattern.size() << std::endl;
   ClearErrorCounters();
+  ClearCrossCheckCounters();
   // Default helicity delay to two patterns.
   fHelicityDelay = 2;
   // Default the EventType flags to HelPlus=1 and HelMinus=4
@@ -149,6 +162,7 @@ QwHelicity::QwHelicity(const QwHelicity& source)
   iseed_Delayed = source.iseed_Delayed;
   iseed_Actual = source.iseed_Actual;
   n_ranbits = source.n_ranbits;
+  std::copy(source.fFirst24Bits, source.fFirst24Bits + 25, fFirst24Bits);
   fEventNumber = source.fEventNumber;
   fEventNumberOld = source.fEventNumberOld;
   fPatternPhaseNumber = source.fPatternPhaseNumber;
@@ -181,6 +195,9 @@ void QwHelicity::DefineOptions(QwOptions &options)
   options.AddOptions("Helicity options")
       ("helicity.toggle-mode", po::value<bool>()->default_bool_value(false),
           "Activates helicity toggle-mode, overriding the 'delay', 'patternphase', 'bitpattern', and 'seed' options.");
+  options.AddOptions("Helicity options")
+      ("helicity.crosscheck", po::value<bool>()->default_bool_value(false),
+          "Compare the reported helicity with all other helicity sources in the data stream, and flag disagreements");
 }
 
 //**************************************************//
@@ -241,6 +258,10 @@ void QwHelicity::ProcessOptions(QwOptions &options)
     BuildHelicityBitPattern(fMaxPatternPhase);
   }
 
+  fCrossCheckSources = options.GetValue<bool>("helicity.crosscheck");
+  if (fCrossCheckSources)
+    QwMessage << " Helicity sources will be cross-checked" << QwLog::endl;
+
   //  Here we're going to try to get the "online" option which
   //  is defined by QwEventBuffer.
   if (options.HasValue("online")){
@@ -449,6 +470,7 @@ void QwHelicity::PrintErrorCounters() const{
   QwMessage << "Number of helicity prediction errors: "
 	    << fNumHelicityErrors
 	    << QwLog::endl;
+  if (fCrossCheckSources) PrintCrossCheckSummary();
   QwMessage <<"---------------------------------------------------\n"
 	    << QwLog::endl;
 }
@@ -466,7 +488,6 @@ void QwHelicity::ProcessEventUserbitMode()
   
   Bool_t ldebug=kFALSE;
   UInt_t userbits;
-  static UInt_t lastuserbits  = 0xFF;
   UInt_t scaleroffset=fWord[kScalerCounter].fValue/32;
 
   if(scaleroffset==1 || scaleroffset==0) {
@@ -475,12 +496,12 @@ void QwHelicity::ProcessEventUserbitMode()
     //  Now fake the input register, MPS coutner, QRT counter, and QRT phase.
     fEventNumber=fEventNumberOld+1;
 
-    lastuserbits = userbits;
+    fLastUserbits = userbits;
 
-    if (lastuserbits==0xFF) {
+    if (fLastUserbits==0xFF) {
       fPatternPhaseNumber    = fMinPatternPhase;
     } else {
-      if ((lastuserbits & 0x8) == 0x8) {
+      if ((fLastUserbits & 0x8) == 0x8) {
 	//  Quartet bit is set.
 	fPatternPhaseNumber    = fMinPatternPhase;  // Reset the QRT phase
 	fPatternNumber=fPatternNumberOld+1;     // Increment the QRT counter
@@ -490,7 +511,7 @@ void QwHelicity::ProcessEventUserbitMode()
 
       fHelicityReported=0;
 
-      if ((lastuserbits & 0x4) == 0x4){ //  Helicity bit is set.
+      if ((fLastUserbits & 0x4) == 0x4){ //  Helicity bit is set.
 	fHelicityReported    |= 1; // Set the InputReg HEL+ bit.
 	fHelicityBitPlus=kTRUE;
 	fHelicityBitMinus=kFALSE;
@@ -536,15 +557,12 @@ void QwHelicity::ProcessEventUserbitMode()
 
 void QwHelicity::ProcessEventInputRegisterMode()
 {
-  static Bool_t firstevent   = kTRUE;
-  static Bool_t firstpattern = kTRUE;
-  static Bool_t fake_the_counters=kFALSE;
   UInt_t thisinputregister=fWord[kInputRegister].fValue;
 
-  if (firstpattern){
+  if (fFirstPattern){
     //  If any of the special counters are negative or zero, setup to
     //  generate the counters internally.
-    fake_the_counters |= (kPatternCounter<=0)
+    fFakeTheCounters |= (kPatternCounter<=0)
       || ( kMpsCounter<=0) || (kPatternPhase<=0);
   }
   
@@ -557,7 +575,7 @@ void QwHelicity::ProcessEventInputRegisterMode()
       we can enable fake counters for mps, pattern number and pattern
       phase to get the job done.
   */
-  if (!fake_the_counters){
+  if (!fFakeTheCounters){
     /**
        In the Input Register Mode,
        the event number is obtained straight from the wordkMPSCounter.
@@ -567,13 +585,13 @@ void QwHelicity::ProcessEventInputRegisterMode()
     // and the input register minimum phase bit is set
     // we can select the second pattern as below.
     if(fWord[kPatternPhase].fValue - fPatternPhaseOffset == 0)
-      if (firstpattern && CheckIORegisterMask(thisinputregister,fInputReg_PatternSync)){
-	firstpattern   = kFALSE;
+      if (fFirstPattern && CheckIORegisterMask(thisinputregister,fInputReg_PatternSync)){
+	fFirstPattern = kFALSE;
       }
     
-    // If firstpattern is still TRUE, we are still searching for the first
+    // If fFirstPattern is still TRUE, we are still searching for the first
     // pattern of the data stream. So set the pattern number = 0
-    if (firstpattern)
+    if (fFirstPattern)
       fPatternNumber      = -1;
     else {
       fPatternNumber      = fWord[kPatternCounter].fValue;
@@ -592,8 +610,8 @@ void QwHelicity::ProcessEventInputRegisterMode()
   }
 
 
-  if (firstevent){
-    firstevent = kFALSE;
+  if (fFirstEvent){
+    fFirstEvent = kFALSE;
   } else if(fEventNumber!=(fEventNumberOld+1)){
     Int_t nummissed(fEventNumber - (fEventNumberOld+1));
     if (!fSuppressMPSErrorMsgs){
@@ -644,10 +662,8 @@ void QwHelicity::ProcessEventInputRegisterMode()
 
 void QwHelicity::ProcessEventInputMollerMode()
 {
-  static Bool_t firstpattern = kTRUE;
-
-  if(firstpattern && fWord[kPatternCounter].fValue > fPatternNumberOld){
-    firstpattern = kFALSE;
+  if(fFirstPattern && fWord[kPatternCounter].fValue > fPatternNumberOld){
+    fFirstPattern = kFALSE;
   }
   
   fEventNumber=fWord[kMpsCounter].fValue;
@@ -659,7 +675,7 @@ void QwHelicity::ProcessEventInputMollerMode()
     fNumMissedGates += nummissed;
     fNumMissedEventBlocks++;
   }
-  if (firstpattern){
+  if (fFirstPattern){
     fPatternNumber      = -1;
     fPatternPhaseNumber = fMinPatternPhase;
   } else {
@@ -713,6 +729,11 @@ void  QwHelicity::ProcessEvent()
 
   if(fHelicityBitPlus==fHelicityBitMinus)
     fHelicityReported=-1;
+
+  //  Keep the decoded reported helicity and the prediction error count,
+  //  since the predictor may overwrite the former and increment the latter
+  Int_t reported        = fHelicityReported;
+  Int_t helicity_errors = fNumHelicityErrors;
     
   // Predict helicity if delay is non zero.
   if(fUsePredictor && !fIgnoreHelicity){
@@ -740,11 +761,113 @@ void  QwHelicity::ProcessEvent()
 
   }
   //std::cout << fPatternPhaseNumber << " " << fHelicityReported << " LOOK HERE !!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+
+  if (fCrossCheckSources && !fIgnoreHelicity)
+    CrossCheckSources(reported, helicity_errors);
+
   return;
 
 }
 
 
+/**
+ * Compare the reported helicity decoded in the configured mode with the
+ * other helicity sources in the data stream: the helicity bits of the input
+ * register, the helicity bit of the userbit word, and the predictor (which
+ * compares the delayed reported helicity with the predicted one).  Each
+ * disagreement is counted per source and sets the helicity error flag, so
+ * that the event and its pattern are cut like for a prediction error.
+ * @param reported Reported helicity decoded in the configured mode
+ * @param helicity_errors Number of prediction errors before this event
+ */
+void QwHelicity::CrossCheckSources(Int_t reported, Int_t helicity_errors)
+{
+  //  Book-keeping of the patterns with at least one disagreement
+  if (fPatternNumber != fCrossCheckPatternNumber) {
+    if (fCrossCheckPatternNumber >= 0) {
+      fNumPatternsCrossChecked++;
+      if (fCrossCheckPatternDisagrees) fNumPatternsDisagreeing++;
+    }
+    fCrossCheckPatternNumber    = fPatternNumber;
+    fCrossCheckPatternDisagrees = kFALSE;
+  }
+  //  Nothing to compare with for undefined helicity
+  if (reported != 0 && reported != 1) return;
+
+  Bool_t disagrees[kNumHelicitySources] = {kFALSE};
+
+  //  Helicity bits of the input register
+  if (fHelicityDecodingMode != kHelInputRegisterMode
+      && fCrossCheckInputRegister >= 0) {
+    UInt_t inputregister = fWord[fCrossCheckInputRegister].fValue;
+    Bool_t plus  = CheckIORegisterMask(inputregister,fInputReg_HelPlus);
+    Bool_t minus = CheckIORegisterMask(inputregister,fInputReg_HelMinus);
+    fNumSourceCompared[kSourceInputRegister]++;
+    disagrees[kSourceInputRegister] = (plus == minus) || (plus != (reported == 1));
+  }
+
+  //  Helicity bit of the userbit word
+  if (fHelicityDecodingMode != kHelUserbitMode
+      && fCrossCheckUserbit >= 0) {
+    Int_t userbit = ((fWord[fCrossCheckUserbit].fValue & 0x40000000) != 0);
+    fNumSourceCompared[kSourceUserbit]++;
+    disagrees[kSourceUserbit] = (userbit != reported);
+  }
+
+  //  Delayed reported helicity against the predictor
+  if (fUsePredictor) {
+    fNumSourceCompared[kSourcePredictor]++;
+    disagrees[kSourcePredictor] = (fNumHelicityErrors > helicity_errors);
+  }
+
+  for (Int_t i = 0; i < kNumHelicitySources; i++) {
+    if (! disagrees[i]) continue;
+    fNumSourceDisagreements[i]++;
+    fCrossCheckPatternDisagrees = kTRUE;
+    fErrorFlag = kErrorFlag_Helicity + kGlobalCut + kEventCutMode3;
+  }
+}
+
+void QwHelicity::ClearCrossCheckCounters()
+{
+  for (Int_t i = 0; i < kNumHelicitySources; i++) {
+    fNumSourceCompared[i]     = 0;
+    fNumSourceDisagreements[i] = 0;
+  }
+  fNumPatternsCrossChecked    = 0;
+  fNumPatternsDisagreeing     = 0;
+  fCrossCheckPatternNumber    = -1;
+  fCrossCheckPatternDisagrees = kFALSE;
+}
+
+void QwHelicity::PrintCrossCheckSummary() const
+{
+  static const char* names[kNumHelicitySources] =
+    {"input register", "userbit", "predictor"};
+
+  //  Include the pattern in progress
+  Int_t patterns    = fNumPatternsCrossChecked;
+  Int_t disagreeing = fNumPatternsDisagreeing;
+  if (fCrossCheckPatternNumber >= 0) {
+    patterns++;
+    if (fCrossCheckPatternDisagrees) disagreeing++;
+  }
+
+  QwMessage << "Helicity source consistency (reported helicity compared with):"
+	    << QwLog::endl;
+  for (Int_t i = 0; i < kNumHelicitySources; i++) {
+    if (fNumSourceCompared[i] == 0) continue;
+    QwMessage << "  " << std::setw(15) << std::left << names[i] << std::right
+	      << fNumSourceDisagreements[i] << " disagreements in "
+	      << fNumSourceCompared[i] << " events"
+	      << QwLog::endl;
+  }
+  QwMessage << "  Patterns with disagreements: " << disagreeing
+	    << " of " << patterns
+	    << QwLog::endl;
+}
+
+
 void QwHelicity::EncodeEventData(std::vector<UInt_t> &buffer)
 {
   std::vector<UInt_t> localbuffer;
@@ -975,6 +1098,9 @@ Int_t QwHelicity::LoadChannelMap(TString mapfile)
       
       // Notice that "namech" is in lower-case, so these checks
       // should all be in lower-case
+      // The redundant helicity sources are recorded in all modes
+      if(namech.Contains("input_register")) fCrossCheckInputRegister = fWord.size()-1;
+      if(namech.Contains("userbit")) fCrossCheckUserbit = fWord.size()-1;
       switch (fHelicityDecodingMode)
 	{
 	case kHelUserbitMode :
@@ -1742,14 +1868,12 @@ Bool_t QwHelicity::CollectRandBits24()
     }
 
 
-  static UShort_t first24bits[25]; //array to store the first 24 bits
-
   fGoodHelicity = kFALSE; //reset before prediction begins
   if(IsContinuous())
     {
       if((fPatternPhaseNumber==fMinPatternPhase)&& (fPatternNumber>=0))
 	{
-	  first24bits[n_ranbits+1] = fHelicityReported;
+	  fFirst24Bits[n_ranbits+1] = fHelicityReported;
 	  n_ranbits ++;
 	  if(ldebug)
 	    {
@@ -1763,9 +1887,9 @@ Bool_t QwHelicity::CollectRandBits24()
 	       if(ldebug)
 		 {
 		   std::cout << "Collected 24 random bits. Get the random seed for the predictor." << "\n";
-		   for(UInt_t i=0;i<ranbit_goal;i++) std::cout << " i:bit =" << i << ":" << first24bits[i] << "\n";
+		   for(UInt_t i=0;i<ranbit_goal;i++) std::cout << " i:bit =" << i << ":" << fFirst24Bits[i] << "\n";
 		 }
-	      iseed_Delayed = GetRandomSeed(first24bits);
+	      iseed_Delayed = GetRandomSeed(fFirst24Bits);
 	      //This random seed will predict the helicity of the event (24+fHelicityDelay) patterns  before;
 	      // run GetRandBit 24 times to get the delayed helicity for this event
 	       QwDebug << "The reported seed 24 patterns ago = " << iseed_Delayed << "\n";
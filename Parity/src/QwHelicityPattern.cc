@@ -18,6 +18,7 @@
 #include "VQwDataElement.h"
 
 #include "QwPromptSummary.h"
+#include "QwUtil.h"
 
 /*****************************************************************/
 /**
@@ -38,6 +39,12 @@ void QwHelicityPattern::DefineOptions(QwOptions &options)
   options.AddOptions("Helicity pattern")
     ("enable-alternateasym", po::value<bool>()->default_bool_value(false),
      "enable alternate asymmetries");
+  options.AddOptions("Helicity pattern")
+    ("enable-hadamard-contrasts", po::value<bool>()->default_bool_value(false),
+     "enable all Walsh-Hadamard contrasts over the pattern windows");
+  options.AddOptions("Helicity pattern")
+    ("hadamard-channels", po::value<std::vector<std::string> >()->multitoken(),
+     "published channels for which Walsh-Hadamard contrasts are calculated");
 
   options.AddOptions("Helicity pattern")
     ("print-burstsum", po::value<bool>()->default_bool_value(false),
@@ -78,6 +85,8 @@ void QwHelicityPattern::ProcessOptions(QwOptions &options)
 
   fEnableDifference    = options.GetValue<bool>("enable-differences");
   fEnableAlternateAsym = options.GetValue<bool>("enable-alternateasym");
+  fEnableHadamard      = options.GetValue<bool>("enable-hadamard-contrasts");
+  fHadamardChannelNames = options.GetValueVector<std::string>("hadamard-channels");
 
   fBurstLength = options.GetValue<int>("burstlength");
   if (fBurstLength == 0) DisableBurstSum();
@@ -92,6 +101,7 @@ void QwHelicityPattern::ProcessOptions(QwOptions &options)
 	      << QwLog::endl;
     fEnableAlternateAsym = kFALSE;
   }
+  if (fEnableHadamard) ConnectHadamardChannels();
 
   fBlinder.ProcessOptions(options);
 }
@@ -107,6 +117,11 @@ QwHelicityPattern::QwHelicityPattern(QwSubsystemArrayParity &event, const TStrin
     fEnableAlternateAsym(kFALSE), 
     fAsymmetry1(event), 
     fAsymmetry2(event),
+    fEnableHadamard(kFALSE),
+    fHadamardPrimary(-1),
+    fHadamardIsConsistent(kTRUE),
+    fHadamardMismatches(0),
+    fHadamardTreeArrayIndex(0),
     fEnablePairs(kTRUE),
     fPairYield(event), 
     fPairDifference(event), 
@@ -196,6 +211,11 @@ QwHelicityPattern::QwHelicityPattern(const QwHelicityPattern &source)
   fEnableAlternateAsym(source.fEnableAlternateAsym),
   fAsymmetry1(source.fAsymmetry1),
   fAsymmetry2(source.fAsymmetry2),
+  fEnableHadamard(kFALSE),
+  fHadamardPrimary(-1),
+  fHadamardIsConsistent(kTRUE),
+  fHadamardMismatches(0),
+  fHadamardTreeArrayIndex(0),
   fPairYield(source.fYield),
   fPairDifference(source.fYield),
   fPairAsymmetry(source.fYield),
@@ -571,8 +591,9 @@ void  QwHelicityPattern::CalculateAsymmetry()
     fDifference.Difference(fPositiveHelicitySum,fNegativeHelicitySum);
     fDifference.Scale(1.0/fPatternSize);
 
-    
-    
+    //  Walsh-Hadamard contrasts, checked against the difference before blinding
+    if (fEnableHadamard) CalculateHadamardContrasts();
+
     if (! fIgnoreHelicity){
       // Update the blinder if conditions have changed
       UpdateBlinder(fYield);
@@ -588,6 +609,13 @@ void  QwHelicityPattern::CalculateAsymmetry()
 	fDifference.UpdateErrorFlag(QwBlinder::kErrorFlag_BlinderFail);
       }
     }
+    //  A primary contrast which disagrees with the difference means that the
+    //  windows were not combined with the helicity sequence of the pattern;
+    //  flag it like a helicity decoding error so it is cut downstream.
+    if (fEnableHadamard && ! fHadamardIsConsistent) {
+      fYield.UpdateErrorFlag(kErrorFlag_Helicity + kGlobalCut + kEventCutMode3);
+      fDifference.UpdateErrorFlag(kErrorFlag_Helicity + kGlobalCut + kEventCutMode3);
+    }
     fAsymmetry.Ratio(fDifference,fYield);
     fAsymmetry.IncrementErrorCounters();
 
@@ -643,6 +671,117 @@ void  QwHelicityPattern::CalculateAsymmetry()
   }
 }
 
+//*****************************************************************
+/**
+ * Connect the window and difference channels for which the Walsh-Hadamard
+ * contrasts are calculated.  The contrasts require a pattern size which is
+ * a power of two.
+ */
+void QwHelicityPattern::ConnectHadamardChannels()
+{
+  fHadamardWindowChannels.clear();
+  fHadamardDifferenceChannels.clear();
+  if (fPatternSize < 2 || (fPatternSize & (fPatternSize - 1)) != 0) {
+    QwWarning << "QwHelicityPattern::ConnectHadamardChannels: "
+              << "Walsh-Hadamard contrasts need a pattern size which is a power of two, "
+              << "but pattern size is " << fPatternSize << "; disabled." << QwLog::endl;
+    fEnableHadamard = kFALSE;
+    return;
+  }
+
+  std::vector<std::string> names;
+  for (size_t ch = 0; ch < fHadamardChannelNames.size(); ch++) {
+    const std::string& name = fHadamardChannelNames.at(ch);
+    std::vector<const VQwHardwareChannel*> windows(fPatternSize, 0);
+    Bool_t found = kTRUE;
+    for (Int_t i = 0; i < fPatternSize && found; i++) {
+      windows[i] = fEvents.at(i).RequestExternalPointer(name);
+      found = (windows[i] != 0);
+    }
+    const VQwHardwareChannel* diff = fDifference.RequestExternalPointer(name);
+    if (! found || diff == 0) {
+      QwWarning << "QwHelicityPattern::ConnectHadamardChannels: "
+                << "channel " << name << " is not published; skipped." << QwLog::endl;
+      continue;
+    }
+    names.push_back(name);
+    fHadamardWindowChannels.push_back(windows);
+    fHadamardDifferenceChannels.push_back(diff);
+  }
+  fHadamardChannelNames = names;
+
+  fHadamardContrasts.assign(fHadamardWindowChannels.size()*fPatternSize, 0.0);
+  fHadamardErrorCode.assign(fHadamardWindowChannels.size(), 0);
+  fHadamardSigns.assign(fPatternSize, 0.0);
+  QwMessage << "QwHelicityPattern: Walsh-Hadamard contrasts enabled for "
+            << fHadamardWindowChannels.size() << " channels" << QwLog::endl;
+}
+
+//*****************************************************************
+/**
+ * Calculate all orthogonal Walsh-Hadamard contrasts over the windows of the
+ * current pattern for the selected channels, with one in-place transform per
+ * channel.  The contrasts are normalized to the pattern size, so that the
+ * zeroth contrast is the yield and the primary contrast (the one matching the
+ * helicity sequence of this pattern, with its sign) is the difference.
+ * Patterns where they disagree get the helicity error flag in
+ * CalculateAsymmetry.
+ */
+void QwHelicityPattern::CalculateHadamardContrasts()
+{
+  const size_t n = fPatternSize;
+
+  //  Helicity sign of each window; its transform selects the primary contrast
+  for (size_t i = 0; i < n; i++) {
+    Int_t localhel = fHelicity[i];
+    if (fIgnoreHelicity) {
+      localhel = 1;
+      for (size_t j = 0; j < n/2; j++) {
+        localhel ^= ((i >> j)&0x1);
+      }
+    }
+    fHadamardSigns[i] = (localhel == 1)? 1.0: -1.0;
+  }
+  QwFastWalshHadamard(fHadamardSigns.data(), n);
+  fHadamardPrimary = -1;
+  Double_t primary_sign = 0.0;
+  for (size_t k = 0; k < n; k++) {
+    if (std::fabs(std::fabs(fHadamardSigns[k]) - n) < 0.5) {
+      fHadamardPrimary = k;
+      primary_sign = (fHadamardSigns[k] > 0)? 1.0: -1.0;
+    }
+  }
+
+  fHadamardIsConsistent = kTRUE;
+  for (size_t ch = 0; ch < fHadamardWindowChannels.size(); ch++) {
+    Double_t* x = &(fHadamardContrasts[ch*n]);
+    UInt_t errorcode = 0;
+    for (size_t i = 0; i < n; i++) {
+      x[i] = fHadamardWindowChannels[ch][i]->GetValue();
+      errorcode |= fHadamardWindowChannels[ch][i]->GetErrorCode();
+    }
+    QwFastWalshHadamard(x, n);
+    for (size_t k = 0; k < n; k++) x[k] /= n;
+    fHadamardErrorCode[ch] = errorcode;
+
+    //  The primary contrast has to reproduce the (unblinded) difference
+    if (fHadamardPrimary >= 0) {
+      Double_t diff = fHadamardDifferenceChannels[ch]->GetValue();
+      Double_t tolerance = 1.0e-9 * std::max(1.0, std::fabs(x[0]));
+      if (std::fabs(primary_sign * x[fHadamardPrimary] - diff) > tolerance)
+        fHadamardIsConsistent = kFALSE;
+    }
+  }
+  if (fHadamardPrimary < 0) fHadamardIsConsistent = kFALSE;
+  if (! fHadamardIsConsistent) {
+    if (fHadamardMismatches == 0)
+      QwWarning << "QwHelicityPattern::CalculateHadamardContrasts: "
+                << "primary contrast does not match the pattern difference "
+                << "in pattern " << fCurrentPatternNumber << QwLog::endl;
+    fHadamardMismatches++;
+  }
+}
+
 //*****************************************************************
 /**
  * Clear event data and the vectors used for the calculation of.
@@ -868,6 +1007,25 @@ TString basename = prefix(0, (prefix.First("|") >= 0)? prefix.First("|"): prefix
     newprefix = "asym2_" + prefix;
     fAsymmetry2.ConstructBranchAndVector(tree, newprefix, values);
   }
+  if (fEnableHadamard) {
+    TString hadprefix = prefix(0, (prefix.First("|") >= 0)? prefix.First("|"): prefix.Length()) + "hadamard";
+    fHadamardTreeArrayIndex = values.size();
+    values.push_back(0.0);
+    values.push_back(0.0);
+    tree->Branch(hadprefix, &(values[fHadamardTreeArrayIndex]), "primary/D:consistent/D");
+    for (size_t ch = 0; ch < fHadamardWindowChannels.size(); ch++) {
+      size_t index = values.size();
+      TString list = "";
+      for (Int_t k = 0; k < fPatternSize; k++) {
+        values.push_back(0.0);
+        list += Form("%sc%d/D", (k > 0)? ":": "", k);
+      }
+      values.push_back(0.0);
+      list += ":Device_Error_Code/D";
+      TString basename = hadprefix + "_" + fHadamardChannelNames.at(ch);
+      tree->Branch(basename, &(values[index]), list);
+    }
+  }
 }
 
 void QwHelicityPattern::ConstructBranch(TTree *tree, TString & prefix)
@@ -925,6 +1083,16 @@ void QwHelicityPattern::FillTreeVector(std::vector<Double_t> &values) const
       fAsymmetry1.FillTreeVector(values);
       fAsymmetry2.FillTreeVector(values);
     }
+    if (fEnableHadamard) {
+      size_t index = fHadamardTreeArrayIndex;
+      values[index++] = fHadamardPrimary;
+      values[index++] = fHadamardIsConsistent;
+      for (size_t ch = 0; ch < fHadamardWindowChannels.size(); ch++) {
+        for (Int_t k = 0; k < fPatternSize; k++)
+          values[index++] = fHadamardContrasts[ch*fPatternSize + k];
+        values[index++] = fHadamardErrorCode[ch];
+      }
+    }
   }
 }
 
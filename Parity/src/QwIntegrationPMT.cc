@@ -119,7 +119,8 @@ void QwIntegrationPMT::RandomizeEventData(int helicity, double time)
 /********************************************************/
 void QwIntegrationPMT::RandomizeMollerEvent(int helicity, const QwBeamCharge& charge, const QwBeamPosition& xpos, const QwBeamPosition& ypos, const QwBeamAngle& xprime, const QwBeamAngle& yprime, const QwBeamEnergy& energy)
 {
-  QwMollerADC_Channel temp(this->fTriumf_ADC);
+  //  Work space of this PMT, to avoid a channel copy for every event
+  QwMollerADC_Channel& temp = fWork.temp;
   fTriumf_ADC.ClearEventData();
 
   temp.AssignScaledValue(xpos, fCoeff_x);
@@ -310,12 +310,10 @@ void QwLinearDiodeArray::UpdateErrorFlag(const VQwBPM *ev_error){
 void  QwLinearDiodeArray::ProcessEvent()
 {
   Bool_t localdebug = kFALSE;
-  static QwVQWK_Channel mean, meansqr;
-  static QwVQWK_Channel tmp("tmp");
-  static QwVQWK_Channel tmp2("tmp2");
-
-  mean.InitializeChannel("mean","raw");
-  meansqr.InitializeChannel("meansqr","raw");
+  QwVQWK_Channel& mean = fWork.mean;
+  QwVQWK_Channel& meansqr = fWork.meansqr;
+  QwVQWK_Channel& tmp = fWork.tmp;
+  QwVQWK_Channel& tmp2 = fWork.tmp2;
 
 
   size_t i = 0;
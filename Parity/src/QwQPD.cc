@@ -383,13 +383,10 @@ void QwQPD::UpdateErrorFlag(const VQwBPM *ev_error){
 void  QwQPD::ProcessEvent()
 {
   Bool_t localdebug = kFALSE;
-  static QwVQWK_Channel numer[2];
-  static QwVQWK_Channel tmp("tmp");
-  static QwVQWK_Channel tmp1("tmp1");
-  static QwVQWK_Channel tmp2("tmp2");
-
-  numer[0].InitializeChannel("Xnumerator","raw");
-  numer[1].InitializeChannel("Ynumerator","raw");
+  QwVQWK_Channel* numer = fWork.numer;
+  QwVQWK_Channel& tmp = fWork.tmp;
+  QwVQWK_Channel& tmp1 = fWork.tmp1;
+  QwVQWK_Channel& tmp2 = fWork.tmp2;
 
   Short_t i = 0;
 
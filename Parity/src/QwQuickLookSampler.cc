@@ -0,0 +1,167 @@
+/*!
+ * \file   QwQuickLookSampler.cc
+ * \brief  Quick-look replay of evenly spaced blocks of helicity patterns
+ */
+
+#include "QwQuickLookSampler.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwEventBuffer.h"
+#include "QwAnalysisPipeline.h"
+
+QwQuickLookSampler::QwQuickLookSampler(QwOptions& options)
+: fEnabled(kFALSE), fNumBlocks(0), fPatternsPerBlock(0), fMaxEvents(0),
+  fFileBlocks(0), fFileIsSampled(kFALSE), fSample(0), fFirstBlock(0), fLastBlock(-1),
+  fPatternsAtStart(0), fEvents(0),
+  fSamplesRead(0), fBlocksRead(0), fBlocksTotal(0), fFilesInFull(0)
+{
+  ProcessOptions(options);
+}
+
+void QwQuickLookSampler::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Quick-look sampling")
+    ("sample-blocks", po::value<int>()->default_value(0),
+     "number of evenly spaced blocks of patterns to analyze in each data file (0: full replay)");
+  options.AddOptions("Quick-look sampling")
+    ("sample-patterns", po::value<int>()->default_value(1000),
+     "number of good helicity patterns in each sampled block");
+  options.AddOptions("Quick-look sampling")
+    ("sample-max-events", po::value<int>()->default_value(100000),
+     "maximum number of events in a sampled block without enough good patterns");
+}
+
+void QwQuickLookSampler::ProcessOptions(QwOptions& options)
+{
+  fNumBlocks        = options.GetValue<int>("sample-blocks");
+  fPatternsPerBlock = options.GetValue<int>("sample-patterns");
+  fMaxEvents        = options.GetValue<int>("sample-max-events");
+  fEnabled = (fNumBlocks > 0);
+  if (fEnabled && fPatternsPerBlock <= 0) {
+    QwError << "Quick-look sampling needs --sample-patterns > 0; "
+            << "replaying all events" << QwLog::endl;
+    fEnabled = kFALSE;
+  }
+  if (fEnabled)
+    QwMessage << "Quick-look replay of " << fNumBlocks << " blocks of "
+              << fPatternsPerBlock << " patterns per data file" << QwLog::endl;
+}
+
+/**
+ * Find the number of file blocks of a new data file, and start its first
+ * sampled block at the current position.
+ * @param eventbuffer Event buffer with the new data file
+ * @param patterns Good patterns so far
+ */
+void QwQuickLookSampler::StartDataFile(QwEventBuffer& eventbuffer, Long64_t patterns)
+{
+  FinishDataFile();
+  fDataFile = eventbuffer.GetDataFile();
+  fFileBlocks = eventbuffer.GetDataFileBlockCount();
+  fFileIsSampled = (fFileBlocks > 0);
+  if (fFileIsSampled) {
+    fBlocksTotal += fFileBlocks;
+  } else {
+    QwWarning << "Cannot sample " << fDataFile << " (no random access); "
+              << "replaying all events" << QwLog::endl;
+    fFilesInFull++;
+  }
+  fSample = 0;
+  fFirstBlock = eventbuffer.GetDataFileBlock();
+  fLastBlock = fFirstBlock;
+  fPatternsAtStart = patterns;
+  fEvents = 0;
+}
+
+void QwQuickLookSampler::FinishDataFile()
+{
+  if (fFileIsSampled && fLastBlock >= fFirstBlock) {
+    fBlocksRead += fLastBlock - fFirstBlock + 1;
+    if (fSample < fNumBlocks) fSamplesRead++;
+  }
+  fFileIsSampled = kFALSE;
+}
+
+/**
+ * Count the events and good patterns of the current block, and jump to the
+ * start of the next block when the block has enough good patterns (or too
+ * many events) and all pipelines are between two patterns.  After the last
+ * block, the rest of the data file is skipped.
+ * @param eventbuffer Event buffer with the data file
+ * @param pipelines Analysis pipelines; the first one counts the patterns
+ */
+void QwQuickLookSampler::ProcessEvent(
+    QwEventBuffer& eventbuffer,
+    std::vector<QwAnalysisPipeline*>& pipelines)
+{
+  if (! fEnabled || pipelines.empty()) return;
+
+  Long64_t patterns = pipelines.front()->GetGoodPatternCount();
+  if (eventbuffer.GetDataFile() != fDataFile)
+    StartDataFile(eventbuffer, patterns);
+  if (! fFileIsSampled) return;
+  fLastBlock = eventbuffer.GetDataFileBlock();
+
+  //  Is this block complete?
+  fEvents++;
+  Bool_t full = (fMaxEvents > 0 && fEvents >= fMaxEvents);
+  if (patterns - fPatternsAtStart < fPatternsPerBlock && ! full) return;
+  for (size_t i = 0; i < pipelines.size() && ! full; i++)
+    if (! pipelines.at(i)->IsAtPatternBoundary()) return;
+  if (full)
+    QwWarning << "Sampled block " << fSample << " of " << fDataFile
+              << " ends after " << fEvents << " events with only "
+              << patterns - fPatternsAtStart << " good patterns" << QwLog::endl;
+
+  Int_t block = fLastBlock;
+  fBlocksRead += block - fFirstBlock + 1;
+  fSamplesRead++;
+
+  //  Start of the next block, or the end of the file
+  fSample++;
+  Int_t next = fFileBlocks;
+  if (fSample < fNumBlocks)
+    next = static_cast<Int_t>(static_cast<Long64_t>(fSample) * fFileBlocks / fNumBlocks);
+  if (next <= block) {
+    //  Blocks overlap: continue without a jump
+    fFirstBlock = block + 1;
+  } else {
+    QwVerbose << "Jumping to block " << next << " of " << fFileBlocks
+              << " in " << fDataFile << QwLog::endl;
+    eventbuffer.SeekDataFileBlock(next);
+    for (size_t i = 0; i < pipelines.size(); i++)
+      pipelines.at(i)->StartSampleBlock();
+    fFirstBlock = next;
+  }
+  fLastBlock = fFirstBlock - 1;
+  //  The patterns of the events unwound from the event rings count for this block
+  fPatternsAtStart = pipelines.front()->GetGoodPatternCount();
+  fEvents = 0;
+}
+
+/**
+ * Record the number of sampled blocks and the fraction of the file blocks
+ * which were read.  The block which was cut short by the end of the data
+ * is included.
+ * @param pipelines Analysis pipelines, before their files are closed
+ */
+void QwQuickLookSampler::WriteSamplingRecord(
+    std::vector<QwAnalysisPipeline*>& pipelines)
+{
+  if (! fEnabled) return;
+  FinishDataFile();
+
+  Double_t fraction = (fBlocksTotal > 0)? Double_t(fBlocksRead) / fBlocksTotal: 1.0;
+  TString record = Form("sampling fraction %.6f: %d blocks of %d patterns, "
+                        "%lld of %lld file blocks read",
+                        fraction, fSamplesRead, fPatternsPerBlock,
+                        fBlocksRead, fBlocksTotal);
+  if (fFilesInFull > 0)
+    record += Form(", %d data files replayed in full", fFilesInFull);
+  QwMessage << "Quick-look " << record << QwLog::endl;
+
+  for (size_t i = 0; i < pipelines.size(); i++)
+    pipelines.at(i)->WriteSamplingRecord(record);
+}
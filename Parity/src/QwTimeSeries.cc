@@ -0,0 +1,438 @@
+/*!
+ * \file   QwTimeSeries.cc
+ * \brief  Multi-resolution time series of selected channels for strip charts
+ */
+
+#include "QwTimeSeries.h"
+
+// System headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwSubsystemArrayParity.h"
+#include "VQwHardwareChannel.h"
+
+/// File signature and version
+static const char kTimeSeriesMagic[8] = {'Q','W','T','S','0','0','0','1'};
+
+/// Channel index of the record with the start time of the run
+static const Int_t kRunStartRecord = -1;
+
+/// Record of a closed bin, as written to the file
+struct QwTimeSeriesRecord {
+  Int_t    fChannel;
+  Int_t    fLevel;
+  Double_t fStart;
+  Long64_t fCount;
+  Double_t fMean;
+  Double_t fM2;
+  Double_t fMin;
+  Double_t fMax;
+};
+
+
+void QwTimeSeriesBin::Clear()
+{
+  fCount = 0;
+  fMean = 0.0;
+  fM2 = 0.0;
+  fMin = 0.0;
+  fMax = 0.0;
+}
+
+void QwTimeSeriesBin::Add(Double_t value)
+{
+  if (fCount == 0) {
+    fMin = fMax = value;
+  } else {
+    fMin = std::min(fMin, value);
+    fMax = std::max(fMax, value);
+  }
+  fCount++;
+  Double_t delta = value - fMean;
+  fMean += delta / fCount;
+  fM2 += delta * (value - fMean);
+}
+
+/**
+ * Add the values of another bin, with the combination of the means and
+ * sums of squared deviations of Chan, Golub and LeVeque
+ * @param bin Bin to add
+ */
+void QwTimeSeriesBin::Merge(const QwTimeSeriesBin& bin)
+{
+  if (bin.fCount == 0) return;
+  if (fCount == 0) {
+    Double_t start = fStart;
+    *this = bin;
+    fStart = start;
+    return;
+  }
+  Long64_t count = fCount + bin.fCount;
+  Double_t delta = bin.fMean - fMean;
+  fMean += delta * bin.fCount / count;
+  fM2 += bin.fM2 + delta * delta * fCount * bin.fCount / count;
+  fMin = std::min(fMin, bin.fMin);
+  fMax = std::max(fMax, bin.fMax);
+  fCount = count;
+}
+
+
+QwTimeSeriesWriter::QwTimeSeriesWriter(QwOptions& options)
+: fBaseWidth(1.0), fFactor(10), fLevels(5), fMPSRate(240.0),
+  fNeedsFlush(kFALSE), fRunStartWritten(kFALSE)
+{
+  ProcessOptions(options);
+}
+
+QwTimeSeriesWriter::~QwTimeSeriesWriter()
+{
+  Close();
+}
+
+void QwTimeSeriesWriter::DefineOptions(QwOptions& options)
+{
+  options.AddOptions("Time series")
+    ("timeseries-channel", po::value<std::vector<std::string> >()->composing(),
+     "channel to aggregate in the multi-resolution time series file");
+  options.AddOptions("Time series")
+    ("timeseries-base", po::value<double>()->default_value(1.0),
+     "width of the finest time bins (seconds)");
+  options.AddOptions("Time series")
+    ("timeseries-factor", po::value<int>()->default_value(10),
+     "ratio of the bin widths of successive levels");
+  options.AddOptions("Time series")
+    ("timeseries-levels", po::value<int>()->default_value(5),
+     "number of levels of time bins");
+  options.AddOptions("Time series")
+    ("timeseries-mps-rate", po::value<double>()->default_value(240.0),
+     "helicity window rate used to convert event numbers to times (Hz)");
+}
+
+void QwTimeSeriesWriter::ProcessOptions(QwOptions& options)
+{
+  fNames = options.GetValueVector<std::string>("timeseries-channel");
+  fBaseWidth = options.GetValue<double>("timeseries-base");
+  fFactor = options.GetValue<int>("timeseries-factor");
+  fLevels = options.GetValue<int>("timeseries-levels");
+  fMPSRate = options.GetValue<double>("timeseries-mps-rate");
+
+  if (fNames.empty()) return;
+  if (fBaseWidth <= 0.0 || fFactor < 2 || fLevels < 1 || fMPSRate <= 0.0) {
+    QwError << "QwTimeSeriesWriter: invalid bin settings (base " << fBaseWidth
+            << " s, factor " << fFactor << ", " << fLevels << " levels, rate "
+            << fMPSRate << " Hz); no time series will be written" << QwLog::endl;
+    fNames.clear();
+    return;
+  }
+  fWidth.resize(fLevels);
+  fWidth[0] = fBaseWidth;
+  for (Int_t level = 1; level < fLevels; level++)
+    fWidth[level] = fWidth[level - 1] * fFactor;
+}
+
+/**
+ * Look up the selected channels, dropping the ones which are not found,
+ * and write the file header
+ * @param detectors Subsystem array of the events which will be processed
+ * @param filename Name of the time series file
+ * @param run_number Run number for the file header
+ */
+void QwTimeSeriesWriter::ConnectChannels(const QwSubsystemArrayParity& detectors,
+    const TString& filename, Int_t run_number)
+{
+  std::vector<std::string> names;
+  fChannels.clear();
+  for (size_t i = 0; i < fNames.size(); i++) {
+    const VQwHardwareChannel* channel = detectors.RequestExternalPointer(fNames[i]);
+    if (channel == 0) {
+      QwWarning << "QwTimeSeriesWriter: channel " << fNames[i]
+                << " was not found, and will not be aggregated" << QwLog::endl;
+      continue;
+    }
+    names.push_back(fNames[i]);
+    fChannels.push_back(channel);
+  }
+  fNames = names;
+  if (fNames.empty()) return;
+
+  fOpenBins.assign(fNames.size() * fLevels, QwTimeSeriesBin());
+
+  fFileName = filename;
+  fFile.open(fFileName.Data(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (! fFile.good()) {
+    QwError << "QwTimeSeriesWriter: unable to open " << fFileName << QwLog::endl;
+    fNames.clear();
+    fChannels.clear();
+    return;
+  }
+  Int_t nchannels = fNames.size();
+  fFile.write(kTimeSeriesMagic, sizeof(kTimeSeriesMagic));
+  fFile.write(reinterpret_cast<const char*>(&run_number), sizeof(run_number));
+  fFile.write(reinterpret_cast<const char*>(&fBaseWidth), sizeof(fBaseWidth));
+  fFile.write(reinterpret_cast<const char*>(&fFactor), sizeof(fFactor));
+  fFile.write(reinterpret_cast<const char*>(&fLevels), sizeof(fLevels));
+  fFile.write(reinterpret_cast<const char*>(&nchannels), sizeof(nchannels));
+  for (size_t i = 0; i < fNames.size(); i++) {
+    Int_t length = fNames[i].size();
+    fFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    fFile.write(fNames[i].data(), length);
+  }
+  fFile.flush();
+  fRunStartWritten = kFALSE;
+
+  QwMessage << "Writing time series of " << fNames.size() << " channels to "
+            << fFileName << QwLog::endl;
+}
+
+/**
+ * Add the values of the selected channels of a good event to the open bins
+ * of level 0, closing the bins which end before the event
+ * @param detectors Subsystem array with the event
+ */
+void QwTimeSeriesWriter::ProcessEvent(const QwSubsystemArrayParity& detectors)
+{
+  if (! fFile.is_open()) return;
+  if (detectors.GetEventcutErrorFlag() != 0) return;
+
+  Double_t time = detectors.GetCodaEventNumber() / fMPSRate;
+  Double_t start = std::floor(time / fWidth[0]) * fWidth[0];
+  for (size_t channel = 0; channel < fChannels.size(); channel++) {
+    QwTimeSeriesBin& bin = fOpenBins[channel * fLevels];
+    if (bin.fCount > 0 && bin.fStart != start) CloseBin(channel, 0);
+    if (bin.fCount == 0) bin.fStart = start;
+    bin.Add(fChannels[channel]->GetValue());
+  }
+  if (fNeedsFlush) {
+    fFile.flush();
+    fNeedsFlush = kFALSE;
+  }
+}
+
+/**
+ * Write a bin and merge it into the open bin of the next level, closing
+ * that one first if the bin is beyond its end
+ * @param channel Channel index
+ * @param level Level of the bin
+ */
+void QwTimeSeriesWriter::CloseBin(size_t channel, Int_t level)
+{
+  QwTimeSeriesBin& bin = fOpenBins[channel * fLevels + level];
+  if (bin.fCount == 0) return;
+  WriteRecord(channel, level, bin);
+
+  if (level + 1 < fLevels) {
+    QwTimeSeriesBin& parent = fOpenBins[channel * fLevels + level + 1];
+    Double_t start = std::floor(bin.fStart / fWidth[level + 1]) * fWidth[level + 1];
+    if (parent.fCount > 0 && parent.fStart != start) CloseBin(channel, level + 1);
+    if (parent.fCount == 0) parent.fStart = start;
+    parent.Merge(bin);
+  }
+  bin.Clear();
+}
+
+void QwTimeSeriesWriter::WriteRecord(Int_t channel, Int_t level, const QwTimeSeriesBin& bin)
+{
+  QwTimeSeriesRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.fChannel = channel;
+  record.fLevel = level;
+  record.fStart = bin.fStart;
+  record.fCount = bin.fCount;
+  record.fMean = bin.fMean;
+  record.fM2 = bin.fM2;
+  record.fMin = bin.fMin;
+  record.fMax = bin.fMax;
+  fFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  fNeedsFlush = kTRUE;
+}
+
+/**
+ * Write the unix time of the start of the run, which the reader adds to
+ * the bin start times of this file.  Only the first known start time is
+ * written; it is called before the events are processed, so that it is the
+ * first record after the header.
+ * @param start Unix time of the start of the run (zero when not known)
+ */
+void QwTimeSeriesWriter::SetRunStartTime(Double_t start)
+{
+  if (! fFile.is_open() || fRunStartWritten || start <= 0.0) return;
+  QwTimeSeriesBin bin;
+  bin.fStart = start;
+  WriteRecord(kRunStartRecord, 0, bin);
+  fFile.flush();
+  fNeedsFlush = kFALSE;
+  fRunStartWritten = kTRUE;
+}
+
+void QwTimeSeriesWriter::Close()
+{
+  if (! fFile.is_open()) return;
+  for (size_t channel = 0; channel < fChannels.size(); channel++)
+    for (Int_t level = 0; level < fLevels; level++)
+      CloseBin(channel, level);
+  fFile.close();
+  QwMessage << "Closed time series file " << fFileName << QwLog::endl;
+}
+
+
+/**
+ * Read the header and the bins of a time series file; a truncated last
+ * record of a file which is still being written is ignored.  The files must
+ * have the same bin settings.
+ * @param filename Name of the time series file
+ * @return True if the file was read
+ */
+Bool_t QwTimeSeriesReader::AddFile(const std::string& filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  char magic[sizeof(kTimeSeriesMagic)];
+  if (! file.read(magic, sizeof(magic))
+      || std::memcmp(magic, kTimeSeriesMagic, sizeof(magic)) != 0) {
+    QwError << "QwTimeSeriesReader: " << filename
+            << " is not a time series file" << QwLog::endl;
+    return kFALSE;
+  }
+  Int_t run_number = 0, factor = 0, levels = 0, nchannels = 0;
+  Double_t base = 0.0;
+  file.read(reinterpret_cast<char*>(&run_number), sizeof(run_number));
+  file.read(reinterpret_cast<char*>(&base), sizeof(base));
+  file.read(reinterpret_cast<char*>(&factor), sizeof(factor));
+  file.read(reinterpret_cast<char*>(&levels), sizeof(levels));
+  file.read(reinterpret_cast<char*>(&nchannels), sizeof(nchannels));
+  if (! file || levels < 1 || nchannels < 0) {
+    QwError << "QwTimeSeriesReader: corrupt header in " << filename << QwLog::endl;
+    return kFALSE;
+  }
+  if (fLevels == 0) {
+    fBaseWidth = base;
+    fFactor = factor;
+    fLevels = levels;
+  } else if (base != fBaseWidth || factor != fFactor || levels != fLevels) {
+    QwError << "QwTimeSeriesReader: bin settings of " << filename
+            << " differ from the files read before" << QwLog::endl;
+    return kFALSE;
+  }
+
+  //  Map the channels of this file to the channels read so far
+  std::vector<Int_t> index(nchannels);
+  for (Int_t i = 0; i < nchannels; i++) {
+    Int_t length = 0;
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    std::string name(length > 0? length: 0, ' ');
+    if (length > 0) file.read(&name[0], length);
+    index[i] = FindChannel(name);
+    if (index[i] < 0) {
+      index[i] = fNames.size();
+      fNames.push_back(name);
+      fBins.resize(fNames.size() * fLevels);
+    }
+  }
+  if (! file) {
+    QwError << "QwTimeSeriesReader: corrupt header in " << filename << QwLog::endl;
+    return kFALSE;
+  }
+
+  //  Read the bins, and shift them by the start of the run when known
+  std::vector<std::pair<size_t, QwTimeSeriesBin> > bins;
+  Double_t offset = 0.0;
+  QwTimeSeriesRecord record;
+  while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    if (record.fChannel == kRunStartRecord) {
+      offset = record.fStart;
+      continue;
+    }
+    if (record.fChannel < 0 || record.fChannel >= nchannels
+        || record.fLevel < 0 || record.fLevel >= fLevels) continue;
+    QwTimeSeriesBin bin;
+    bin.fStart = record.fStart;
+    bin.fCount = record.fCount;
+    bin.fMean = record.fMean;
+    bin.fM2 = record.fM2;
+    bin.fMin = record.fMin;
+    bin.fMax = record.fMax;
+    bins.push_back(std::make_pair(index[record.fChannel] * fLevels + record.fLevel, bin));
+  }
+  for (size_t i = 0; i < bins.size(); i++) {
+    bins[i].second.fStart += offset;
+    fBins[bins[i].first].push_back(bins[i].second);
+  }
+
+  //  Keep the bins sorted by start time
+  for (size_t i = 0; i < fBins.size(); i++) {
+    std::vector<QwTimeSeriesBin>& list = fBins[i];
+    for (size_t j = 1; j < list.size(); j++) {
+      if (list[j].fStart < list[j - 1].fStart) {
+        std::stable_sort(list.begin(), list.end(),
+            [](const QwTimeSeriesBin& a, const QwTimeSeriesBin& b) { return a.fStart < b.fStart; });
+        break;
+      }
+    }
+  }
+
+  QwMessage << "Read " << bins.size() << " time bins of run " << run_number
+            << " from " << filename << QwLog::endl;
+  return kTRUE;
+}
+
+Int_t QwTimeSeriesReader::FindChannel(const std::string& name) const
+{
+  for (size_t i = 0; i < fNames.size(); i++)
+    if (fNames[i] == name) return i;
+  return -1;
+}
+
+Double_t QwTimeSeriesReader::GetBinWidth(Int_t level) const
+{
+  return fBaseWidth * std::pow(Double_t(fFactor), level);
+}
+
+/**
+ * Bins of a channel and level which overlap the time range [tmin, tmax)
+ * @param channel Channel index
+ * @param level Level of the bins
+ * @param tmin Start of the time range
+ * @param tmax End of the time range
+ * @return Bins sorted by start time
+ */
+std::vector<QwTimeSeriesBin> QwTimeSeriesReader::GetBins(Int_t channel, Int_t level,
+    Double_t tmin, Double_t tmax) const
+{
+  std::vector<QwTimeSeriesBin> result;
+  if (channel < 0 || channel >= Int_t(fNames.size()) || level < 0 || level >= fLevels)
+    return result;
+  const std::vector<QwTimeSeriesBin>& list = fBins[channel * fLevels + level];
+  Double_t width = GetBinWidth(level);
+  QwTimeSeriesBin first;
+  first.fStart = tmin - width;
+  std::vector<QwTimeSeriesBin>::const_iterator bin =
+    std::upper_bound(list.begin(), list.end(), first,
+        [](const QwTimeSeriesBin& a, const QwTimeSeriesBin& b) { return a.fStart < b.fStart; });
+  for ( ; bin != list.end() && bin->fStart < tmax; ++bin)
+    result.push_back(*bin);
+  return result;
+}
+
+/**
+ * Bins of a channel in the time range [tmin, tmax), at the finest level
+ * with at most maxbins bins in the range, or at the coarsest level
+ * @param channel Channel index
+ * @param tmin Start of the time range
+ * @param tmax End of the time range
+ * @param maxbins Maximum number of bins
+ * @return Bins sorted by start time
+ */
+std::vector<QwTimeSeriesBin> QwTimeSeriesReader::GetRange(Int_t channel,
+    Double_t tmin, Double_t tmax, size_t maxbins) const
+{
+  std::vector<QwTimeSeriesBin> result;
+  for (Int_t level = 0; level < fLevels; level++) {
+    result = GetBins(channel, level, tmin, tmax);
+    if (result.size() <= maxbins) break;
+  }
+  return result;
+}
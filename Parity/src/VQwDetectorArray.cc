@@ -575,7 +575,13 @@ void VQwDetectorArray::LoadEventCuts_Fin(Int_t &eventcut_flag) {
     for (size_t i = 0; i < fCombinedPMT.size(); i++)
      fCombinedPMT[i].SetEventCutMode(eventcut_flag); 
 
-    fMainDetErrorCount = 0;//set the error counter to zero
+    //  The error counter is kept when the event cuts are reloaded while running
+}
+
+Bool_t VQwDetectorArray::HasEventCutDevice(TString device_type, TString device_name) {
+    device_type.ToLower();
+    device_name.ToLower();
+    return (GetDetectorIndex(GetDetectorTypeID(device_type),device_name) != -1);
 }
 
 
@@ -0,0 +1,71 @@
+#!/bin/bash
+
+# Test 005:
+#
+#   Replay a mock run twice with a replay store, and make sure that the
+#   second replay is recalled from the store.  Then change the raw data file
+#   and a parameter file in turn, and make sure that each change gives a new
+#   replay hash, and that the replay is not recalled.  Finally, truncate the
+#   manifest of a store entry and make sure that it is not recalled.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+STORE=${TESTDIR}/store
+OUT=${TESTDIR}/memo.out
+
+#  memo_replay <expected result>
+#    Replay with the store, check whether the replay was recalled, and
+#    set HASH to the replay hash
+function memo_replay() {
+  mock_replay 5 --memo-store ${STORE} > ${OUT} 2>&1 || return 1
+  HASH=`grep "Replay hash:" ${OUT} | awk '{print $NF}'`
+  if [ -z "${HASH}" ] ; then
+    echo "No replay hash found in the log."
+    return 1
+  fi
+  if grep -q "Replay hash found in store" ${OUT} ; then
+    result=recalled
+  else
+    result=replayed
+  fi
+  if [ "${result}" != "$1" ] ; then
+    echo "Replay with hash ${HASH} was ${result}, but should be $1."
+    return 1
+  fi
+  return 0
+}
+
+mock_generate 5 4000 || exit -1
+
+#  First replay is stored, second one is recalled
+memo_replay replayed || exit -1
+HASH_FIRST=${HASH}
+grep -q "Stored replay outputs" ${OUT} || exit -1
+memo_replay recalled || exit -1
+[ "${HASH}" == "${HASH_FIRST}" ] || exit -1
+
+#  A different raw data file changes the hash
+mock_generate 5 3000 || exit -1
+memo_replay replayed || exit -1
+HASH_DATA=${HASH}
+[ "${HASH_DATA}" != "${HASH_FIRST}" ] || exit -1
+
+#  A different parameter file changes the hash
+sed -e 's/^QWK_BCM0L00 ,\([[:space:]]*\)0 /QWK_BCM0L00 ,\1100 /' \
+  Parity/prminput/mock_qweak_pedestal.map > ${QW_PRMINPUT}/mock_qweak_pedestal.map
+cmp -s Parity/prminput/mock_qweak_pedestal.map ${QW_PRMINPUT}/mock_qweak_pedestal.map && exit -1
+memo_replay replayed || exit -1
+[ "${HASH}" != "${HASH_DATA}" ] || exit -1
+[ "${HASH}" != "${HASH_FIRST}" ] || exit -1
+memo_replay recalled || exit -1
+
+#  A truncated or empty manifest is a miss
+head -n 1 ${STORE}/${HASH}/manifest > ${TESTDIR}/manifest
+cp ${TESTDIR}/manifest ${STORE}/${HASH}/manifest
+memo_replay replayed || exit -1
+: > ${STORE}/${HASH}/manifest
+memo_replay replayed || exit -1
+memo_replay recalled || exit -1
+
+exit 0
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Test 006:
+#
+#   Generate mock data with injected pedestals and calibration factors for
+#   two BCMs, and frequent beam trips so that the beam current covers the
+#   full range, and make sure that the QwCalibrator data handler recovers
+#   the injected values from a replay with the default pedestal map.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+#  Injected pedestals and calibration factors
+PED1=1234.5 ; CAL1=0.5
+PED2=-321.0 ; CAL2=1.25
+
+#  Beam trips every 2 s on average, 0.1 s long with a 0.5 s ramp
+sed -e 's/^\(combinedbcm,[[:space:]]*bcm_target,[[:space:]]*beamtrip\).*/\1  2.0, 0.1, 0.5/' \
+  Parity/prminput/mock_data_parameters.map > ${QW_PRMINPUT}/mock_data_parameters.map
+sed -e "s/^QWK_BCM0L01 ,.*/QWK_BCM0L01 , ${PED1} , ${CAL1}/" \
+    -e "s/^QWK_BCM0L02 ,.*/QWK_BCM0L02 , ${PED2} , ${CAL2}/" \
+  Parity/prminput/mock_qweak_pedestal.map > ${QW_PRMINPUT}/mock_qweak_pedestal.map
+
+mock_generate 6 20000 || exit -1
+
+#  Replay with the default pedestal map
+rm ${QW_PRMINPUT}/mock_qweak_pedestal.map
+cat > ${QW_PRMINPUT}/test_calibrator.map <<EOF
+reference mps_qwk_bcm0l00
+gain      mps_qwk_bcm0l01
+gain      mps_qwk_bcm0l02
+EOF
+cat > ${QW_PRMINPUT}/test_datahandlers.map <<EOF
+[QwCalibrator]
+  name       = calib
+  scope      = event
+  map        = test_calibrator.map
+  reference-minimum = -1
+  output-file-base = calibration_pedestal.
+  output-file-suff = .map
+  output-path = ${TESTDIR}
+  tree-name  = calib
+  tree-comment = Pedestal and gain calibration
+EOF
+mock_replay 6 --datahandlers test_datahandlers.map > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+OUTPUT=${TESTDIR}/calibration_pedestal.6.map
+[ -f ${OUTPUT} ] || exit -1
+cat ${OUTPUT}
+
+#  check <channel> <pedestal> <calibration factor>
+#    Compare the fitted pedestal (to 0.1% of the full scale) and calibration
+#    factor (to 0.1%) of a channel with the injected values
+function check() {
+  grep -i "^$1 ," ${OUTPUT} | tr -d ',' | awk -v ped=$2 -v cal=$3 '
+    function abs(x) { return (x < 0)? -x: x }
+    { found = 1
+      if (abs($2 - ped) > 1e-3 * (abs(ped) + 100.0 / cal)) { print "pedestal " $2 " != " ped; exit 1 }
+      if (abs($3 - cal) > 1e-3 * cal) { print "calibration " $3 " != " cal; exit 1 } }
+    END { if (! found) { print "not calibrated"; exit 1 } }'
+}
+check qwk_bcm0l01 ${PED1} ${CAL1} || exit -1
+check qwk_bcm0l02 ${PED2} ${CAL2} || exit -1
+
+exit 0
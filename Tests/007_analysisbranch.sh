@@ -0,0 +1,36 @@
+#!/bin/bash
+
+# Test 007:
+#
+#   Analyze a mock run with an additional analysis branch, and make sure that
+#   the trees of the standard analysis and of the branch are identical to
+#   those of two standalone replays with the same options.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+TREES=evt,mul,pr,burst,evts,muls,bursts
+
+#  Option overlay of the branch, and the same options on the command line
+cat > ${QW_PRMINPUT}/test_branch.conf <<EOF
+rootfile-stem = branch_
+enable-differences = yes
+burstlength = 500
+EOF
+BRANCH_OPTIONS="--enable-differences yes --burstlength 500"
+OPTIONS="--disable-burst-tree no"
+
+mock_generate 7 8000 || exit -1
+
+#  One decoding pass with the branch
+mock_replay 7 ${OPTIONS} --analysis-branch test_branch.conf > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+grep -q "Creating analysis branch test_branch.conf" ${TESTDIR}/qwparity.out || exit -1
+
+#  Standalone replays
+mock_replay 7 ${OPTIONS} --rootfile-stem standalone_ > /dev/null 2>&1 || exit -1
+mock_replay 7 ${OPTIONS} --rootfile-stem standalone_branch_ ${BRANCH_OPTIONS} > /dev/null 2>&1 || exit -1
+
+run_macro compare_trees.C "\"`mock_rootfile 7`\",\"`mock_rootfile 7 standalone_`\",\"${TREES}\"" || exit -1
+run_macro compare_trees.C "\"`mock_rootfile 7 branch_`\",\"`mock_rootfile 7 standalone_branch_`\",\"${TREES}\"" || exit -1
+
+exit 0
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Test 008:
+#
+#   Analyze a mock run with the stripline and cavity BPM positions calculated
+#   per channel and in batch, and make sure that the event, multiplet and
+#   running sum trees are identical.  Then run the benchmark of the batched
+#   calculation for 50 stripline BPMs, which also compares both paths event
+#   by event, including the good event counts and the running sums.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+TREES=evt,mul,evts,muls
+
+mock_generate 8 8000 || exit -1
+
+mock_replay 8 --beamline.batched-bpm no  --rootfile-stem perchannel_ > /dev/null 2>&1 || exit -1
+mock_replay 8 --beamline.batched-bpm yes --rootfile-stem batched_    > /dev/null 2>&1 || exit -1
+
+run_macro compare_trees.C "\"`mock_rootfile 8 perchannel_`\",\"`mock_rootfile 8 batched_`\",\"${TREES}\"" || exit -1
+
+build/qwbpmbatchbenchmark 10000 50 || exit -1
+
+exit 0
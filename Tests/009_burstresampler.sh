@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# Test 009:
+#
+#   Analyze a mock run with a QwBurstResampler on sub-bursts of 100 patterns,
+#   and make sure that its means, regression slopes and jackknife
+#   uncertainties agree with those calculated directly from the patterns in
+#   the mul tree, deleting one block at a time.  Since the resampler builds
+#   every sample by merging block sums, this also checks the merging of
+#   LinRegBevPeb sums against a single pass.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+DV=asym_tq01_r1,asym_sm01
+IV=diff_bpm_targetX,diff_bpm_targetY
+
+cat > ${QW_PRMINPUT}/test_resampler.map <<EOF2
+`echo ${DV} | tr ',' '\n' | sed -e 's/^/dv /'`
+`echo ${IV} | tr ',' '\n' | sed -e 's/^/iv /'`
+EOF2
+cat > ${QW_PRMINPUT}/test_datahandlers.map <<EOF2
+[QwBurstResampler]
+  name       = resample
+  map        = test_resampler.map
+  block-size = 100
+  replicates = 2000
+  seed       = 4357
+  tree-name  = resample
+  tree-comment = Jackknife and bootstrap uncertainties
+EOF2
+
+mock_generate 9 20000 || exit -1
+mock_replay 9 --datahandlers test_datahandlers.map > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+grep -q "QwBurstResampler::CalcUncertainties" ${TESTDIR}/qwparity.out || exit -1
+
+run_macro check_resampler.C "\"`mock_rootfile 9`\",\"${DV}\",\"${IV}\",100" || exit -1
+
+exit 0
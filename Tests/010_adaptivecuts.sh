@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# Test 010:
+#
+#   Analyze a mock run with a drifting beam current, short beam trips and
+#   adaptive event cuts on one BCM, and make sure that the adaptive limits
+#   follow the baseline without being widened by the trips: in beam almost
+#   no event fails the limits, during the trips all do, and the width of
+#   the limits written to the log corresponds to the generated resolution.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=10
+BCM=qwk_bcm0l00
+SIGMA=1.0
+
+#  Resolution of 1, a drift of +-10 over 50 s, and a trip every 2.5 s
+sed -e "s/^combinedbcm,\([[:space:]]*\)bcm_target,\([[:space:]]*\)0.0,.*/combinedbcm, bcm_target, 0.0, 100.0, ${SIGMA}/" \
+    -e "s/^combinedbcm,\([[:space:]]*\)bcm_target,\([[:space:]]*\)drift.*/combinedbcm, bcm_target, drift 10.0, 0.0, 0.02/" \
+    -e "s/^combinedbcm,\([[:space:]]*\)bcm_target,\([[:space:]]*\)beamtrip.*/combinedbcm, bcm_target, beamtrip 2.5, 0.5, 0.02/" \
+    Parity/prminput/mock_data_parameters.map > ${QW_PRMINPUT}/mock_data_parameters.map || exit -1
+
+#  Wide fixed limits, which the trips fail but the drift does not
+cat > ${QW_PRMINPUT}/mock_beamline_eventcuts.map <<EOF2
+EVENTCUTS = 3
+bcm, ${BCM}, 50, 150, g, 0
+EOF2
+cat > ${QW_PRMINPUT}/test_adaptive_eventcuts.map <<EOF2
+${BCM}  1000  5  trimmed
+EOF2
+
+mock_generate ${RUN} 60000 || exit -1
+mock_replay ${RUN} --adaptive-eventcuts-map test_adaptive_eventcuts.map \
+  --adaptive-eventcuts-update 50 --adaptive-eventcuts-log ${TESTDIR}/adaptive.log \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+#  Event cut failures (EventCut_L or EventCut_U) in beam and in the trips
+ROOTFILE=`mock_rootfile ${RUN}`
+run_macro check_fraction.C "\"${ROOTFILE}\",\"evt\",\"${BCM}.hw_sum>90\",\"(int(${BCM}.Device_Error_Code)&0xc0)!=0\",0,0.01" || exit -1
+run_macro check_fraction.C "\"${ROOTFILE}\",\"evt\",\"${BCM}.hw_sum<40\",\"(int(${BCM}.Device_Error_Code)&0xc0)!=0\",0.99,1" || exit -1
+
+#  Limits of five sigma around the baseline; values from the trips in the
+#  window would widen them far beyond the resolution
+awk -v channel=${BCM} -v sigma=${SIGMA} '
+  $1 == channel {
+    n++
+    center = ($3 + $4) / 2
+    width = ($4 - $3) / 10
+    if (width < 0.8 * sigma || width > 1.2 * sigma || center < 85 || center > 115) {
+      print "Limits " $3 " to " $4 " at update " $2
+      bad++
+    }
+  }
+  END {
+    print n " updates of the limits of " channel
+    exit (n < 100 || bad > 0)
+  }' ${TESTDIR}/adaptive.log || exit -1
+
+exit 0
@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Test 011:
+#
+#   Analyze a mock run with beam trips and a scan of the lower event cut on
+#   a BCM, and make sure that every grid point gives the same patterns and
+#   asymmetries as a separate replay with its threshold as event cut.  The
+#   grid point below the event cut in effect has to be marked as bounded,
+#   and give the results of the cut in effect.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=11
+BCM=qwk_bcm0l00
+ASYMS=qwk_bcm0l01,qwk_bcm0l02
+
+#  A trip every 2 s, with slow ramps which the thresholds cut differently
+sed -e "s/^combinedbcm,\([[:space:]]*\)bcm_target,\([[:space:]]*\)beamtrip.*/combinedbcm, bcm_target, beamtrip 2.0, 0.3, 0.2/" \
+    Parity/prminput/mock_data_parameters.map > ${QW_PRMINPUT}/mock_data_parameters.map || exit -1
+
+#  Global lower event cut with beam trip holdoff, in event cut mode 3
+function eventcuts() {
+  cat > ${QW_PRMINPUT}/mock_beamline_eventcuts.map <<EOF2
+EVENTCUTS = 3
+bcm, ${BCM}, $1, 1e9, g, 0
+EOF2
+}
+
+cat > ${QW_PRMINPUT}/test_cutscan.map <<EOF2
+lower ${BCM} holdoff 40 60 80 95
+asym  qwk_bcm0l01
+asym  qwk_bcm0l02
+EOF2
+
+mock_generate ${RUN} 40000 || exit -1
+
+#  Scan on top of a cut at 50
+eventcuts 50
+mock_replay ${RUN} --cutscan-map test_cutscan.map > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+grep -q "threshold 40 for ${BCM} is looser than the event cut in effect" ${TESTDIR}/qwparity.out || exit -1
+
+#  Separate replays, one per threshold
+for threshold in 50 60 80 95 ; do
+  eventcuts ${threshold}
+  mock_replay ${RUN} --rootfile-stem cut${threshold}_ > /dev/null 2>&1 || exit -1
+done
+
+SCANFILE=`mock_rootfile ${RUN}`
+run_macro check_cutscan.C "\"${SCANFILE}\",0,\"`mock_rootfile ${RUN} cut50_`\",\"${ASYMS}\",1" || exit -1
+run_macro check_cutscan.C "\"${SCANFILE}\",1,\"`mock_rootfile ${RUN} cut60_`\",\"${ASYMS}\",0" || exit -1
+run_macro check_cutscan.C "\"${SCANFILE}\",2,\"`mock_rootfile ${RUN} cut80_`\",\"${ASYMS}\",0" || exit -1
+run_macro check_cutscan.C "\"${SCANFILE}\",3,\"`mock_rootfile ${RUN} cut95_`\",\"${ASYMS}\",0" || exit -1
+
+exit 0
@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Test 012:
+#
+#   Analyze a mock run with the Arrow export of the mul and burst trees, in
+#   batches which do not divide the number of entries and with a prescaled
+#   mul tree, and make sure that the Arrow files give back the trees in the
+#   ROOT file exactly.  Skipped in builds without Apache Arrow.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=12
+
+build/qwarrowroundtrip > /dev/null 2>&1
+if [ $? -eq 77 ] ; then
+  echo "Built without Apache Arrow, skipping the Arrow round trip."
+  exit 0
+fi
+
+mock_generate ${RUN} 20000 || exit -1
+mock_replay ${RUN} --arrow-tree "^mul$" --arrow-tree "^burst$" --arrow-batch-size 333 \
+  --burstlength 500 --num-hel-accepted-events 10 --num-hel-discarded-events 3 \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+ROOTFILE=`mock_rootfile ${RUN}`
+for tree in mul burst ; do
+  build/qwarrowroundtrip ${ROOTFILE} ${tree} ${ROOTFILE%.root}.${tree}.arrow || exit -1
+done
+
+exit 0
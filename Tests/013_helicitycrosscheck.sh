@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Test 013:
+#
+#   Inject disagreements between the input register and the userbit word
+#   into generated helicity data, decode it in input register mode and in
+#   userbit mode with the helicity cross-check, and make sure that every
+#   injected flip of the source which is not decoded is counted, and that
+#   the flips of the decoded source are found by the predictor.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+EVENTS=40000
+
+#  Helicity words of the mock data, and a userbit word
+function helicitymap() {
+  cat <<EOF2
+HelicityDecodingMode=$1
+PatternPhase=64
+RandSeedBits=30
+
+ROC=31
+Bank=0x3103
+
+WORD, 0,  0, helicitydata,  input_register
+WORD, 0,  0, helicitydata,  output_register
+WORD, 0,  0, helicitydata,  MPS_counter
+WORD, 0,  0, helicitydata,  PAT_counter
+WORD, 0,  0, helicitydata,  PAT_phase
+WORD, 0,  0, helicitydata,  scalercounter
+WORD, 0,  0, helicitydata,  userbit
+EOF2
+}
+helicitymap InputRegisterMode > ${QW_PRMINPUT}/test_helicity_inputregister.map
+helicitymap UserbitMode > ${QW_PRMINPUT}/test_helicity_userbit.map
+
+#  Disagreements of a source in the cross-check summary
+function disagreements() {
+  awk -v source="$1" '$0 ~ "^ *" source " +[0-9]+ disagreements" { print $(NF-4) }' $2
+}
+#  Number of injected flips
+function flips() {
+  awk -v source="$1" '/Injected/ { print (source == "userbit")? $2: $6 }' $2
+}
+
+for mode in inputregister userbit ; do
+  OUT=${TESTDIR}/crosscheck_${mode}.out
+  build/qwhelicitycrosscheck test_helicity_inputregister.map test_helicity_${mode}.map \
+    ${EVENTS} --helicity.crosscheck yes > ${OUT} 2>&1 || exit -1
+
+  if [ ${mode} == inputregister ] ; then
+    redundant=userbit ; decoded=input
+  else
+    redundant="input register" ; decoded=userbit
+  fi
+  injected=`flips "${redundant}" ${OUT}`
+  counted=`disagreements "${redundant}" ${OUT}`
+  echo "${mode} mode: ${injected} flips of the ${redundant}, ${counted} disagreements"
+  [ -n "${injected}" ] && [ "${injected}" -gt 0 ] && [ "${counted}" == "${injected}" ] || exit -1
+
+  injected=`flips "${decoded}" ${OUT}`
+  counted=`disagreements predictor ${OUT}`
+  echo "${mode} mode: ${injected} flips of the decoded source, ${counted} predictor disagreements"
+  [ -n "${counted}" ] && [ "${counted}" -ge "${injected}" ] && [ "${counted}" -le $((2 * injected)) ] || exit -1
+done
+
+exit 0
@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# Test 014:
+#
+#   Run two analyses with their own analysis context, with different seeds
+#   and different adaptive event cuts, first one after the other and then
+#   concurrently in two threads, and make sure that the results of each
+#   analysis do not depend on the other one running at the same time.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+EVENTS=20000
+
+#  Helicity words of the mock data
+cat > ${QW_PRMINPUT}/test_helicity_contexts.map <<EOF2
+HelicityDecodingMode=InputRegisterMode
+PatternPhase=64
+RandSeedBits=30
+
+ROC=31
+Bank=0x3103
+
+WORD, 0,  0, helicitydata,  input_register
+WORD, 0,  0, helicitydata,  output_register
+WORD, 0,  0, helicitydata,  MPS_counter
+WORD, 0,  0, helicitydata,  PAT_counter
+WORD, 0,  0, helicitydata,  PAT_phase
+EOF2
+
+#  Adaptive event cuts of each analysis
+echo "qwk_bcm0l00 1000 5 median"  > ${QW_PRMINPUT}/test_adaptive_a.map
+echo "qwk_bcm0l00 500  3 trimmed" > ${QW_PRMINPUT}/test_adaptive_b.map
+
+OUT=${TESTDIR}/contexts.out
+build/qwanalysiscontextthreads test_helicity_contexts.map ${EVENTS} \
+  "--adaptive-eventcuts-map test_adaptive_a.map --adaptive-eventcuts-update 50" \
+  "--adaptive-eventcuts-map test_adaptive_b.map --adaptive-eventcuts-update 20" \
+  > ${OUT} 2>&1
+status=$?
+grep -E "^(Sequential|Concurrent)|differ|No good" ${OUT}
+[ ${status} -eq 0 ] || exit -1
+
+exit 0
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Test 015:
+#
+#   Replay a mock run with the event loop of qwparity under a counting
+#   allocator, and make sure that after the warmup (the event ring and the
+#   first patterns) the decoding, event processing and pattern analysis
+#   make no heap allocations at all.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=15
+EVENTS=20000
+WARMUP=2000
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+
+#  No tree or histogram output, which allocates when baskets are written
+OUT=${TESTDIR}/allocations.out
+build/qwallocationbudget ${WARMUP} -r ${RUN} ${MOCK_CONFIG} \
+  --data ${TESTDIR} --rootfiles ${TESTDIR} --disable-trees --disable-histos \
+  > ${OUT} 2>&1
+status=$?
+grep -E "allocation|warmup" ${OUT}
+[ ${status} -eq 0 ] || exit -1
+
+exit 0
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Test 016:
+#
+#   Analyze a mock run with derived channels defined by expressions, which
+#   reproduce hard-coded devices of the beamline: the combined BCM (the
+#   average of eight BCMs) for events and for the pattern yields and
+#   differences, and the energy calculator (a linear combination of BPM
+#   positions with the arctangent of the target angle) for events.  The
+#   expressions have to give the values of the devices.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=16
+BCMS="qwk_bcm0l00 + qwk_bcm0l01 + qwk_bcm0l02 + qwk_bcm0l03 + qwk_bcm0l04 + qwk_bcm0l05 + qwk_bcm0l06 + qwk_bcm0l07"
+
+cat > ${QW_PRMINPUT}/test_expressions.map <<EOF2
+mps_q_expr     = (${BCMS}) / 8
+mps_e_expr     = 0.00024 * qwk_1c12X - 0.00017 * x_targ + 2.6 * atan(xp_targ)
+yield_q_yexpr  = (${BCMS}) / 8
+diff_q_dexpr   = (${BCMS}) / 8
+EOF2
+
+cat > ${QW_PRMINPUT}/test_datahandlers.map <<EOF2
+[QwExpressionHandler]
+  name       = expr_event
+  scope      = event
+  map        = test_expressions.map
+  tree-name  = expr
+  tree-comment = Derived channels from expressions
+
+[QwExpressionHandler]
+  name       = expr_pattern
+  map        = test_expressions.map
+  tree-name  = expr
+  tree-comment = Derived channels from expressions
+EOF2
+
+mock_generate ${RUN} 20000 || exit -1
+mock_replay ${RUN} --datahandlers test_datahandlers.map --enable-differences yes \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+ROOTFILE=`mock_rootfile ${RUN}`
+BLOCKS="block0 block1 block2 block3"
+function pairs() {
+  local list="" leaf
+  for leaf in $3; do list="${list}${list:+,}$1.${leaf}=$2.${leaf}"; done
+  echo ${list}
+}
+
+#  Combined BCM, on the hardware sum and the blocks
+run_macro compare_leaves.C "\"${ROOTFILE}\",\"evt\",\"evt_expr\",\"`pairs bcm_target q_expr "hw_sum ${BLOCKS}"`\",1e-12" || exit -1
+run_macro compare_leaves.C "\"${ROOTFILE}\",\"mul\",\"expr\",\"`pairs yield_bcm_target q_yexpr "hw_sum ${BLOCKS}"`\",1e-12" || exit -1
+run_macro compare_leaves.C "\"${ROOTFILE}\",\"mul\",\"expr\",\"`pairs diff_bcm_target q_dexpr "hw_sum ${BLOCKS}"`\",1e-12" || exit -1
+
+#  Energy calculator, on the blocks: its hardware sum is the average of
+#  the arctangent of the blocks, not the arctangent of the hardware sum
+run_macro compare_leaves.C "\"${ROOTFILE}\",\"evt\",\"evt_expr\",\"`pairs target_energy e_expr "${BLOCKS}"`\",1e-12" || exit -1
+
+exit 0
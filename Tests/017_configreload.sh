@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Test 017:
+#
+#   Replay a mock run with the configuration reload, and replace the event
+#   cuts of one BCM in the middle of a helicity pattern: the new cuts have
+#   to start with the next pattern, so that no pattern is cut with both,
+#   the error counters have to keep the events failed before the reload,
+#   and the tree file has to record the reload and the new cut file.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=17
+EVENTS=20000
+RELOAD=10010
+BCM=qwk_bcm0l00
+
+#  Before the reload about half of the events fail, after it all of them
+cat > ${QW_PRMINPUT}/mock_beamline_eventcuts.map <<EOF2
+EVENTCUTS = 2
+bcm, ${BCM}, 0, 100, g, 0
+EOF2
+cat > ${TESTDIR}/mock_beamline_eventcuts.map.new <<EOF2
+! reloaded event cuts
+EVENTCUTS = 2
+bcm, ${BCM}, 1000, 2000, g, 0
+EOF2
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+
+OUT=${TESTDIR}/configreload.out
+build/qwconfigreloadreplay ${BCM} ${QW_PRMINPUT}/mock_beamline_eventcuts.map \
+  ${TESTDIR}/mock_beamline_eventcuts.map.new ${RELOAD} \
+  -r ${RUN} ${MOCK_CONFIG} --data ${TESTDIR} --rootfiles ${TESTDIR} \
+  --config-reload yes --reload-target eventcuts \
+  > ${OUT} 2>&1
+status=$?
+grep -E "Reload|reload|limits|pattern" ${OUT}
+[ ${status} -eq 0 ] || exit -1
+
+exit 0
@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Test 018:
+#
+#   Analyze a mock run in full and as a quick-look replay of a few sampled
+#   blocks, with an event ring which still holds events at each jump.  Every
+#   pattern of the quick-look replay has to be a pattern of the full replay
+#   with the same values, so that no pattern mixes events from both sides of
+#   a jump, and the means of the sampled patterns have to agree with those
+#   of the full replay within their statistical uncertainty.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=18
+EVENTS=100000
+RING="--ring.size 200"
+BRANCHES=asym_bcm_target,yield_bcm_target,asym_sm01,asym_tq01_r1
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+
+mock_replay ${RUN} ${RING} > ${TESTDIR}/qwparity_full.out 2>&1 || exit -1
+mv `mock_rootfile ${RUN}` ${TESTDIR}/full_${RUN}.root || exit -1
+
+mock_replay ${RUN} ${RING} --sample-blocks 5 --sample-patterns 100 \
+  > ${TESTDIR}/qwparity_sampled.out 2>&1 || exit -1
+grep "Quick-look sampling fraction" ${TESTDIR}/qwparity_sampled.out || exit -1
+
+run_macro compare_sampled.C "\"${TESTDIR}/full_${RUN}.root\",\"`mock_rootfile ${RUN}`\",\"${BRANCHES}\",4" || exit -1
+
+exit 0
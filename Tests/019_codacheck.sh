@@ -0,0 +1,84 @@
+#!/bin/bash
+
+# Test 019:
+#
+#   Check a mock data file with qwcodacheck, which has to pass it and count
+#   every generated physics event, and then copies of it with injected
+#   corruption: a damaged block header, a wrong block number, an event with
+#   an invalid length, a truncated file, and a second segment which does not
+#   continue the event numbers of the first.  Each of them has to fail with
+#   the matching error, and the rest of the file has to be scanned.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=19
+EVENTS=20000
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+DATAFILE=${TESTDIR}/QwMock_${RUN}.log
+
+#  word <file> <index>: word of the file, in host byte order
+function word() {
+  od -An -tu4 -j $((4 * $2)) -N4 $1 | tr -d ' '
+}
+#  put <file> <index> <bytes>: overwrite a word of the file
+function put() {
+  printf "$3" | dd of=$1 bs=4 seek=$2 conv=notrunc status=none
+}
+#  corrupt <name>: copy of the data file to corrupt
+function corrupt() {
+  cp ${DATAFILE} ${TESTDIR}/$1.dat && echo ${TESTDIR}/$1.dat
+}
+#  expect_error <file> <pattern>: qwcodacheck has to fail with the error
+function expect_error() {
+  local out=${TESTDIR}/codacheck.out
+  build/qwcodacheck -q $1 > ${out} 2>&1
+  local status=$?
+  cat ${out}
+  [ ${status} -ne 0 ] || { echo "$1 passed"; return 1; }
+  grep -q "$2" ${out} || { echo "No error '$2' for $1"; return 1; }
+}
+
+#  The intact file passes with all events
+build/qwcodacheck ${DATAFILE} > ${TESTDIR}/codacheck.out 2>&1 || { cat ${TESTDIR}/codacheck.out; exit -1; }
+cat ${TESTDIR}/codacheck.out
+grep -q ": OK" ${TESTDIR}/codacheck.out || exit -1
+grep -q " ${EVENTS} physics events with numbers 1 to ${EVENTS}" ${TESTDIR}/codacheck.out || exit -1
+
+BLOCKSIZE=`word ${DATAFILE} 0`
+NBLOCKS=$(( `stat -c %s ${DATAFILE}` / 4 / BLOCKSIZE ))
+echo "${NBLOCKS} blocks of ${BLOCKSIZE} words"
+[ ${NBLOCKS} -gt 10 ] || exit -1
+
+#  Damaged magic word of block 3
+FILE=`corrupt magic`
+put ${FILE} $((3 * BLOCKSIZE + 7)) '\x00\x00\x00\x00'
+expect_error ${FILE} "block 3: corrupted block header" || exit -1
+
+#  Wrong block number of block 4
+FILE=`corrupt number`
+put ${FILE} $((4 * BLOCKSIZE + 1)) '\xff\xff\xff\x0f'
+expect_error ${FILE} "block 4: block number" || exit -1
+
+#  Invalid length of the first event which starts in block 5
+FILE=`corrupt length`
+START=`word ${FILE} $((5 * BLOCKSIZE + 3))`
+[ ${START} -gt 0 ] || exit -1
+put ${FILE} $((5 * BLOCKSIZE + START)) '\xff\xff\xff\x7f'
+expect_error ${FILE} "block 5: invalid event length" || exit -1
+
+#  Truncated in the middle of the last block
+FILE=`corrupt truncated`
+truncate -s $(( (NBLOCKS - 1) * BLOCKSIZE * 4 + BLOCKSIZE * 2 )) ${FILE}
+expect_error ${FILE} "truncated file" || exit -1
+
+#  The same data as the second segment of a run
+cp ${DATAFILE} ${TESTDIR}/segments.dat.0 || exit -1
+cp ${DATAFILE} ${TESTDIR}/segments.dat.1 || exit -1
+OUT=${TESTDIR}/codacheck.out
+build/qwcodacheck -q ${TESTDIR}/segments.dat.0 ${TESTDIR}/segments.dat.1 > ${OUT} 2>&1 && exit -1
+cat ${OUT}
+grep -q "segments.dat.1 starts at event 1, but .*segments.dat.0 ends at event ${EVENTS}" ${OUT} || exit -1
+
+exit 0
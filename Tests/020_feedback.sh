@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# Test 020:
+#
+#   Close the loop of a QwFeedbackHandler on mock data: the charge asymmetry
+#   of each mock run is generated from the setpoint which the feedback wrote
+#   in the analysis of the previous run, with a response of 2.5 ppm per unit
+#   of the setpoint, while the feedback loop assumes a slope of 2.0.  The
+#   feedback has to make one correction per run, move the setpoint from its
+#   start to the one which cancels the asymmetry, and leave an asymmetry in
+#   the last run which is zero within its uncertainty.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+EVENTS=20000
+ITERATIONS=6
+ASYM0=200.0       # ppm at the starting setpoint
+RESPONSE=2.5      # ppm per unit of the setpoint
+START=1000
+TARGET=920        # START - ASYM0 / RESPONSE
+LOG=${TESTDIR}/feedback.log
+
+cat > ${QW_PRMINPUT}/test_feedback.map <<EOF2
+[charge]
+  input     = asym_bcm_target
+  patterns  = 250
+  precision = 0
+  slope     = 2.0
+  setpoints = TEST:DAC
+  limits    = 0, 2000
+EOF2
+cat > ${QW_PRMINPUT}/test_datahandlers.map <<EOF2
+[QwFeedbackHandler]
+  name           = feedback
+  map            = test_feedback.map
+  control        = mock
+  control-config = test_feedback_setpoints.map
+  log-file       = ${LOG}
+EOF2
+
+SETPOINT=${START}
+for i in `seq 1 ${ITERATIONS}` ; do
+  RUN=20${i}
+
+  #  Charge asymmetry of the beam for the current setpoint
+  ASYM=`awk -v s=${SETPOINT} "BEGIN { printf \"%.9g\", (${ASYM0} + ${RESPONSE} * (s - ${START})) * 1e-6 }"`
+  sed -e "s/^combinedbcm,\([[:space:]]*\)bcm_target,\([[:space:]]*\)0.0,.*/combinedbcm, bcm_target, ${ASYM}, 100.0, 0.02/" \
+      Parity/prminput/mock_data_parameters.map > ${QW_PRMINPUT}/mock_data_parameters.map || exit -1
+  echo "TEST:DAC = ${SETPOINT}" > ${QW_PRMINPUT}/test_feedback_setpoints.map
+
+  mock_generate ${RUN} ${EVENTS} || exit -1
+  mock_replay ${RUN} --datahandlers test_datahandlers.map > ${TESTDIR}/qwparity_${RUN}.out 2>&1 || exit -1
+  grep -q "Feedback charge: 1 corrections" ${TESTDIR}/qwparity_${RUN}.out || {
+    grep "Feedback" ${TESTDIR}/qwparity_${RUN}.out
+    echo "Run ${RUN} did not make exactly one correction"
+    exit -1
+  }
+
+  #  Setpoint written by the feedback for the next run
+  LINE=`grep " charge pattern" ${LOG} | tail -1`
+  echo "Run ${RUN}: asymmetry ${ASYM}, ${LINE}"
+  SETPOINT=`echo "${LINE}" | sed -e 's/.*-> //' -e 's/,.*//'`
+done
+
+#  Setpoint which cancels the asymmetry, and no asymmetry left in the last run
+echo "${LINE}" | awk -v target=${TARGET} -v setpoint=${SETPOINT} '{
+  for (i = 1; i < NF; i++) if ($i == "+/-") { mean = $(i-1); error = $(i+1) }
+  print "Final setpoint " setpoint " (target " target "), last asymmetry " mean " +/- " error " ppm"
+  exit (setpoint < target - 3 || setpoint > target + 3 || mean > 4 * error || mean < -4 * error)
+}' || exit -1
+
+#  The first correction went all the way with the slope of the loop
+FIRST=`grep " charge pattern" ${LOG} | head -1 | sed -e 's/.*-> //' -e 's/,.*//'`
+awk -v first=${FIRST} -v start=${START} -v asym=${ASYM0} 'BEGIN {
+  expected = start - asym / 2.0
+  print "First correction to " first " (expected " expected ")"
+  exit (first < expected - 5 || first > expected + 5)
+}' || exit -1
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Test 021:
+#
+#   Analyze a mock run with the QwCovarianceMonitor in blocks of 64
+#   patterns, and again with blocks of one pattern, which is the rank-1
+#   update of the running means and co-moments with every pattern (the
+#   last, partial block of 64 is folded in at the end of the run).  The
+#   pattern counts, means, widths, correlation matrix and eigenvalues have
+#   to agree up to rounding.  The eigenvectors are not compared, since their
+#   signs are arbitrary.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=21
+EVENTS=20000
+BRANCHES=total_count,good_count,mean,width,correlation,eigenvalues
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+
+for BLOCK in 64 1 ; do
+  cat > ${QW_PRMINPUT}/test_datahandlers.map <<EOF2
+[QwCovarianceMonitor]
+  name       = covariance
+  map        = mock_covariance.map
+  block-size = ${BLOCK}
+  components = 5
+  tree-name  = covariance
+  tree-comment = Covariance in blocks of ${BLOCK} patterns
+EOF2
+  mock_replay ${RUN} --datahandlers test_datahandlers.map \
+    > ${TESTDIR}/qwparity_block${BLOCK}.out 2>&1 || exit -1
+  grep "in blocks of ${BLOCK} patterns" ${TESTDIR}/qwparity_block${BLOCK}.out || exit -1
+  mv `mock_rootfile ${RUN}` ${TESTDIR}/block${BLOCK}_${RUN}.root || exit -1
+done
+
+run_macro compare_trees.C "\"${TESTDIR}/block64_${RUN}.root\",\"${TESTDIR}/block1_${RUN}.root\",\"covariance\",1e-10,\"${BRANCHES}\"" || exit -1
+
+exit 0
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Test 022:
+#
+#   Analyze a mock run in bursts of 50 patterns with a burst-aligned mul
+#   tree, and make sure that the burst index stored with the tree has the
+#   entry ranges of the BurstCounter branch, and that every burst starts a
+#   new cluster.  The evt tree is not selected, and has no burst index.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=22
+EVENTS=20000
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+mock_replay ${RUN} --burstlength 50 --burst-aligned-tree "^mul$" \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+ROOTFILE=`mock_rootfile ${RUN}`
+build/qwburstindexcheck ${ROOTFILE} mul 5 || exit -1
+build/qwburstindexcheck ${ROOTFILE} evt 2 && exit -1
+
+exit 0
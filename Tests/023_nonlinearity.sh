@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Test 023:
+#
+#   Write a nonlinearity correction table for a synthetic quadratic
+#   response as binary and as text file, load both through a map file given
+#   with --nonlinearity-map (the binary table memory-mapped, the text table
+#   read by the fallback), and make sure that the correction gives back the
+#   true values to interpolation precision and leaves the values outside
+#   the table unchanged.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+build/qwnonlinearityroundtrip ${TESTDIR} > ${TESTDIR}/qwnonlinearityroundtrip.out 2>&1
+STATUS=$?
+grep "largest difference" ${TESTDIR}/qwnonlinearityroundtrip.out
+[ ${STATUS} -eq 0 ] || { cat ${TESTDIR}/qwnonlinearityroundtrip.out ; exit -1 ; }
+
+exit 0
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Test 024:
+#
+#   Generate a mock run with EPICS events which change the horizontal Wien
+#   angle twice in the run, and analyze it with a long event ring and the
+#   Wien angle carried forward onto the mul tree.
+#   The EPICS events are decoded ahead of the events which leave the ring,
+#   but each change has to appear first on the pattern of the first event
+#   after the EPICS event, with the update count incremented there.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=24
+EVENTS=20000
+RING="--ring.size 1000"
+
+cat > ${QW_PRMINPUT}/test_epics.dat <<EOF2
+# event  tag         value
+1        HWienAngle  10
+5000     HWienAngle  20
+12001    HWienAngle  30
+EOF2
+
+mock_generate ${RUN} ${EVENTS} --mock-epics test_epics.dat || exit -1
+mock_replay ${RUN} ${RING} --epics-carry-forward HWienAngle \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+ROOTFILE=`mock_rootfile ${RUN}`
+run_macro check_carryforward.C "\"${ROOTFILE}\",\"HWienAngle\",\"1:10,5000:20,12001:30\"" || exit -1
+
+exit 0
@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# Test 025:
+#
+#   Analyze a mock run with the principal component regression on the five
+#   stripline BPMs together with the target position and angle fitted from
+#   them (mock_eigenregression.conf).  Two eigenvalues have to vanish and
+#   the retained rank has to be 5.  The same dependent variables are
+#   regressed on the five BPMs alone, which are not degenerate, with a
+#   QwEigenRegression and with a QwCorrelator: the monitor slopes have to
+#   agree, and the corrected means of all three regressions have to agree,
+#   since the target monitors do not add to the space of the BPMs.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=25
+EVENTS=20000
+
+grep -e "^dv" -e "^iv diff_qwk_" Parity/prminput/mock_eigenregression.conf \
+  > ${QW_PRMINPUT}/test_eigenregression_bpm.conf || exit -1
+cat > ${QW_PRMINPUT}/test_datahandlers.map <<EOF2
+[QwEigenRegression]
+  name       = eigen
+  map        = mock_eigenregression.conf
+  rank       = 0
+  eigenvalue-cut = 1e-9
+  standardize = false
+  tree-name  = eigen
+  tree-comment = Principal component regression on degenerate monitors
+
+[QwEigenRegression]
+  name       = eigen_bpm
+  map        = test_eigenregression_bpm.conf
+  rank       = 0
+  eigenvalue-cut = 1e-9
+  standardize = false
+  tree-name  = eigen_bpm
+  tree-comment = Principal component regression on the BPMs
+
+[QwCorrelator]
+  name       = lrb_bpm
+  map        = test_eigenregression_bpm.conf
+  slope-file-base = blueR
+  slope-file-suff = new.slope.root
+  slope-path = ${TESTDIR}
+  alias-file-base = regalias_
+  alias-file-suff =
+  alias-path = ${TESTDIR}
+  disable-histos = true
+  tree-name  = lrb_bpm
+  tree-comment = Correlations on the BPMs
+EOF2
+
+mock_generate ${RUN} ${EVENTS} || exit -1
+mock_replay ${RUN} --datahandlers test_datahandlers.map \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+grep "5 of 7 components retained" ${TESTDIR}/qwparity.out || exit -1
+
+run_macro check_eigenregression.C "\"`mock_rootfile ${RUN}`\",\"eigen\",\"eigen_bpm\",\"lrb_bpm\",5,2" || exit -1
+
+exit 0
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# Test 026:
+#
+#   End bursts on EPICS changes, beam trips and beam modulation cycles:
+#
+#   - Generate a mock run with EPICS events which change the horizontal
+#     Wien angle twice, and analyze it with a long event ring and a burst
+#     break on the Wien angle.  The EPICS events are decoded ahead of the
+#     events which leave the ring, but each burst has to end before the
+#     pattern of the first event after the EPICS event, with reason 5.
+#   - Generate a mock run with beam trips, and analyze it with a global
+#     event cut on a BCM and a burst break after trips of 100 events.  Each
+#     burst has to end before the first good pattern after a trip, with
+#     reason 2.
+#   - The mock data have no beam modulation, so modulation cycles and trips
+#     are injected into a sequence of events for QwBurstSegmentation.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+EVENTS=40000
+BURSTS="--disable-burst-tree no"
+
+#  EPICS changes
+cat > ${QW_PRMINPUT}/test_epics.dat <<EOF2
+# event  tag         value
+1        HWienAngle  10
+5000     HWienAngle  20
+12001    HWienAngle  30
+EOF2
+
+mock_generate 261 ${EVENTS} --mock-epics test_epics.dat || exit -1
+mock_replay 261 ${BURSTS} --ring.size 1000 --burst-break-epics HWienAngle \
+  > ${TESTDIR}/qwparity_epics.out 2>&1 || exit -1
+grep "Bursts ended by EPICS change: 2" ${TESTDIR}/qwparity_epics.out || exit -1
+run_macro check_bursts.C "\"`mock_rootfile 261`\",\"5:5000,5:12001\",0,2" || exit -1
+
+#  Beam trips every 4 s, with a global lower event cut on a BCM
+sed -e "s/^combinedbcm,\([[:space:]]*\)bcm_target,\([[:space:]]*\)beamtrip.*/combinedbcm, bcm_target, beamtrip 4.0, 0.3, 0.2/" \
+    Parity/prminput/mock_data_parameters.map > ${QW_PRMINPUT}/mock_data_parameters.map || exit -1
+cat > ${QW_PRMINPUT}/mock_beamline_eventcuts.map <<EOF2
+EVENTCUTS = 3
+bcm, qwk_bcm0l00, 50, 1e9, g, 0
+EOF2
+
+mock_generate 262 ${EVENTS} || exit -1
+mock_replay 262 ${BURSTS} --burst-break-trip 100 \
+  > ${TESTDIR}/qwparity_trip.out 2>&1 || exit -1
+grep "Bursts ended by beam trip" ${TESTDIR}/qwparity_trip.out || exit -1
+run_macro check_bursts.C "\"`mock_rootfile 262`\",\"\",100,2" || exit -1
+
+#  Injected modulation cycles and trips
+build/qwburstsegmentationcheck ${TESTDIR} || exit -1
+
+exit 0
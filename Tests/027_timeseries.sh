@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Test 027:
+#
+#   Analyze a mock run with the time series of two BCMs, and make sure that
+#   the bins of all levels agree with the bins of the good events in the evt
+#   tree, and that the time series file starts with the start time of the
+#   run (between the times before and after the generation of the run), so
+#   that a reader of the first half of the file already gets the unix times
+#   of the bins.
+#
+
+source Tests/mock_functions.sh || exit -1
+
+RUN=27
+EVENTS=40000
+RATE=240
+
+TMIN=`date +%s`
+mock_generate ${RUN} ${EVENTS} || exit -1
+TMAX=`date +%s`
+
+mock_replay ${RUN} --timeseries-channel qwk_bcm0l00 --timeseries-channel bcm_target \
+  --timeseries-mps-rate ${RATE} --timeseries-base 1 --timeseries-factor 4 --timeseries-levels 4 \
+  > ${TESTDIR}/qwparity.out 2>&1 || exit -1
+
+ROOTFILE=`mock_rootfile ${RUN}`
+build/qwtimeseriescheck ${ROOTFILE} ${ROOTFILE%.root}.timeseries ${RATE} ${TMIN} ${TMAX} || exit -1
+
+exit 0
@@ -0,0 +1,177 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwAllocationBudget.cc
+
+ \ingroup QwAnalysis
+
+ \brief Heap allocations of the steady-state event loop of a replay
+
+ Usage: qwallocationbudget warmup [qwparity options]
+
+ Replays the runs selected by the options (e.g. a mock data run) with the
+ event loop of qwparity: decoding, ProcessEvent, the single event cuts and
+ the analysis pipeline with its event ring, helicity pattern, data handlers
+ and running sums.  The global operator new and operator new[] of this
+ executable count every allocation (also those made in the libraries).
+ After the first 'warmup' physics events of each run, which fill the event
+ ring and the first patterns, the allocations are counted until the end of
+ the run.  The exit status is zero only if no allocation was made in the
+ counted events.
+
+ Tree and histogram output, which allocates when baskets are written out,
+ should be disabled with --disable-trees and --disable-histos, and the
+ counted events should end before the first burst is finished.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptionsParity.h"
+#include "QwParameterFile.h"
+#include "QwEventBuffer.h"
+#include "QwHistogramHelper.h"
+#include "QwSubsystemArrayParity.h"
+#include "QwEPICSEvent.h"
+#include "QwAnalysisPipeline.h"
+
+/// Are allocations counted?
+static std::atomic<Bool_t> gCounting(kFALSE);
+/// Number of counted allocations
+static std::atomic<Long64_t> gAllocations(0);
+
+/// Allocate memory, and count the allocation if requested
+static void* CountedAllocation(std::size_t size)
+{
+  if (gCounting) gAllocations++;
+  void* ptr = std::malloc(size > 0? size: 1);
+  if (ptr == 0) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(std::size_t size) { return CountedAllocation(size); }
+void* operator new[](std::size_t size) { return CountedAllocation(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  try { return CountedAllocation(size); } catch (...) { return 0; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  try { return CountedAllocation(size); } catch (...) { return 0; }
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    QwError << "Usage: qwallocationbudget warmup [qwparity options]" << QwLog::endl;
+    return 1;
+  }
+  Long64_t warmup = atol(argv[1]);
+
+  // The remaining arguments are options, as for qwparity
+  DefineOptionsParity(gQwOptions);
+  gQwOptions.AddOptions()("single-output-file", po::value<bool>()->default_bool_value(false), "Write a single output file");
+  gQwOptions.AddOptions()("print-errorcounters", po::value<bool>()->default_bool_value(true), "Print summary of error counters");
+  std::vector<char*> arguments(1, argv[0]);
+  for (Int_t i = 2; i < argc; i++) arguments.push_back(argv[i]);
+
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QW_PRMINPUT"));
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QWANALYSIS") + "/Parity/prminput");
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QWANALYSIS") + "/Analysis/prminput");
+
+  gQwOptions.SetCommandLine(arguments.size(), &arguments[0]);
+  gQwHists.ProcessOptions(gQwOptions);
+  gQwLog.ProcessOptions(&gQwOptions);
+
+  QwEventBuffer eventbuffer;
+  eventbuffer.ProcessOptions(gQwOptions);
+
+  Long64_t counted_events = 0;
+  Long64_t counted_allocations = 0;
+  while (eventbuffer.OpenNextStream() == CODA_OK) {
+
+    Int_t run_number = eventbuffer.GetRunNumber();
+    TString run_label = eventbuffer.GetRunLabel();
+    QwParameterFile::SetCurrentRunNumber(run_number);
+    QwParameterFile::ClearOpenedFileList();
+    gQwOptions.Parse(kTRUE);
+    eventbuffer.ProcessOptions(gQwOptions);
+
+    QwEPICSEvent epicsevent;
+    epicsevent.ProcessOptions(gQwOptions);
+    epicsevent.LoadChannelMap("EpicsTable.map");
+
+    QwSubsystemArrayParity detectors(gQwOptions);
+    detectors.ProcessOptions(gQwOptions);
+
+    QwAnalysisPipeline pipeline(gQwOptions, detectors, run_label);
+    pipeline.OpenRootFiles(detectors, epicsevent);
+
+    // Event loop of qwparity, with the allocations counted after the warmup
+    Long64_t events = 0;
+    Long64_t allocations = 0;
+    while (eventbuffer.GetNextEvent() == CODA_OK) {
+
+      if (eventbuffer.IsROCConfigurationEvent())
+        eventbuffer.FillSubsystemConfigurationData(detectors);
+
+      if (eventbuffer.IsEPICSEvent()) {
+        eventbuffer.FillEPICSData(epicsevent);
+        if (epicsevent.HasDataLoaded()) {
+          epicsevent.CalculateRunningValues();
+          pipeline.ProcessEPICSEvent(epicsevent);
+        }
+      }
+
+      if (! eventbuffer.IsPhysicsEvent()) continue;
+
+      // Count this event after the warmup
+      gCounting = (events >= warmup);
+      Long64_t before = gAllocations;
+
+      eventbuffer.FillSubsystemData(detectors);
+      detectors.ProcessEvent();
+      if (detectors.ApplySingleEventCuts())
+        pipeline.ProcessEvent(detectors);
+
+      if (gCounting) {
+        gCounting = kFALSE;
+        if (gAllocations > before && allocations == 0)
+          QwError << "First allocation in event " << eventbuffer.GetPhysicsEventNumber()
+                  << " of run " << run_number << QwLog::endl;
+        allocations += gAllocations - before;
+        counted_events++;
+      }
+      events++;
+    }
+
+    QwMessage << "Run " << run_number << ": " << allocations << " allocations in "
+              << ((events > warmup)? events - warmup: 0) << " events after "
+              << warmup << " warmup events" << QwLog::endl;
+    counted_allocations += allocations;
+
+    pipeline.FinishEventLoop(run_number);
+    pipeline.FinishRun();
+    eventbuffer.CloseStream();
+  }
+
+  if (counted_events == 0) {
+    QwError << "No events after the warmup" << QwLog::endl;
+    return 1;
+  }
+  QwMessage << "Allocations per event: "
+            << Double_t(counted_allocations) / counted_events << QwLog::endl;
+  return (counted_allocations == 0)? 0: 1;
+}
@@ -0,0 +1,202 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwAnalysisContextThreads.cc
+
+ \ingroup QwAnalysis
+
+ \brief Two analyses with their own context in concurrent threads
+
+ Usage: qwanalysiscontextthreads helicitymap events "options A" "options B"
+
+ Each analysis makes its own QwAnalysisContext current, with its own seed
+ of the mock data randomness, and parses its own options (e.g. a different
+ --adaptive-eventcuts-map and --adaptive-eventcuts-update).  It generates
+ and decodes helicity data from the map file (in input register mode, as
+ in the mock data), and applies the event cuts, with the adaptive cuts of
+ its options, to a mock BCM channel with the helicity of each event.
+
+ The two analyses are run one after the other, and then concurrently in
+ two threads.  The results of each analysis (event cut failures, sum of
+ the values, final cut limits, and the decoded helicity) have to be
+ identical in both runs, and the two analyses have to differ from each
+ other.  The exit status is zero only if they do.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ROOT headers
+#include "TROOT.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwOptionsParity.h"
+#include "QwParameterFile.h"
+#include "QwAnalysisContext.h"
+#include "QwAdaptiveEventCut.h"
+#include "QwVQWK_Channel.h"
+#include "QwHelicity.h"
+
+// Multiplet structure of the mock data
+static const Int_t kMultiplet = 64;
+
+/// Configuration and results of one analysis
+struct Analysis {
+  std::string fName;
+  UInt_t fSeed;
+  std::string fOptions;
+
+  Long64_t fFailed;
+  Double_t fSum;
+  Double_t fLower, fUpper;
+  Long64_t fGoodHelicity;
+  Long64_t fHelicitySum;
+  UInt_t fHelicitySeed;
+
+  Bool_t operator==(const Analysis& other) const {
+    return fFailed == other.fFailed && fSum == other.fSum
+        && fLower == other.fLower && fUpper == other.fUpper
+        && fGoodHelicity == other.fGoodHelicity
+        && fHelicitySum == other.fHelicitySum
+        && fHelicitySeed == other.fHelicitySeed;
+  }
+};
+
+/// Run one analysis in its own context
+static void Run(Analysis& analysis, const TString& helicitymap, Int_t nevents)
+{
+  QwAnalysisContext context(analysis.fName, analysis.fSeed);
+  QwAnalysisContext::Scope scope(context);
+
+  // Options of this analysis only
+  DefineOptionsParity(gQwOptions);
+  std::vector<std::string> words(1, analysis.fName);
+  std::istringstream options(analysis.fOptions);
+  for (std::string word; options >> word; ) words.push_back(word);
+  std::vector<char*> arguments;
+  for (size_t i = 0; i < words.size(); i++) arguments.push_back(&words[i][0]);
+  gQwOptions.SetCommandLine(arguments.size(), &arguments[0], false);
+  QwAdaptiveEventCut::ProcessOptions(gQwOptions);
+
+  // Mock BCM with a global cut
+  QwVQWK_Channel bcm;
+  bcm.InitializeChannel("qwk_bcm0l00", "derived");
+  bcm.SetRandomEventParameters(100.0, 1.0);
+  bcm.SetRandomEventAsymmetry(1.0e-3);
+  bcm.SetSingleEventCuts(kGlobalCut, 50.0, 150.0);
+  bcm.SetEventCutMode(2);
+
+  // Helicity generator and decoder
+  QwHelicity generator("Helicity Info");
+  generator.LoadChannelMap(helicitymap);
+  generator.ProcessOptions(gQwOptions);
+  QwHelicity helicity("Helicity Info");
+  helicity.LoadChannelMap(helicitymap);
+  helicity.ProcessOptions(gQwOptions);
+  generator.SetEventPatternPhase(-1, -1, -1);
+  generator.SetFirstBits(24, analysis.fSeed & 0xFFFFFF);
+
+  analysis.fFailed = 0;
+  analysis.fSum = 0.0;
+  analysis.fGoodHelicity = 0;
+  analysis.fHelicitySum = 0;
+  std::vector<UInt_t> buffer;
+  for (Int_t event = 0; event < nevents; event++) {
+    generator.SetEventPatternPhase(event, event / kMultiplet, event % kMultiplet + 1);
+    generator.RunPredictor();
+    buffer.clear();
+    generator.EncodeEventData(buffer);
+    // Skip the bank and subbank headers
+    helicity.ClearEventData();
+    helicity.ProcessEvBuffer(buffer[1] >> 16, buffer[3] >> 16, &buffer[4], buffer.size() - 4);
+    helicity.ProcessEvent();
+    if (helicity.IsGoodHelicity()) {
+      analysis.fGoodHelicity++;
+      analysis.fHelicitySum += helicity.GetHelicityActual();
+    }
+
+    bcm.ClearEventData();
+    bcm.RandomizeEventData(generator.GetHelicityActual(), 0.001 * event);
+    if (! bcm.ApplySingleEventCuts()) analysis.fFailed++;
+    analysis.fSum += bcm.GetValue();
+  }
+  analysis.fLower = bcm.GetEventCutLowerLimit();
+  analysis.fUpper = bcm.GetEventCutUpperLimit();
+  analysis.fHelicitySeed = helicity.GetRandomSeedActual();
+}
+
+/// Print the results of an analysis
+static void Print(const char* run, const Analysis& analysis)
+{
+  QwMessage << std::setprecision(15) << run << " " << analysis.fName
+            << ": failed " << analysis.fFailed << ", sum " << analysis.fSum
+            << ", limits " << analysis.fLower << " " << analysis.fUpper
+            << ", good helicity " << analysis.fGoodHelicity
+            << ", helicity sum " << analysis.fHelicitySum
+            << ", seed 0x" << std::hex << analysis.fHelicitySeed << std::dec
+            << QwLog::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 5) {
+    QwError << "Usage: qwanalysiscontextthreads helicitymap events \"options A\" \"options B\""
+            << QwLog::endl;
+    return 1;
+  }
+  TString helicitymap = argv[1];
+  Int_t nevents = atoi(argv[2]);
+
+  ROOT::EnableThreadSafety();
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QW_PRMINPUT"));
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QWANALYSIS") + "/Parity/prminput");
+
+  Analysis analyses[2];
+  analyses[0].fName = "A";
+  analyses[0].fSeed = 0x1234;
+  analyses[0].fOptions = argv[3];
+  analyses[1].fName = "B";
+  analyses[1].fSeed = 0x5678;
+  analyses[1].fOptions = argv[4];
+
+  // One after the other
+  Analysis sequential[2] = { analyses[0], analyses[1] };
+  for (Int_t i = 0; i < 2; i++) {
+    Run(sequential[i], helicitymap, nevents);
+    Print("Sequential", sequential[i]);
+  }
+
+  // Concurrently
+  Analysis concurrent[2] = { analyses[0], analyses[1] };
+  std::thread first(Run, std::ref(concurrent[0]), helicitymap, nevents);
+  std::thread second(Run, std::ref(concurrent[1]), helicitymap, nevents);
+  first.join();
+  second.join();
+  for (Int_t i = 0; i < 2; i++)
+    Print("Concurrent", concurrent[i]);
+
+  Int_t status = 0;
+  for (Int_t i = 0; i < 2; i++) {
+    if (! (sequential[i] == concurrent[i])) {
+      QwError << "Analysis " << analyses[i].fName << " differs when run concurrently"
+              << QwLog::endl;
+      status = 1;
+    }
+  }
+  if (sequential[0] == sequential[1]) {
+    QwError << "Analyses A and B do not differ" << QwLog::endl;
+    status = 1;
+  }
+  if (sequential[0].fGoodHelicity == 0 || sequential[1].fGoodHelicity == 0) {
+    QwError << "No good helicity decoded" << QwLog::endl;
+    status = 1;
+  }
+  return status;
+}
@@ -0,0 +1,166 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwArrowRoundTrip.cc
+
+ \ingroup QwAnalysis
+
+ \brief Round trip of a tree through its Arrow IPC export
+
+ Usage: qwarrowroundtrip rootfile tree arrowfile
+
+ Reads the Arrow file written by QwArrowFile for a tree, and compares it
+ with the tree in the ROOT file: the number of rows has to equal the number
+ of entries, every exported column has to belong to a leaf of the tree
+ (by branch name, 'branch.leaf' or 'leaf[index]' as in QwArrowFile), every
+ leaf with a fixed number of numerical values has to be exported, and all
+ values have to be identical, including the integer error flags.  The exit
+ status is zero only if the round trip is exact.  Without Arrow the test
+ cannot run, and exits with status 77.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <iostream>
+#include <map>
+#include <string>
+
+// ROOT headers
+#include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
+#include "TLeafC.h"
+#include "TBranch.h"
+#include "TObjArray.h"
+#include "TString.h"
+
+#ifdef __USE_ARROW__
+// Arrow headers
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#endif
+
+// Qweak headers
+#include "QwLog.h"
+
+#ifdef __USE_ARROW__
+/// Exported column of a leaf
+struct Element {
+  TLeaf* fLeaf;
+  Int_t fIndex;
+};
+
+/// Columns expected for the leaves of the tree, named as in QwArrowFile
+static std::map<std::string, Element> ExpectedColumns(TTree* tree)
+{
+  std::map<std::string, Element> columns;
+  TObjArray* leaves = tree->GetListOfLeaves();
+  for (Int_t i = 0; i < leaves->GetEntriesFast(); i++) {
+    TLeaf* leaf = static_cast<TLeaf*>(leaves->UncheckedAt(i));
+    if (leaf->IsA() == TLeafC::Class() || leaf->GetLeafCount() != 0) continue;
+    TString branch = leaf->GetBranch()->GetName();
+    TString name = (branch == leaf->GetName())? branch: branch + "." + leaf->GetName();
+    for (Int_t j = 0; j < leaf->GetLen(); j++) {
+      Element element = { leaf, j };
+      columns[(leaf->GetLen() > 1)? Form("%s[%d]", name.Data(), j): name.Data()] = element;
+    }
+  }
+  return columns;
+}
+
+/// Compare the Arrow file with the tree, returns the number of differences
+static Long64_t Compare(TTree* tree, const std::string& arrowfile)
+{
+  arrow::Result<std::shared_ptr<arrow::io::ReadableFile> >
+    input = arrow::io::ReadableFile::Open(arrowfile);
+  if (! input.ok()) {
+    QwError << "Unable to open " << arrowfile << ": " << input.status().ToString() << QwLog::endl;
+    return 1;
+  }
+  arrow::Result<std::shared_ptr<arrow::ipc::RecordBatchFileReader> >
+    reader = arrow::ipc::RecordBatchFileReader::Open(*input);
+  if (! reader.ok()) {
+    QwError << "Unable to read " << arrowfile << ": " << reader.status().ToString() << QwLog::endl;
+    return 1;
+  }
+
+  Long64_t differences = 0;
+  std::map<std::string, Element> expected = ExpectedColumns(tree);
+  std::shared_ptr<arrow::Schema> schema = (*reader)->schema();
+  for (int c = 0; c < schema->num_fields(); c++) {
+    if (expected.count(schema->field(c)->name()) == 0) {
+      QwError << "Column " << schema->field(c)->name() << " is not a leaf of tree "
+              << tree->GetName() << QwLog::endl;
+      differences++;
+    }
+  }
+  if (schema->num_fields() != static_cast<int>(expected.size())) {
+    QwError << "Arrow file has " << schema->num_fields() << " columns, tree "
+            << tree->GetName() << " has " << expected.size() << " exported leaves" << QwLog::endl;
+    differences++;
+  }
+  if (differences > 0) return differences;
+
+  Long64_t entry = 0;
+  for (int b = 0; b < (*reader)->num_record_batches(); b++) {
+    arrow::Result<std::shared_ptr<arrow::RecordBatch> > batch = (*reader)->ReadRecordBatch(b);
+    if (! batch.ok()) {
+      QwError << "Unable to read batch " << b << ": " << batch.status().ToString() << QwLog::endl;
+      return differences + 1;
+    }
+    for (int64_t row = 0; row < (*batch)->num_rows(); row++, entry++) {
+      if (entry >= tree->GetEntries()) continue;
+      tree->GetEntry(entry);
+      for (int c = 0; c < (*batch)->num_columns(); c++) {
+        const Element& element = expected[schema->field(c)->name()];
+        std::shared_ptr<arrow::Array> column = (*batch)->column(c);
+        Bool_t same;
+        if (column->type_id() == arrow::Type::INT64) {
+          Long64_t value = std::static_pointer_cast<arrow::Int64Array>(column)->Value(row);
+          same = (value == element.fLeaf->GetValueLong64(element.fIndex));
+        } else {
+          Double_t value = std::static_pointer_cast<arrow::DoubleArray>(column)->Value(row);
+          same = (value == element.fLeaf->GetValue(element.fIndex));
+        }
+        if (! same) {
+          if (differences < 10)
+            QwError << "Entry " << entry << ": column " << schema->field(c)->name()
+                    << " differs from the tree" << QwLog::endl;
+          differences++;
+        }
+      }
+    }
+  }
+  if (entry != tree->GetEntries()) {
+    QwError << "Arrow file has " << entry << " rows, tree " << tree->GetName()
+            << " has " << tree->GetEntries() << " entries" << QwLog::endl;
+    differences++;
+  }
+
+  QwMessage << "Tree " << tree->GetName() << ": " << entry << " rows in "
+            << (*reader)->num_record_batches() << " batches, " << schema->num_fields()
+            << " columns, " << differences << " differences" << QwLog::endl;
+  return differences;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef __USE_ARROW__
+  if (argc != 4) {
+    QwError << "Usage: qwarrowroundtrip rootfile tree arrowfile" << QwLog::endl;
+    return 1;
+  }
+
+  TFile file(argv[1]);
+  TTree* tree = (TTree*) file.Get(argv[2]);
+  if (tree == 0) {
+    QwError << "No tree " << argv[2] << " in " << argv[1] << QwLog::endl;
+    return 1;
+  }
+  return (Compare(tree, argv[3]) == 0)? 0: 1;
+#else
+  QwWarning << "Built without Apache Arrow, no round trip possible" << QwLog::endl;
+  return 77;
+#endif
+}
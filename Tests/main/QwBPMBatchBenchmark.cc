@@ -0,0 +1,180 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwBPMBatchBenchmark.cc
+
+ \ingroup QwAnalysis_BL
+
+ \brief Equivalence and timing of the batched stripline BPM positions
+
+ Usage: qwbpmbatchbenchmark [events] [bpms]
+
+ Two identical sets of stripline BPMs (50 by default) with different
+ rotations, gains, pedestals and calibration factors are filled with the
+ same encoded VQWK data.  The positions of the first set are calculated with
+ QwBPMStripline::ProcessEvent, those of the second set with
+ QwBPMStriplineBatch.  After every event the values, number of samples,
+ good event count and error flag of all derived channels must be
+ identical, and so must the running sums, to which every event is added
+ and from which every tenth event is removed again.  This is done without
+ and with event cuts, and the time spent in both paths is printed.  The
+ exit status is zero only if both paths agree.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+// ROOT headers
+#include "TRandom3.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwVQWK_Channel.h"
+#include "QwBPMStripline.h"
+#include "QwBPMBatch.h"
+
+typedef QwBPMStripline<QwVQWK_Channel> Stripline;
+
+static const Int_t kSamples = 2000;
+static const char* kDerived[] = { "relx", "rely", "absx", "absy", "charge", "elli" };
+static const char* kWires[] = { "xp", "xm", "yp", "ym" };
+
+/// Compare the derived channels of two BPMs, including errors for sums
+static Int_t Compare(Stripline& one, Stripline& two, Bool_t errors)
+{
+  Int_t differences = 0;
+  for (size_t c = 0; c < sizeof(kDerived)/sizeof(kDerived[0]); c++) {
+    const QwVQWK_Channel* a = dynamic_cast<const QwVQWK_Channel*>(one.GetSubelementByName(kDerived[c]));
+    const QwVQWK_Channel* b = dynamic_cast<const QwVQWK_Channel*>(two.GetSubelementByName(kDerived[c]));
+    Bool_t same = a->GetNumberOfSamples() == b->GetNumberOfSamples()
+               && a->GetGoodEventCount() == b->GetGoodEventCount()
+               && a->GetErrorCode() == b->GetErrorCode();
+    for (size_t v = 0; v < 5; v++) {
+      same = same && a->GetValue(v) == b->GetValue(v);
+      if (errors) same = same && a->GetValueError(v) == b->GetValueError(v);
+    }
+    if (! same) {
+      if (differences == 0)
+        QwError << one.GetElementName() << " " << kDerived[c] << ": "
+                << a->GetValue() << " (" << a->GetGoodEventCount() << ", 0x"
+                << std::hex << a->GetErrorCode() << std::dec << ") and "
+                << b->GetValue() << " (" << b->GetGoodEventCount() << ", 0x"
+                << std::hex << b->GetErrorCode() << std::dec << ")" << QwLog::endl;
+      differences++;
+    }
+  }
+  return differences;
+}
+
+/// Run the events through both paths, returns the number of differences
+static Int_t Run(Int_t nevents, Int_t nbpms, Int_t eventcutmode)
+{
+  std::vector<Stripline*> single, batched, singlesum, batchedsum;
+  QwBPMStriplineBatch<QwVQWK_Channel> batch;
+  for (Int_t b = 0; b < nbpms; b++) {
+    for (Int_t set = 0; set < 2; set++) {
+      Stripline* bpm = new Stripline("benchmark", Form("bpm%02d", b), "VQWK");
+      bpm->SetDefaultSampleSize(kSamples);
+      bpm->SetEventCutMode(eventcutmode);
+      bpm->SetRotation(10.0 * b);
+      bpm->SetGains("X", 1.0 + 0.01 * b);
+      bpm->SetGains("Y", 1.0 - 0.01 * b);
+      for (Int_t k = 0; k < 4; k++) {
+        bpm->SetSubElementPedestal(k, 0.1 * k);
+        bpm->SetSubElementCalibrationFactor(k, 1.0 + 0.05 * k);
+      }
+      Stripline* sum = new Stripline(*bpm);
+      sum->ClearEventData();
+      (set == 0? single: batched).push_back(bpm);
+      (set == 0? singlesum: batchedsum).push_back(sum);
+    }
+    batch.Add(batched.back());
+  }
+
+  QwVQWK_Channel encoder("encoder");
+  encoder.SetDefaultSampleSize(kSamples);
+  TRandom3 random(4357);
+  std::vector<UInt_t> buffer;
+  Double_t block[4];
+
+  std::chrono::duration<double> tsingle(0), tbatched(0);
+  Int_t differences = 0;
+  for (Int_t event = 0; event < nevents; event++) {
+    //  Encode the wires; a few wires read zero to exercise the zero
+    //  denominators and the hardware checks
+    buffer.clear();
+    for (Int_t b = 0; b < nbpms; b++) {
+      for (Int_t k = 0; k < 4; k++) {
+        Double_t mean = (random.Uniform() < 0.001)? 0.0: random.Gaus(2.0, 0.2);
+        for (Int_t i = 0; i < 4; i++) block[i] = (mean == 0.0)? 0.0: random.Gaus(mean, 0.01);
+        encoder.SetEventData(block, event % 256);
+        encoder.EncodeEventData(buffer);
+      }
+    }
+    for (Int_t set = 0; set < 2; set++) {
+      std::vector<Stripline*>& bpms = (set == 0)? single: batched;
+      for (Int_t b = 0; b < nbpms; b++) {
+        bpms[b]->ClearEventData();
+        for (Int_t k = 0; k < 4; k++)
+          bpms[b]->ProcessEvBuffer(&buffer[(4 * b + k) * 6], 6, k);
+      }
+    }
+
+    //  Positions in both paths
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (Int_t b = 0; b < nbpms; b++) single[b]->ProcessEvent();
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    batch.ProcessEvent();
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    tsingle  += middle - start;
+    tbatched += stop - middle;
+
+    for (Int_t b = 0; b < nbpms; b++) {
+      differences += Compare(*single[b], *batched[b], kFALSE);
+      singlesum[b]->AccumulateRunningSum(*single[b]);
+      batchedsum[b]->AccumulateRunningSum(*batched[b]);
+      if (event % 10 == 0) {
+        singlesum[b]->DeaccumulateRunningSum(*single[b]);
+        batchedsum[b]->DeaccumulateRunningSum(*batched[b]);
+      }
+    }
+  }
+
+  for (Int_t b = 0; b < nbpms; b++) {
+    singlesum[b]->CalculateRunningAverage();
+    batchedsum[b]->CalculateRunningAverage();
+    differences += Compare(*singlesum[b], *batchedsum[b], kTRUE);
+  }
+
+  //  The wires are scaled by the relative gains in both paths
+  for (Int_t b = 0; b < nbpms; b++)
+    for (Int_t k = 0; k < 4; k++)
+      if (single[b]->GetSubelementByName(kWires[k])->GetValue()
+       != batched[b]->GetSubelementByName(kWires[k])->GetValue())
+        differences++;
+
+  QwMessage << nbpms << " BPMs, " << nevents << " events, event cut mode "
+            << eventcutmode << ": per channel " << tsingle.count() << " s, batched "
+            << tbatched.count() << " s, speedup "
+            << ((tbatched.count() > 0)? tsingle.count() / tbatched.count(): 0.0)
+            << ", " << differences << " differences" << QwLog::endl;
+
+  for (size_t i = 0; i < single.size(); i++) {
+    delete single[i]; delete batched[i];
+    delete singlesum[i]; delete batchedsum[i];
+  }
+  return differences;
+}
+
+int main(int argc, char** argv)
+{
+  Int_t nevents = (argc > 1)? atoi(argv[1]): 10000;
+  Int_t nbpms = (argc > 2)? atoi(argv[2]): 50;
+
+  Int_t differences = 0;
+  differences += Run(nevents, nbpms, 0);
+  differences += Run(nevents, nbpms, 3);
+  return (differences == 0)? 0: 1;
+}
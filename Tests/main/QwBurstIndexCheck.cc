@@ -0,0 +1,132 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwBurstIndexCheck.cc
+
+ \ingroup QwAnalysis
+
+ \brief Burst index of a tree against its BurstCounter branch
+
+ Usage: qwburstindexcheck rootfile tree minbursts
+
+ Reads the QwBurstIndex stored by QwRootFile in the user info of a tree
+ written with --burst-aligned-tree, and compares it with the bursts found
+ by scanning the BurstCounter branch of every entry: the index has to have
+ one range [first, end) for each run of entries with the same burst counter,
+ with that burst number, and no other ranges.  GetEntryRange of each burst
+ number and GetEntryRanges have to return the same ranges, and CheckTree
+ has to accept the index.  With ROOT 6.14 or later, each burst also has to
+ start a new cluster of the tree.  The exit status is zero only if the tree
+ has at least 'minbursts' bursts and all checks pass.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+// ROOT headers
+#include "RVersion.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
+#include "TBranch.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwBurstIndex.h"
+
+int main(int argc, char* argv[])
+{
+  if (argc != 4) {
+    QwError << "Usage: qwburstindexcheck rootfile tree minbursts" << QwLog::endl;
+    return 1;
+  }
+  Int_t minbursts = atoi(argv[3]);
+
+  TFile file(argv[1]);
+  TTree* tree = (TTree*) file.Get(argv[2]);
+  if (file.IsZombie() || tree == 0) {
+    QwError << "No tree " << argv[2] << " in " << argv[1] << QwLog::endl;
+    return 1;
+  }
+  const QwBurstIndex* index = QwBurstIndex::GetFromTree(tree);
+  if (index == 0) {
+    QwError << "No burst index in tree " << argv[2] << QwLog::endl;
+    return 1;
+  }
+  index->Print();
+
+  // Bursts from the burst counter of every entry
+  TLeaf* leaf = tree->GetLeaf("BurstCounter");
+  if (leaf == 0) {
+    QwError << "No BurstCounter in tree " << argv[2] << QwLog::endl;
+    return 1;
+  }
+  std::vector<Int_t> bursts;
+  std::vector< std::pair<Long64_t,Long64_t> > ranges;
+  for (Long64_t entry = 0; entry < tree->GetEntries(); entry++) {
+    leaf->GetBranch()->GetEntry(entry);
+    Int_t burst = Int_t(leaf->GetValue());
+    if (bursts.empty() || bursts.back() != burst) {
+      bursts.push_back(burst);
+      ranges.push_back(std::make_pair(entry, entry));
+    }
+    ranges.back().second = entry + 1;
+  }
+  QwMessage << "BurstCounter of " << tree->GetEntries() << " entries: "
+            << bursts.size() << " bursts" << QwLog::endl;
+
+  Int_t status = 0;
+  if (Int_t(bursts.size()) < minbursts) {
+    QwError << "Fewer than " << minbursts << " bursts" << QwLog::endl;
+    status = 1;
+  }
+  if (index->GetNumberOfBursts() != Int_t(bursts.size())) {
+    QwError << "The index has " << index->GetNumberOfBursts() << " bursts" << QwLog::endl;
+    return 1;
+  }
+
+  // Same bursts and ranges in the index
+  std::vector< std::pair<Long64_t,Long64_t> > indexranges = index->GetEntryRanges();
+  if (indexranges != ranges) {
+    QwError << "GetEntryRanges differs from the BurstCounter ranges" << QwLog::endl;
+    status = 1;
+  }
+  for (size_t i = 0; i < bursts.size(); i++) {
+    Long64_t first = -1, end = -1;
+    if (index->GetBurst(i) != bursts[i]
+     || index->GetFirstEntry(i) != ranges[i].first
+     || index->GetEndEntry(i) != ranges[i].second
+     || ! index->GetEntryRange(bursts[i], first, end)
+     || first != ranges[i].first || end != ranges[i].second) {
+      QwError << "Burst " << bursts[i] << ": entries " << ranges[i].first
+              << " to " << ranges[i].second - 1 << ", but the index has burst "
+              << index->GetBurst(i) << " with entries " << index->GetFirstEntry(i)
+              << " to " << index->GetEndEntry(i) - 1 << QwLog::endl;
+      status = 1;
+    }
+  }
+  if (! index->CheckTree(tree)) {
+    QwError << "CheckTree rejects the index" << QwLog::endl;
+    status = 1;
+  }
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,14,00)
+  // Every burst starts a cluster
+  std::set<Long64_t> clusters;
+  TTree::TClusterIterator cluster = tree->GetClusterIterator(0);
+  for (Long64_t start = cluster.Next(); start < tree->GetEntries(); start = cluster.Next())
+    clusters.insert(start);
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (clusters.count(ranges[i].first) == 0) {
+      QwError << "Burst " << bursts[i] << " does not start a cluster at entry "
+              << ranges[i].first << QwLog::endl;
+      status = 1;
+    }
+  }
+#endif
+
+  return status;
+}
@@ -0,0 +1,150 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwBurstSegmentationCheck.cc
+
+ \ingroup QwAnalysis
+
+ \brief Burst breaks of QwBurstSegmentation on injected modulation cycles
+
+ Usage: qwburstsegmentationcheck directory
+
+ The mock data generator has no beam modulation, so this injects beam
+ modulation cycles (events with kBModFFBErrorFlag) and beam trips (events
+ with kBeamTripError, and events dropped by the event cuts) into a sequence
+ of events out of the event ring, and passes them to a QwBurstSegmentation
+ with --burst-break-bmod and --burst-break-trip.  A break has to be
+ requested on the first event after each cycle or trip which is at least
+ as long as the option, with the right reason, and on no other event.  The
+ subsystem array of the events is empty (its detector map is written to
+ the directory).  The exit status is zero only if all checks pass.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwOptionsParity.h"
+#include "QwTypes.h"
+#include "QwEPICSEvent.h"
+#include "QwSubsystemArrayParity.h"
+#include "QwBurstSegmentation.h"
+
+/// Events in a cycle or trip before a break
+static const Int_t kModulationEvents = 50;
+static const Int_t kTripEvents = 20;
+/// Number of events in the sequence
+static const UInt_t kEvents = 12000;
+
+/// Kind of an injected interval
+enum EInterval { kModulated, kTripped, kDropped };
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    QwError << "Usage: qwburstsegmentationcheck directory" << QwLog::endl;
+    return 1;
+  }
+
+  // Empty detector map
+  const std::string mapfile = std::string(argv[1]) + "/test_empty_detectors.map";
+  std::ofstream map(mapfile.c_str());
+  map << "# No subsystems" << std::endl;
+  map.close();
+
+  DefineOptionsParity(gQwOptions);
+  std::vector<std::string> options;
+  options.push_back(argv[0]);
+  options.push_back("--detectors");
+  options.push_back(mapfile);
+  options.push_back("--burst-break-bmod");
+  options.push_back(Form("%d", kModulationEvents));
+  options.push_back("--burst-break-trip");
+  options.push_back(Form("%d", kTripEvents));
+  std::vector<char*> arguments;
+  for (size_t i = 0; i < options.size(); i++)
+    arguments.push_back(&options[i][0]);
+  gQwOptions.SetCommandLine(arguments.size(), &arguments[0], false);
+
+  // Events in beam, in a modulation cycle and in a beam trip
+  QwSubsystemArrayParity clean(gQwOptions);
+  QwSubsystemArrayParity modulated(clean);
+  modulated.UpdateErrorFlag(kGlobalCut | kBModErrorFlag | kBModFFBErrorFlag | kEventCutMode3);
+  QwSubsystemArrayParity tripped(clean);
+  tripped.UpdateErrorFlag(kGlobalCut | kBeamTripError | kEventCutMode3);
+
+  QwBurstSegmentation segmentation(gQwOptions);
+  QwEPICSEvent epicsevent;
+  segmentation.ConnectChannels(clean, epicsevent);
+
+  // Injected intervals: first event, number of events and kind, with the
+  // expected breaks on the first event after the long ones
+  struct Interval { UInt_t fFirst; UInt_t fLength; EInterval fKind; };
+  const Interval intervals[] = {
+    { 1000, 200, kModulated },
+    { 2000,  49, kModulated },  // too short
+    { 3000,  50, kModulated },
+    { 4000,   1, kModulated },  // too short
+    { 5000,  19, kTripped },    // too short
+    { 6000,  20, kTripped },
+    { 7000,  30, kDropped },
+    { 8000,  10, kDropped },    // too short
+    { 9000,  10, kTripped },    // with the dropped events below, long enough
+    { 9010,  10, kDropped },
+    {10000, 500, kModulated }
+  };
+  const size_t nintervals = sizeof(intervals) / sizeof(intervals[0]);
+  std::map<UInt_t, QwBurstSegmentation::EQwBurstEndReason> expected;
+  expected[1200]  = QwBurstSegmentation::kBurstModulation;
+  expected[3050]  = QwBurstSegmentation::kBurstModulation;
+  expected[6020]  = QwBurstSegmentation::kBurstBeamTrip;
+  expected[7030]  = QwBurstSegmentation::kBurstBeamTrip;
+  expected[9020]  = QwBurstSegmentation::kBurstBeamTrip;
+  expected[10500] = QwBurstSegmentation::kBurstModulation;
+
+  // Events out of the event ring, with a good pattern after every event
+  Int_t failures = 0;
+  std::map<UInt_t, QwBurstSegmentation::EQwBurstEndReason> found;
+  for (UInt_t event = 1; event <= kEvents; event++) {
+    QwSubsystemArrayParity* array = &clean;
+    for (size_t i = 0; i < nintervals; i++) {
+      if (event < intervals[i].fFirst || event >= intervals[i].fFirst + intervals[i].fLength)
+        continue;
+      if (intervals[i].fKind == kModulated) array = &modulated;
+      if (intervals[i].fKind == kTripped) array = &tripped;
+      if (intervals[i].fKind == kDropped) array = 0;
+    }
+    if (array == 0) continue;
+    array->SetCodaEventNumber(event);
+    segmentation.ProcessEvent(*array);
+    if (segmentation.IsBreakPending()) {
+      found[event] = segmentation.GetPendingReason();
+      segmentation.EndBurst(segmentation.GetPendingReason());
+    }
+  }
+
+  std::map<UInt_t, QwBurstSegmentation::EQwBurstEndReason>::const_iterator it;
+  for (it = found.begin(); it != found.end(); ++it) {
+    QwMessage << "Break with reason " << it->second << " on event " << it->first << QwLog::endl;
+    if (expected.count(it->first) == 0 || expected[it->first] != it->second) {
+      QwError << "Unexpected break with reason " << it->second
+              << " on event " << it->first << QwLog::endl;
+      failures++;
+    }
+  }
+  for (it = expected.begin(); it != expected.end(); ++it) {
+    if (found.count(it->first) == 0) {
+      QwError << "No break with reason " << it->second
+              << " on event " << it->first << QwLog::endl;
+      failures++;
+    }
+  }
+  segmentation.PrintSummary();
+
+  return (failures == 0)? 0: 1;
+}
@@ -0,0 +1,294 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwConfigReloadReplay.cc
+
+ \ingroup QwAnalysis
+
+ \brief Reload of the event cuts in the middle of a replay
+
+ Usage: qwconfigreloadreplay cutchannel cutfile newcutfile event [qwparity options]
+
+ Replays the runs selected by the options (e.g. a mock data run) with the
+ event loop of qwparity and its configuration reload (the options have to
+ include --config-reload yes).  At the physics event 'event' of each run,
+ the event cut file 'cutfile' is replaced by 'newcutfile', which has to
+ set other limits for the channel 'cutchannel', and a reload is requested
+ as by SIGHUP.
+
+ The limits of the channel in effect for each event are compared: every
+ helicity pattern has to be cut with one set of limits only, and the new
+ limits have to start with the pattern after the one of the requesting
+ event.  The events which fail the cuts of the channel are counted, and
+ the failed events counted by the beamline, which are not reset by the
+ reload, cannot be fewer.  The tree file has to record the reload with its
+ first pattern as 'config_reload_0', and the contents of the new cut file
+ in 'mapfiles_reload_0', which have to contain the word 'reloaded'.  The
+ exit status is zero only if all checks pass.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+// ROOT headers
+#include "TFile.h"
+#include "TList.h"
+#include "TObjString.h"
+#include "TSystem.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptionsParity.h"
+#include "QwParameterFile.h"
+#include "QwEventBuffer.h"
+#include "QwHistogramHelper.h"
+#include "QwSubsystemArrayParity.h"
+#include "QwEPICSEvent.h"
+#include "QwAnalysisPipeline.h"
+#include "QwConfigReload.h"
+#include "QwBeamLine.h"
+#include "QwHelicity.h"
+
+/// Contents of the map file in a list of map files written by the pipeline
+static TString MapFileContents(TFile& file, const TString& listname, const TString& mapfile)
+{
+  TList* list = (TList*) file.Get(listname);
+  if (list == 0) return "";
+  TIter next(list);
+  while (TList* entry = (TList*) next()) {
+    TString name = entry->GetName();
+    if (name.EndsWith(mapfile) && entry->First() != 0)
+      return ((TObjString*) entry->First())->GetString();
+  }
+  return "";
+}
+
+/// Check the records of the reload in the tree file
+static Int_t CheckRecords(const TString& rootfile, const TString& cutfile, Long_t first_pattern)
+{
+  TFile file(rootfile);
+  if (file.IsZombie()) {
+    QwError << "Unable to open " << rootfile << QwLog::endl;
+    return 1;
+  }
+  Int_t status = 0;
+
+  TObjString* record = (TObjString*) file.Get("config_reload_0");
+  if (record == 0) {
+    QwError << "No config_reload_0 in " << rootfile << QwLog::endl;
+    status = 1;
+  } else {
+    QwMessage << "Reload record: " << record->GetString() << QwLog::endl;
+    if (! record->GetString().Contains(Form("pattern %ld:", first_pattern))) {
+      QwError << "Reload record does not start with pattern " << first_pattern << QwLog::endl;
+      status = 1;
+    }
+  }
+
+  //  The map files of the run, and after the reload
+  TString basename = gSystem->BaseName(cutfile);
+  TString before = MapFileContents(file, "mapfiles", basename);
+  TString after = MapFileContents(file, "mapfiles_reload_0", basename);
+  if (before.Length() == 0 || before.Contains("reloaded")) {
+    QwError << "The map files of the run do not have the original " << basename << QwLog::endl;
+    status = 1;
+  }
+  if (after.Length() == 0 || ! after.Contains("reloaded")) {
+    QwError << "The map files after the reload do not have the new " << basename << QwLog::endl;
+    status = 1;
+  }
+  return status;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 5) {
+    QwError << "Usage: qwconfigreloadreplay cutchannel cutfile newcutfile event [qwparity options]"
+            << QwLog::endl;
+    return 1;
+  }
+  TString cutchannel = argv[1];
+  TString cutfile = argv[2];
+  TString newcutfile = argv[3];
+  UInt_t reload_event = atoi(argv[4]);
+
+  // The remaining arguments are options, as for qwparity
+  DefineOptionsParity(gQwOptions);
+  gQwOptions.AddOptions()("single-output-file", po::value<bool>()->default_bool_value(false), "Write a single output file");
+  gQwOptions.AddOptions()("print-errorcounters", po::value<bool>()->default_bool_value(true), "Print summary of error counters");
+  std::vector<char*> arguments(1, argv[0]);
+  for (Int_t i = 5; i < argc; i++) arguments.push_back(argv[i]);
+
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QW_PRMINPUT"));
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QWANALYSIS") + "/Parity/prminput");
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QWANALYSIS") + "/Analysis/prminput");
+
+  gQwOptions.SetCommandLine(arguments.size(), &arguments[0]);
+  gQwHists.ProcessOptions(gQwOptions);
+  gQwLog.ProcessOptions(&gQwOptions);
+
+  QwConfigReload reload(gQwOptions);
+  if (! reload.IsEnabled()) {
+    QwError << "The configuration reload is not enabled" << QwLog::endl;
+    return 1;
+  }
+
+  QwEventBuffer eventbuffer;
+  eventbuffer.ProcessOptions(gQwOptions);
+
+  Int_t status = 0;
+  Int_t runs = 0;
+  while (eventbuffer.OpenNextStream() == CODA_OK) {
+
+    Int_t run_number = eventbuffer.GetRunNumber();
+    TString run_label = eventbuffer.GetRunLabel();
+    QwParameterFile::SetCurrentRunNumber(run_number);
+    QwParameterFile::ClearOpenedFileList();
+    gQwOptions.Parse(kTRUE);
+    eventbuffer.ProcessOptions(gQwOptions);
+    reload.ProcessOptions(gQwOptions);
+
+    QwEPICSEvent epicsevent;
+    epicsevent.ProcessOptions(gQwOptions);
+    epicsevent.LoadChannelMap("EpicsTable.map");
+
+    QwSubsystemArrayParity detectors(gQwOptions);
+    detectors.ProcessOptions(gQwOptions);
+
+    std::vector<QwAnalysisPipeline*> pipelines;
+    pipelines.push_back(new QwAnalysisPipeline(gQwOptions, detectors, run_label));
+    pipelines.front()->OpenRootFiles(detectors, epicsevent);
+    const TString rootfile = pipelines.front()->GetRootFileNames().at(0);
+
+    //  Cut channel, beamline with the cut file, and helicity of the event
+    const VQwHardwareChannel* channel = detectors.RequestExternalPointer(cutchannel);
+    QwBeamLine* beamline = 0;
+    std::vector<VQwSubsystem*> subsys_beamline = detectors.GetSubsystemByType("QwBeamLine");
+    for (size_t i = 0; i < subsys_beamline.size(); i++) {
+      QwBeamLine* candidate = dynamic_cast<QwBeamLine*>(subsys_beamline.at(i));
+      if (candidate != 0 && candidate->GetEventCutsFile().EndsWith(gSystem->BaseName(cutfile)))
+        beamline = candidate;
+    }
+    QwHelicity* helicity = 0;
+    std::vector<VQwSubsystem*> subsys_helicity = detectors.GetSubsystemByType("QwHelicity");
+    if (subsys_helicity.size() > 0)
+      helicity = dynamic_cast<QwHelicity*>(subsys_helicity.at(0));
+    if (channel == 0 || beamline == 0 || helicity == 0) {
+      QwError << "No channel " << cutchannel << ", beamline with " << cutfile
+              << " or helicity subsystem" << QwLog::endl;
+      return 1;
+    }
+    const Double_t old_lower = channel->GetEventCutLowerLimit();
+    const Double_t old_upper = channel->GetEventCutUpperLimit();
+
+    //  Lower limit in effect for the events of each pattern
+    std::map<Long_t, std::map<Double_t, Long64_t> > pattern_limits;
+    Long_t request_pattern = -1;
+    Long64_t failed = 0, failed_before = 0;
+    while (eventbuffer.GetNextEvent() == CODA_OK) {
+
+      if (eventbuffer.IsROCConfigurationEvent())
+        eventbuffer.FillSubsystemConfigurationData(detectors);
+
+      if (eventbuffer.IsEPICSEvent()) {
+        eventbuffer.FillEPICSData(epicsevent);
+        if (epicsevent.HasDataLoaded()) {
+          epicsevent.CalculateRunningValues();
+          for (size_t i = 0; i < pipelines.size(); i++)
+            pipelines.at(i)->ProcessEPICSEvent(epicsevent);
+        }
+      }
+
+      if (! eventbuffer.IsPhysicsEvent()) continue;
+
+      eventbuffer.FillSubsystemData(detectors);
+      detectors.ProcessEvent();
+      if (detectors.ApplySingleEventCuts()) {
+        for (size_t i = 0; i < pipelines.size(); i++)
+          pipelines.at(i)->ProcessEvent(detectors);
+      }
+
+      //  Limits with which this event was cut
+      if (helicity->HasDataLoaded())
+        pattern_limits[helicity->GetPatternNumber()][channel->GetEventCutLowerLimit()]++;
+      if ((channel->GetErrorCode() & (kErrorFlag_EventCut_L | kErrorFlag_EventCut_U)) != 0) {
+        failed++;
+        if (request_pattern < 0) failed_before++;
+      }
+
+      //  Replace the cut file and request the reload in the middle of a pattern
+      if (eventbuffer.GetPhysicsEventNumber() == reload_event) {
+        if (std::rename(newcutfile, cutfile) != 0) {
+          QwError << "Unable to replace " << cutfile << " by " << newcutfile << QwLog::endl;
+          return 1;
+        }
+        request_pattern = helicity->GetPatternNumber();
+        QwMessage << "Reload requested at event " << reload_event
+                  << " in pattern " << request_pattern << QwLog::endl;
+        QwConfigReload::RequestReload();
+      }
+      reload.ProcessEvent(detectors, pipelines, eventbuffer.GetPhysicsEventNumber());
+    }
+
+    for (size_t i = 0; i < pipelines.size(); i++)
+      pipelines.at(i)->FinishEventLoop(run_number);
+    for (size_t i = 0; i < pipelines.size(); i++)
+      pipelines.at(i)->FinishRun();
+    for (size_t i = 0; i < pipelines.size(); i++) delete pipelines.at(i);
+    eventbuffer.CloseStream();
+    runs++;
+
+    if (request_pattern < 0) {
+      QwError << "Run " << run_number << " ended before event " << reload_event << QwLog::endl;
+      status = 1;
+      continue;
+    }
+
+    //  Patterns with both limits, and the first pattern with the new limits
+    Long_t mixed = 0, first_pattern = -1, old_after_new = 0;
+    for (std::map<Long_t, std::map<Double_t, Long64_t> >::const_iterator
+         pattern = pattern_limits.begin(); pattern != pattern_limits.end(); ++pattern) {
+      if (pattern->second.size() > 1) {
+        if (mixed < 10)
+          QwError << "Pattern " << pattern->first << " was cut with "
+                  << pattern->second.size() << " sets of limits" << QwLog::endl;
+        mixed++;
+      }
+      Bool_t is_old = (pattern->second.count(old_lower) > 0);
+      if (! is_old && first_pattern < 0) first_pattern = pattern->first;
+      if (is_old && first_pattern >= 0) old_after_new++;
+    }
+    QwMessage << "Run " << run_number << ": limits " << old_lower << " to " << old_upper
+              << " until pattern " << first_pattern << ", " << mixed << " mixed patterns, "
+              << failed << " events failed " << cutchannel << " (" << failed_before
+              << " before the reload), " << beamline->GetNumberOfFailedEvents()
+              << " failed the beamline cuts" << QwLog::endl;
+
+    if (mixed > 0 || old_after_new > 0) status = 1;
+    if (first_pattern != request_pattern + 1) {
+      QwError << "New limits from pattern " << first_pattern << " instead of "
+              << request_pattern + 1 << QwLog::endl;
+      status = 1;
+    }
+    if (failed_before == 0 || failed == failed_before) {
+      QwError << "The cuts of " << cutchannel << " have to fail events before "
+              << "and after the reload" << QwLog::endl;
+      status = 1;
+    }
+    if (beamline->GetNumberOfFailedEvents() < failed) {
+      QwError << "The beamline counted fewer failed events than " << cutchannel
+              << "; its error counter was reset" << QwLog::endl;
+      status = 1;
+    }
+    status |= CheckRecords(rootfile, cutfile, request_pattern + 1);
+  }
+
+  if (runs == 0) {
+    QwError << "No runs replayed" << QwLog::endl;
+    return 1;
+  }
+  return status;
+}
@@ -0,0 +1,123 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwHelicityCrossCheck.cc
+
+ \ingroup QwAnalysis_BL
+
+ \brief Helicity source cross-check with injected disagreements
+
+ Usage: qwhelicitycrosscheck generatormap mapfile events [options]
+
+ A helicity generator, set up from a map file in input register mode,
+ encodes the delayed helicity of every event into the input register, and
+ also into the userbit word which the map files have to list after the
+ words of the input register mode (with a scaler counter word before it,
+ for the userbit mode).  From event 5000 on, every 5000 events the
+ helicity bit of the userbit word is flipped, and 2500 events later the
+ helicity bits of the input register.  The events are decoded by a second
+ QwHelicity from the other map file, with the same words in either
+ decoding mode, and with the options on the command line (e.g.
+ --helicity.crosscheck yes).
+
+ The flips of the source which is not decoded have to show up as exactly
+ as many disagreements of that source.  The flips of the decoded source
+ are seen by the predictor, which then collects a new seed; there have to
+ be at least as many predictor disagreements, and at most twice as many.
+ The injected flips are printed with the helicity error summary, which the
+ test script compares.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <cstdlib>
+#include <vector>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwOptionsParity.h"
+#include "QwParameterFile.h"
+#include "QwHelicity.h"
+
+// Multiplet structure of the mock data
+static const Int_t kMultiplet = 64;
+// Events between flips of the same source, and first flip
+static const Int_t kFlipSpacing = 5000;
+// Words of the input register mode before the scaler counter and userbit
+static const Int_t kInputRegisterWord = 0;
+static const Int_t kScalerCounterWord = 5;
+static const Int_t kUserbitWord = 6;
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4) {
+    QwError << "Usage: qwhelicitycrosscheck generatormap mapfile events [options]" << QwLog::endl;
+    return 1;
+  }
+  TString generatormap = argv[1];
+  TString mapfile = argv[2];
+  Int_t nevents = atoi(argv[3]);
+
+  // The remaining arguments are options
+  DefineOptionsParity(gQwOptions);
+  std::vector<char*> arguments(1, argv[0]);
+  for (Int_t i = 4; i < argc; i++) arguments.push_back(argv[i]);
+  gQwOptions.SetCommandLine(arguments.size(), &arguments[0], false);
+
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QW_PRMINPUT"));
+  QwParameterFile::AppendToSearchPath(getenv_safe_string("QWANALYSIS") + "/Parity/prminput");
+
+  // Generator in input register mode
+  QwHelicity generator("Helicity Info");
+  generator.LoadChannelMap(generatormap);
+  generator.ProcessOptions(gQwOptions);
+
+  // Analysis in the decoding mode of its map file
+  QwHelicity helicity("Helicity Info");
+  helicity.LoadChannelMap(mapfile);
+  helicity.ProcessOptions(gQwOptions);
+
+  generator.SetEventPatternPhase(-1, -1, -1);
+  generator.SetFirstBits(24, 0x1234 & 0xFFFFFF);
+
+  Int_t userbitflips = 0, registerflips = 0;
+  std::vector<UInt_t> buffer;
+  for (Int_t event = 0; event < nevents; event++) {
+    generator.SetEventPatternPhase(event, event / kMultiplet, event % kMultiplet + 1);
+    generator.RunPredictor();
+
+    buffer.clear();
+    generator.EncodeEventData(buffer);
+    // Skip the bank and subbank headers
+    const ROCID_t roc_id = buffer[1] >> 16;
+    const BankID_t bank_id = buffer[3] >> 16;
+    UInt_t* words = &buffer[4];
+    const UInt_t nwords = buffer.size() - 4;
+
+    // Redundant userbit word, with the pattern start and delayed helicity
+    words[kScalerCounterWord] = 0x20;
+    words[kUserbitWord] = 0x0;
+    if (event % kMultiplet == 0)                words[kUserbitWord] |= 0x80000000;
+    if (generator.GetHelicityDelayed() == 1)    words[kUserbitWord] |= 0x40000000;
+
+    // Injected disagreements, in different patterns
+    if (event >= kFlipSpacing && event % kFlipSpacing == 0) {
+      words[kUserbitWord] ^= 0x40000000;
+      userbitflips++;
+    }
+    if (event >= kFlipSpacing && event % kFlipSpacing == kFlipSpacing / 2) {
+      // Default HelPlus and HelMinus bits of the input register
+      words[kInputRegisterWord] ^= 0x3;
+      registerflips++;
+    }
+
+    helicity.ClearEventData();
+    helicity.ProcessEvBuffer(roc_id, bank_id, words, nwords);
+    helicity.ProcessEvent();
+  }
+
+  helicity.PrintErrorCounters();
+  QwMessage << "Injected " << userbitflips << " userbit flips and "
+            << registerflips << " input register flips" << QwLog::endl;
+  return 0;
+}
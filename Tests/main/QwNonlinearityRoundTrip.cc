@@ -0,0 +1,181 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwNonlinearityRoundTrip.cc
+
+ \ingroup QwAnalysis
+
+ \brief Round trip of a nonlinearity correction table
+
+ Usage: qwnonlinearityroundtrip directory
+
+ Tabulates the inverse of the synthetic nonlinear response
+
+   measured = true + kQuadratic * true^2
+
+ on a grid of measured values, and writes the table to the directory with
+ QwInterpolator::WriteBinaryFile and WriteTextFile.  A map file assigns the
+ binary table to one channel and the text table to another, and is loaded
+ as --nonlinearity-map.  The binary table has to be memory-mapped, and the
+ text table has to be read by the text fallback.  For both channels,
+ QwNonlinearityCorrection::Apply has to give back the true value of
+ measured values inside the table to interpolation precision, and has to
+ leave values outside the table (and NaN) unchanged.  The exit status is
+ zero only if all checks pass.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwOptions.h"
+#include "QwOptionsParity.h"
+#include "QwParameterFile.h"
+#include "QwInterpolator.h"
+#include "QwNonlinearityCorrection.h"
+
+/// Quadratic term of the synthetic response
+static const Double_t kQuadratic = 0.02;
+/// Grid of measured values in the table
+static const Double_t kMinimum = 0.0, kMaximum = 10.0, kStep = 0.01;
+/// Tolerance of the corrected values: the interpolation error is below
+/// kStep^2/8 times the curvature of the inverse (5e-7), and the text table
+/// has six significant digits
+static const Double_t kTolerance = 1.0e-5;
+
+/// Synthetic nonlinear response
+static Double_t Response(Double_t value)
+{
+  return value + kQuadratic * value * value;
+}
+
+/// True value of a measured value
+static Double_t Inverse(Double_t measured)
+{
+  return (std::sqrt(1.0 + 4.0 * kQuadratic * measured) - 1.0) / (2.0 * kQuadratic);
+}
+
+/// Check the correction of one channel
+static Int_t Check(const TString& channel)
+{
+  const QwNonlinearityCorrection* correction = QwNonlinearityCorrection::Find(channel);
+  if (correction == 0) {
+    QwError << "No correction for channel " << channel << QwLog::endl;
+    return 1;
+  }
+
+  // Inside the table: true values from 0 to just below the inverse of the
+  // maximum (the response of that value may round to above the table)
+  Int_t failures = 0;
+  Double_t maxdiff = 0.0;
+  const Double_t last = Inverse(kMaximum);
+  for (Int_t i = 0; i < 10000; i++) {
+    Double_t value = last * i / 10000.0;
+    Double_t corrected = Response(value);
+    correction->Apply(&corrected, 1);
+    maxdiff = std::max(maxdiff, std::fabs(corrected - value));
+    if (std::fabs(corrected - value) > kTolerance) {
+      if (failures < 10)
+        QwError << channel << ": measured " << Response(value) << " corrected to "
+                << corrected << " instead of " << value << QwLog::endl;
+      failures++;
+    }
+  }
+  QwMessage << channel << ": largest difference " << maxdiff << " of the corrected "
+            << "from the true values, " << Response(last) - last
+            << " without correction" << QwLog::endl;
+
+  // Outside the table, and NaN, as hardware sum and blocks
+  Double_t outside[4] = { kMinimum - 1.0, kMaximum + 0.5, -1.0e6, NAN };
+  Double_t values[4];
+  std::copy(outside, outside + 4, values);
+  correction->Apply(values, 4);
+  for (Int_t i = 0; i < 4; i++) {
+    if (values[i] != outside[i] && ! (std::isnan(values[i]) && std::isnan(outside[i]))) {
+      QwError << channel << ": " << outside[i] << " outside of the table changed to "
+              << values[i] << QwLog::endl;
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    QwError << "Usage: qwnonlinearityroundtrip directory" << QwLog::endl;
+    return 1;
+  }
+  std::string directory = argv[1];
+
+  // Table of the true value as function of the measured value
+  QwInterpolator<float,1> table(1);
+  table.SetMinimumMaximumStep(kMinimum, kMaximum, kStep);
+  for (unsigned int i = 0; i < table.GetMaximumEntries(); i++) {
+    coord_t measured = kMinimum + i * kStep;
+    table.Set(i, float(Inverse(measured)));
+  }
+  const std::string binary = directory + "/nonlinearity_table.bin";
+  const std::string text = directory + "/nonlinearity_table.txt";
+  if (! table.WriteBinaryFile(binary) || ! table.WriteTextFile(text)) {
+    QwError << "Unable to write the tables to " << directory << QwLog::endl;
+    return 1;
+  }
+
+  // The binary table is mapped, the text table is not
+  Int_t failures = 0;
+  QwInterpolator<float,1> mapped(1), unmapped(1);
+  if (! mapped.MapBinaryFile(binary) || ! mapped.IsMapped()) {
+    QwError << "Unable to map " << binary << QwLog::endl;
+    failures++;
+  }
+  if (unmapped.MapBinaryFile(text)) {
+    QwError << "Text table " << text << " was mapped as binary table" << QwLog::endl;
+    failures++;
+  }
+
+  // Map file with relative table paths
+  const std::string mapfile = directory + "/nonlinearity_test.map";
+  std::ofstream map(mapfile.c_str());
+  map << "# Nonlinearity round trip" << std::endl
+      << "test_binary  nonlinearity_table.bin" << std::endl
+      << "test_text    nonlinearity_table.txt" << std::endl;
+  map.close();
+
+  // Load the map file as in a replay
+  DefineOptionsParity(gQwOptions);
+  std::string option = "--nonlinearity-map";
+  std::vector<char*> arguments;
+  arguments.push_back(argv[0]);
+  arguments.push_back(&option[0]);
+  arguments.push_back(const_cast<char*>(mapfile.c_str()));
+  gQwOptions.SetCommandLine(arguments.size(), &arguments[0], false);
+  QwNonlinearityCorrection::ProcessOptions(gQwOptions);
+
+  failures += Check("test_binary");
+  failures += Check("TEST_TEXT");
+  if (QwNonlinearityCorrection::Find("test_other") != 0) {
+    QwError << "Correction for a channel which is not in the map" << QwLog::endl;
+    failures++;
+  }
+
+  // The tables are part of the replay configuration
+  Int_t opened = 0;
+  const std::set<std::string>& files = QwParameterFile::GetOpenedFileList();
+  for (std::set<std::string>::const_iterator file = files.begin(); file != files.end(); file++)
+    if (TString(*file).EndsWith("/nonlinearity_table.bin")
+     || TString(*file).EndsWith("/nonlinearity_table.txt")) opened++;
+  if (opened != 2) {
+    QwError << "The tables are not in the list of opened files" << QwLog::endl;
+    failures++;
+  }
+
+  return (failures == 0)? 0: 1;
+}
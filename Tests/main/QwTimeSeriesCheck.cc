@@ -0,0 +1,204 @@
+/*------------------------------------------------------------------------*//*!
+
+ \file QwTimeSeriesCheck.cc
+
+ \ingroup QwAnalysis
+
+ \brief Time series file against brute-force binning of the evt tree
+
+ Usage: qwtimeseriescheck rootfile timeseriesfile rate tmin tmax
+
+ Reads the time series file written with --timeseries-channel and
+ --timeseries-mps-rate 'rate' with QwTimeSeriesReader, and bins the hardware
+ sums of the same channels in the good events (zero ErrorFlag) of the evt
+ tree directly, at every level.  The start time of the run is the offset of
+ the first bin from its time since the start of the run, and has to be
+ between the unix times 'tmin' and 'tmax' (before and after the generation
+ of the mock data).  The bins have to agree in start time, count, minimum
+ and maximum exactly, and in mean and variance to rounding.
+
+ The first half of the file, as read while the run is still being analyzed,
+ has to give the same start times for the bins in it: the start time of the
+ run has to be written before the bins.  The exit status is zero only if all
+ checks pass.
+
+*//*-------------------------------------------------------------------------*/
+
+// C and C++ headers
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "TFile.h"
+#include "TTree.h"
+#include "TLeaf.h"
+
+// Qweak headers
+#include "QwLog.h"
+#include "QwTimeSeries.h"
+
+/// Relative tolerance of the means and variances
+static const Double_t kTolerance = 1.0e-9;
+
+/// Do two values agree to the tolerance?
+static Bool_t Agree(Double_t a, Double_t b)
+{
+  return std::fabs(a - b) <= kTolerance * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 6) {
+    QwError << "Usage: qwtimeseriescheck rootfile timeseriesfile rate tmin tmax" << QwLog::endl;
+    return 1;
+  }
+  const std::string filename = argv[2];
+  const Double_t rate = atof(argv[3]);
+  const Double_t tmin = atof(argv[4]), tmax = atof(argv[5]);
+
+  QwTimeSeriesReader reader;
+  if (! reader.AddFile(filename) || reader.GetNumberOfChannels() == 0) {
+    QwError << "No channels in " << filename << QwLog::endl;
+    return 1;
+  }
+  const Int_t levels = reader.GetNumberOfLevels();
+
+  TFile file(argv[1]);
+  TTree* evt = (TTree*) file.Get("evt");
+  if (file.IsZombie() || evt == 0) {
+    QwError << "No evt tree in " << argv[1] << QwLog::endl;
+    return 1;
+  }
+  TLeaf* number = evt->GetLeaf("CodaEventNumber");
+  TLeaf* flag = evt->GetLeaf("ErrorFlag");
+  if (number == 0 || flag == 0) {
+    QwError << "No CodaEventNumber or ErrorFlag in the evt tree" << QwLog::endl;
+    return 1;
+  }
+
+  Int_t failures = 0;
+  Double_t start = -1.0;
+  for (size_t channel = 0; channel < reader.GetNumberOfChannels(); channel++) {
+    const std::string& name = reader.GetChannelName(channel);
+    TLeaf* value = evt->GetLeaf(name.c_str(), "hw_sum");
+    if (value == 0) {
+      QwError << "No " << name << ".hw_sum in the evt tree" << QwLog::endl;
+      return 1;
+    }
+
+    // Brute-force bins of each level, in seconds since the start of the run
+    std::vector<std::vector<QwTimeSeriesBin> > bins(levels);
+    std::vector<std::vector<std::vector<Double_t> > > values(levels);
+    for (Long64_t entry = 0; entry < evt->GetEntries(); entry++) {
+      evt->GetEntry(entry);
+      if (flag->GetValue() != 0) continue;
+      Double_t time = number->GetValue() / rate;
+      for (Int_t level = 0; level < levels; level++) {
+        Double_t width = reader.GetBinWidth(level);
+        Double_t binstart = std::floor(time / width) * width;
+        if (bins[level].empty() || bins[level].back().fStart != binstart) {
+          bins[level].push_back(QwTimeSeriesBin());
+          bins[level].back().fStart = binstart;
+          values[level].push_back(std::vector<Double_t>());
+        }
+        values[level].back().push_back(value->GetValue());
+      }
+    }
+    for (Int_t level = 0; level < levels; level++) {
+      for (size_t i = 0; i < bins[level].size(); i++) {
+        const std::vector<Double_t>& v = values[level][i];
+        QwTimeSeriesBin& bin = bins[level][i];
+        Double_t sum = 0.0;
+        bin.fCount = v.size();
+        bin.fMin = bin.fMax = v[0];
+        for (size_t k = 0; k < v.size(); k++) {
+          sum += v[k];
+          bin.fMin = std::min(bin.fMin, v[k]);
+          bin.fMax = std::max(bin.fMax, v[k]);
+        }
+        bin.fMean = sum / v.size();
+        for (size_t k = 0; k < v.size(); k++)
+          bin.fM2 += (v[k] - bin.fMean) * (v[k] - bin.fMean);
+      }
+    }
+
+    // Start time of the run from the first bin
+    std::vector<QwTimeSeriesBin> first = reader.GetBins(channel, 0, -1e300, 1e300);
+    if (first.empty() || bins[0].empty()) {
+      QwError << "No bins for " << name << QwLog::endl;
+      return 1;
+    }
+    if (start < 0.0) {
+      start = first[0].fStart - bins[0][0].fStart;
+      QwMessage << "Start of the run at unix time " << Long64_t(start) << QwLog::endl;
+      if (start < tmin || start > tmax || start != std::floor(start)) {
+        QwError << "Start of the run " << start << " is not between " << tmin
+                << " and " << tmax << QwLog::endl;
+        failures++;
+      }
+    }
+
+    // Bins of the file
+    for (Int_t level = 0; level < levels; level++) {
+      std::vector<QwTimeSeriesBin> read = reader.GetBins(channel, level, -1e300, 1e300);
+      if (read.size() != bins[level].size()) {
+        QwError << name << " level " << level << ": " << read.size()
+                << " bins instead of " << bins[level].size() << QwLog::endl;
+        failures++;
+        continue;
+      }
+      for (size_t i = 0; i < read.size(); i++) {
+        const QwTimeSeriesBin& a = read[i];
+        const QwTimeSeriesBin& b = bins[level][i];
+        if (a.fStart != b.fStart + start || a.fCount != b.fCount
+         || a.fMin != b.fMin || a.fMax != b.fMax
+         || ! Agree(a.fMean, b.fMean) || ! Agree(a.GetVariance(), b.GetVariance())) {
+          if (failures < 10)
+            QwError << name << " level " << level << " bin " << i << ": start "
+                    << a.fStart - start << ", count " << a.fCount << ", mean " << a.fMean
+                    << " instead of start " << b.fStart << ", count " << b.fCount
+                    << ", mean " << b.fMean << QwLog::endl;
+          failures++;
+        }
+      }
+      QwMessage << name << " level " << level << ": " << read.size() << " bins" << QwLog::endl;
+    }
+  }
+
+  // First half of the file, as read during the analysis
+  std::ifstream full(filename.c_str(), std::ios::in | std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(full)), std::istreambuf_iterator<char>());
+  const std::string halfname = filename + ".half";
+  std::ofstream half(halfname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  half.write(&bytes[0], bytes.size() / 2);
+  half.close();
+  QwTimeSeriesReader partial;
+  if (! partial.AddFile(halfname)) return 1;
+  Int_t partialbins = 0;
+  for (size_t channel = 0; channel < reader.GetNumberOfChannels(); channel++) {
+    for (Int_t level = 0; level < levels; level++) {
+      std::vector<QwTimeSeriesBin> all = reader.GetBins(channel, level, -1e300, 1e300);
+      std::vector<QwTimeSeriesBin> some = partial.GetBins(channel, level, -1e300, 1e300);
+      partialbins += some.size();
+      for (size_t i = 0; i < some.size(); i++) {
+        if (i >= all.size() || some[i].fStart != all[i].fStart || some[i].fCount != all[i].fCount) {
+          QwError << "Bin " << i << " of level " << level << " in the first half of the file"
+                  << " starts at " << some[i].fStart << QwLog::endl;
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+  if (partialbins == 0) {
+    QwError << "No bins in the first half of the file" << QwLog::endl;
+    failures++;
+  }
+
+  return (failures == 0)? 0: 1;
+}
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Common functions for the tests which generate and analyze mock data.
+#
+#   Source this file from a test script in the top directory.  It creates a
+#   scratch directory ${TESTDIR}, which is removed when the test exits, and
+#   puts ${QW_PRMINPUT} (a directory in the scratch directory) first in the
+#   parameter file search path, so that tests can override single parameter
+#   files.  The mock data and the analysis use the configuration described
+#   in the README.
+#
+
+export QWANALYSIS=${QWANALYSIS:-`pwd`}
+TESTDIR=`mktemp -d -t qwtest.XXXXXX` || exit -1
+trap "rm -rf ${TESTDIR}" EXIT
+export QW_PRMINPUT=${TESTDIR}/prminput
+mkdir -p ${QW_PRMINPUT} || exit -1
+
+MOCK_CONFIG="--config qwparity_simple.conf --detectors mock_newdets.map"
+
+#  mock_generate <run> <events> [options]
+#    Generate a mock data file for a run in the scratch directory
+function mock_generate() {
+  local run=$1 events=$2
+  shift 2
+  build/qwmockdatagenerator -r ${run} -e 1:${events} ${MOCK_CONFIG} \
+    --data ${TESTDIR} "$@" > ${TESTDIR}/qwmockdatagenerator_${run}.log 2>&1
+}
+
+#  mock_replay <run> [options]
+#    Analyze the mock data file of a run, writing the ROOT files to the
+#    scratch directory; the log is written to standard output
+function mock_replay() {
+  local run=$1
+  shift
+  build/qwparity -r ${run} ${MOCK_CONFIG} \
+    --data ${TESTDIR} --rootfiles ${TESTDIR} "$@"
+}
+
+#  mock_rootfile <run> [stem]
+#    Name of the ROOT file of a run written by mock_replay
+function mock_rootfile() {
+  echo ${TESTDIR}/${2:-isu_sample_}${1}.root
+}
+
+#  run_macro <macro> [arguments]
+#    Run a ROOT macro from the test directory in batch mode; the macros
+#    exit with a nonzero status on failure
+function run_macro() {
+  local macro=$1
+  shift
+  root -l -b -q "Tests/${macro}(${*})"
+}
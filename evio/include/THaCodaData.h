@@ -36,6 +36,9 @@ public:
    virtual int codaOpen(TString __attribute__((__unused__)) filename, TString __attribute__((__unused__)) session, int __attribute__((__unused__)) mode) {return CODA_OK;};
    virtual int codaClose() = 0;
    virtual int codaRead() = 0;
+   virtual int codaSeekBlock(int __attribute__((__unused__)) block) {return CODA_ERROR;};
+   virtual int getBlockCount() const {return 0;};
+   virtual int getBlockNumber() const {return -1;};
    virtual int *getEvBuffer() { return evbuffer; };
    virtual int getBuffSize() const { return MAXEVLEN; };
    virtual int status() const { return fStatus; };
@@ -40,6 +40,9 @@ public:
   int codaClose();
   int codaRead();
   int codaWrite(int* evbuffer);
+  int codaSeekBlock(int block);              // continue reading at a block
+  int getBlockCount() const;                 // number of blocks in the file
+  int getBlockNumber() const;                // block of the last read
   int *getEvBuffer();
   int filterToFile(TString output_file);     // filter to an output file
   void addEvTypeFilt(int evtype_to_filt);    // add an event type to list
@@ -60,6 +60,7 @@ public:
     int *getEvBuffer();        // Gets next event buffer after codaRead()
     int codaRead();            // codaRead() must be called once per event
     int getheartbeat();
+    void setZeroCopy(int flag) { zerocopy = flag; };  // decode events in ET memory
 
 private:
 
@@ -71,6 +72,11 @@ private:
     int SMALL_TIMEOUT; 
     int BIG_TIMEOUT; 
     int nread, nused, timeout;
+    et_event *evs[ET_CHUNK_SIZE];  // chunk of events from et_events_get
+    int held;                      // chunk not yet returned to ET
+    int zerocopy;                  // point into ET memory instead of copying
+    int *evptr;                    // current event
+    int putChunk();
     et_sys_id id;
     et_statconfig sconfig;
     et_stat_id my_stat;
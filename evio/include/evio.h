@@ -60,6 +60,8 @@ typedef struct evBinarySearch{
 extern int evOpen(char *filename, char *flags, EVFILE **handle);
 extern int evRead(EVFILE *handle, int *buffer, int buflen);
 extern int evGetNewBuffer(EVFILE *a);
+extern int evGetBlockCount(EVFILE *handle);
+extern int evSeekBlock(EVFILE *handle, int blknum);
 extern int evWrite(EVFILE *handle,int *buffer);
 extern int evFlush(EVFILE *a);
 extern int evIoctl(EVFILE *handle,char *request,void *argp);